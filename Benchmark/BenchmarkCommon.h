@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <random>
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Shared helpers for the headless collision benchmarks
+
+// Simple wall clock stopwatch
+class BenchmarkTimer
+{
+public:
+	BenchmarkTimer() : start(std::chrono::high_resolution_clock::now()) {}
+
+	void Reset() { start = std::chrono::high_resolution_clock::now(); }
+
+	// Milliseconds since construction or the last Reset()
+	double ElapsedMs() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point start;
+};
+
+// Moving box used to drive a broadphase
+struct BenchmarkBox
+{
+	XMFLOAT3 center;
+	XMFLOAT3 halfExtents;
+	XMFLOAT3 velocity;
+};
+
+// Fill a cube of the given half width with boxes that bounce around inside it
+inline std::vector<BenchmarkBox> CreateBenchmarkBoxes(unsigned int count, float worldHalfWidth, float minHalf, float maxHalf, float maxSpeed, unsigned int seed = 1234)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-worldHalfWidth, worldHalfWidth);
+	std::uniform_real_distribution<float> half(minHalf, maxHalf);
+	std::uniform_real_distribution<float> speed(-maxSpeed, maxSpeed);
+
+	std::vector<BenchmarkBox> boxes(count);
+	for (auto& box : boxes) {
+		float h = half(rng);
+		box.center = XMFLOAT3(position(rng), position(rng), position(rng));
+		box.halfExtents = XMFLOAT3(h, h, h);
+		box.velocity = XMFLOAT3(speed(rng), speed(rng), speed(rng));
+	}
+	return boxes;
+}
+
+// Advance every box, reflecting off the world bounds
+inline void StepBenchmarkBoxes(std::vector<BenchmarkBox>& boxes, const XMFLOAT3& worldHalfWidth, float deltaTime)
+{
+	const float* w = &worldHalfWidth.x;
+	for (auto& box : boxes) {
+		float* c = &box.center.x;
+		float* v = &box.velocity.x;
+		for (int axis = 0; axis < 3; axis++) {
+			c[axis] += v[axis] * deltaTime;
+			if (c[axis] < -w[axis] || c[axis] > w[axis]) {
+				v[axis] = -v[axis];
+				c[axis] += 2 * v[axis] * deltaTime;
+			}
+		}
+	}
+}
+
+inline void StepBenchmarkBoxes(std::vector<BenchmarkBox>& boxes, float worldHalfWidth, float deltaTime)
+{
+	StepBenchmarkBoxes(boxes, XMFLOAT3(worldHalfWidth, worldHalfWidth, worldHalfWidth), deltaTime);
+}
+
+// True when two boxes overlap, used so candidate pairs are actually consumed
+inline bool BenchmarkBoxesOverlap(const BenchmarkBox& a, const BenchmarkBox& b)
+{
+	return fabsf(a.center.x - b.center.x) <= a.halfExtents.x + b.halfExtents.x
+		&& fabsf(a.center.y - b.center.y) <= a.halfExtents.y + b.halfExtents.y
+		&& fabsf(a.center.z - b.center.z) <= a.halfExtents.z + b.halfExtents.z;
+}
@@ -0,0 +1,212 @@
+#include "BenchmarkEntities.h"
+#include <cassert>
+#include "CollisionManager.h"
+
+// --------------------------------------------------------
+// Members of Entity that collision uses, as the game's
+// Entity.cpp defines them less the renderer
+// --------------------------------------------------------
+Entity::Entity(EntityFactory* entityFactory, std::string name, Mesh* mesh, Material* material) :
+	entityFactory(entityFactory),
+	name(name),
+	mesh(mesh),
+	material(material)
+{
+	SetIsRendering(mesh != nullptr && material != nullptr);
+	SetIsUpdating(true);
+	SetIsColliding(false);
+}
+
+Entity::~Entity()
+{
+	if (storeId != ENTITY_STORE_NONE) entityFactory->GetEntityStore().Destroy(storeId);
+}
+
+void Entity::SetIsUpdating(bool isUpdating)
+{
+	entityFactory->SetEntityUpdating(this, isUpdating);
+}
+
+void Entity::SetIsRendering(bool isRendering)
+{
+	entityFactory->SetEntityRendering(this, isRendering);
+}
+
+void Entity::SetIsColliding(bool isColliding)
+{
+	entityFactory->SetEntityCollision(this, isColliding);
+}
+
+bool Entity::GetIsColliding()
+{
+	return isColliding;
+}
+
+void Entity::SetCollider(Collider::ColliderType type, XMFLOAT3 scale, XMFLOAT3 offset, XMFLOAT4 rotation, unsigned int layer)
+{
+	if (collider != nullptr) {
+		return;
+	}
+	collider = entityFactory->GetSceneArena().Create<Collider>(type, offset, scale, rotation);
+	collider->SetParentEntity(this);
+	collider->SetLayer(layer);
+	entityFactory->SetEntityCollision(this, true);
+}
+
+Collider * const Entity::GetCollider() const
+{
+	return collider;
+}
+
+std::string Entity::GetName() const
+{
+	return name;
+}
+
+EntityHandle Entity::GetHandle() const
+{
+	return handle;
+}
+
+void Entity::OnCollision(const Collision&)
+{
+}
+
+void Entity::OnCollisionEnter(const Collision& collision)
+{
+	OnCollision(collision);
+}
+
+void Entity::OnCollisionStay(const Collision& collision)
+{
+	OnCollision(collision);
+}
+
+void Entity::OnCollisionExit(const Collision&)
+{
+}
+
+// --------------------------------------------------------
+// The factory's bookkeeping, as EntityFactory.cpp less the
+// command buffers and the renderer
+// --------------------------------------------------------
+EntityFactory::~EntityFactory()
+{
+	Release();
+}
+
+void EntityFactory::DestroyEntity(Entity* entity)
+{
+	if (entity->isDestroyed) return;
+	SetEntityUpdating(entity, false);
+	SetEntityRendering(entity, false);
+	SetEntityCollision(entity, false);
+	entity->isDestroyed = true;
+	destroyedEntities.push_back(entity);
+}
+
+void EntityFactory::FlushDestroyedEntities()
+{
+	assert(!CollisionManager::Instance()->IsDispatching());
+	for (size_t i = 0; i < destroyedEntities.size(); i++) {
+		Entity* entity = destroyedEntities[i];
+		registry.Destroy(entity->handle);
+		sceneArena.Destroy(entity->collider);
+		sceneArena.Destroy(entity);
+	}
+	destroyedEntities.clear();
+}
+
+void EntityFactory::UpdateEntities(float deltaTime, float totalTime)
+{
+	const std::vector<Entity*>& updatingEntities = registry.GetList(ENTITY_LIST_UPDATING);
+	updateOrder.clear();
+	for (size_t i = 0; i < updatingEntities.size(); i++)
+		updateOrder.push_back(updatingEntities[i]->handle);
+	for (size_t i = 0; i < updateOrder.size(); i++) {
+		if (registry.IsInList(updateOrder[i], ENTITY_LIST_UPDATING))
+			registry.Get(updateOrder[i])->Update(deltaTime, totalTime);
+	}
+	FlushDestroyedEntities();
+}
+
+void EntityFactory::SetEntityCollision(Entity* entity, bool isColliding)
+{
+	if (entity->isColliding == isColliding) {
+		return;
+	}
+	entity->isColliding = isColliding;
+	isColliding ? registry.AddToList(entity->handle, ENTITY_LIST_COLLIDING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_COLLIDING);
+	isColliding ? CollisionManager::Instance()->StageCollider(entity->GetCollider()) : CollisionManager::Instance()->UnstageCollider(entity->GetCollider());
+}
+
+void EntityFactory::SetEntityRendering(Entity* entity, bool isRendering)
+{
+	if (entity->isRendering == isRendering) {
+		return;
+	}
+	entity->isRendering = isRendering;
+	isRendering ? registry.AddToList(entity->handle, ENTITY_LIST_RENDERING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_RENDERING);
+}
+
+void EntityFactory::SetEntityUpdating(Entity* entity, bool isUpdating)
+{
+	if (entity->isUpdating == isUpdating) {
+		return;
+	}
+	entity->isUpdating = isUpdating;
+	isUpdating ? registry.AddToList(entity->handle, ENTITY_LIST_UPDATING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_UPDATING);
+}
+
+void EntityFactory::Release()
+{
+	if (registry.GetCount() > 0)
+		CollisionManager::Instance()->UnstageAll();
+	destroyedEntities.clear();
+	sceneArena.Reset();
+	registry.Clear();
+	entityStore.Clear();
+}
+
+const EntityRegistry& EntityFactory::GetRegistry() const
+{
+	return registry;
+}
+
+EntityStore& EntityFactory::GetEntityStore()
+{
+	return entityStore;
+}
+
+SceneArena& EntityFactory::GetSceneArena()
+{
+	return sceneArena;
+}
+
+// --------------------------------------------------------
+// Benchmark entity
+// --------------------------------------------------------
+BenchmarkEntity::BenchmarkEntity(EntityFactory* entityFactory, std::string name) :
+	Entity(entityFactory, name)
+{
+}
+
+void BenchmarkEntity::Update(float, float)
+{
+}
+
+void BenchmarkEntity::OnCollisionEnter(const Collision&)
+{
+	enters++;
+}
+
+void BenchmarkEntity::OnCollisionStay(const Collision&)
+{
+	stays++;
+}
+
+void BenchmarkEntity::OnCollisionExit(const Collision& collision)
+{
+	exits++;
+	if (collision.otherCollider == nullptr) owedExits++;
+}
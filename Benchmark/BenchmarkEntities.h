@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Entity.h"
+#include "EntityRegistry.h"
+#include "EntityStore.h"
+#include "SceneArena.h"
+
+// Stand-in for the game's EntityFactory, which needs the renderer, so a
+// benchmark can run entities through the real CollisionManager without a
+// window. Entity names the factory a friend, so this one keeps handles, lists
+// and colliders the way the game's does, and BenchmarkEntities.cpp defines
+// the members of Entity that collision and these benchmarks use against it.
+// Meshes, materials, names, tags, emitters and the store systems are left
+// out, and entities only update serially.
+class EntityFactory
+{
+public:
+	~EntityFactory();
+
+	// T is constructed from the factory and the name
+	template<typename T>
+	T* CreateEntity(std::string name);
+
+	// As the game's: the entity leaves every list at once and is freed on
+	// the next flush, never while collision callbacks run
+	void DestroyEntity(Entity* entity);
+	void FlushDestroyedEntities();
+
+	// Updates the entities updating as the walk starts, as the game's serial
+	// walk, then frees those destroyed meanwhile
+	void UpdateEntities(float deltaTime, float totalTime);
+
+	void SetEntityCollision(Entity* entity, bool isColliding);
+	void SetEntityRendering(Entity* entity, bool isRendering);
+	void SetEntityUpdating(Entity* entity, bool isUpdating);
+
+	// Unstages and frees every entity, as a scene unloading
+	void Release();
+
+	const EntityRegistry& GetRegistry() const;
+	EntityStore& GetEntityStore();
+	SceneArena& GetSceneArena();
+
+private:
+	EntityRegistry registry;
+	EntityStore entityStore;
+	std::vector<EntityHandle> updateOrder;
+	std::vector<Entity*> destroyedEntities;
+	SceneArena sceneArena;
+};
+
+// Entity that tallies the collision callbacks it is given
+class BenchmarkEntity : public Entity
+{
+public:
+	BenchmarkEntity(EntityFactory* entityFactory, std::string name);
+
+	void Update(float deltaTime, float totalTime) override;
+	void OnCollisionEnter(const Collision& collision) override;
+	void OnCollisionStay(const Collision& collision) override;
+	void OnCollisionExit(const Collision& collision) override;
+
+	unsigned int enters = 0;
+	unsigned int stays = 0;
+	unsigned int exits = 0;
+	unsigned int owedExits = 0;	// Exits whose other collider was unstaged
+};
+
+template<typename T>
+T* EntityFactory::CreateEntity(std::string name)
+{
+	T* entity = sceneArena.Create<T>(this, name);
+	entity->handle = registry.Create(entity);
+	if (entity->isUpdating) registry.AddToList(entity->handle, ENTITY_LIST_UPDATING);
+	if (entity->isRendering) registry.AddToList(entity->handle, ENTITY_LIST_RENDERING);
+	return entity;
+}
@@ -0,0 +1,200 @@
+// Compares the map based Grid against the Broadphase backends.
+// Each frame the boxes move a little, the broadphase reports candidate pairs
+// and every candidate is tested for overlap. The Grid path mirrors the old
+// collision manager (rebuilt every frame, no deduplication), the backends
+// run through the same CollisionPairCache the game uses.
+//
+// The first table uses uniformly sized boxes in a cube, the second the
+// collider mix of SceneGame with a hundred times as many colliders in a
+// hundred times the play area, once more with the game's collision layers
+// filtering pairs in the backends (the Grid path has no layers). The last
+// row spreads collider sizes over two orders of magnitude, which the
+// hierarchical grid's levels are for.
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include "BenchmarkCommon.h"
+#include "Grid.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+#include "HierarchicalGrid.h"
+#include "CollisionLayers.h"
+
+// Same cell size as the game (Game::Init)
+#define BENCH_MAX_SCALE 0.25f
+#define BENCH_DELTA_TIME (1.0f / 60.0f)
+
+struct BroadphaseResult
+{
+	double msPerFrame;
+	unsigned long long candidates;
+	unsigned long long overlaps;
+};
+
+BroadphaseResult RunGrid(std::vector<BenchmarkBox> boxes, XMFLOAT3 worldHalfWidth, unsigned int frames)
+{
+	Grid grid(BENCH_MAX_SCALE, worldHalfWidth);
+	BroadphaseResult result = {};
+
+	BenchmarkTimer timer;
+	for (unsigned int frame = 0; frame < frames; frame++) {
+		StepBenchmarkBoxes(boxes, worldHalfWidth, BENCH_DELTA_TIME);
+
+		grid.clear();
+		for (auto& box : boxes)
+			grid.insert(box.center, box.halfExtents, &box);
+
+		auto& map = grid.getMapRef();
+		for (auto cell = map.begin(); cell != map.end(); ++cell) {
+			auto& bin = cell->second;
+			for (auto i = bin.begin(); i != bin.end(); ++i) {
+				auto j = i;
+				for (++j; j != bin.end(); ++j) {
+					result.candidates++;
+					if (BenchmarkBoxesOverlap(*(BenchmarkBox*)*i, *(BenchmarkBox*)*j))
+						result.overlaps++;
+				}
+			}
+		}
+	}
+	result.msPerFrame = timer.ElapsedMs() / frames;
+	return result;
+}
+
+// Layer of every box and which layers collide, for rows that filter by layer
+struct BenchmarkLayers
+{
+	std::vector<unsigned int> layers;
+	CollisionLayerMatrix matrix;
+};
+
+BroadphaseResult RunBroadphase(Broadphase& broadphase, std::vector<BenchmarkBox> boxes, XMFLOAT3 worldHalfWidth, unsigned int frames, const BenchmarkLayers* layers)
+{
+	CollisionPairCache pairCache;
+	BroadphaseResult result = {};
+
+	for (unsigned int i = 0; i < boxes.size(); i++) {
+		broadphase.AddProxy(i, boxes[i].center, boxes[i].halfExtents);
+		if (layers) broadphase.SetProxyLayer(i, 1u << layers->layers[i], layers->matrix.GetMask(layers->layers[i]));
+	}
+
+	// Settle incremental backends before timing
+	pairCache.BeginFrame();
+	broadphase.FindPairs(pairCache);
+
+	BenchmarkTimer timer;
+	for (unsigned int frame = 0; frame < frames; frame++) {
+		StepBenchmarkBoxes(boxes, worldHalfWidth, BENCH_DELTA_TIME);
+
+		for (unsigned int i = 0; i < boxes.size(); i++)
+			broadphase.UpdateProxy(i, boxes[i].center, boxes[i].halfExtents);
+
+		pairCache.BeginFrame();
+		broadphase.FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+
+		for (size_t i = 0; i < candidates.size(); i++) {
+			result.candidates++;
+			if (BenchmarkBoxesOverlap(boxes[CollisionPairCache::GetFirst(candidates[i])], boxes[CollisionPairCache::GetSecond(candidates[i])]))
+				result.overlaps++;
+		}
+	}
+	result.msPerFrame = timer.ElapsedMs() / frames;
+	return result;
+}
+
+// Add boxes of one SceneGame collider kind, moving in the xy plane like the game
+void AddSceneBoxes(std::vector<BenchmarkBox>& boxes, unsigned int count, float minHalf, float maxHalf, float speed, const XMFLOAT3& worldHalfWidth, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> half(minHalf, maxHalf);
+	std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+
+	for (unsigned int i = 0; i < count; i++) {
+		BenchmarkBox box;
+		float h = half(rng);
+		float a = angle(rng);
+		box.center = XMFLOAT3(unit(rng) * worldHalfWidth.x, unit(rng) * worldHalfWidth.y, unit(rng) * worldHalfWidth.z);
+		box.halfExtents = XMFLOAT3(h, h, h);
+		box.velocity = XMFLOAT3(cosf(a) * speed, sinf(a) * speed, 0.0f);
+		boxes.push_back(box);
+	}
+}
+
+// Time every backend on the same boxes and print one row
+void RunRow(const char* label, float speed, const std::vector<BenchmarkBox>& boxes, XMFLOAT3 worldHalfWidth, unsigned int frames, const BenchmarkLayers* layers = nullptr)
+{
+	SpatialHash hash(BENCH_MAX_SCALE, worldHalfWidth);
+	SweepAndPrune sap;
+	DynamicAABBTree tree(BENCH_MAX_SCALE * 0.2f);
+	HierarchicalGrid levels(BENCH_MAX_SCALE, worldHalfWidth);
+
+	BroadphaseResult gridResult = RunGrid(boxes, worldHalfWidth, frames);
+	BroadphaseResult hashResult = RunBroadphase(hash, boxes, worldHalfWidth, frames, layers);
+	BroadphaseResult sapResult = RunBroadphase(sap, boxes, worldHalfWidth, frames, layers);
+	BroadphaseResult treeResult = RunBroadphase(tree, boxes, worldHalfWidth, frames, layers);
+	BroadphaseResult levelsResult = RunBroadphase(levels, boxes, worldHalfWidth, frames, layers);
+
+	printf("%18s %8u %6.1f %10.3f %10.3f %10.3f %10.3f %10.3f %10llu %10llu %10llu %10llu %10llu\n",
+		label, static_cast<unsigned int>(boxes.size()), speed,
+		gridResult.msPerFrame, hashResult.msPerFrame, sapResult.msPerFrame, treeResult.msPerFrame, levelsResult.msPerFrame,
+		gridResult.candidates / frames, hashResult.candidates / frames, sapResult.candidates / frames, treeResult.candidates / frames,
+		levelsResult.candidates / frames);
+	fflush(stdout);
+}
+
+int main()
+{
+	const unsigned int counts[] = { 1000, 10000, 100000 };
+	const float speeds[] = { 0.5f, 5.0f };
+
+	printf("%18s %8s %6s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+		"scenario", "count", "speed", "grid ms", "hash ms", "sap ms", "tree ms", "levels ms",
+		"grid pairs", "hash pairs", "sap pairs", "tree pairs", "lvl pairs");
+	for (unsigned int count : counts) {
+		for (float speed : speeds) {
+			// Keep roughly one collider per unit cube as the count grows
+			float worldHalfWidth = 0.5f * cbrtf(static_cast<float>(count));
+			XMFLOAT3 halfWidth(worldHalfWidth, worldHalfWidth, worldHalfWidth);
+			unsigned int frames = count >= 100000 ? 20 : 100;
+			auto boxes = CreateBenchmarkBoxes(count, worldHalfWidth, 0.05f, 0.125f, speed);
+			RunRow("uniform", speed, boxes, halfWidth, frames);
+		}
+	}
+
+	// SceneGame x100: the game area (Game::Init) grows 10x on x and y, and
+	// each collider kind is repeated a hundred times
+	XMFLOAT3 sceneHalfWidth(30.0f, 30.0f, 0.5f);
+	std::mt19937 rng(1234);
+	std::vector<BenchmarkBox> sceneBoxes;
+	AddSceneBoxes(sceneBoxes, 2000, 0.075f, 0.075f, 5.0f, sceneHalfWidth, rng);		// Projectiles
+	AddSceneBoxes(sceneBoxes, 100, 0.125f, 0.125f, 2.0f, sceneHalfWidth, rng);		// Players
+	AddSceneBoxes(sceneBoxes, 1000, 0.0375f, 0.125f, 1.0f, sceneHalfWidth, rng);		// Enemies, shrink with health
+	RunRow("scene x100", 0.0f, sceneBoxes, sceneHalfWidth, 100);
+
+	// Same scene with the layers of Game::Init
+	BenchmarkLayers sceneLayers;
+	sceneLayers.layers.insert(sceneLayers.layers.end(), 2000, LAYER_PROJECTILE);
+	sceneLayers.layers.insert(sceneLayers.layers.end(), 100, LAYER_PLAYER);
+	sceneLayers.layers.insert(sceneLayers.layers.end(), 1000, LAYER_ENEMY);
+	sceneLayers.matrix.SetCollides(LAYER_PROJECTILE, LAYER_PROJECTILE, false);
+	sceneLayers.matrix.SetCollides(LAYER_PROJECTILE, LAYER_PLAYER, false);
+	RunRow("scene x100 layers", 0.0f, sceneBoxes, sceneHalfWidth, 100, &sceneLayers);
+
+	// Same scene plus a few large colliders, which the grids insert into
+	// many cells
+	AddSceneBoxes(sceneBoxes, 30, 1.0f, 2.0f, 0.1f, sceneHalfWidth, rng);
+	RunRow("scene x100+large", 0.0f, sceneBoxes, sceneHalfWidth, 100);
+
+	// Sizes spread over two orders of magnitude in a cube, half widths
+	// falling off so small colliders outnumber large ones
+	XMFLOAT3 mixedHalfWidth(25.0f, 25.0f, 25.0f);
+	std::vector<BenchmarkBox> mixedBoxes;
+	AddSceneBoxes(mixedBoxes, 16000, 0.05f, 0.25f, 2.0f, mixedHalfWidth, rng);
+	AddSceneBoxes(mixedBoxes, 3000, 0.25f, 1.0f, 1.0f, mixedHalfWidth, rng);
+	AddSceneBoxes(mixedBoxes, 300, 1.0f, 4.0f, 0.5f, mixedHalfWidth, rng);
+	AddSceneBoxes(mixedBoxes, 20, 4.0f, 10.0f, 0.1f, mixedHalfWidth, rng);
+	RunRow("mixed sizes", 0.0f, mixedBoxes, mixedHalfWidth, 20);
+	return 0;
+}
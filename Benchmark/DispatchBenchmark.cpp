@@ -0,0 +1,506 @@
+// Times the narrowphase over mixed populations of oriented boxes, spheres,
+// axis aligned boxes and half volumes. The hashed path is the collision
+// manager's old one, an unordered_map lookup of a member function pointer
+// per pair and another lookup of a radial projection per tested axis. The
+// bucketed path sorts the same candidates by type pair and runs each bucket
+// through its compile time kernel. Both must agree on every pair.
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "ColliderStore.h"
+#include "ColliderWorldState.h"
+#include "Narrowphase.h"
+#include "SpatialHash.h"
+
+#define DISPATCH_BENCH_COLLIDERS 20000
+#define DISPATCH_BENCH_REPEATS 20
+
+static const ContactResult noContact = { false, XMFLOAT3(0, 0, 0) };
+
+struct LegacyCollider
+{
+	const ColliderWorldState* worldState;
+	unsigned char type;
+	const void* owner;
+
+	const ColliderWorldState& State() const { return *worldState; }
+};
+
+// --------------------------------------------------------
+// Old path, the collision manager's tests as they were
+// --------------------------------------------------------
+class LegacyDispatch
+{
+public:
+	LegacyDispatch()
+	{
+		collisionTable[{SHAPE_SPHERE, SHAPE_SPHERE}] = &LegacyDispatch::collidesSpherevSphere;
+		collisionTable[{SHAPE_SPHERE, SHAPE_AABB}] = &LegacyDispatch::collidesSpherevAABB;
+		collisionTable[{SHAPE_AABB, SHAPE_SPHERE}] = &LegacyDispatch::collidesAABBvSphere;
+		collisionTable[{SHAPE_AABB, SHAPE_AABB}] = &LegacyDispatch::collidesAABBvAABB;
+		collisionTable[{SHAPE_OBB, SHAPE_OBB}] = &LegacyDispatch::collidesOBBvOBB;
+		collisionTable[{SHAPE_OBB, SHAPE_SPHERE}] = &LegacyDispatch::collidesOBBvSphere;
+		collisionTable[{SHAPE_SPHERE, SHAPE_OBB}] = &LegacyDispatch::collidesSpherevOBB;
+		collisionTable[{SHAPE_OBB, SHAPE_AABB}] = &LegacyDispatch::collidesOBBvAABB;
+		collisionTable[{SHAPE_AABB, SHAPE_OBB}] = &LegacyDispatch::collidesAABBvOBB;
+		collisionTable[{SHAPE_HALFVOL, SHAPE_AABB}] = &LegacyDispatch::collidesHalfvolvCollider;
+		collisionTable[{SHAPE_HALFVOL, SHAPE_OBB}] = &LegacyDispatch::collidesHalfvolvCollider;
+		collisionTable[{SHAPE_HALFVOL, SHAPE_SPHERE}] = &LegacyDispatch::collidesHalfvolvCollider;
+		collisionTable[{SHAPE_AABB, SHAPE_HALFVOL}] = &LegacyDispatch::collidesCollidervHalfvol;
+		collisionTable[{SHAPE_OBB, SHAPE_HALFVOL}] = &LegacyDispatch::collidesCollidervHalfvol;
+		collisionTable[{SHAPE_SPHERE, SHAPE_HALFVOL}] = &LegacyDispatch::collidesCollidervHalfvol;
+
+		radialProjections[SHAPE_SPHERE] = &LegacyDispatch::radialSphere;
+		radialProjections[SHAPE_AABB] = &LegacyDispatch::radialAABB;
+		radialProjections[SHAPE_OBB] = &LegacyDispatch::radialOBB;
+		radialProjections[SHAPE_HALFVOL] = &LegacyDispatch::radialHalfVol;
+	}
+
+	ContactResult collides(const LegacyCollider& a, const LegacyCollider& b) const;
+
+private:
+	typedef ContactResult (LegacyDispatch::*collisionFunction)(const LegacyCollider&, const LegacyCollider&) const;
+	typedef std::pair<unsigned char, unsigned char> collisionPair;
+
+	struct ColliderHasher {
+		std::size_t operator()(const collisionPair& pair) const { return pair.first * 4 + pair.second; }
+	};
+	std::unordered_map<collisionPair, collisionFunction, ColliderHasher> collisionTable;
+	std::unordered_map<unsigned char, XMFLOAT3(LegacyDispatch::*)(const LegacyCollider&, const XMFLOAT3&) const> radialProjections;
+
+	XMFLOAT3 radialSphere(const LegacyCollider& a, const XMFLOAT3& axis) const;
+	XMFLOAT3 radialAABB(const LegacyCollider& a, const XMFLOAT3& axis) const;
+	XMFLOAT3 radialOBB(const LegacyCollider& a, const XMFLOAT3& axis) const;
+	XMFLOAT3 radialHalfVol(const LegacyCollider& a, const XMFLOAT3& axis) const;
+	bool testAxis(const XMFLOAT3& aCenter, const XMFLOAT3& aRad, const XMFLOAT3& bCenter, const XMFLOAT3& bRad, const XMFLOAT3& axis) const;
+	bool testAxis(const LegacyCollider& a, const LegacyCollider& b, XMFLOAT3 axis) const;
+	XMFLOAT3 nearPtOBB(const LegacyCollider & obb, XMFLOAT3 axisToC) const;
+	XMFLOAT3 nearPtAABB(const LegacyCollider& aabb, XMFLOAT3 axis) const;
+	XMFLOAT3 nearPtPlane(const LegacyCollider& plane, const LegacyCollider& other) const;
+	ContactResult collidesAABBvAABB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesSpherevSphere(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesAABBvSphere(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesSpherevAABB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesOBBvOBB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesOBBvSphere(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesSpherevOBB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesOBBvAABB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesAABBvOBB(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesHalfvolvCollider(const LegacyCollider & a, const LegacyCollider & b) const;
+	ContactResult collidesCollidervHalfvol(const LegacyCollider & a, const LegacyCollider & b) const;
+};
+
+XMFLOAT3 LegacyDispatch::radialSphere(const LegacyCollider & a, const XMFLOAT3 & axis) const
+{
+	XMVECTOR axisV = XMLoadFloat3(&axis);
+	XMFLOAT3 rad;
+	XMStoreFloat3(&rad, a.State().radius*axisV);
+	return rad;
+}
+
+XMFLOAT3 LegacyDispatch::radialAABB(const LegacyCollider & a, const XMFLOAT3 & axis) const
+{
+	XMFLOAT3 L = axis;
+	L.x < 0 ? L.x = -1 : L.x = 1;
+	L.y < 0 ? L.y = -1 : L.y = 1;
+	L.z < 0 ? L.z = -1 : L.z = 1;
+	XMVECTOR radVec = XMLoadFloat3(&L);
+	XMVECTOR scaleVec = XMLoadFloat3(&a.State().halfExtents);
+	XMStoreFloat3(&L, scaleVec*radVec);
+	return L;
+}
+
+XMFLOAT3 LegacyDispatch::radialOBB(const LegacyCollider & a, const XMFLOAT3 & axis) const
+{
+	const ColliderWorldState& state = a.State();
+	XMVECTOR axisVec = XMLoadFloat3(&axis);
+
+	//each box axis scaled by its half width, flipped to face along the axis
+	const float* halfWidths = &state.halfExtents.x;
+	XMVECTOR radVec = XMVectorZero();
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&state.axes[i]);
+		float sign = XMVectorGetX(XMVector3Dot(axisVec, boxAxis)) < 0 ? -1.0f : 1.0f;
+		radVec += boxAxis * (halfWidths[i] * sign);
+	}
+
+	XMFLOAT3 L;
+	XMStoreFloat3(&L, radVec);
+	return L;
+}
+
+XMFLOAT3 LegacyDispatch::radialHalfVol(const LegacyCollider &, const XMFLOAT3 &) const
+{
+	return XMFLOAT3(0, 0, 0);
+}
+
+bool LegacyDispatch::testAxis(const XMFLOAT3 & aCenter, const XMFLOAT3 & aRad, const XMFLOAT3 & bCenter, const XMFLOAT3 & bRad, const XMFLOAT3 & axis) const
+{
+	//vec3 L = glm::normalize(axis);
+
+	XMVECTOR axisVec = XMLoadFloat3(&axis);
+
+	XMVECTOR ac = XMLoadFloat3(&aCenter);
+	XMVECTOR ar = XMLoadFloat3(&aRad);
+	XMVECTOR bc = XMLoadFloat3(&bCenter);
+	XMVECTOR br = XMLoadFloat3(&bRad);
+
+	float greater, less, plus;
+	XMStoreFloat(&greater, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, (ac - bc))));
+	XMStoreFloat(&less, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, ar)));
+	XMStoreFloat(&plus, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, br)));
+
+	if (greater > less + plus) {
+		return true;
+	}
+	return false;
+}
+
+bool LegacyDispatch::testAxis(const LegacyCollider & a, const LegacyCollider & b, XMFLOAT3 axis) const
+{
+	XMVECTOR axisVec = XMLoadFloat3(&axis);
+
+	axisVec = DirectX::XMVector3Normalize(axisVec);
+	XMStoreFloat3(&axis, axisVec);
+
+	XMFLOAT3 aRad = (this->*radialProjections.at(a.type))(a, axis);
+	XMFLOAT3 bRad = (this->*radialProjections.at(b.type))(b, axis);
+
+	return testAxis(a.State().center, aRad, b.State().center, bRad, axis);
+}
+
+XMFLOAT3 LegacyDispatch::nearPtOBB(const LegacyCollider & obb, XMFLOAT3 axisToC) const
+{
+	const ColliderWorldState& state = obb.State();
+	XMVECTOR axisToCVec = XMLoadFloat3(&axisToC);
+
+	//clamp the distance along each box axis to its half width
+	const float* halfWidths = &state.halfExtents.x;
+	XMVECTOR point = XMLoadFloat3(&state.center);
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&state.axes[i]);
+		float distance = XMVectorGetX(XMVector3Dot(axisToCVec, boxAxis));
+		if (distance > halfWidths[i]) distance = halfWidths[i];
+		if (distance < -halfWidths[i]) distance = -halfWidths[i];
+		point += boxAxis * distance;
+	}
+
+	XMStoreFloat3(&axisToC, point);
+	return axisToC;
+}
+
+XMFLOAT3 LegacyDispatch::nearPtAABB(const LegacyCollider & aabb, XMFLOAT3 axis) const
+{
+	const ColliderWorldState& state = aabb.State();
+	XMVECTOR axisVec = XMLoadFloat3(&axis);
+
+	//clamp to halfwidths
+	XMVECTOR scale = XMLoadFloat3(&state.halfExtents);
+	axisVec = XMVectorClamp(axisVec, -scale, scale);
+
+	//add center loc
+	XMVECTOR pos = XMLoadFloat3(&state.center);
+	axisVec += pos;
+	XMStoreFloat3(&axis, axisVec);
+	return axis;
+}
+
+XMFLOAT3 LegacyDispatch::nearPtPlane(const LegacyCollider & plane, const LegacyCollider & other) const
+{
+	const ColliderWorldState& planeState = plane.State();
+	XMVECTOR nor = XMLoadFloat3(&planeState.axes[2]);
+	XMVECTOR planePos = XMLoadFloat3(&planeState.center);
+	XMVECTOR otherPos = XMLoadFloat3(&other.State().center);
+
+	nor = otherPos - DirectX::XMVector3Dot(nor, (otherPos - planePos))*nor;
+
+	XMFLOAT3 p;
+	XMStoreFloat3(&p, nor);
+	return p;
+}
+
+ContactResult LegacyDispatch::collidesAABBvAABB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	XMFLOAT3 axis = XMFLOAT3(0, 0, 1);//z
+	if (testAxis(a, b, axis)) return noContact;
+	axis = XMFLOAT3(0, 1, 0);//y
+	if (testAxis(a, b, axis)) return noContact;
+	axis = XMFLOAT3(1, 0, 0);//x
+	if (testAxis(a, b, axis)) return noContact;
+
+	//contact at the center of the overlapping region
+	const ColliderWorldState& aState = a.State();
+	const ColliderWorldState& bState = b.State();
+	XMVECTOR aPos = XMLoadFloat3(&aState.center);
+	XMVECTOR bPos = XMLoadFloat3(&bState.center);
+	XMVECTOR aScale = XMLoadFloat3(&aState.halfExtents);
+	XMVECTOR bScale = XMLoadFloat3(&bState.halfExtents);
+	XMVECTOR low = XMVectorMax(aPos - aScale, bPos - bScale);
+	XMVECTOR high = XMVectorMin(aPos + aScale, bPos + bScale);
+
+	ContactResult result = { true };
+	XMStoreFloat3(&result.point, (low + high) * 0.5f);
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesSpherevSphere(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	XMVECTOR aPos = XMLoadFloat3(&a.State().center);
+	XMVECTOR bPos = XMLoadFloat3(&b.State().center);
+	XMFLOAT3 axis;
+	XMStoreFloat3(&axis, aPos - bPos);
+	if (testAxis(a, b, axis)) return noContact;
+
+	//nearest point is on the surface of a, facing b
+	XMVECTOR axisVec = DirectX::XMVector3Normalize(bPos - aPos);
+	axisVec *= a.State().radius;
+	axisVec += aPos;
+
+	ContactResult result = { true };
+	XMStoreFloat3(&result.point, axisVec);
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesAABBvSphere(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	//find nearest point on box
+	const XMFLOAT3& bCenter = b.State().center;
+	XMVECTOR aPos = XMLoadFloat3(&a.State().center);
+	XMVECTOR bPos = XMLoadFloat3(&bCenter);
+	XMFLOAT3 pos;
+	XMStoreFloat3(&pos, bPos - aPos);
+	XMFLOAT3 aNearest = nearPtAABB(a, pos);
+	XMVECTOR aNear = XMLoadFloat3(&aNearest);
+
+	//check distance from nearest point to center of sphere
+	XMFLOAT3 axis;
+	XMStoreFloat3(&axis, XMVector3Normalize(aNear - bPos));
+	XMFLOAT3 bRad = (this->*radialProjections.at(b.type))(b, axis);
+
+	if (testAxis(aNearest, XMFLOAT3(0, 0, 0), bCenter, bRad, axis)) return noContact;
+
+	ContactResult result = { true, aNearest };
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesSpherevAABB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	return collidesAABBvSphere(b, a);
+}
+
+ContactResult LegacyDispatch::collidesOBBvOBB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	const ColliderWorldState& aState = a.State();
+	const ColliderWorldState& bState = b.State();
+	XMFLOAT3 axis;
+	XMVECTOR axisVec;
+
+	for (int i = 0; i < 3; i++) {
+
+		if (testAxis(a, b, aState.axes[i])) return noContact;
+		if (testAxis(a, b, bState.axes[i])) return noContact;
+
+		for (int j = 0; j < 3; j++) {
+			//cross product axes
+			axisVec = DirectX::XMVector3Cross(XMLoadFloat3(&aState.axes[i]), XMLoadFloat3(&bState.axes[j]));
+			XMStoreFloat3(&axis, axisVec);
+			//axis = glm::cross(((XMFLOAT3X3)a.transform.getRotMat())[i], ((XMFLOAT3X3)b.transform.getRotMat())[j]);
+			if (testAxis(a, b, axis)) return noContact;
+		}
+	}
+
+	//TODO: Calculate nearest point, midway between the centers for now
+	XMVECTOR aPos = XMLoadFloat3(&aState.center);
+	XMVECTOR bPos = XMLoadFloat3(&bState.center);
+
+	ContactResult result = { true };
+	XMStoreFloat3(&result.point, (aPos + bPos) * 0.5f);
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesOBBvSphere(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	//calc nearest point to sphere
+	const XMFLOAT3& bCenter = b.State().center;
+	XMVECTOR aPos = XMLoadFloat3(&a.State().center);
+	XMVECTOR bPos = XMLoadFloat3(&bCenter);
+	XMFLOAT3 pos;
+	XMStoreFloat3(&pos, bPos - aPos);
+	XMFLOAT3 aNearest = nearPtOBB(a, pos);
+	XMVECTOR aNear = XMLoadFloat3(&aNearest);
+
+	//test axis from point to sphere center
+	XMFLOAT3 axis;
+	XMStoreFloat3(&axis, XMVector3Normalize(bPos - aNear));
+	XMFLOAT3 bRad = (this->*radialProjections.at(b.type))(b, axis);
+
+	if (testAxis(aNearest, XMFLOAT3(0, 0, 0), bCenter, bRad, axis)) return noContact;
+
+	ContactResult result = { true, aNearest };
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesSpherevOBB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	return collidesOBBvSphere(b, a);
+}
+
+ContactResult LegacyDispatch::collidesOBBvAABB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	return collidesOBBvOBB(a, b);
+}
+
+ContactResult LegacyDispatch::collidesAABBvOBB(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	return collidesOBBvAABB(b, a);
+}
+
+ContactResult LegacyDispatch::collidesHalfvolvCollider(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	const ColliderWorldState& aState = a.State();
+	const XMFLOAT3& axis = aState.axes[2];
+	XMVECTOR axisVec = XMLoadFloat3(&axis);
+
+	XMFLOAT3 aRad = (this->*radialProjections.at(a.type))(a, axis);
+	XMFLOAT3 bRad = (this->*radialProjections.at(b.type))(b, axis);
+	XMFLOAT3 aNearest = nearPtPlane(a, b);//nearest point on plane
+
+										  //test collision
+	ContactResult result = { true, aNearest };
+	if (testAxis(aNearest, aRad, b.State().center, bRad, axis)) {
+		//test half
+		XMVECTOR aPos = XMLoadFloat3(&aState.center);
+		XMVECTOR bPos = XMLoadFloat3(&b.State().center);
+		float dot;
+		XMStoreFloat(&dot, XMVector3Dot(bPos - aPos, axisVec));
+		if (dot > 0) return result;
+		return noContact;
+	}
+
+	return result;
+}
+
+ContactResult LegacyDispatch::collidesCollidervHalfvol(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	return collidesHalfvolvCollider(b, a);
+}
+
+ContactResult LegacyDispatch::collides(const LegacyCollider & a, const LegacyCollider & b) const
+{
+	//no collisions when belonging to the same base entity -> unity children colliders do not collide with parent colliders
+	if (a.owner == b.owner) return noContact;
+
+	// Use object a and object b's collider type
+	//		to get a function pointer from the jump table and call the function
+	auto entry = collisionTable.find({ a.type, b.type });
+	if (entry != collisionTable.end() && entry->second) {
+		return (this->*entry->second)(a, b);
+	}
+
+	return noContact;
+}
+
+// --------------------------------------------------------
+// Population of colliders, percentages of each shape
+// --------------------------------------------------------
+struct DispatchMix
+{
+	const char* label;
+	unsigned int obb, sphere, aabb;	// Half volumes make up the rest
+};
+
+static bool RunMix(const DispatchMix& mix)
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_int_distribution<unsigned int> percent(0, 99);
+
+	float worldHalfWidth = 0.3f * cbrtf(static_cast<float>(DISPATCH_BENCH_COLLIDERS));
+	auto boxes = CreateBenchmarkBoxes(DISPATCH_BENCH_COLLIDERS, worldHalfWidth, 0.05f, 0.125f, 0.0f);
+
+	std::vector<ColliderWorldState> states(DISPATCH_BENCH_COLLIDERS);
+	std::vector<LegacyCollider> legacy(DISPATCH_BENCH_COLLIDERS);
+	ColliderStore store;
+	store.Resize(DISPATCH_BENCH_COLLIDERS);
+	SpatialHash hash(0.25f, XMFLOAT3(worldHalfWidth, worldHalfWidth, worldHalfWidth));
+	for (unsigned int i = 0; i < DISPATCH_BENCH_COLLIDERS; i++) {
+		unsigned int roll = percent(rng);
+		unsigned char shape = roll < mix.obb ? SHAPE_OBB
+			: roll < mix.obb + mix.sphere ? SHAPE_SPHERE
+			: roll < mix.obb + mix.sphere + mix.aabb ? SHAPE_AABB : SHAPE_HALFVOL;
+
+		// Half volumes are floors and walls spanning a few cells
+		XMFLOAT4 rotation(0, 0, 0, 1);
+		XMFLOAT3 half = boxes[i].halfExtents;
+		if (shape == SHAPE_OBB || shape == SHAPE_HALFVOL)
+			XMStoreFloat4(&rotation, XMQuaternionRotationAxis(XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0)), unit(rng) * XM_PI));
+		if (shape == SHAPE_HALFVOL)
+			half = XMFLOAT3(0.5f, 0.5f, 0.5f);
+
+		ColliderWorldState& state = states[i];
+		ComputeColliderWorldState(state, boxes[i].center, rotation, half, shape == SHAPE_SPHERE);
+		legacy[i] = { &state, shape, &boxes[i] };
+		store.Set(i, state.center, state.halfExtents, state.radius, shape, 0, &boxes[i]);
+		store.SetAxes(i, state.axes);
+		hash.AddProxy(i, state.center, state.boundsExtents);
+	}
+
+	CollisionPairCache pairCache;
+	pairCache.BeginFrame();
+	hash.FindPairs(pairCache);
+	const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+
+	// Old path, one table lookup per pair
+	LegacyDispatch dispatch;
+	std::vector<unsigned char> legacyHits(candidates.size());
+	BenchmarkTimer legacyTimer;
+	for (unsigned int repeat = 0; repeat < DISPATCH_BENCH_REPEATS; repeat++) {
+		for (size_t i = 0; i < candidates.size(); i++) {
+			const LegacyCollider& a = legacy[CollisionPairCache::GetFirst(candidates[i])];
+			const LegacyCollider& b = legacy[CollisionPairCache::GetSecond(candidates[i])];
+			legacyHits[i] = dispatch.collides(a, b).isTouching;
+		}
+	}
+	double legacyMs = legacyTimer.ElapsedMs() / DISPATCH_BENCH_REPEATS;
+
+	// Bucketed path on one thread
+	Narrowphase narrowphase;
+	BenchmarkTimer bucketTimer;
+	for (unsigned int repeat = 0; repeat < DISPATCH_BENCH_REPEATS; repeat++)
+		narrowphase.Run(store, candidates);
+	double bucketMs = bucketTimer.ElapsedMs() / DISPATCH_BENCH_REPEATS;
+
+	unsigned int contacts = 0, mismatches = 0;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		contacts += narrowphase.GetHits()[i];
+		mismatches += narrowphase.GetHits()[i] != legacyHits[i];
+	}
+
+	printf("%16s %10u %10u %12.3f %12.3f %9.2fx %10u\n", mix.label,
+		static_cast<unsigned int>(candidates.size()), contacts, legacyMs, bucketMs, legacyMs / bucketMs, mismatches);
+	fflush(stdout);
+	return mismatches == 0;
+}
+
+int main()
+{
+	printf("%u colliders, %u repeats\n", DISPATCH_BENCH_COLLIDERS, DISPATCH_BENCH_REPEATS);
+	printf("%16s %10s %10s %12s %12s %10s %10s\n", "mix", "candidates", "contacts", "hashed ms", "bucketed ms", "speedup", "mismatches");
+
+	const DispatchMix mixes[] = {
+		{ "even", 25, 25, 25 },
+		{ "obb heavy", 70, 10, 10 },
+		{ "sphere heavy", 10, 70, 10 },
+		{ "aabb heavy", 10, 10, 70 },
+		{ "no halfvol", 34, 33, 33 },
+	};
+
+	bool isSame = true;
+	for (const DispatchMix& mix : mixes)
+		isSame = RunMix(mix) && isSame;
+	return isSame ? 0 : 1;
+}
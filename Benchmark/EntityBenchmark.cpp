@@ -0,0 +1,257 @@
+// Times a frame of enemy and projectile movement, once the old way with each
+// entity a heap object carrying a Transform, name and tags, updated through
+// a virtual call while walking the factory's map of updating entities, and
+// once as entity store systems over dense component arrays followed by the
+// copy back into each entity's Transform the game does. The entity classes
+// here stand in for Entity, which needs the renderer; their updates are the
+// same math EntityEnemy and EntityProjectile used to run. Both must leave
+// every Transform in the same place, and writing back again with nothing
+// changed must leave every Transform's collider clean.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "EntityStore.h"
+#include "EntitySystems.h"
+#include "Transform.h"
+
+#define ENTITY_BENCH_FRAMES 240
+#define ENTITY_BENCH_DELTA_TIME (1.0f / 60.0f)
+#define ENTITY_BENCH_PROJECTILE_SHARE 0.5f
+#define ENTITY_BENCH_IDLE_SHARE 0.1f	// Of projectiles, not updating
+#define ENTITY_BENCH_TOLERANCE 1e-3f
+
+// Layout of Entity, the hot Transform between the cold members
+class BaselineEntity
+{
+public:
+	BaselineEntity(const std::string& name, const char* tag) : name(name) { tags.push_back(tag); }
+	virtual ~BaselineEntity() {}
+	virtual void Update(float deltaTime, float totalTime) = 0;
+
+	Transform transform;
+	void* entityFactory = nullptr;
+	bool isUpdating = true;
+	bool isRendering = true;
+	bool isColliding = true;
+	std::string name;
+	std::vector<std::string> tags;
+	void* mesh = nullptr;
+	void* material = nullptr;
+	void* collider = nullptr;
+};
+
+// EntityEnemy::Update as it was
+class BaselineEnemy : public BaselineEntity
+{
+public:
+	BaselineEnemy(const std::string& name) : BaselineEntity(name, "Enemy") {}
+
+	void Update(float deltaTime, float totalTime) override
+	{
+		if (target != nullptr) {
+			XMStoreFloat3(&direction, XMVector3Normalize(XMLoadFloat3(target->GetPosition()) - XMLoadFloat3(transform.GetPosition())));
+			transform.Move(direction.x * deltaTime * speed, direction.y * deltaTime * speed, direction.z * deltaTime * speed);
+		}
+		transform.SetRotation(rotationAxis.x, rotationAxis.y, rotationAxis.z, totalTime);
+
+		health += 0.25f * deltaTime;
+		if (health > healthMax)
+			health = healthMax;
+		float scale = health / healthMax * maxScale;
+		transform.SetScale(XMFLOAT3(scale, scale, scale));
+	}
+
+	float maxScale = 0.25f;
+	float speed = 1.0f;
+	float health = 0.000001f;
+	float healthMax = 1.0f;
+	const Transform* target = nullptr;
+	XMFLOAT3 direction = XMFLOAT3(0, 0, 0);
+	XMFLOAT3 rotationAxis = XMFLOAT3(0, 0, 1);
+	void* material = nullptr;
+	void* emitters[2] = { nullptr, nullptr };
+};
+
+// EntityProjectile::Update as it was, without the particle trail
+class BaselineProjectile : public BaselineEntity
+{
+public:
+	BaselineProjectile(const std::string& name) : BaselineEntity(name, "Projectile") {}
+
+	void Update(float deltaTime, float) override
+	{
+		XMFLOAT3 movement;
+		XMStoreFloat3(&movement, XMLoadFloat3(&direction) * speed * deltaTime);
+		transform.Move(movement.x, movement.y, movement.z);
+	}
+
+	float speed = 5.0f;
+	XMFLOAT3 direction = XMFLOAT3(0, 0, 0);
+	void* trail = nullptr;
+};
+
+// Starting state shared by both paths
+struct EntitySpawn
+{
+	bool isProjectile;
+	bool isUpdating;
+	XMFLOAT3 position;
+	XMFLOAT3 direction;	// Projectiles
+	float speed;
+	XMFLOAT3 rotationAxis;	// Enemies
+};
+
+static std::vector<EntitySpawn> CreateSpawns(unsigned int count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> axis(-50.0f, 50.0f);
+
+	std::vector<EntitySpawn> spawns(count);
+	for (auto& spawn : spawns) {
+		spawn.isProjectile = unit(rng) < ENTITY_BENCH_PROJECTILE_SHARE;
+		spawn.isUpdating = !spawn.isProjectile || unit(rng) >= ENTITY_BENCH_IDLE_SHARE;
+		spawn.position = XMFLOAT3(position(rng), position(rng), 0.0f);
+		float angle = unit(rng) * XM_2PI;
+		spawn.direction = XMFLOAT3(cosf(angle), sinf(angle), 0.0f);
+		spawn.speed = spawn.isProjectile ? 5.0f : 0.5f + unit(rng);
+		spawn.rotationAxis = XMFLOAT3(axis(rng), axis(rng), axis(rng));
+	}
+	return spawns;
+}
+
+// The player the enemies chase, circling the origin
+static void MoveTarget(Transform& target, float totalTime)
+{
+	target.SetPosition(cosf(totalTime) * 5.0f, sinf(totalTime) * 5.0f, 0.0f);
+}
+
+int main()
+{
+	unsigned int counts[] = { 10000, 25000, 50000, 100000 };
+	printf("%u frames of enemies chasing a target and projectiles flying straight, %.0f%% projectiles\n",
+		ENTITY_BENCH_FRAMES, ENTITY_BENCH_PROJECTILE_SHARE * 100);
+	printf("%8s %12s %12s %12s %12s %12s %10s %6s\n", "entities", "virtual ms", "systems ms", "write ms", "store ms", "bounds ms", "speedup", "same");
+
+	bool isSame = true;
+	for (unsigned int count : counts) {
+		std::vector<EntitySpawn> spawns = CreateSpawns(count);
+		Transform baselineTarget, storeTarget;
+
+		// Old path, entities allocated one by one and walked through the map
+		std::vector<BaselineEntity*> baselineEntities(count);
+		std::unordered_map<std::string, BaselineEntity*> updatingEntities;
+		for (unsigned int i = 0; i < count; i++) {
+			const EntitySpawn& spawn = spawns[i];
+			BaselineEntity* entity;
+			if (spawn.isProjectile) {
+				BaselineProjectile* projectile = new BaselineProjectile("Projectile_" + std::to_string(i));
+				projectile->direction = spawn.direction;
+				projectile->speed = spawn.speed;
+				entity = projectile;
+			}
+			else {
+				BaselineEnemy* enemy = new BaselineEnemy("Enemy_" + std::to_string(i));
+				enemy->speed = spawn.speed;
+				enemy->rotationAxis = spawn.rotationAxis;
+				enemy->target = &baselineTarget;
+				entity = enemy;
+			}
+			entity->transform.SetPosition(spawn.position);
+			entity->isUpdating = spawn.isUpdating;
+			if (spawn.isUpdating)
+				updatingEntities[entity->name] = entity;
+			baselineEntities[i] = entity;
+		}
+
+		// Store path, the same entities as rows linked to their own Transforms
+		EntityStore store;
+		std::vector<Transform> storeTransforms(count);
+		for (unsigned int i = 0; i < count; i++) {
+			const EntitySpawn& spawn = spawns[i];
+			storeTransforms[i].SetPosition(spawn.position);
+			unsigned int id;
+			if (spawn.isProjectile) {
+				id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY), &storeTransforms[i]);
+				store.GetVelocity(id)->direction = spawn.direction;
+			}
+			else {
+				id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY) | COMPONENT_BIT(COMPONENT_SEEK)
+					| COMPONENT_BIT(COMPONENT_SPIN) | COMPONENT_BIT(COMPONENT_HEALTH) | COMPONENT_BIT(COMPONENT_COLLIDER), &storeTransforms[i]);
+				store.GetSeek(id)->target = storeTarget.GetPosition();
+				store.GetSpin(id)->axis = spawn.rotationAxis;
+				HealthComponent* health = store.GetHealth(id);
+				health->health = 0.000001f;
+				health->maxScale = 0.25f;
+				health->regeneration = 0.25f;
+			}
+			store.GetVelocity(id)->speed = spawn.speed;
+			if (!spawn.isUpdating)
+				store.AddComponents(id, COMPONENT_BIT(COMPONENT_DISABLED));
+		}
+
+		double baselineMs = 0, systemsMs = 0, writeMs = 0, boundsMs = 0;
+		for (unsigned int frame = 0; frame < ENTITY_BENCH_FRAMES; frame++) {
+			float totalTime = frame * ENTITY_BENCH_DELTA_TIME;
+			MoveTarget(baselineTarget, totalTime);
+			MoveTarget(storeTarget, totalTime);
+
+			BenchmarkTimer timer;
+			for (auto iter = updatingEntities.begin(); iter != updatingEntities.end(); ++iter)
+				iter->second->Update(ENTITY_BENCH_DELTA_TIME, totalTime);
+			baselineMs += timer.ElapsedMs();
+
+			timer.Reset();
+			UpdateSeek(store);
+			UpdateMovement(store, ENTITY_BENCH_DELTA_TIME);
+			UpdateSpin(store, totalTime);
+			UpdateHealth(store, ENTITY_BENCH_DELTA_TIME);
+			systemsMs += timer.ElapsedMs();
+
+			timer.Reset();
+			WriteTransforms(store);
+			writeMs += timer.ElapsedMs();
+
+			timer.Reset();
+			UpdateColliderBounds(store);
+			boundsMs += timer.ElapsedMs();
+		}
+
+		// Every Transform must have ended up in the same place either way
+		bool isSameHere = true;
+		for (unsigned int i = 0; i < count; i++) {
+			const XMFLOAT3* a = baselineEntities[i]->transform.GetPosition();
+			const XMFLOAT3* b = storeTransforms[i].GetPosition();
+			const XMFLOAT3* scaleA = baselineEntities[i]->transform.GetScale();
+			const XMFLOAT3* scaleB = storeTransforms[i].GetScale();
+			if (fabsf(a->x - b->x) > ENTITY_BENCH_TOLERANCE || fabsf(a->y - b->y) > ENTITY_BENCH_TOLERANCE
+				|| fabsf(a->z - b->z) > ENTITY_BENCH_TOLERANCE || fabsf(scaleA->x - scaleB->x) > ENTITY_BENCH_TOLERANCE)
+				isSameHere = false;
+		}
+
+		// Nothing moved since the last write, so nothing may be marked dirty
+		for (Transform& transform : storeTransforms)
+			transform.ClearDirty(IS_DIRTY_COL);
+		WriteTransforms(store);
+		for (const Transform& transform : storeTransforms) {
+			if (transform.IsDirty() & IS_DIRTY_COL)
+				isSameHere = false;
+		}
+		isSame = isSame && isSameHere;
+
+		double storeMs = systemsMs + writeMs;
+		printf("%8u %12.3f %12.3f %12.3f %12.3f %12.3f %9.2fx %6s\n", count,
+			baselineMs / ENTITY_BENCH_FRAMES, systemsMs / ENTITY_BENCH_FRAMES, writeMs / ENTITY_BENCH_FRAMES,
+			storeMs / ENTITY_BENCH_FRAMES, boundsMs / ENTITY_BENCH_FRAMES, baselineMs / storeMs, isSameHere ? "yes" : "NO");
+
+		for (BaselineEntity* entity : baselineEntities)
+			delete entity;
+	}
+
+	return isSame ? 0 : 1;
+}
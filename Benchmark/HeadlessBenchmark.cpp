@@ -0,0 +1,172 @@
+// Runs the frame loop on the headless platform, with a scripted player
+// steering through the input snapshot as EntityPlayer does, enemies chasing
+// it through the entity store systems on the job system, and projectiles
+// fired the way the arrow keys aim. Frames of fixed length must come out the
+// same on every run and for every frame length that adds up to the same
+// ticks, while the wall time around them shows what a tick costs.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "EntityStore.h"
+#include "EntitySystems.h"
+#include "FrameLoop.h"
+#include "JobSystem.h"
+#include "Platform.h"
+#include "Transform.h"
+
+#define HEADLESS_BENCH_SECONDS 20
+#define HEADLESS_BENCH_ENEMIES 20000
+#define HEADLESS_BENCH_PROJECTILES 200
+#define HEADLESS_BENCH_FIRE_RATE 0.1f
+#define HEADLESS_BENCH_ARENA 2.0f
+
+// The part of the game the loop drives
+class Simulation
+{
+public:
+	Simulation(JobSystem* jobSystem) : jobSystem(jobSystem), enemyTransforms(HEADLESS_BENCH_ENEMIES), projectileTransforms(HEADLESS_BENCH_PROJECTILES)
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for (unsigned int i = 0; i < HEADLESS_BENCH_ENEMIES; i++) {
+			enemyTransforms[i].SetPosition(position(rng), position(rng), 0.0f);
+			unsigned int id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY)
+				| COMPONENT_BIT(COMPONENT_SEEK) | COMPONENT_BIT(COMPONENT_SPIN), &enemyTransforms[i]);
+			store.GetVelocity(id)->speed = 0.5f + unit(rng);
+			store.GetSeek(id)->target = player.GetPosition();
+			store.GetSpin(id)->axis = XMFLOAT3(0, 0, 1);
+		}
+		for (unsigned int i = 0; i < HEADLESS_BENCH_PROJECTILES; i++)
+			projectiles.push_back(store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY), &projectileTransforms[i]));
+	}
+
+	// As EntityPlayer::Update reads the keys, then the store systems
+	void Update(float deltaTime, float totalTime)
+	{
+		XMFLOAT3 movement = XMFLOAT3(0, 0, 0);
+		if (Input::IsKeyDown('W')) movement.y += 1.0f;
+		else if (Input::IsKeyDown('S')) movement.y -= 1.0f;
+		if (Input::IsKeyDown('D')) movement.x += 1.0f;
+		else if (Input::IsKeyDown('A')) movement.x -= 1.0f;
+		XMStoreFloat3(&movement, XMVector3Normalize(XMLoadFloat3(&movement)) * 3.0f * deltaTime);
+		player.Move(movement.x, movement.y, movement.z);
+		const XMFLOAT3* position = player.GetPosition();
+		player.SetPosition(fminf(fmaxf(position->x, -HEADLESS_BENCH_ARENA), HEADLESS_BENCH_ARENA),
+			fminf(fmaxf(position->y, -HEADLESS_BENCH_ARENA), HEADLESS_BENCH_ARENA), 0.0f);
+
+		XMFLOAT3 fireDirection = XMFLOAT3(0, 0, 0);
+		if (Input::IsKeyDown(INPUT_KEY_UP)) fireDirection.y += 1.0f;
+		else if (Input::IsKeyDown(INPUT_KEY_DOWN)) fireDirection.y -= 1.0f;
+		if (Input::IsKeyDown(INPUT_KEY_RIGHT)) fireDirection.x += 1.0f;
+		else if (Input::IsKeyDown(INPUT_KEY_LEFT)) fireDirection.x -= 1.0f;
+		fireTimer += deltaTime;
+		if ((fireDirection.x != 0 || fireDirection.y != 0) && fireTimer > HEADLESS_BENCH_FIRE_RATE) {
+			fireTimer = 0;
+			unsigned int id = projectiles[nextProjectile++ % projectiles.size()];
+			store.GetTransform(id)->position = *player.GetPosition();
+			store.GetVelocity(id)->direction = fireDirection;
+			store.GetVelocity(id)->speed = 5.0f;
+			shots++;
+		}
+
+		JobCounter steered, stepped;
+		JobSystem* jobs = jobSystem;
+		jobSystem->Submit([this, jobs](unsigned int) { UpdateSeek(store, jobs); }, &steered);
+		jobSystem->Submit([this, jobs, deltaTime](unsigned int) { UpdateMovement(store, deltaTime, jobs); }, &stepped, &steered);
+		jobSystem->Submit([this, jobs, totalTime](unsigned int) { UpdateSpin(store, totalTime, jobs); }, &stepped);
+		jobSystem->Wait(stepped);
+		WriteTransforms(store, jobs);
+	}
+
+	bool IsSame(const Simulation& other) const
+	{
+		for (size_t i = 0; i < enemyTransforms.size(); i++) {
+			const XMFLOAT3* a = enemyTransforms[i].GetPosition();
+			const XMFLOAT3* b = other.enemyTransforms[i].GetPosition();
+			if (a->x != b->x || a->y != b->y || a->z != b->z)
+				return false;
+		}
+		const XMFLOAT3* a = player.GetPosition();
+		const XMFLOAT3* b = other.player.GetPosition();
+		return a->x == b->x && a->y == b->y && shots == other.shots;
+	}
+
+	Transform player;
+	unsigned int shots = 0;
+
+private:
+	JobSystem* jobSystem;
+	EntityStore store;
+	std::vector<Transform> enemyTransforms;
+	std::vector<Transform> projectileTransforms;
+	std::vector<unsigned int> projectiles;
+	unsigned int nextProjectile = 0;
+	float fireTimer = 0;
+};
+
+// Like Game::SoakInput, by the second so every frame length used presses the
+// same keys on the same ticks
+static void ScriptInput(float seconds, InputSnapshot& input)
+{
+	const char moves[] = { 'W', 'D', 'S', 'A' };
+	const unsigned int fires[] = { INPUT_KEY_UP, INPUT_KEY_RIGHT, INPUT_KEY_DOWN, INPUT_KEY_LEFT };
+	input.keys[(unsigned char)moves[(unsigned int)(seconds / 2.0f) % 4]] = true;
+	input.keys[fires[(unsigned int)seconds % 4]] = true;
+}
+
+struct LoopResult {
+	unsigned int frames;
+	unsigned int ticks;
+	double ms;
+};
+
+static LoopResult RunLoop(Simulation& simulation, unsigned int frames, float frameTime)
+{
+	PlatformHeadless platform(frames, frameTime);
+	platform.SetInputScript([frameTime](unsigned int frame, InputSnapshot& input) { ScriptInput(frame * frameTime, input); });
+
+	FrameLoop loop;
+	BenchmarkTimer timer;
+	loop.Run(platform,
+		[&simulation](float deltaTime, float totalTime) { simulation.Update(deltaTime, totalTime); },
+		[](float, float) {});
+	LoopResult result = { loop.GetFrameCount(), loop.GetTickCount(), timer.ElapsedMs() };
+	return result;
+}
+
+int main()
+{
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	JobSystem jobSystem(hardwareThreads > 0 ? hardwareThreads : 1);
+	printf("%u s of %u enemies chasing a scripted player, headless at %.0f ticks a second on %u threads\n",
+		HEADLESS_BENCH_SECONDS, HEADLESS_BENCH_ENEMIES, FRAME_LOOP_DEFAULT_TICK_RATE, jobSystem.GetThreadCount());
+	printf("%10s %8s %8s %10s %12s %8s %6s\n", "frame ms", "frames", "ticks", "total ms", "ms/tick", "shots", "same");
+
+	// Reference run, a frame a tick
+	const unsigned int ticks = (unsigned int)(HEADLESS_BENCH_SECONDS * FRAME_LOOP_DEFAULT_TICK_RATE);
+	Simulation reference(&jobSystem);
+	RunLoop(reference, ticks, 1.0f / FRAME_LOOP_DEFAULT_TICK_RATE);
+
+	bool isSame = true;
+
+	// A whole number of ticks a frame, up to the max substeps
+	unsigned int ticksPerFrame[] = { 1, 2, 4 };
+	for (unsigned int perFrame : ticksPerFrame) {
+		Simulation simulation(&jobSystem);
+		float frameTime = perFrame * (1.0f / FRAME_LOOP_DEFAULT_TICK_RATE);
+		unsigned int frames = ticks / perFrame;
+		LoopResult result = RunLoop(simulation, frames, frameTime);
+
+		// Longer frames only run more ticks each, of the same input
+		bool isSameHere = result.ticks == ticks && simulation.IsSame(reference);
+		isSame = isSame && isSameHere;
+		printf("%10.2f %8u %8u %10.1f %12.3f %8u %6s\n", frameTime * 1000.0f, result.frames, result.ticks,
+			result.ms, result.ms / result.ticks, simulation.shots, isSameHere ? "yes" : "NO");
+	}
+
+	return isSame ? 0 : 1;
+}
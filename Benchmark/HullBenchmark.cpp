@@ -0,0 +1,285 @@
+// Colliders fitted to meshes. First the fit itself, the aligned box,
+// principal axes box and bounding sphere of a few generated point clouds and
+// how many vertices their simplified hulls keep. Then boxes given as hulls
+// of their 8 corners go through GJK and EPA and must agree with the
+// separating axis test on every pair that is not touching to within a hair.
+// Last, tumbling rocks are tested frame after frame by a narrowphase that
+// starts GJK from the direction each pair ended on last frame, and by one
+// that starts every pair cold. Both must find the same contacts.
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "BoxCollision.h"
+#include "ColliderStore.h"
+#include "ColliderWorldState.h"
+#include "ConvexHull.h"
+#include "Narrowphase.h"
+#include "SpatialHash.h"
+
+#define HULL_BENCH_CLOUD_POINTS 4000
+#define HULL_BENCH_BOX_PAIRS 20000
+#define HULL_BENCH_TOUCH_MARGIN 1e-3f	// Pairs closer than this to touching may go either way
+#define HULL_BENCH_ROCKS 6000
+#define HULL_BENCH_ROCK_POINTS 400
+#define HULL_BENCH_FRAMES 120
+#define HULL_BENCH_DELTA_TIME (1.0f / 60.0f)
+
+static XMVECTOR RandomRotation(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	XMVECTOR axis = XMVectorSet(unit(rng), unit(rng), unit(rng), 0);
+	if (XMVectorGetX(XMVector3LengthSq(axis)) < 1e-4f) axis = XMVectorSet(0, 0, 1, 0);
+	return XMQuaternionRotationAxis(XMVector3Normalize(axis), unit(rng) * XM_PI);
+}
+
+// --------------------------------------------------------
+// Point clouds to fit, each turned away from the world axes
+// so the aligned box has something to lose
+// --------------------------------------------------------
+static std::vector<XMFLOAT3> CreateCloud(int kind, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	XMVECTOR rotation = XMQuaternionRotationAxis(XMVector3Normalize(XMVectorSet(1, 2, 3, 0)), 0.9f);
+	std::vector<XMFLOAT3> points(HULL_BENCH_CLOUD_POINTS);
+	for (XMFLOAT3& point : points) {
+		XMVECTOR p;
+		switch (kind) {
+		case 0:	// Slab
+			p = XMVectorSet(unit(rng) * 1.0f, unit(rng) * 0.3f, unit(rng) * 0.15f, 0);
+			break;
+		case 1:	// Ellipsoid surface
+			p = XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0)) * XMVectorSet(1.0f, 0.4f, 0.2f, 0);
+			break;
+		default:	// Long body with a pair of wings
+			if (unit(rng) < 0)
+				p = XMVectorSet(unit(rng) * 1.0f, unit(rng) * 0.12f, unit(rng) * 0.12f, 0);
+			else
+				p = XMVectorSet(unit(rng) * 0.2f - 0.2f, unit(rng) * 0.7f, unit(rng) * 0.03f, 0);
+			break;
+		}
+		XMStoreFloat3(&point, XMVector3Rotate(p, rotation));
+	}
+	return points;
+}
+
+// --------------------------------------------------------
+// Rock shaped cloud, a lumpy ellipsoid
+// --------------------------------------------------------
+static std::vector<XMFLOAT3> CreateRock(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> lump(0.8f, 1.0f);
+	std::vector<XMFLOAT3> points(HULL_BENCH_ROCK_POINTS);
+	for (XMFLOAT3& point : points) {
+		XMVECTOR p = XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0)) * lump(rng);
+		XMStoreFloat3(&point, p * XMVectorSet(1.0f, 0.6f, 0.4f, 0));
+	}
+	return points;
+}
+
+static void ReportFits()
+{
+	const char* labels[] = { "slab", "ellipsoid", "winged body" };
+	std::mt19937 rng(7);
+	printf("%12s %12s %12s %12s %14s\n", "cloud", "aabb vol", "pca box vol", "sphere vol", "hull vertices");
+	for (int kind = 0; kind < 3; kind++) {
+		std::vector<XMFLOAT3> points = CreateCloud(kind, rng);
+		ConvexHull hull;
+		hull.Build(points.data(), static_cast<unsigned int>(points.size()));
+		const XMFLOAT3& a = hull.GetAlignedHalfExtents();
+		const XMFLOAT3& b = hull.GetBoxHalfExtents();
+		float r = hull.GetSphereRadius();
+		printf("%12s %12.4f %12.4f %12.4f %14u\n", labels[kind], 8 * a.x * a.y * a.z, 8 * b.x * b.y * b.z,
+			4.0f / 3.0f * XM_PI * r * r * r, static_cast<unsigned int>(hull.GetVertices().size()));
+	}
+}
+
+// --------------------------------------------------------
+// Boxes as hulls through GJK and EPA against the separating
+// axis test. Returns false on any mismatch outside the
+// touching margin.
+// --------------------------------------------------------
+static bool CheckBoxAgreement()
+{
+	// A unit cube's hull is its corners
+	std::vector<XMFLOAT3> corners;
+	for (int i = 0; i < 8; i++)
+		corners.push_back(XMFLOAT3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f));
+	ConvexHull cube;
+	cube.Build(corners.data(), 8);
+
+	std::mt19937 rng(21);
+	std::uniform_real_distribution<float> half(0.2f, 0.6f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	unsigned int count = HULL_BENCH_BOX_PAIRS * 2;
+	std::vector<ColliderWorldState> states(count);
+	std::vector<unsigned char> owners(count);
+	ColliderStore store;
+	store.Resize(count);
+	CollisionPairCache pairCache;
+	pairCache.BeginFrame();
+	for (unsigned int i = 0; i < count; i++) {
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, RandomRotation(rng));
+		XMFLOAT3 halfExtents(half(rng), half(rng), half(rng));
+		XMFLOAT3 center(0, 0, 0);
+		if (i & 1) {
+			// Near its partner so about half the pairs touch
+			const XMFLOAT3& other = states[i - 1].center;
+			center = XMFLOAT3(other.x + unit(rng) * 1.2f, other.y + unit(rng) * 1.2f, other.z + unit(rng) * 1.2f);
+		}
+		else {
+			// Only partners are paired, so every pair can sit near the origin where floats are fine
+			center = XMFLOAT3(unit(rng) * 2.0f, unit(rng) * 2.0f, unit(rng) * 2.0f);
+		}
+		ComputeColliderWorldState(states[i], center, rotation, halfExtents, false);
+
+		unsigned char shape = i & 1 ? SHAPE_OBB : SHAPE_HULL;
+		store.Set(i, center, halfExtents, states[i].radius, shape, 0, &owners[i]);
+		store.SetAxes(i, states[i].axes);
+		if (shape == SHAPE_HULL) store.SetHull(i, cube.GetVertices().data(), static_cast<unsigned int>(cube.GetVertices().size()));
+		if (i & 1) pairCache.AddCandidate(i - 1, i);
+	}
+	const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+
+	Narrowphase narrowphase;
+	BenchmarkTimer gjkTimer;
+	narrowphase.Run(store, candidates);
+	double gjkMs = gjkTimer.ElapsedMs();
+
+	unsigned int hits = 0, borderline = 0, mismatches = 0, deeper = 0;
+	double depthError = 0, maxDepthError = 0;
+	BenchmarkTimer satTimer;
+	std::vector<unsigned char> satHits(candidates.size());
+	std::vector<BoxContact> satContacts(candidates.size());
+	for (size_t c = 0; c < candidates.size(); c++) {
+		const ColliderWorldState& a = states[CollisionPairCache::GetFirst(candidates[c])];
+		const ColliderWorldState& b = states[CollisionPairCache::GetSecond(candidates[c])];
+		satHits[c] = OrientedBoxesOverlap(a.center, a.axes, a.halfExtents, b.center, b.axes, b.halfExtents, &satContacts[c]);
+	}
+	double satMs = satTimer.ElapsedMs();
+
+	const std::vector<unsigned char>& gjkHits = narrowphase.GetHits();
+	const std::vector<float>& depths = narrowphase.GetDepths();
+	for (size_t c = 0; c < candidates.size(); c++) {
+		if (satHits[c] != gjkHits[c]) {
+			float depth = satHits[c] ? satContacts[c].depth : depths[c];
+			if (depth < HULL_BENCH_TOUCH_MARGIN) borderline++;
+			else mismatches++;
+			continue;
+		}
+		if (!satHits[c]) continue;
+
+		// The separating axis test favors face axes a little, EPA finds the least depth
+		hits++;
+		if (depths[c] > satContacts[c].depth + HULL_BENCH_TOUCH_MARGIN) deeper++;
+		double error = fabs(static_cast<double>(satContacts[c].depth) - depths[c]);
+		depthError += error;
+		if (error > maxDepthError) maxDepthError = error;
+	}
+
+	printf("\n%u box pairs as hull against box, %u touching\n", HULL_BENCH_BOX_PAIRS, hits);
+	printf("  gjk/epa %.3f ms, separating axis %.3f ms\n", gjkMs, satMs);
+	printf("  %u mismatches, %u within %.0e of touching, depth error mean %.2e max %.2e, %u deeper than the separating axis test\n",
+		mismatches, borderline, HULL_BENCH_TOUCH_MARGIN, hits ? depthError / hits : 0.0, maxDepthError, deeper);
+	return mismatches == 0 && deeper == 0;
+}
+
+// --------------------------------------------------------
+// Tumbling rocks, GJK started from last frame's direction
+// against GJK started from the centers every frame
+// --------------------------------------------------------
+static bool CompareDirectionCache()
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<XMFLOAT3> rockPoints = CreateRock(rng);
+	ConvexHull rock;
+	rock.Build(rockPoints.data(), static_cast<unsigned int>(rockPoints.size()));
+
+	float worldHalfWidth = 14.0f;
+	std::vector<BenchmarkBox> boxes = CreateBenchmarkBoxes(HULL_BENCH_ROCKS, worldHalfWidth, 0.3f, 0.6f, 0.5f, 17);
+	std::vector<XMFLOAT4> spinAxes(HULL_BENCH_ROCKS);
+	std::vector<XMFLOAT4> startRotations(HULL_BENCH_ROCKS);
+	for (unsigned int i = 0; i < HULL_BENCH_ROCKS; i++) {
+		XMStoreFloat4(&spinAxes[i], XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0) + XMVectorSet(0, 0, 0.01f, 0)));
+		XMStoreFloat4(&startRotations[i], RandomRotation(rng));
+	}
+
+	std::vector<ColliderWorldState> states(HULL_BENCH_ROCKS);
+	std::vector<unsigned char> owners(HULL_BENCH_ROCKS);
+	ColliderStore store;
+	store.Resize(HULL_BENCH_ROCKS);
+	SpatialHash hash(1.2f, XMFLOAT3(worldHalfWidth + 1, worldHalfWidth + 1, worldHalfWidth + 1));
+	CollisionPairCache pairCache;
+	Narrowphase warm, cold;
+	std::vector<CollisionPairKey> noCandidates;
+	const XMFLOAT3& rockCenter = rock.GetBoxCenter();
+	const XMFLOAT3& rockHalf = rock.GetBoxHalfExtents();
+
+	double warmMs = 0, coldMs = 0;
+	unsigned long long tested = 0, touching = 0, boxTouching = 0, differing = 0;
+	for (unsigned int frame = 0; frame < HULL_BENCH_FRAMES; frame++) {
+		StepBenchmarkBoxes(boxes, worldHalfWidth, HULL_BENCH_DELTA_TIME);
+		pairCache.BeginFrame();
+		for (unsigned int i = 0; i < HULL_BENCH_ROCKS; i++) {
+			// Fitted box of the rock, scaled and turned with it
+			float scale = boxes[i].halfExtents.x;
+			XMVECTOR spin = XMQuaternionRotationAxis(XMLoadFloat4(&spinAxes[i]), frame * HULL_BENCH_DELTA_TIME);
+			XMVECTOR rotation = XMQuaternionMultiply(XMLoadFloat4(&rock.GetBoxRotation()), XMQuaternionMultiply(XMLoadFloat4(&startRotations[i]), spin));
+			XMFLOAT4 worldRotation;
+			XMStoreFloat4(&worldRotation, rotation);
+			XMFLOAT3 center;
+			XMStoreFloat3(&center, XMLoadFloat3(&boxes[i].center) + XMVector3Rotate(XMLoadFloat3(&rockCenter) * scale,
+				XMQuaternionMultiply(XMLoadFloat4(&startRotations[i]), spin)));
+			XMFLOAT3 halfExtents(rockHalf.x * scale, rockHalf.y * scale, rockHalf.z * scale);
+			ComputeColliderWorldState(states[i], center, worldRotation, halfExtents, false);
+
+			store.Set(i, center, halfExtents, states[i].radius, SHAPE_HULL, 0, &owners[i]);
+			store.SetAxes(i, states[i].axes);
+			store.SetHull(i, rock.GetVertices().data(), static_cast<unsigned int>(rock.GetVertices().size()));
+			if (frame == 0) hash.AddProxy(i, center, states[i].boundsExtents);
+			else hash.UpdateProxy(i, center, states[i].boundsExtents);
+		}
+		hash.FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+		tested += candidates.size();
+
+		BenchmarkTimer warmTimer;
+		warm.Run(store, candidates);
+		warmMs += warmTimer.ElapsedMs();
+
+		// An empty run leaves the cold narrowphase with nothing cached but its scratch space warm
+		cold.Run(store, noCandidates);
+		BenchmarkTimer coldTimer;
+		cold.Run(store, candidates);
+		coldMs += coldTimer.ElapsedMs();
+
+		for (size_t c = 0; c < candidates.size(); c++) {
+			touching += warm.GetHits()[c];
+			differing += warm.GetHits()[c] != cold.GetHits()[c];
+			const ColliderWorldState& a = states[CollisionPairCache::GetFirst(candidates[c])];
+			const ColliderWorldState& b = states[CollisionPairCache::GetSecond(candidates[c])];
+			boxTouching += OrientedBoxesOverlap(a.center, a.axes, a.halfExtents, b.center, b.axes, b.halfExtents);
+		}
+	}
+
+	printf("\n%u tumbling rock hulls of %u vertices, %u frames\n", HULL_BENCH_ROCKS,
+		static_cast<unsigned int>(rock.GetVertices().size()), HULL_BENCH_FRAMES);
+	printf("  %llu candidates a frame, %llu touch as hulls, %llu as their fitted boxes\n",
+		tested / HULL_BENCH_FRAMES, touching / HULL_BENCH_FRAMES, boxTouching / HULL_BENCH_FRAMES);
+	printf("  cold %.3f ms, cached direction %.3f ms a frame, %.2fx, %llu pairs differ\n",
+		coldMs / HULL_BENCH_FRAMES, warmMs / HULL_BENCH_FRAMES, coldMs / warmMs, differing);
+	return differing == 0;
+}
+
+int main()
+{
+	ReportFits();
+	bool isAgreeing = CheckBoxAgreement();
+	bool isSame = CompareDirectionCache();
+	return isAgreeing && isSame ? 0 : 1;
+}
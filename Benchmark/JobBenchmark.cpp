@@ -0,0 +1,135 @@
+// Times a frame of the entity store systems run one after another on the
+// calling thread, as the factory does without a job system, against the same
+// systems scheduled on the work stealing job system the way the factory does:
+// seeking first, movement once it is done, spin and health alongside both,
+// each split into batches of rows, then the copy back into each Transform.
+// Every system works on rows of its own, so both must leave every Transform
+// exactly the same.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "EntityStore.h"
+#include "EntitySystems.h"
+#include "JobSystem.h"
+#include "Transform.h"
+
+#define JOB_BENCH_FRAMES 240
+#define JOB_BENCH_DELTA_TIME (1.0f / 60.0f)
+#define JOB_BENCH_PROJECTILE_SHARE 0.5f
+
+// Enemies chasing the target and projectiles flying straight, linked to transforms
+static void CreateEntities(EntityStore& store, std::vector<Transform>& transforms, const Transform& target, unsigned int count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> axis(-50.0f, 50.0f);
+
+	for (unsigned int i = 0; i < count; i++) {
+		transforms[i].SetPosition(position(rng), position(rng), 0.0f);
+		unsigned int id;
+		if (unit(rng) < JOB_BENCH_PROJECTILE_SHARE) {
+			id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY), &transforms[i]);
+			float angle = unit(rng) * XM_2PI;
+			store.GetVelocity(id)->direction = XMFLOAT3(cosf(angle), sinf(angle), 0.0f);
+			store.GetVelocity(id)->speed = 5.0f;
+		}
+		else {
+			id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY) | COMPONENT_BIT(COMPONENT_SEEK)
+				| COMPONENT_BIT(COMPONENT_SPIN) | COMPONENT_BIT(COMPONENT_HEALTH), &transforms[i]);
+			store.GetVelocity(id)->speed = 0.5f + unit(rng);
+			store.GetSeek(id)->target = target.GetPosition();
+			store.GetSpin(id)->axis = XMFLOAT3(axis(rng), axis(rng), axis(rng));
+			HealthComponent* health = store.GetHealth(id);
+			health->health = 0.000001f;
+			health->maxScale = 0.25f;
+			health->regeneration = 0.25f;
+		}
+	}
+}
+
+// The player the enemies chase, circling the origin
+static void MoveTarget(Transform& target, float totalTime)
+{
+	target.SetPosition(cosf(totalTime) * 5.0f, sinf(totalTime) * 5.0f, 0.0f);
+}
+
+// As EntityFactory::UpdateEntities schedules the systems
+static void UpdateOnJobs(EntityStore& store, JobSystem& jobSystem, float deltaTime, float totalTime)
+{
+	JobCounter steered, stepped;
+	JobSystem* jobs = &jobSystem;
+	jobSystem.Submit([&store, jobs](unsigned int) { UpdateSeek(store, jobs); }, &steered);
+	jobSystem.Submit([&store, jobs, deltaTime](unsigned int) { UpdateMovement(store, deltaTime, jobs); }, &stepped, &steered);
+	jobSystem.Submit([&store, jobs, totalTime](unsigned int) { UpdateSpin(store, totalTime, jobs); }, &stepped);
+	jobSystem.Submit([&store, jobs, deltaTime](unsigned int) { UpdateHealth(store, deltaTime, jobs); }, &stepped);
+	jobSystem.Wait(stepped);
+	WriteTransforms(store, jobs);
+}
+
+static bool IsSameTransform(const Transform& a, const Transform& b)
+{
+	const XMFLOAT3* positionA = a.GetPosition();
+	const XMFLOAT3* positionB = b.GetPosition();
+	const XMFLOAT3* scaleA = a.GetScale();
+	const XMFLOAT3* scaleB = b.GetScale();
+	return positionA->x == positionB->x && positionA->y == positionB->y && positionA->z == positionB->z
+		&& scaleA->x == scaleB->x && scaleA->y == scaleB->y && scaleA->z == scaleB->z;
+}
+
+int main()
+{
+	unsigned int counts[] = { 1000, 10000, 50000, 100000 };
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	unsigned int threadCounts[] = { 2, 4, hardwareThreads > 0 ? hardwareThreads : 1 };
+	printf("%u frames of enemies chasing a target and projectiles flying straight, %u hardware threads\n",
+		JOB_BENCH_FRAMES, hardwareThreads);
+	printf("%8s %8s %12s %12s %10s %6s\n", "entities", "threads", "serial ms", "jobs ms", "speedup", "same");
+
+	bool isSame = true;
+	for (unsigned int count : counts) {
+		for (unsigned int threadCount : threadCounts) {
+			Transform serialTarget, jobTarget;
+			EntityStore serialStore, jobStore;
+			std::vector<Transform> serialTransforms(count), jobTransforms(count);
+			CreateEntities(serialStore, serialTransforms, serialTarget, count);
+			CreateEntities(jobStore, jobTransforms, jobTarget, count);
+			JobSystem jobSystem(threadCount);
+
+			double serialMs = 0, jobsMs = 0;
+			for (unsigned int frame = 0; frame < JOB_BENCH_FRAMES; frame++) {
+				float totalTime = frame * JOB_BENCH_DELTA_TIME;
+				MoveTarget(serialTarget, totalTime);
+				MoveTarget(jobTarget, totalTime);
+
+				BenchmarkTimer timer;
+				UpdateSeek(serialStore);
+				UpdateMovement(serialStore, JOB_BENCH_DELTA_TIME);
+				UpdateSpin(serialStore, totalTime);
+				UpdateHealth(serialStore, JOB_BENCH_DELTA_TIME);
+				WriteTransforms(serialStore);
+				serialMs += timer.ElapsedMs();
+
+				timer.Reset();
+				UpdateOnJobs(jobStore, jobSystem, JOB_BENCH_DELTA_TIME, totalTime);
+				jobsMs += timer.ElapsedMs();
+			}
+
+			// The same math on the same rows, so nothing may differ at all
+			bool isSameHere = true;
+			for (unsigned int i = 0; i < count; i++) {
+				if (!IsSameTransform(serialTransforms[i], jobTransforms[i]))
+					isSameHere = false;
+			}
+			isSame = isSame && isSameHere;
+
+			printf("%8u %8u %12.3f %12.3f %9.2fx %6s\n", count, threadCount,
+				serialMs / JOB_BENCH_FRAMES, jobsMs / JOB_BENCH_FRAMES, serialMs / jobsMs, isSameHere ? "yes" : "NO");
+		}
+	}
+
+	return isSame ? 0 : 1;
+}
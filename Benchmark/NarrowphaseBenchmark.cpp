@@ -0,0 +1,83 @@
+// Times the narrowphase on 1 to 16 threads over the same candidate pairs and
+// checks every thread count produces exactly the contacts of a single
+// thread, in the same order.
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "BenchmarkCommon.h"
+#include "ColliderStore.h"
+#include "CollisionKernels.h"
+#include "JobSystem.h"
+#include "Narrowphase.h"
+#include "SpatialHash.h"
+
+#define NARROWPHASE_BENCH_COLLIDERS 200000
+#define NARROWPHASE_BENCH_REPEATS 50
+
+int main()
+{
+	// Dense mix of spheres and boxes so the broadphase hands out plenty of pairs
+	float worldHalfWidth = 0.3f * cbrtf(static_cast<float>(NARROWPHASE_BENCH_COLLIDERS));
+	auto boxes = CreateBenchmarkBoxes(NARROWPHASE_BENCH_COLLIDERS, worldHalfWidth, 0.05f, 0.125f, 0.0f);
+
+	ColliderStore store;
+	store.Resize(NARROWPHASE_BENCH_COLLIDERS);
+	SpatialHash hash(0.25f, XMFLOAT3(worldHalfWidth, worldHalfWidth, worldHalfWidth));
+	for (unsigned int i = 0; i < NARROWPHASE_BENCH_COLLIDERS; i++) {
+		unsigned char shape = i % 3 == 0 ? SHAPE_AABB : SHAPE_SPHERE;
+		store.Set(i, boxes[i].center, boxes[i].halfExtents, boxes[i].halfExtents.x, shape, 0, &boxes[i]);
+		hash.AddProxy(i, boxes[i].center, boxes[i].halfExtents);
+	}
+
+	CollisionPairCache pairCache;
+	pairCache.BeginFrame();
+	hash.FindPairs(pairCache);
+	const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+
+	// Single thread reference
+	Narrowphase narrowphase;
+	narrowphase.Run(store, candidates);
+	std::vector<unsigned char> referenceHits = narrowphase.GetHits();
+	std::vector<XMFLOAT3> referencePoints = narrowphase.GetPoints();
+	std::vector<XMFLOAT3> referenceNormals = narrowphase.GetNormals();
+	std::vector<float> referenceDepths = narrowphase.GetDepths();
+
+	unsigned int contacts = 0;
+	for (size_t i = 0; i < referenceHits.size(); i++)
+		contacts += referenceHits[i];
+
+	printf("%u candidates, %u contacts, %u hardware threads, kernels built for %s\n",
+		static_cast<unsigned int>(candidates.size()), contacts, std::thread::hardware_concurrency(), GetCollisionKernelTarget());
+	printf("%8s %12s %10s %14s\n", "threads", "ms/frame", "speedup", "deterministic");
+
+	double singleMs = 0;
+	const unsigned int threadCounts[] = { 1, 2, 4, 8, 16 };
+	for (unsigned int threads : threadCounts) {
+		std::unique_ptr<JobSystem> jobSystem;
+		if (threads > 1) jobSystem.reset(new JobSystem(threads));
+		narrowphase.SetJobSystem(jobSystem.get());
+		narrowphase.Run(store, candidates);
+
+		BenchmarkTimer timer;
+		for (unsigned int repeat = 0; repeat < NARROWPHASE_BENCH_REPEATS; repeat++)
+			narrowphase.Run(store, candidates);
+		double ms = timer.ElapsedMs() / NARROWPHASE_BENCH_REPEATS;
+		if (threads == 1) singleMs = ms;
+
+		// Same hits, and the same contacts wherever there is a hit
+		bool isSame = narrowphase.GetHits() == referenceHits;
+		for (size_t i = 0; isSame && i < referenceHits.size(); i++) {
+			if (referenceHits[i])
+				isSame = memcmp(&narrowphase.GetPoints()[i], &referencePoints[i], sizeof(XMFLOAT3)) == 0 &&
+					memcmp(&narrowphase.GetNormals()[i], &referenceNormals[i], sizeof(XMFLOAT3)) == 0 &&
+					narrowphase.GetDepths()[i] == referenceDepths[i];
+		}
+
+		printf("%8u %12.3f %9.2fx %14s\n", threads, ms, singleMs / ms, isSame ? "yes" : "NO");
+		fflush(stdout);
+		if (!isSame) return 1;
+	}
+	return 0;
+}
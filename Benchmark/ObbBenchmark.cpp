@@ -0,0 +1,257 @@
+// Times the OBB against OBB test over tumbling enemy boxes, once rebuilding
+// rotation matrices inside the test the way the collision manager used to
+// (a matrix per axis fetch, a matrix and its inverse per radius projection)
+// once reading world states computed a single time per box per frame, and
+// once with b's axes taken into a's frame a single time per pair, which also
+// finds the contact. All paths test the same axes, so their overlap counts
+// must match, and pushing b out along each contact normal by the contact
+// depth must separate the boxes.
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "BoxCollision.h"
+#include "ColliderWorldState.h"
+#include "CollisionPairCache.h"
+#include "SpatialHash.h"
+
+#define OBB_BENCH_FRAMES 100
+#define OBB_BENCH_DELTA_TIME (1.0f / 60.0f)
+
+// Enemy as the old tests saw it, rotations still split between entity and collider
+struct LegacyObb
+{
+	XMFLOAT3 position;
+	XMFLOAT4 entityRotation;
+	XMFLOAT4 colliderRotation;
+	XMFLOAT3 scale;
+};
+
+// --------------------------------------------------------
+// Old path
+// --------------------------------------------------------
+static XMMATRIX LegacyRotationMatrix(const LegacyObb& box)
+{
+	return XMMatrixRotationQuaternion(XMQuaternionMultiply(XMLoadFloat4(&box.entityRotation), XMLoadFloat4(&box.colliderRotation)));
+}
+
+// Whole matrix rebuilt for every axis fetched
+static XMVECTOR LegacyAxis(const LegacyObb& box, int axis)
+{
+	XMFLOAT4X4 rotation;
+	XMStoreFloat4x4(&rotation, LegacyRotationMatrix(box));
+	return XMVectorSet(rotation.m[axis][0], rotation.m[axis][1], rotation.m[axis][2], 0);
+}
+
+// Axis into box space through the inverse matrix, signs times half widths,
+// then back out again
+static XMVECTOR LegacyRadial(const LegacyObb& box, FXMVECTOR axis)
+{
+	XMMATRIX rotMat = LegacyRotationMatrix(box);
+	XMVECTOR determinant = XMMatrixDeterminant(rotMat);
+	XMMATRIX inverse = XMMatrixInverse(&determinant, rotMat);
+
+	XMFLOAT3 L;
+	XMStoreFloat3(&L, XMVector3Transform(axis, inverse));
+	L.x = L.x < 0 ? -1.0f : 1.0f;
+	L.y = L.y < 0 ? -1.0f : 1.0f;
+	L.z = L.z < 0 ? -1.0f : 1.0f;
+	return XMVector3Transform(XMLoadFloat3(&L) * XMLoadFloat3(&box.scale), rotMat);
+}
+
+static bool LegacySeparates(const LegacyObb& a, const LegacyObb& b, FXMVECTOR axis)
+{
+	XMVECTOR L = XMVector3Normalize(axis);
+	float distance = fabsf(XMVectorGetX(XMVector3Dot(L, XMLoadFloat3(&a.position) - XMLoadFloat3(&b.position))));
+	float aRadius = fabsf(XMVectorGetX(XMVector3Dot(L, LegacyRadial(a, L))));
+	float bRadius = fabsf(XMVectorGetX(XMVector3Dot(L, LegacyRadial(b, L))));
+	return distance > aRadius + bRadius;
+}
+
+static bool LegacyOverlap(const LegacyObb& a, const LegacyObb& b)
+{
+	for (int i = 0; i < 3; i++) {
+		if (LegacySeparates(a, b, LegacyAxis(a, i))) return false;
+		if (LegacySeparates(a, b, LegacyAxis(b, i))) return false;
+		for (int j = 0; j < 3; j++) {
+			if (LegacySeparates(a, b, XMVector3Cross(LegacyAxis(a, i), LegacyAxis(b, j)))) return false;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Cached path
+// --------------------------------------------------------
+static XMVECTOR CachedRadial(const ColliderWorldState& state, FXMVECTOR axis)
+{
+	const float* halfWidths = &state.halfExtents.x;
+	XMVECTOR radius = XMVectorZero();
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&state.axes[i]);
+		float sign = XMVectorGetX(XMVector3Dot(axis, boxAxis)) < 0 ? -1.0f : 1.0f;
+		radius += boxAxis * (halfWidths[i] * sign);
+	}
+	return radius;
+}
+
+static bool CachedSeparates(const ColliderWorldState& a, const ColliderWorldState& b, FXMVECTOR axis)
+{
+	XMVECTOR L = XMVector3Normalize(axis);
+	float distance = fabsf(XMVectorGetX(XMVector3Dot(L, XMLoadFloat3(&a.center) - XMLoadFloat3(&b.center))));
+	float aRadius = fabsf(XMVectorGetX(XMVector3Dot(L, CachedRadial(a, L))));
+	float bRadius = fabsf(XMVectorGetX(XMVector3Dot(L, CachedRadial(b, L))));
+	return distance > aRadius + bRadius;
+}
+
+static bool CachedOverlap(const ColliderWorldState& a, const ColliderWorldState& b)
+{
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR aAxis = XMLoadFloat3(&a.axes[i]);
+		if (CachedSeparates(a, b, aAxis)) return false;
+		if (CachedSeparates(a, b, XMLoadFloat3(&b.axes[i]))) return false;
+		for (int j = 0; j < 3; j++) {
+			if (CachedSeparates(a, b, XMVector3Cross(aAxis, XMLoadFloat3(&b.axes[j])))) return false;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Relative rotation path
+// --------------------------------------------------------
+static bool RelativeOverlap(const ColliderWorldState& a, const ColliderWorldState& b, BoxContact& contact)
+{
+	return OrientedBoxesOverlap(a.center, a.axes, a.halfExtents, b.center, b.axes, b.halfExtents, &contact);
+}
+
+// Unit normal, b no longer overlapping once pushed out along it, and the
+// point no further outside either box than the depth
+static bool IsContactValid(const ColliderWorldState& a, const ColliderWorldState& b, const BoxContact& contact)
+{
+	XMVECTOR normal = XMLoadFloat3(&contact.normal);
+	if (fabsf(XMVectorGetX(XMVector3Length(normal)) - 1.0f) > 1e-3f) return false;
+
+	XMFLOAT3 pushed;
+	XMStoreFloat3(&pushed, XMLoadFloat3(&b.center) + normal * (contact.depth + 1e-3f));
+	if (OrientedBoxesOverlap(a.center, a.axes, a.halfExtents, pushed, b.axes, b.halfExtents)) return false;
+
+	const ColliderWorldState* boxes[] = { &a, &b };
+	for (const ColliderWorldState* box : boxes) {
+		XMVECTOR offset = XMLoadFloat3(&contact.point) - XMLoadFloat3(&box->center);
+		const float* halfWidths = &box->halfExtents.x;
+		for (int i = 0; i < 3; i++) {
+			float distance = fabsf(XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&box->axes[i]))));
+			if (distance > halfWidths[i] + contact.depth + 1e-3f) return false;
+		}
+	}
+	return true;
+}
+
+// Enemies of SceneGame, tumbling around their own axis while drifting
+static bool RunScene(const char* label, unsigned int count, XMFLOAT3 worldHalfWidth)
+{
+	std::mt19937 rng(1234);
+	auto boxes = CreateBenchmarkBoxes(count, 1.0f, 0.0375f, 0.125f, 1.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<XMFLOAT3> spinAxes(count);
+	for (unsigned int i = 0; i < count; i++) {
+		boxes[i].center = XMFLOAT3(unit(rng) * worldHalfWidth.x, unit(rng) * worldHalfWidth.y, unit(rng) * worldHalfWidth.z);
+		boxes[i].velocity.z = 0;
+		XMStoreFloat3(&spinAxes[i], XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0)));
+	}
+
+	SpatialHash hash(0.25f, worldHalfWidth);
+	CollisionPairCache pairCache;
+	std::vector<LegacyObb> legacy(count);
+	std::vector<ColliderWorldState> states(count);
+	XMFLOAT4 identity(0, 0, 0, 1);
+
+	double legacyMs = 0, cachedMs = 0, relativeMs = 0, stateMs = 0;
+	unsigned long long candidates = 0, legacyOverlaps = 0, cachedOverlaps = 0, relativeOverlaps = 0, badContacts = 0;
+	std::vector<BoxContact> contacts;
+	std::vector<unsigned char> touching;
+	for (unsigned int frame = 0; frame < OBB_BENCH_FRAMES; frame++) {
+		float totalTime = frame * OBB_BENCH_DELTA_TIME;
+		StepBenchmarkBoxes(boxes, worldHalfWidth, OBB_BENCH_DELTA_TIME);
+		for (unsigned int i = 0; i < count; i++) {
+			LegacyObb& box = legacy[i];
+			box.position = boxes[i].center;
+			box.scale = boxes[i].halfExtents;
+			box.colliderRotation = identity;
+			XMStoreFloat4(&box.entityRotation, XMQuaternionRotationAxis(XMLoadFloat3(&spinAxes[i]), totalTime));
+		}
+
+		// World states, timed with both cached paths since they replace the
+		// matrix work of the old one
+		BenchmarkTimer stateTimer;
+		for (unsigned int i = 0; i < count; i++)
+			ComputeColliderWorldState(states[i], legacy[i].position, legacy[i].entityRotation, legacy[i].scale, false);
+		stateMs += stateTimer.ElapsedMs();
+
+		if (frame == 0) {
+			for (unsigned int i = 0; i < count; i++)
+				hash.AddProxy(i, states[i].center, states[i].boundsExtents);
+		}
+		else {
+			for (unsigned int i = 0; i < count; i++)
+				hash.UpdateProxy(i, states[i].center, states[i].boundsExtents);
+		}
+		pairCache.BeginFrame();
+		hash.FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& pairs = pairCache.ResolveCandidates();
+		candidates += pairs.size();
+
+		BenchmarkTimer legacyTimer;
+		for (size_t i = 0; i < pairs.size(); i++)
+			legacyOverlaps += LegacyOverlap(legacy[CollisionPairCache::GetFirst(pairs[i])], legacy[CollisionPairCache::GetSecond(pairs[i])]);
+		legacyMs += legacyTimer.ElapsedMs();
+
+		BenchmarkTimer cachedTimer;
+		for (size_t i = 0; i < pairs.size(); i++)
+			cachedOverlaps += CachedOverlap(states[CollisionPairCache::GetFirst(pairs[i])], states[CollisionPairCache::GetSecond(pairs[i])]);
+		cachedMs += cachedTimer.ElapsedMs();
+
+		contacts.resize(pairs.size());
+		touching.resize(pairs.size());
+		BenchmarkTimer relativeTimer;
+		for (size_t i = 0; i < pairs.size(); i++)
+			touching[i] = RelativeOverlap(states[CollisionPairCache::GetFirst(pairs[i])], states[CollisionPairCache::GetSecond(pairs[i])], contacts[i]);
+		relativeMs += relativeTimer.ElapsedMs();
+
+		for (size_t i = 0; i < pairs.size(); i++) {
+			if (!touching[i]) continue;
+			relativeOverlaps++;
+			badContacts += !IsContactValid(states[CollisionPairCache::GetFirst(pairs[i])], states[CollisionPairCache::GetSecond(pairs[i])], contacts[i]);
+		}
+
+		std::vector<CollisionPairCache::PairTransition> transitions;
+		pairCache.EndFrame(transitions);
+	}
+
+	cachedMs += stateMs;
+	relativeMs += stateMs;
+	bool isSame = legacyOverlaps == cachedOverlaps && legacyOverlaps == relativeOverlaps && badContacts == 0;
+	printf("%16s %8u %12llu %12llu %12.3f %12.3f %12.3f %9.2fx %9.2fx %6s\n", label, count,
+		candidates / OBB_BENCH_FRAMES, cachedOverlaps / OBB_BENCH_FRAMES,
+		legacyMs / OBB_BENCH_FRAMES, cachedMs / OBB_BENCH_FRAMES, relativeMs / OBB_BENCH_FRAMES,
+		legacyMs / cachedMs, legacyMs / relativeMs, isSame ? "yes" : "NO");
+	if (badContacts > 0)
+		printf("%llu contacts failed the push out check\n", badContacts);
+	fflush(stdout);
+	return isSame;
+}
+
+int main()
+{
+	printf("%16s %8s %12s %12s %12s %12s %12s %10s %10s %6s\n", "scene", "enemies", "candidates", "overlaps",
+		"rebuilt ms", "cached ms", "relative ms", "cached x", "relative x", "same");
+
+	// SceneGame's 10 enemies in its 3 x 3 play area, then a hundred times
+	// both, then ten times denser again
+	bool isSame = RunScene("scene", 10, XMFLOAT3(3, 3, 0.5f));
+	isSame = RunScene("scene x100", 1000, XMFLOAT3(30, 30, 0.5f)) && isSame;
+	isSame = RunScene("scene x100 dense", 10000, XMFLOAT3(30, 30, 0.5f)) && isSame;
+	return isSame ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Times a frame of collision for colliders that stay on the z = 0 plane, as
+// the game's do, once through the 3D path (the spatial hash and the solid
+// narrowphase buckets, 15 axis box tests) and once through the planar path
+// (the planar grid and the 2D buckets, 4 axis rectangle tests). Boxes only
+// turn about z, so both must find exactly the same touching pairs. The 3D
+// hash is run with the game's grid bounds, thin in z, and with cube bounds.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "ColliderStore.h"
+#include "ColliderWorldState.h"
+#include "CollisionPairCache.h"
+#include "Narrowphase.h"
+#include "PlanarCollision.h"
+#include "PlanarGrid.h"
+#include "SpatialHash.h"
+
+#define PLANAR_BENCH_COLLIDERS 20000
+#define PLANAR_BENCH_FRAMES 100
+#define PLANAR_BENCH_DELTA_TIME (1.0f / 60.0f)
+#define PLANAR_BENCH_MAX_SCALE 0.5f
+
+// Same as the collision manager's grid depth
+#define PLANAR_BENCH_GAME_HALF_DEPTH 0.5f
+
+struct PlanarScene
+{
+	std::vector<BenchmarkBox> boxes;
+	std::vector<unsigned char> shapes;	// Solid shape of each collider
+	std::vector<float> angles;			// About z
+	std::vector<float> spins;
+	std::vector<ColliderWorldState> states;
+};
+
+// Planar shape a solid one is stored as
+static unsigned char PlanarShape(unsigned char shape)
+{
+	return shape == SHAPE_SPHERE ? SHAPE_CIRCLE : shape == SHAPE_AABB ? SHAPE_RECT : SHAPE_ORECT;
+}
+
+static void UpdateStates(PlanarScene& scene)
+{
+	XMVECTOR zAxis = XMVectorSet(0, 0, 1, 0);
+	for (size_t i = 0; i < scene.boxes.size(); i++) {
+		const BenchmarkBox& box = scene.boxes[i];
+		XMFLOAT4 rotation(0, 0, 0, 1);
+		if (scene.shapes[i] == SHAPE_OBB)
+			XMStoreFloat4(&rotation, XMQuaternionRotationAxis(zAxis, scene.angles[i]));
+		ComputeColliderWorldState(scene.states[i], box.center, rotation, box.halfExtents, scene.shapes[i] == SHAPE_SPHERE);
+	}
+}
+
+// --------------------------------------------------------
+// Broadphase and narrowphase over one store, keeping the
+// touching pairs of the frame
+// --------------------------------------------------------
+class PlanarRunner
+{
+public:
+	PlanarRunner(const PlanarScene& scene, Broadphase* broadphase, bool isPlanar) :
+		scene(scene), broadphase(broadphase), isPlanar(isPlanar)
+	{
+		unsigned int count = static_cast<unsigned int>(scene.boxes.size());
+		store.Resize(count);
+		for (unsigned int i = 0; i < count; i++)
+			broadphase->AddProxy(i, scene.states[i].center, scene.states[i].boundsExtents);
+	}
+
+	void Step()
+	{
+		for (unsigned int i = 0; i < scene.boxes.size(); i++) {
+			const ColliderWorldState& state = scene.states[i];
+			unsigned char shape = isPlanar ? PlanarShape(scene.shapes[i]) : scene.shapes[i];
+			store.Set(i, state.center, state.halfExtents, state.radius, shape, 0, &scene.boxes[i]);
+			store.SetAxes(i, state.axes);
+			if (shape == SHAPE_ORECT) {
+				XMFLOAT2 axis, halfWidths;
+				ComputePlanarRect(state, true, axis, halfWidths);
+				store.SetPlanarRect(i, axis, halfWidths);
+			}
+			broadphase->UpdateProxy(i, state.center, state.boundsExtents);
+		}
+
+		pairCache.BeginFrame();
+		broadphase->FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+		narrowphase.Run(store, candidates);
+
+		const std::vector<unsigned char>& hits = narrowphase.GetHits();
+		touching.clear();
+		for (size_t i = 0; i < candidates.size(); i++) {
+			if (hits[i]) touching.push_back(candidates[i]);
+		}
+		tested += candidates.size();
+	}
+
+	std::vector<CollisionPairKey> touching;	// Sorted, as the candidates are
+	unsigned long long tested = 0;
+
+private:
+	const PlanarScene& scene;
+	std::unique_ptr<Broadphase> broadphase;
+	bool isPlanar;
+	ColliderStore store;
+	CollisionPairCache pairCache;
+	Narrowphase narrowphase;
+};
+
+int main()
+{
+	float worldHalfWidth = 40.0f;
+	printf("%u colliders on the z = 0 plane, spheres, boxes and boxes turning about z\n", PLANAR_BENCH_COLLIDERS);
+	printf("%22s %12s %12s %12s %12s %10s %6s\n", "3d broadphase", "3d ms", "tested", "planar ms", "tested", "speedup", "same");
+
+	const char* labels[] = { "hash, game bounds", "hash, cube bounds" };
+	float halfDepths[] = { PLANAR_BENCH_GAME_HALF_DEPTH, worldHalfWidth };
+	bool isSame = true;
+	for (int run = 0; run < 2; run++) {
+		PlanarScene scene;
+		scene.boxes = CreateBenchmarkBoxes(PLANAR_BENCH_COLLIDERS, worldHalfWidth, 0.1f, PLANAR_BENCH_MAX_SCALE, 2.0f);
+		unsigned int count = static_cast<unsigned int>(scene.boxes.size());
+		scene.shapes.resize(count);
+		scene.angles.resize(count);
+		scene.spins.resize(count);
+		scene.states.resize(count);
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> aspect(0.3f, 1.0f);
+		for (unsigned int i = 0; i < count; i++) {
+			BenchmarkBox& box = scene.boxes[i];
+			box.center.z = 0;
+			box.velocity.z = 0;
+			box.halfExtents.y *= aspect(rng);
+			scene.shapes[i] = i % 3 == 0 ? SHAPE_SPHERE : i % 3 == 1 ? SHAPE_OBB : SHAPE_AABB;
+			scene.angles[i] = angle(rng);
+			scene.spins[i] = angle(rng);
+		}
+		UpdateStates(scene);
+
+		XMFLOAT3 gridHalfWidth(worldHalfWidth, worldHalfWidth, halfDepths[run]);
+		PlanarRunner solid(scene, new SpatialHash(PLANAR_BENCH_MAX_SCALE, gridHalfWidth), false);
+		PlanarRunner planar(scene, new PlanarGrid(PLANAR_BENCH_MAX_SCALE, gridHalfWidth), true);
+
+		double solidMs = 0, planarMs = 0;
+		bool isSameHere = true;
+		for (unsigned int frame = 0; frame < PLANAR_BENCH_FRAMES; frame++) {
+			StepBenchmarkBoxes(scene.boxes, XMFLOAT3(worldHalfWidth, worldHalfWidth, 1.0f), PLANAR_BENCH_DELTA_TIME);
+			for (unsigned int i = 0; i < count; i++)
+				scene.angles[i] += scene.spins[i] * PLANAR_BENCH_DELTA_TIME;
+			UpdateStates(scene);
+
+			BenchmarkTimer solidTimer;
+			solid.Step();
+			solidMs += solidTimer.ElapsedMs();
+
+			BenchmarkTimer planarTimer;
+			planar.Step();
+			planarMs += planarTimer.ElapsedMs();
+
+			isSameHere = isSameHere && solid.touching == planar.touching;
+		}
+
+		printf("%22s %12.3f %12llu %12.3f %12llu %9.2fx %6s\n", labels[run],
+			solidMs / PLANAR_BENCH_FRAMES, solid.tested / PLANAR_BENCH_FRAMES,
+			planarMs / PLANAR_BENCH_FRAMES, planar.tested / PLANAR_BENCH_FRAMES,
+			solidMs / planarMs, isSameHere ? "yes" : "NO");
+		fflush(stdout);
+		isSame = isSame && isSameHere;
+	}
+	return isSame ? 0 : 1;
+}
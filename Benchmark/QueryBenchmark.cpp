@@ -0,0 +1,244 @@
+// Times closest hit raycasts, sphere overlaps and box overlaps answered
+// through each broadphase against testing every collider, over a scene of
+// spheres, boxes and tumbling oriented boxes. Every broadphase must report
+// exactly the hits of the full scan.
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "CollisionPairCache.h"
+#include "SceneQuery.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+
+#define QUERY_BENCH_COLLIDERS 10000
+#define QUERY_BENCH_QUERIES 5000
+#define QUERY_BENCH_RAY_LENGTH 20.0f
+
+struct QueryScene
+{
+	std::vector<ColliderWorldState> states;
+	std::vector<unsigned char> shapes;
+};
+
+struct QueryShapes
+{
+	std::vector<XMFLOAT3> origins;
+	std::vector<XMFLOAT3> directions;
+	std::vector<ColliderWorldState> boxes;	// Centers double as sphere centers
+	std::vector<float> radii;
+};
+
+// Answers the scene queries the way the collision manager does, one
+// exact test per unique candidate
+class QueryRunner
+{
+public:
+	QueryRunner(const QueryScene& scene, Broadphase* broadphase) : scene(scene), broadphase(broadphase), stamps(scene.states.size(), 0) {}
+
+	int Raycast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, float& distance)
+	{
+		Begin();
+		if (broadphase)
+			broadphase->QueryRay(origin, direction, maxDistance, candidates);
+
+		int closestId = -1;
+		float closest = maxDistance;
+		unsigned int count = Count();
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int id = Next(i);
+			if (id == NO_ID) continue;
+			RayHit hit = RaycastCollider(scene.states[id], scene.shapes[id], origin, direction, closest);
+			if (hit.isHit && (closestId < 0 || hit.distance < closest)) {
+				closestId = static_cast<int>(id);
+				closest = hit.distance;
+			}
+		}
+		distance = closest;
+		return closestId;
+	}
+
+	unsigned int OverlapSphere(const XMFLOAT3& center, float radius)
+	{
+		Begin();
+		if (broadphase)
+			broadphase->QueryBox(center, XMFLOAT3(radius, radius, radius), candidates);
+
+		unsigned int overlaps = 0;
+		unsigned int count = Count();
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int id = Next(i);
+			if (id != NO_ID) overlaps += OverlapSphereCollider(scene.states[id], scene.shapes[id], center, radius);
+		}
+		return overlaps;
+	}
+
+	unsigned int OverlapBox(const ColliderWorldState& box)
+	{
+		Begin();
+		if (broadphase)
+			broadphase->QueryBox(box.center, box.boundsExtents, candidates);
+
+		unsigned int overlaps = 0;
+		unsigned int count = Count();
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int id = Next(i);
+			if (id != NO_ID) overlaps += OverlapBoxCollider(scene.states[id], scene.shapes[id], box);
+		}
+		return overlaps;
+	}
+
+	unsigned long long GetCandidates() const { return candidateTotal; }
+
+private:
+	static const unsigned int NO_ID = 0xFFFFFFFF;
+
+	const QueryScene& scene;
+	Broadphase* broadphase;	// Null scans every collider
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> stamps;
+	unsigned int stamp = 0;
+	unsigned long long candidateTotal = 0;
+
+	void Begin()
+	{
+		candidates.clear();
+		stamp++;
+	}
+
+	unsigned int Count()
+	{
+		unsigned int count = broadphase ? static_cast<unsigned int>(candidates.size()) : static_cast<unsigned int>(scene.states.size());
+		candidateTotal += count;
+		return count;
+	}
+
+	unsigned int Next(unsigned int i)
+	{
+		if (!broadphase) return i;
+		unsigned int id = candidates[i];
+		if (stamps[id] == stamp) return NO_ID;
+		stamps[id] = stamp;
+		return id;
+	}
+};
+
+struct QueryTotals
+{
+	double rayMs, sphereMs, boxMs;
+	std::vector<int> rayHits;
+	std::vector<float> rayDistances;
+	std::vector<unsigned int> overlaps;
+};
+
+static QueryTotals RunQueries(QueryRunner& runner, const QueryShapes& queries)
+{
+	QueryTotals totals;
+	size_t count = queries.origins.size();
+	totals.rayHits.resize(count);
+	totals.rayDistances.resize(count);
+
+	BenchmarkTimer timer;
+	for (size_t i = 0; i < count; i++)
+		totals.rayHits[i] = runner.Raycast(queries.origins[i], queries.directions[i], QUERY_BENCH_RAY_LENGTH, totals.rayDistances[i]);
+	totals.rayMs = timer.ElapsedMs();
+
+	timer.Reset();
+	for (size_t i = 0; i < count; i++)
+		totals.overlaps.push_back(runner.OverlapSphere(queries.boxes[i].center, queries.radii[i]));
+	totals.sphereMs = timer.ElapsedMs();
+
+	timer.Reset();
+	for (size_t i = 0; i < count; i++)
+		totals.overlaps.push_back(runner.OverlapBox(queries.boxes[i]));
+	totals.boxMs = timer.ElapsedMs();
+	return totals;
+}
+
+static void PrintRow(const char* label, const QueryTotals& totals, unsigned long long candidates, const char* same)
+{
+	double perQuery = 1e3 / QUERY_BENCH_QUERIES;
+	printf("%16s %12.2f %12.2f %12.2f %14llu %6s\n", label,
+		totals.rayMs * perQuery, totals.sphereMs * perQuery, totals.boxMs * perQuery,
+		candidates / (3 * QUERY_BENCH_QUERIES), same);
+	fflush(stdout);
+}
+
+static XMVECTOR RandomRotation(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	XMVECTOR axis = XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0));
+	return XMQuaternionRotationAxis(axis, unit(rng) * XM_PI);
+}
+
+int main()
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// Scene colliders, a third each of spheres, boxes and oriented boxes
+	XMFLOAT3 worldHalfWidth(30, 30, 30);
+	auto boxes = CreateBenchmarkBoxes(QUERY_BENCH_COLLIDERS, worldHalfWidth.x, 0.05f, 0.25f, 0.0f);
+	QueryScene scene;
+	scene.states.resize(QUERY_BENCH_COLLIDERS);
+	scene.shapes.resize(QUERY_BENCH_COLLIDERS);
+	for (unsigned int i = 0; i < QUERY_BENCH_COLLIDERS; i++) {
+		unsigned char shape = i % 3 == 0 ? SHAPE_SPHERE : i % 3 == 1 ? SHAPE_AABB : SHAPE_OBB;
+		XMFLOAT4 rotation(0, 0, 0, 1);
+		if (shape == SHAPE_OBB)
+			XMStoreFloat4(&rotation, RandomRotation(rng));
+		XMFLOAT3 half(boxes[i].halfExtents.x, boxes[i].halfExtents.x * 0.5f, boxes[i].halfExtents.x * 2.0f);
+		ComputeColliderWorldState(scene.states[i], boxes[i].center, rotation, half, shape == SHAPE_SPHERE);
+		scene.shapes[i] = shape;
+	}
+
+	// Picking and line of sight sized rays, homing sized spheres and boxes
+	QueryShapes queries;
+	queries.origins.resize(QUERY_BENCH_QUERIES);
+	queries.directions.resize(QUERY_BENCH_QUERIES);
+	queries.boxes.resize(QUERY_BENCH_QUERIES);
+	queries.radii.resize(QUERY_BENCH_QUERIES);
+	for (unsigned int i = 0; i < QUERY_BENCH_QUERIES; i++) {
+		queries.origins[i] = XMFLOAT3(unit(rng) * worldHalfWidth.x, unit(rng) * worldHalfWidth.y, unit(rng) * worldHalfWidth.z);
+		XMStoreFloat3(&queries.directions[i], XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0)));
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, RandomRotation(rng));
+		XMFLOAT3 center(unit(rng) * worldHalfWidth.x, unit(rng) * worldHalfWidth.y, unit(rng) * worldHalfWidth.z);
+		ComputeColliderWorldState(queries.boxes[i], center, rotation, XMFLOAT3(1.0f, 0.5f, 1.5f), false);
+		queries.radii[i] = 1.0f + (unit(rng) + 1.0f);
+	}
+
+	SpatialHash hash(0.5f, worldHalfWidth);
+	SweepAndPrune sap;
+	DynamicAABBTree tree;
+	Broadphase* broadphases[] = { &hash, &sap, &tree };
+	const char* labels[] = { "spatial hash", "sweep and prune", "aabb tree" };
+	for (Broadphase* broadphase : broadphases) {
+		for (unsigned int i = 0; i < QUERY_BENCH_COLLIDERS; i++)
+			broadphase->AddProxy(i, scene.states[i].center, scene.states[i].boundsExtents);
+		CollisionPairCache pairCache;
+		pairCache.BeginFrame();
+		broadphase->FindPairs(pairCache);
+	}
+
+	printf("%u colliders, %u queries of each kind, rays %.0f long\n", QUERY_BENCH_COLLIDERS, QUERY_BENCH_QUERIES, QUERY_BENCH_RAY_LENGTH);
+	printf("%16s %12s %12s %12s %14s %6s\n", "broadphase", "us/ray", "us/sphere", "us/box", "candidates", "same");
+
+	QueryRunner scan(scene, nullptr);
+	QueryTotals reference = RunQueries(scan, queries);
+	PrintRow("every collider", reference, scan.GetCandidates(), "-");
+
+	bool isSame = true;
+	for (int b = 0; b < 3; b++) {
+		QueryRunner runner(scene, broadphases[b]);
+		QueryTotals totals = RunQueries(runner, queries);
+		bool isSameHere = totals.rayHits == reference.rayHits && totals.overlaps == reference.overlaps;
+		for (size_t i = 0; isSameHere && i < totals.rayHits.size(); i++)
+			isSameHere = reference.rayHits[i] < 0 || totals.rayDistances[i] == reference.rayDistances[i];
+		PrintRow(labels[b], totals, runner.GetCandidates(), isSameHere ? "yes" : "NO");
+		isSame = isSame && isSameHere;
+	}
+	return isSame ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+// Times what EntityFactory does every frame with its entities, once with the
+// old string keyed maps and once with the registry of generational handles:
+// projectiles being fired and removed, each of which toggles whether the
+// projectile updates and collides, a walk over the updating entities, and
+// lookups of entities held on to by other entities. Both must update the
+// same entities every frame, handles to destroyed entities must stop
+// resolving, and an update stopping an entity the walk has passed must not
+// make it skip the entity moved into its place. Then times tag tests at every contact and finding every entity
+// with a tag, against the vector of tag names entities used to keep.
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "EntityRegistry.h"
+
+#define REGISTRY_BENCH_FRAMES 240
+#define REGISTRY_BENCH_PROJECTILE_SHARE 0.5f
+#define REGISTRY_BENCH_TOGGLE_SHARE 0.05f	// Of projectiles, fired or removed each frame
+#define REGISTRY_BENCH_LOOKUPS 2000			// Each frame
+#define REGISTRY_BENCH_CONTACTS 20000		// Tag tests a frame, two per contact
+
+// Stand in for Entity, only what the factory touches
+class Entity
+{
+public:
+	Entity(const std::string& name) : name(name) {}
+	virtual ~Entity() {}
+	virtual void Update() { updates++; }
+
+	std::string GetName() const { return name; }	// By value, as Entity::GetName
+
+	EntityHandle handle;
+	std::vector<std::string> tagNames;	// As Entity kept its tags
+	TagMask tags = 0;
+	bool isUpdating = true;
+	bool isColliding = true;
+	unsigned int updates = 0;
+	std::string name;
+};
+
+// EntityFactory as it was
+class MapFactory
+{
+public:
+	void Add(Entity* entity)
+	{
+		entities[entity->GetName()] = entity;
+		updatingEntities[entity->GetName()] = entity;
+		collidingEntities[entity->GetName()] = entity;
+	}
+
+	void SetUpdating(Entity* entity, bool isUpdating)
+	{
+		if (entity->isUpdating == isUpdating) return;
+		entity->isUpdating = isUpdating;
+		isUpdating ? (void)(updatingEntities[entity->GetName()] = entity) : (void)updatingEntities.erase(entity->GetName());
+	}
+
+	void SetColliding(Entity* entity, bool isColliding)
+	{
+		if (entity->isColliding == isColliding) return;
+		entity->isColliding = isColliding;
+		isColliding ? (void)(collidingEntities[entity->GetName()] = entity) : (void)collidingEntities.erase(entity->GetName());
+	}
+
+	void Update()
+	{
+		for (auto iter = updatingEntities.begin(); iter != updatingEntities.end(); ++iter)
+			iter->second->Update();
+	}
+
+	Entity* Find(const std::string& name) const
+	{
+		auto found = entities.find(name);
+		return found == entities.end() ? nullptr : found->second;
+	}
+
+	std::unordered_map<std::string, Entity*> entities;
+	std::unordered_map<std::string, Entity*> updatingEntities;
+	std::unordered_map<std::string, Entity*> collidingEntities;	// The collision manager's staging
+};
+
+// EntityFactory as it is now
+class RegistryFactory
+{
+public:
+	void Add(Entity* entity)
+	{
+		entity->handle = registry.Create(entity);
+		registry.SetName(entity->handle, entity->name);
+		registry.AddToList(entity->handle, ENTITY_LIST_UPDATING);
+		registry.AddToList(entity->handle, ENTITY_LIST_COLLIDING);
+	}
+
+	void SetUpdating(Entity* entity, bool isUpdating)
+	{
+		if (entity->isUpdating == isUpdating) return;
+		entity->isUpdating = isUpdating;
+		isUpdating ? registry.AddToList(entity->handle, ENTITY_LIST_UPDATING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_UPDATING);
+	}
+
+	void SetColliding(Entity* entity, bool isColliding)
+	{
+		if (entity->isColliding == isColliding) return;
+		entity->isColliding = isColliding;
+		isColliding ? registry.AddToList(entity->handle, ENTITY_LIST_COLLIDING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_COLLIDING);
+	}
+
+	// As EntityFactory::UpdateEntities walks them, over the handles updating
+	// when the walk starts, as updates can stop other entities updating
+	void Update()
+	{
+		const std::vector<Entity*>& updating = registry.GetList(ENTITY_LIST_UPDATING);
+		updateOrder.clear();
+		for (size_t i = 0; i < updating.size(); i++)
+			updateOrder.push_back(updating[i]->handle);
+		for (size_t i = 0; i < updateOrder.size(); i++) {
+			if (registry.IsInList(updateOrder[i], ENTITY_LIST_UPDATING))
+				registry.Get(updateOrder[i])->Update();
+		}
+	}
+
+	EntityRegistry registry;
+	std::vector<EntityHandle> updateOrder;
+};
+
+// Stops another entity updating from its own update, as a projectile does
+// to what it hits
+class StoppingEntity : public Entity
+{
+public:
+	StoppingEntity(const std::string& name, RegistryFactory& factory) : Entity(name), factory(factory) {}
+
+	void Update() override
+	{
+		Entity::Update();
+		if (target != nullptr)
+			factory.SetUpdating(target, false);
+	}
+
+	RegistryFactory& factory;
+	Entity* target = nullptr;
+};
+
+// An entity stopping one the walk has passed moves the last entity into that
+// place, which must still update this tick, and the stopped one not again
+static bool CheckStopDuringWalk()
+{
+	RegistryFactory factory;
+	Entity first("First"), stopped("Stopped"), last("Last");
+	StoppingEntity stopping("Stopping", factory);
+	stopping.target = &stopped;
+	factory.Add(&first);
+	factory.Add(&stopped);
+	factory.Add(&stopping);
+	factory.Add(&last);
+
+	factory.Update();
+	bool isFirstTick = first.updates == 1 && stopped.updates == 1 && stopping.updates == 1 && last.updates == 1;
+	factory.Update();
+	return isFirstTick && first.updates == 2 && stopped.updates == 1 && stopping.updates == 2 && last.updates == 2;
+}
+
+// Tag names of the game and a few more, as most entities carry several
+static const char* tagNames[] = { "Projectile", "Enemy", "Player", "Static", "Damaging", "Explodes", "Boss", "Pickup" };
+#define REGISTRY_BENCH_TAG_NAMES (sizeof(tagNames) / sizeof(tagNames[0]))
+
+static bool HasTagName(const Entity* entity, const std::string& tag)
+{
+	return std::find(entity->tagNames.begin(), entity->tagNames.end(), tag) != entity->tagNames.end();
+}
+
+// Tag tests at contacts and a query for every enemy, both ways
+static bool CompareTags(unsigned int count)
+{
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<unsigned int> any(0, count - 1);
+	std::uniform_int_distribution<unsigned int> tagCount(1, 4);
+	std::uniform_int_distribution<unsigned int> tagName(0, REGISTRY_BENCH_TAG_NAMES - 1);
+
+	EntityRegistry registry;
+	std::vector<Entity*> entities(count);
+	for (unsigned int i = 0; i < count; i++) {
+		entities[i] = new Entity("Entity_" + std::to_string(i));
+		for (unsigned int t = tagCount(rng); t > 0; t--) {
+			const char* name = tagNames[tagName(rng)];
+			if (!HasTagName(entities[i], name))
+				entities[i]->tagNames.push_back(name);
+			entities[i]->tags |= TagTable::GetMask(name);
+		}
+		entities[i]->handle = registry.Create(entities[i]);
+		registry.SetTags(entities[i]->handle, entities[i]->tags);
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> contacts(REGISTRY_BENCH_CONTACTS / 2);
+	for (auto& contact : contacts)
+		contact = std::make_pair(any(rng), any(rng));
+
+	// What OnCollision does, the name is a literal at the call
+	BenchmarkTimer timer;
+	unsigned int nameHits = 0;
+	for (unsigned int frame = 0; frame < REGISTRY_BENCH_FRAMES; frame++) {
+		for (const auto& contact : contacts) {
+			nameHits += HasTagName(entities[contact.first], "Enemy");
+			nameHits += HasTagName(entities[contact.second], "Projectile");
+		}
+	}
+	double nameMs = timer.ElapsedMs();
+
+	timer.Reset();
+	TagMask enemy = TagTable::GetMask("Enemy");
+	TagMask projectile = TagTable::GetMask("Projectile");
+	unsigned int maskHits = 0;
+	for (unsigned int frame = 0; frame < REGISTRY_BENCH_FRAMES; frame++) {
+		for (const auto& contact : contacts) {
+			maskHits += (entities[contact.first]->tags & enemy) != 0;
+			maskHits += (entities[contact.second]->tags & projectile) != 0;
+		}
+	}
+	double maskMs = timer.ElapsedMs();
+
+	// Every enemy, by scanning every entity's names or from its tag list
+	timer.Reset();
+	size_t scanned = 0;
+	std::vector<Entity*> found;
+	for (unsigned int frame = 0; frame < REGISTRY_BENCH_FRAMES; frame++) {
+		found.clear();
+		for (Entity* entity : entities) {
+			if (HasTagName(entity, "Enemy") && HasTagName(entity, "Damaging"))
+				found.push_back(entity);
+		}
+		scanned += found.size();
+	}
+	double scanMs = timer.ElapsedMs();
+
+	timer.Reset();
+	size_t listed = 0;
+	for (unsigned int frame = 0; frame < REGISTRY_BENCH_FRAMES; frame++) {
+		registry.FindTagged(enemy | TagTable::GetMask("Damaging"), found);
+		listed += found.size();
+	}
+	double listMs = timer.ElapsedMs();
+
+	bool isSame = nameHits == maskHits && scanned == listed;
+	printf("%8u %12.4f %12.4f %12.4f %12.4f %6s\n", count, nameMs / REGISTRY_BENCH_FRAMES, maskMs / REGISTRY_BENCH_FRAMES,
+		scanMs / REGISTRY_BENCH_FRAMES, listMs / REGISTRY_BENCH_FRAMES, isSame ? "yes" : "NO");
+
+	for (Entity* entity : entities)
+		delete entity;
+	return isSame;
+}
+
+// Projectiles fired and removed in a frame, and the entities looked up
+struct RegistryFrame
+{
+	std::vector<unsigned int> toggled;
+	std::vector<unsigned int> lookups;
+};
+
+int main()
+{
+	unsigned int counts[] = { 1000, 10000, 100000 };
+	printf("%u frames, %.0f%% projectiles of which %.0f%% are fired or removed each frame, %u lookups a frame\n",
+		REGISTRY_BENCH_FRAMES, REGISTRY_BENCH_PROJECTILE_SHARE * 100, REGISTRY_BENCH_TOGGLE_SHARE * 100, REGISTRY_BENCH_LOOKUPS);
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s %6s\n", "entities",
+		"map tog", "map walk", "map find", "reg tog", "reg walk", "reg get", "speedup", "same");
+
+	bool isSame = true;
+	for (unsigned int count : counts) {
+		unsigned int projectiles = static_cast<unsigned int>(count * REGISTRY_BENCH_PROJECTILE_SHARE);
+		unsigned int toggles = static_cast<unsigned int>(projectiles * REGISTRY_BENCH_TOGGLE_SHARE);
+
+		// The same entities for both factories, projectiles first
+		std::vector<Entity*> mapEntities(count), registryEntities(count);
+		MapFactory mapFactory;
+		RegistryFactory registryFactory;
+		for (unsigned int i = 0; i < count; i++) {
+			std::string name = (i < projectiles ? "Projectile_" : "Enemy_") + std::to_string(i);
+			mapEntities[i] = new Entity(name);
+			registryEntities[i] = new Entity(name);
+			mapFactory.Add(mapEntities[i]);
+			registryFactory.Add(registryEntities[i]);
+		}
+
+		// What gets fired, removed and looked up
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<unsigned int> projectile(0, projectiles - 1);
+		std::uniform_int_distribution<unsigned int> any(0, count - 1);
+		std::vector<RegistryFrame> frames(REGISTRY_BENCH_FRAMES);
+		for (auto& frame : frames) {
+			for (unsigned int i = 0; i < toggles; i++)
+				frame.toggled.push_back(projectile(rng));
+			for (unsigned int i = 0; i < REGISTRY_BENCH_LOOKUPS; i++)
+				frame.lookups.push_back(any(rng));
+		}
+
+		// Names are what the old factory had to look entities up by, handles
+		// are what callers keep now
+		std::vector<std::string> names(count);
+		std::vector<EntityHandle> handles(count);
+		for (unsigned int i = 0; i < count; i++) {
+			names[i] = mapEntities[i]->name;
+			handles[i] = registryEntities[i]->handle;
+		}
+
+		double mapToggleMs = 0, mapWalkMs = 0, mapFindMs = 0;
+		double registryToggleMs = 0, registryWalkMs = 0, registryGetMs = 0;
+		unsigned int mapFound = 0, registryFound = 0;
+		for (const auto& frame : frames) {
+			BenchmarkTimer timer;
+			for (unsigned int i : frame.toggled) {
+				bool fire = !mapEntities[i]->isUpdating;
+				mapFactory.SetColliding(mapEntities[i], fire);
+				mapFactory.SetUpdating(mapEntities[i], fire);
+			}
+			mapToggleMs += timer.ElapsedMs();
+
+			timer.Reset();
+			mapFactory.Update();
+			mapWalkMs += timer.ElapsedMs();
+
+			timer.Reset();
+			for (unsigned int i : frame.lookups)
+				mapFound += mapFactory.Find(names[i]) != nullptr;
+			mapFindMs += timer.ElapsedMs();
+
+			timer.Reset();
+			for (unsigned int i : frame.toggled) {
+				bool fire = !registryEntities[i]->isUpdating;
+				registryFactory.SetColliding(registryEntities[i], fire);
+				registryFactory.SetUpdating(registryEntities[i], fire);
+			}
+			registryToggleMs += timer.ElapsedMs();
+
+			timer.Reset();
+			registryFactory.Update();
+			registryWalkMs += timer.ElapsedMs();
+
+			timer.Reset();
+			for (unsigned int i : frame.lookups)
+				registryFound += registryFactory.registry.Get(handles[i]) != nullptr;
+			registryGetMs += timer.ElapsedMs();
+		}
+
+		// Every entity updated as often either way, and everything was found
+		bool isSameHere = mapFound == registryFound && registryFactory.registry.GetList(ENTITY_LIST_COLLIDING).size() == mapFactory.collidingEntities.size();
+		for (unsigned int i = 0; i < count; i++)
+			isSameHere = isSameHere && mapEntities[i]->updates == registryEntities[i]->updates;
+
+		// Destroying must invalidate handles, including once the slot is reused
+		EntityHandle destroyed = registryEntities[0]->handle;
+		registryFactory.registry.Destroy(destroyed);
+		Entity reused("Reused");
+		EntityHandle reusedHandle = registryFactory.registry.Create(&reused);
+		isSameHere = isSameHere && reusedHandle.slot == destroyed.slot && registryFactory.registry.Get(destroyed) == nullptr
+			&& registryFactory.registry.Get(reusedHandle) == &reused && registryFactory.registry.Find(registryEntities[0]->name) == nullptr;
+		isSame = isSame && isSameHere;
+
+		double mapMs = mapToggleMs + mapWalkMs + mapFindMs;
+		double registryMs = registryToggleMs + registryWalkMs + registryGetMs;
+		printf("%8u %10.4f %10.4f %10.4f %10.4f %10.4f %10.4f %9.2fx %6s\n", count,
+			mapToggleMs / REGISTRY_BENCH_FRAMES, mapWalkMs / REGISTRY_BENCH_FRAMES, mapFindMs / REGISTRY_BENCH_FRAMES,
+			registryToggleMs / REGISTRY_BENCH_FRAMES, registryWalkMs / REGISTRY_BENCH_FRAMES, registryGetMs / REGISTRY_BENCH_FRAMES,
+			mapMs / registryMs, isSameHere ? "yes" : "NO");
+
+		for (unsigned int i = 0; i < count; i++) {
+			delete mapEntities[i];
+			delete registryEntities[i];
+		}
+	}
+
+	bool isStopSafe = CheckStopDuringWalk();
+	isSame = isSame && isStopSafe;
+	printf("entity stopped by a later one's update, the last still updated: %s\n", isStopSafe ? "yes" : "NO");
+
+	printf("\n%u tag tests a frame, then every entity tagged Enemy and Damaging\n", REGISTRY_BENCH_CONTACTS);
+	printf("%8s %12s %12s %12s %12s %6s\n", "entities", "names ms", "mask ms", "scan ms", "list ms", "same");
+	for (unsigned int count : counts)
+		isSame = CompareTags(count) && isSame;
+
+	return isSame ? 0 : 1;
+}
@@ -0,0 +1,405 @@
+// Runs generated scenes shaped like the game's through the collision
+// manager, without a window: enemies as oriented boxes turning about z,
+// projectiles as fast moving spheres, and static half volumes as walls, all
+// on the z = 0 plane and on the game's layers. The entities are owned by the
+// benchmark's stand-in entity factory, and every frame is a real
+// CollisionUpdate, so layer filtering, sweeps, sleeping and the dispatch of
+// callbacks are all timed. Results are printed as CSV so broadphase changes
+// can be compared run to run. Every broadphase sees the same scene and
+// motion, so the contacts of a scenario must match across its rows, and the
+// benchmark fails when they do not or a callback went missing.
+//
+// Without arguments a few preset scenarios are run. Any option runs one
+// scenario, starting from the defaults below:
+//
+//   --enemies N            oriented boxes (2000)
+//   --projectiles N        spheres (4000)
+//   --walls N              static half volumes (32)
+//   --layout L             uniform or clustered (uniform)
+//   --clusters N           cluster count of the clustered layout (8)
+//   --enemy-speed S        largest enemy speed, units per second (2)
+//   --projectile-speed S   largest projectile speed, units per second (10)
+//   --frames N             frames stepped (120)
+//   --world W              half width of the square world (40)
+//   --broadphase B         hash, sap, tree, levels, planar or all (all)
+//   --seed N               scene seed (1234)
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "BenchmarkEntities.h"
+#include "CollisionManager.h"
+
+#define SCENARIO_BENCH_DELTA_TIME (1.0f / 60.0f)
+#define SCENARIO_BENCH_MAX_SCALE 0.5f		// Largest moving collider half width
+#define SCENARIO_BENCH_HALF_DEPTH 0.5f		// Grid depth, as the game's
+#define SCENARIO_BENCH_PROJECTILE_RADIUS 0.1f
+
+enum ScenarioLayout { LAYOUT_UNIFORM, LAYOUT_CLUSTERED };
+
+enum ScenarioBroadphase {
+	SCENARIO_HASH,
+	SCENARIO_SAP,
+	SCENARIO_TREE,
+	SCENARIO_LEVELS,
+	SCENARIO_PLANAR,
+	SCENARIO_BROADPHASE_COUNT
+};
+
+static const char* broadphaseNames[SCENARIO_BROADPHASE_COUNT] = { "hash", "sap", "tree", "levels", "planar" };
+
+struct ScenarioConfig
+{
+	const char* name = "custom";
+	unsigned int enemies = 2000;
+	unsigned int projectiles = 4000;
+	unsigned int walls = 32;
+	ScenarioLayout layout = LAYOUT_UNIFORM;
+	unsigned int clusters = 8;
+	float enemySpeed = 2.0f;
+	float projectileSpeed = 10.0f;
+	unsigned int frames = 120;
+	float worldHalfWidth = 40.0f;
+	unsigned int seed = 1234;
+};
+
+struct ScenarioWall
+{
+	XMFLOAT3 center;
+	XMFLOAT4 rotation;
+	XMFLOAT3 size;
+};
+
+// Moving colliders first, enemies then projectiles, then the walls
+struct ScenarioScene
+{
+	std::vector<BenchmarkBox> boxes;		// Moving colliders
+	std::vector<unsigned char> shapes;		// Solid shape of each moving collider
+	std::vector<float> angles;				// About z
+	std::vector<float> spins;
+	std::vector<XMFLOAT4> rotations;
+	std::vector<ScenarioWall> walls;
+};
+
+// Totals over the frames of a run
+struct ScenarioStats
+{
+	double totalMs = 0;		// CollisionUpdate, dispatch included
+	unsigned long long contacts = 0;	// Enter and stay events
+	unsigned long long enters = 0;
+	unsigned long long exits = 0;
+	unsigned long long callbacks = 0;	// Counted by the entities
+};
+
+// --------------------------------------------------------
+// Place the moving colliders and walls of a scenario
+// --------------------------------------------------------
+static ScenarioScene CreateScene(const ScenarioConfig& config)
+{
+	ScenarioScene scene;
+	std::mt19937 rng(config.seed);
+	float w = config.worldHalfWidth;
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> enemyHalf(0.2f, SCENARIO_BENCH_MAX_SCALE);
+
+	std::vector<XMFLOAT2> clusterCenters;
+	for (unsigned int i = 0; i < config.clusters; i++)
+		clusterCenters.push_back(XMFLOAT2(unit(rng) * w * 0.8f, unit(rng) * w * 0.8f));
+	std::normal_distribution<float> spread(0.0f, w * 0.08f);
+
+	unsigned int moving = config.enemies + config.projectiles;
+	scene.boxes.resize(moving);
+	scene.shapes.resize(moving);
+	scene.angles.resize(moving);
+	scene.spins.resize(moving);
+	scene.rotations.resize(moving);
+	for (unsigned int i = 0; i < moving; i++) {
+		bool isEnemy = i < config.enemies;
+		BenchmarkBox& box = scene.boxes[i];
+		if (config.layout == LAYOUT_CLUSTERED && !clusterCenters.empty()) {
+			const XMFLOAT2& cluster = clusterCenters[rng() % clusterCenters.size()];
+			box.center = XMFLOAT3(std::max(-w, std::min(w, cluster.x + spread(rng))), std::max(-w, std::min(w, cluster.y + spread(rng))), 0);
+		}
+		else {
+			box.center = XMFLOAT3(unit(rng) * w, unit(rng) * w, 0);
+		}
+
+		float speed = (isEnemy ? config.enemySpeed : config.projectileSpeed) * (0.5f + 0.5f * fabsf(unit(rng)));
+		float heading = angle(rng);
+		box.velocity = XMFLOAT3(cosf(heading) * speed, sinf(heading) * speed, 0);
+
+		if (isEnemy) {
+			box.halfExtents = XMFLOAT3(enemyHalf(rng), enemyHalf(rng), enemyHalf(rng));
+			scene.shapes[i] = SHAPE_OBB;
+			scene.angles[i] = angle(rng);
+			scene.spins[i] = angle(rng);
+		}
+		else {
+			float r = SCENARIO_BENCH_PROJECTILE_RADIUS;
+			box.halfExtents = XMFLOAT3(r, r, r);
+			scene.shapes[i] = SHAPE_SPHERE;
+			scene.angles[i] = 0;
+			scene.spins[i] = 0;
+		}
+	}
+
+	// Walls stand on the plane, their normal (third axis) turned into it
+	std::uniform_real_distribution<float> wallLength(2.0f, 8.0f);
+	XMVECTOR standUp = XMQuaternionRotationAxis(XMVectorSet(1, 0, 0, 0), XM_PIDIV2);
+	scene.walls.resize(config.walls);
+	for (unsigned int i = 0; i < config.walls; i++) {
+		ScenarioWall& wall = scene.walls[i];
+		XMStoreFloat4(&wall.rotation, XMQuaternionMultiply(standUp, XMQuaternionRotationAxis(XMVectorSet(0, 0, 1, 0), angle(rng))));
+		wall.center = XMFLOAT3(unit(rng) * w, unit(rng) * w, 0);
+		wall.size = XMFLOAT3(wallLength(rng), 1.0f, 0.5f);
+	}
+	return scene;
+}
+
+// --------------------------------------------------------
+// Advance the moving colliders and turn the enemies
+// --------------------------------------------------------
+static void StepScene(ScenarioScene& scene, float worldHalfWidth)
+{
+	StepBenchmarkBoxes(scene.boxes, XMFLOAT3(worldHalfWidth, worldHalfWidth, 1.0f), SCENARIO_BENCH_DELTA_TIME);
+
+	XMVECTOR zAxis = XMVectorSet(0, 0, 1, 0);
+	for (size_t i = 0; i < scene.boxes.size(); i++) {
+		scene.angles[i] += scene.spins[i] * SCENARIO_BENCH_DELTA_TIME;
+		scene.rotations[i] = XMFLOAT4(0, 0, 0, 1);
+		if (scene.shapes[i] == SHAPE_OBB)
+			XMStoreFloat4(&scene.rotations[i], XMQuaternionRotationAxis(zAxis, scene.angles[i]));
+	}
+}
+
+// --------------------------------------------------------
+// One broadphase over one scene, every entity staged with
+// the collision manager as the game's scene does
+// --------------------------------------------------------
+class ScenarioRunner
+{
+public:
+	ScenarioRunner(const ScenarioScene& scene, ScenarioBroadphase type, const XMFLOAT3& gridHalfWidth) :
+		scene(scene)
+	{
+		BroadphaseType broadphaseType = BroadphaseType::SPATIAL_HASH;
+		if (type == SCENARIO_SAP) broadphaseType = BroadphaseType::SWEEP_AND_PRUNE;
+		else if (type == SCENARIO_TREE) broadphaseType = BroadphaseType::AABB_TREE;
+		else if (type == SCENARIO_LEVELS) broadphaseType = BroadphaseType::HIERARCHICAL_GRID;
+		collisionManager = CollisionManager::Initialize(SCENARIO_BENCH_MAX_SCALE, gridHalfWidth, broadphaseType);
+		collisionManager->SetLayersCollide(LAYER_STATIC, LAYER_STATIC, false);
+		collisionManager->SetLayersCollide(LAYER_PROJECTILE, LAYER_PROJECTILE, false);
+		collisionManager->SetEntityRegistry(&entityFactory.GetRegistry());
+
+		// The planar run keeps moving colliders in the planar grid, as the game does
+		bool isPlanar = type == SCENARIO_PLANAR;
+		XMFLOAT3 zero(0, 0, 0);
+		XMFLOAT4 noRotation(0, 0, 0, 0);
+		for (size_t i = 0; i < scene.boxes.size(); i++) {
+			const BenchmarkBox& box = scene.boxes[i];
+			BenchmarkEntity* entity = entityFactory.CreateEntity<BenchmarkEntity>("Moving");
+			entity->transform.SetPosition(box.center);
+			entity->transform.SetRotation(scene.rotations[i]);
+			if (scene.shapes[i] == SHAPE_OBB) {
+				entity->SetCollider(Collider::OBB, box.halfExtents, zero, noRotation, LAYER_ENEMY);
+			}
+			else {
+				entity->SetCollider(Collider::SPHERE, box.halfExtents, zero, noRotation, LAYER_PROJECTILE);
+				entity->GetCollider()->SetIsFastMoving(true);
+			}
+			entity->GetCollider()->SetIsPlanar(isPlanar);
+			entities.push_back(entity);
+		}
+
+		for (const ScenarioWall& wall : scene.walls) {
+			BenchmarkEntity* entity = entityFactory.CreateEntity<BenchmarkEntity>("Wall");
+			entity->transform.SetPosition(wall.center);
+			entity->transform.SetRotation(wall.rotation);
+			entity->SetCollider(Collider::HALFVOL, wall.size, zero, noRotation, LAYER_STATIC);
+			entity->GetCollider()->SetIsStatic(true);
+			entities.push_back(entity);
+		}
+	}
+
+	~ScenarioRunner()
+	{
+		entityFactory.Release();
+		CollisionManager::Shutdown();
+	}
+
+	void Step(ScenarioStats& stats)
+	{
+		for (size_t i = 0; i < scene.boxes.size(); i++) {
+			entities[i]->transform.SetPosition(scene.boxes[i].center);
+			entities[i]->transform.SetRotation(scene.rotations[i]);
+		}
+
+		BenchmarkTimer timer;
+		collisionManager->CollisionUpdate();
+		stats.totalMs += timer.ElapsedMs();
+		entityFactory.FlushDestroyedEntities();
+
+		const std::vector<CollisionManager::CollisionEvent>& events = collisionManager->GetCollisionEvents();
+		for (const CollisionManager::CollisionEvent& event : events) {
+			if (event.type == CollisionPairCache::PAIR_EXIT) stats.exits++;
+			else stats.contacts++;
+			if (event.type == CollisionPairCache::PAIR_ENTER) stats.enters++;
+		}
+	}
+
+	// Callbacks the entities were given over every step so far
+	unsigned long long CountCallbacks() const
+	{
+		unsigned long long callbacks = 0;
+		for (const BenchmarkEntity* entity : entities)
+			callbacks += entity->enters + entity->stays + entity->exits;
+		return callbacks;
+	}
+
+private:
+	const ScenarioScene& scene;
+	CollisionManager* collisionManager;
+	EntityFactory entityFactory;
+	std::vector<BenchmarkEntity*> entities;	// Moving entities first, as the scene's boxes
+};
+
+// --------------------------------------------------------
+// Run a scenario once per selected broadphase, printing a
+// CSV row for each
+// --------------------------------------------------------
+static bool RunScenario(const ScenarioConfig& config, const std::vector<ScenarioBroadphase>& broadphases)
+{
+	XMFLOAT3 gridHalfWidth(config.worldHalfWidth, config.worldHalfWidth, SCENARIO_BENCH_HALF_DEPTH);
+	bool isAllSame = true;
+	unsigned long long firstContacts = 0;
+	for (size_t row = 0; row < broadphases.size(); row++) {
+		ScenarioBroadphase type = broadphases[row];
+
+		// Same scene and motion for every broadphase
+		ScenarioScene scene = CreateScene(config);
+		StepScene(scene, config.worldHalfWidth);
+		ScenarioStats stats;
+		{
+			ScenarioRunner runner(scene, type, gridHalfWidth);
+			for (unsigned int frame = 0; frame < config.frames; frame++) {
+				StepScene(scene, config.worldHalfWidth);
+				runner.Step(stats);
+			}
+			stats.callbacks = runner.CountCallbacks();
+		}
+
+		// Both entities of every contact change are told
+		if (row == 0) firstContacts = stats.contacts;
+		bool isSame = stats.contacts == firstContacts && stats.callbacks == 2 * (stats.contacts + stats.exits);
+		isAllSame = isAllSame && isSame;
+
+		double frames = config.frames;
+		printf("%s,%s,%s,%u,%u,%u,%.2f,%.2f,%u,%.1f,%.2f,%.2f,%.4f,%s\n",
+			config.name, config.layout == LAYOUT_CLUSTERED ? "clustered" : "uniform", broadphaseNames[type],
+			config.enemies, config.projectiles, config.walls, config.enemySpeed, config.projectileSpeed, config.frames,
+			stats.contacts / frames, stats.enters / frames, stats.exits / frames, stats.totalMs / frames,
+			isSame ? "yes" : "NO");
+		fflush(stdout);
+	}
+	return isAllSame;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr, "usage: ScenarioBenchmark [--enemies N] [--projectiles N] [--walls N] [--layout uniform|clustered]\n"
+		"                         [--clusters N] [--enemy-speed S] [--projectile-speed S] [--frames N] [--world W]\n"
+		"                         [--broadphase hash|sap|tree|levels|planar|all] [--seed N]\n");
+}
+
+// --------------------------------------------------------
+// Read the options over the defaults, false on anything
+// not understood
+// --------------------------------------------------------
+static bool ParseArguments(int argc, char** argv, ScenarioConfig& config, std::vector<ScenarioBroadphase>& broadphases)
+{
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 >= argc) return false;
+		std::string option = argv[i];
+		const char* value = argv[i + 1];
+
+		if (option == "--enemies") config.enemies = static_cast<unsigned int>(atoi(value));
+		else if (option == "--projectiles") config.projectiles = static_cast<unsigned int>(atoi(value));
+		else if (option == "--walls") config.walls = static_cast<unsigned int>(atoi(value));
+		else if (option == "--clusters") config.clusters = static_cast<unsigned int>(atoi(value));
+		else if (option == "--enemy-speed") config.enemySpeed = static_cast<float>(atof(value));
+		else if (option == "--projectile-speed") config.projectileSpeed = static_cast<float>(atof(value));
+		else if (option == "--frames") config.frames = static_cast<unsigned int>(atoi(value));
+		else if (option == "--world") config.worldHalfWidth = static_cast<float>(atof(value));
+		else if (option == "--seed") config.seed = static_cast<unsigned int>(atoi(value));
+		else if (option == "--layout") {
+			if (strcmp(value, "uniform") == 0) config.layout = LAYOUT_UNIFORM;
+			else if (strcmp(value, "clustered") == 0) config.layout = LAYOUT_CLUSTERED;
+			else return false;
+		}
+		else if (option == "--broadphase") {
+			broadphases.clear();
+			for (int type = 0; type < SCENARIO_BROADPHASE_COUNT; type++) {
+				if (strcmp(value, "all") == 0 || strcmp(value, broadphaseNames[type]) == 0)
+					broadphases.push_back(static_cast<ScenarioBroadphase>(type));
+			}
+			if (broadphases.empty()) return false;
+		}
+		else return false;
+	}
+	return config.frames > 0 && config.worldHalfWidth > 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<ScenarioBroadphase> broadphases;
+	for (int type = 0; type < SCENARIO_BROADPHASE_COUNT; type++)
+		broadphases.push_back(static_cast<ScenarioBroadphase>(type));
+
+	std::vector<ScenarioConfig> scenarios;
+	if (argc > 1) {
+		ScenarioConfig config;
+		if (!ParseArguments(argc, argv, config, broadphases)) {
+			PrintUsage();
+			return 2;
+		}
+		scenarios.push_back(config);
+	}
+	else {
+		ScenarioConfig small;
+		small.name = "small";
+		small.enemies = 200;
+		small.projectiles = 400;
+		small.walls = 8;
+		small.worldHalfWidth = 15.0f;
+		scenarios.push_back(small);
+
+		ScenarioConfig wave;
+		wave.name = "wave";
+		scenarios.push_back(wave);
+
+		ScenarioConfig swarm = wave;
+		swarm.name = "swarm";
+		swarm.layout = LAYOUT_CLUSTERED;
+		scenarios.push_back(swarm);
+
+		ScenarioConfig barrage = wave;
+		barrage.name = "barrage";
+		barrage.enemies = 1000;
+		barrage.projectiles = 10000;
+		barrage.projectileSpeed = 30.0f;
+		scenarios.push_back(barrage);
+	}
+
+	printf("scenario,layout,broadphase,enemies,projectiles,walls,enemy_speed,projectile_speed,frames,"
+		"contacts_per_frame,enters_per_frame,exits_per_frame,total_ms,same\n");
+	bool isAllSame = true;
+	for (const ScenarioConfig& config : scenarios)
+		isAllSame = RunScenario(config, broadphases) && isAllSame;
+	return isAllSame ? 0 : 1;
+}
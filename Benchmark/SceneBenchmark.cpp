@@ -0,0 +1,303 @@
+// Times switching scenes the way StateManager does, unloading every entity of
+// the old scene and creating those of the new one. Once as the entity factory
+// used to: each entity, collider and emitter its own heap allocation, and
+// every collider and entity unstaged one by one with the searches
+// UnstageCollider and UnstageEntity do. Then with the scene arena, the
+// broadphase and render batches dropping everything at once. Both must
+// create and destroy the same objects and leave nothing staged. Entities
+// destroyed before the switch, as EntityFactory::Release does, must be found
+// through an Entity pointer even when Entity is a virtual base of them.
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "SceneArena.h"
+#include "SpatialHash.h"
+
+#define SCENE_BENCH_SWITCHES 40
+#define SCENE_BENCH_MATERIALS 8
+#define SCENE_BENCH_EMITTER_SHARE 0.3f	// Entities owning an emitter, as projectiles and enemies do
+#define SCENE_BENCH_HALF_WIDTH 3.0f
+
+static unsigned int liveObjects = 0;
+
+// Stand in for ParticleEmitter, about its size
+class Emitter
+{
+public:
+	Emitter(unsigned int numParticles) : numParticles(numParticles) { liveObjects++; }
+	~Emitter() { liveObjects--; }
+
+	float emitter[40];
+	unsigned int numParticles;
+};
+
+// Stand in for Collider, about its size
+class Collider
+{
+public:
+	Collider(const XMFLOAT3& center, float halfWidth) : center(center), halfExtents(halfWidth, halfWidth, halfWidth) { liveObjects++; }
+	~Collider() { liveObjects--; }
+
+	XMFLOAT3 center;
+	XMFLOAT3 halfExtents;
+	XMFLOAT4 rotation;
+	float worldState[40];
+	unsigned int proxyId = 0;
+	bool isStaged = false;
+};
+
+// Stand in for Entity, about its size
+class Entity
+{
+public:
+	Entity(const std::string& name, unsigned int material) : name(name), material(material) { liveObjects++; }
+	virtual ~Entity() { liveObjects--; }
+
+	std::string name;
+	XMFLOAT4X4 world;
+	XMFLOAT4X4 inverseTransposeWorld;
+	float transform[16];
+	unsigned int material;
+	Collider* collider = nullptr;
+	Emitter* emitter = nullptr;
+};
+
+// Stand in for EntityProjectile, whose Entity is a virtual base that does
+// not start where the object does
+class Projectile : public virtual Entity
+{
+public:
+	Projectile(const std::string& name, unsigned int material) : Entity(name, material) { liveObjects++; }
+	~Projectile() { liveObjects--; }
+
+	float velocity[4];
+};
+
+// What the collision manager, renderer and particle renderer keep of a scene
+class SceneManagers
+{
+public:
+	SceneManagers() : broadphase(0.25f, XMFLOAT3(SCENE_BENCH_HALF_WIDTH, SCENE_BENCH_HALF_WIDTH, SCENE_BENCH_HALF_WIDTH)) {}
+
+	void Stage(Entity* entity)
+	{
+		Collider* c = entity->collider;
+		unsigned int id;
+		if (freeProxies.empty()) {
+			id = static_cast<unsigned int>(proxies.size());
+			proxies.push_back(c);
+			impacts.push_back(nullptr);
+		}
+		else {
+			id = freeProxies.back();
+			freeProxies.pop_back();
+			proxies[id] = c;
+		}
+		c->proxyId = id;
+		c->isStaged = true;
+		colliderVector.push_back(c);
+		broadphase.AddProxy(id, c->center, c->halfExtents);
+		renderBatches.insert(std::make_pair(entity->material, entity));
+	}
+
+	// As UnstageCollider and UnstageEntity
+	void Unstage(Entity* entity)
+	{
+		Collider* c = entity->collider;
+		for (size_t i = colliderVector.size() - 1; i < colliderVector.size(); i--) {
+			if (colliderVector[i] == c) {
+				std::swap(colliderVector[i], colliderVector.back());
+				colliderVector.pop_back();
+			}
+		}
+		c->isStaged = false;
+		for (size_t i = 0; i < impacts.size(); i++) {
+			if (impacts[i] == c) impacts[i] = nullptr;
+		}
+		broadphase.RemoveProxy(c->proxyId);
+		proxies[c->proxyId] = nullptr;
+		freeProxies.push_back(c->proxyId);
+
+		auto bucket = renderBatches.equal_range(entity->material);
+		for (auto iterator = bucket.first; iterator != bucket.second; iterator++) {
+			if (iterator->second == entity) {
+				renderBatches.erase(iterator);
+				break;
+			}
+		}
+	}
+
+	// As UnstageAll and UnstageAllEntities
+	void UnstageAll()
+	{
+		for (size_t id = 0; id < proxies.size(); id++) {
+			if (proxies[id] != nullptr) proxies[id]->isStaged = false;
+		}
+		broadphase.RemoveAllProxies();
+		colliderVector.clear();
+		proxies.clear();
+		freeProxies.clear();
+		impacts.clear();
+		renderBatches.clear();
+	}
+
+	bool IsEmpty() const
+	{
+		return colliderVector.empty() && renderBatches.empty() && emitters.empty();
+	}
+
+	SpatialHash broadphase;
+	std::vector<Collider*> colliderVector;
+	std::vector<Collider*> proxies;
+	std::vector<unsigned int> freeProxies;
+	std::vector<Collider*> impacts;
+	std::unordered_multimap<unsigned int, Entity*> renderBatches;
+	std::unordered_map<std::string, Emitter*> emitters;
+};
+
+// Where an entity of a scene is and whether it has an emitter
+struct SceneEntity {
+	XMFLOAT3 center;
+	float halfWidth;
+	unsigned int material;
+	bool hasEmitter;
+};
+
+static std::vector<SceneEntity> CreateScene(unsigned int count, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-SCENE_BENCH_HALF_WIDTH, SCENE_BENCH_HALF_WIDTH);
+	std::uniform_real_distribution<float> half(0.05f, 0.25f);
+	std::uniform_int_distribution<unsigned int> material(0, SCENE_BENCH_MATERIALS - 1);
+	std::uniform_real_distribution<float> share(0, 1);
+
+	std::vector<SceneEntity> scene(count);
+	for (auto& entity : scene) {
+		entity.center = XMFLOAT3(position(rng), position(rng), position(rng));
+		entity.halfWidth = half(rng);
+		entity.material = material(rng);
+		entity.hasEmitter = share(rng) < SCENE_BENCH_EMITTER_SHARE;
+	}
+	return scene;
+}
+
+// Every entity, collider and emitter on the heap, unstaged and deleted one by one
+static void SwitchOnHeap(SceneManagers& managers, std::vector<Entity*>& entities, const std::vector<SceneEntity>& scene)
+{
+	for (Entity* entity : entities) {
+		managers.Unstage(entity);
+		delete entity->collider;
+		delete entity;
+	}
+	entities.clear();
+	for (auto it = managers.emitters.begin(); it != managers.emitters.end(); it++)
+		delete it->second;
+	managers.emitters.clear();
+
+	for (size_t i = 0; i < scene.size(); i++) {
+		Entity* entity = new Entity("Entity_" + std::to_string(i), scene[i].material);
+		entity->collider = new Collider(scene[i].center, scene[i].halfWidth);
+		if (scene[i].hasEmitter) {
+			entity->emitter = new Emitter(20);
+			managers.emitters["PE_" + entity->name] = entity->emitter;
+		}
+		managers.Stage(entity);
+		entities.push_back(entity);
+	}
+}
+
+// Every entity, collider and emitter in the arenas, unstaged and freed together
+static void SwitchInArena(SceneManagers& managers, SceneArena& sceneArena, SceneArena& emitterArena, std::vector<Entity*>& entities, const std::vector<SceneEntity>& scene)
+{
+	if (!entities.empty())
+		managers.UnstageAll();
+	sceneArena.Reset();
+	entities.clear();
+	managers.emitters.clear();
+	emitterArena.Reset();
+
+	for (size_t i = 0; i < scene.size(); i++) {
+		Entity* entity = sceneArena.Create<Entity>("Entity_" + std::to_string(i), scene[i].material);
+		entity->collider = sceneArena.Create<Collider>(scene[i].center, scene[i].halfWidth);
+		if (scene[i].hasEmitter) {
+			entity->emitter = emitterArena.Create<Emitter>(20u);
+			managers.emitters["PE_" + entity->name] = entity->emitter;
+		}
+		managers.Stage(entity);
+		entities.push_back(entity);
+	}
+}
+
+// Destroys some entities early through their Entity pointer, the rest with
+// the reset, and every destructor must run exactly once
+static bool CheckEarlyDestroy(SceneArena& sceneArena)
+{
+	std::vector<Entity*> entities;
+	for (unsigned int i = 0; i < 64; i++) {
+		if (i % 2 == 0)
+			entities.push_back(sceneArena.Create<Projectile>("Projectile_" + std::to_string(i), i));
+		else
+			entities.push_back(sceneArena.Create<Entity>("Entity_" + std::to_string(i), i));
+		entities.back()->collider = sceneArena.Create<Collider>(XMFLOAT3(0, 0, 0), 0.1f);
+	}
+	bool isBaseOffset = static_cast<void*>(entities[0]) != dynamic_cast<void*>(entities[0]);
+
+	for (size_t i = 0; i < entities.size(); i += 3) {
+		sceneArena.Destroy(entities[i]->collider);
+		sceneArena.Destroy(entities[i]);
+	}
+	unsigned int afterEarly = liveObjects;
+	sceneArena.Reset();
+
+	// Of the 22 destroyed early 11 are projectiles, each 3 live objects with its
+	// collider, and 11 are entities of 2
+	return isBaseOffset && afterEarly == 32 * 3 + 32 * 2 - (11 * 3 + 11 * 2) && liveObjects == 0;
+}
+
+int main()
+{
+	// The menu's 100 entities, the game's as it is and as it may grow
+	unsigned int counts[] = { 100, 1000, 10000 };
+	printf("%u switches between two scenes of each size, %.0f%% of entities with an emitter\n",
+		SCENE_BENCH_SWITCHES, SCENE_BENCH_EMITTER_SHARE * 100);
+	printf("%8s %12s %12s %10s %10s %6s\n", "entities", "heap ms/sw", "arena ms/sw", "speedup", "arena KB", "same");
+
+	bool isSame = true;
+	for (unsigned int count : counts) {
+		std::vector<SceneEntity> scenes[2] = { CreateScene(count, 1), CreateScene(count / 2 + 1, 2) };
+
+		SceneManagers heapManagers;
+		std::vector<Entity*> heapEntities;
+		BenchmarkTimer timer;
+		for (unsigned int i = 0; i < SCENE_BENCH_SWITCHES; i++)
+			SwitchOnHeap(heapManagers, heapEntities, scenes[i % 2]);
+		SwitchOnHeap(heapManagers, heapEntities, std::vector<SceneEntity>());
+		double heapMs = timer.ElapsedMs();
+		bool heapClean = liveObjects == 0 && heapManagers.IsEmpty();
+
+		SceneManagers arenaManagers;
+		SceneArena sceneArena, emitterArena;
+		std::vector<Entity*> arenaEntities;
+		timer.Reset();
+		for (unsigned int i = 0; i < SCENE_BENCH_SWITCHES; i++)
+			SwitchInArena(arenaManagers, sceneArena, emitterArena, arenaEntities, scenes[i % 2]);
+		SwitchInArena(arenaManagers, sceneArena, emitterArena, arenaEntities, std::vector<SceneEntity>());
+		double arenaMs = timer.ElapsedMs();
+		bool arenaClean = liveObjects == 0 && arenaManagers.IsEmpty();
+
+		bool same = heapClean && arenaClean;
+		isSame = isSame && same;
+		printf("%8u %12.3f %12.3f %9.1fx %10.0f %6s\n", count,
+			heapMs / (SCENE_BENCH_SWITCHES + 1), arenaMs / (SCENE_BENCH_SWITCHES + 1), heapMs / arenaMs,
+			(sceneArena.GetReservedBytes() + emitterArena.GetReservedBytes()) / 1024.0, same ? "yes" : "NO");
+	}
+
+	SceneArena sceneArena;
+	bool isEarlyDestroyed = CheckEarlyDestroy(sceneArena);
+	printf("entities destroyed early through a virtual base: %s\n", isEarlyDestroyed ? "yes" : "NO");
+
+	return isSame && isEarlyDestroyed ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+// Times a frame of collision over a scene that is mostly scenery, once the
+// old way with every collider moved in the broadphase and every candidate
+// tested, and once the way the collision manager now partitions it: scenery
+// in a static hash binned once that only moving colliders query, colliders
+// that stopped moving asleep in the broadphase, and pairs of resting
+// colliders keeping last frame's contact. Apart from pairs of scenery, which
+// the partitioned path never tests, both must produce the same transitions
+// every frame.
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "ColliderStore.h"
+#include "CollisionPairCache.h"
+#include "Narrowphase.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+
+#define SLEEP_BENCH_COLLIDERS 20000
+#define SLEEP_BENCH_FRAMES 200
+#define SLEEP_BENCH_DELTA_TIME (1.0f / 60.0f)
+#define SLEEP_BENCH_STATIC_SHARE 0.6f	// Scenery
+#define SLEEP_BENCH_MOVING_SHARE 0.05f	// Never stop, the rest move in bursts
+#define SLEEP_BENCH_WAKE_CHANCE 0.005f	// Per frame, for a collider at rest
+#define SLEEP_BENCH_BURST_FRAMES 30
+
+// Same as the collision manager
+#define SLEEP_BENCH_SLEEP_UPDATES 2
+
+struct SleepScene
+{
+	std::vector<BenchmarkBox> boxes;
+	std::vector<unsigned char> shapes;
+	std::vector<unsigned char> isStatic;
+	std::vector<unsigned char> moved;	// This frame
+};
+
+static Broadphase* CreateBroadphase(int type, float worldHalfWidth)
+{
+	switch (type) {
+	case 0: return new SpatialHash(0.5f, XMFLOAT3(worldHalfWidth, worldHalfWidth, worldHalfWidth));
+	case 1: return new SweepAndPrune();
+	default: return new DynamicAABBTree(0.1f);
+	}
+}
+
+static void SetCollider(ColliderStore& store, const SleepScene& scene, unsigned int id)
+{
+	const BenchmarkBox& box = scene.boxes[id];
+	store.Set(id, box.center, box.halfExtents, box.halfExtents.x, scene.shapes[id], 0, &scene.boxes[id]);
+}
+
+// Narrowphase contacts into the pair cache, then the frame's transitions
+static void FinishFrame(CollisionPairCache& pairCache, Narrowphase& narrowphase, const ColliderStore& store,
+	const std::vector<CollisionPairKey>& candidates, std::vector<CollisionPairCache::PairTransition>& transitions)
+{
+	narrowphase.Run(store, candidates);
+	const std::vector<unsigned char>& hits = narrowphase.GetHits();
+	const std::vector<XMFLOAT3>& points = narrowphase.GetPoints();
+	const std::vector<XMFLOAT3>& normals = narrowphase.GetNormals();
+	const std::vector<float>& depths = narrowphase.GetDepths();
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (hits[i]) pairCache.AddContact(candidates[i], points[i], normals[i], depths[i]);
+	}
+	transitions.clear();
+	pairCache.EndFrame(transitions);
+}
+
+// --------------------------------------------------------
+// Every collider moved and every pair tested, every frame
+// --------------------------------------------------------
+class EveryFrameRunner
+{
+public:
+	EveryFrameRunner(const SleepScene& scene, Broadphase* broadphase) : scene(scene), broadphase(broadphase)
+	{
+		unsigned int count = static_cast<unsigned int>(scene.boxes.size());
+		store.Resize(count);
+		for (unsigned int i = 0; i < count; i++)
+			broadphase->AddProxy(i, scene.boxes[i].center, scene.boxes[i].halfExtents);
+	}
+
+	void Step(std::vector<CollisionPairCache::PairTransition>& transitions)
+	{
+		for (unsigned int i = 0; i < scene.boxes.size(); i++) {
+			SetCollider(store, scene, i);
+			broadphase->UpdateProxy(i, scene.boxes[i].center, scene.boxes[i].halfExtents);
+		}
+		pairCache.BeginFrame();
+		broadphase->FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+		tested += candidates.size();
+		FinishFrame(pairCache, narrowphase, store, candidates, transitions);
+	}
+
+	unsigned long long tested = 0;
+
+private:
+	const SleepScene& scene;
+	std::unique_ptr<Broadphase> broadphase;
+	ColliderStore store;
+	CollisionPairCache pairCache;
+	Narrowphase narrowphase;
+};
+
+// --------------------------------------------------------
+// Static hash, sleeping and resting pairs, as the collision
+// manager runs them
+// --------------------------------------------------------
+class PartitionedRunner
+{
+public:
+	PartitionedRunner(const SleepScene& scene, Broadphase* broadphase, float worldHalfWidth) : scene(scene), broadphase(broadphase),
+		staticHash(0.5f, XMFLOAT3(worldHalfWidth, worldHalfWidth, worldHalfWidth))
+	{
+		unsigned int count = static_cast<unsigned int>(scene.boxes.size());
+		store.Resize(count);
+		stillUpdates.assign(count, 0);
+		isResting.assign(count, 0);
+		for (unsigned int i = 0; i < count; i++) {
+			if (scene.isStatic[i]) {
+				SetCollider(store, scene, i);
+				staticHash.AddProxy(i, scene.boxes[i].center, scene.boxes[i].halfExtents);
+				isResting[i] = 1;
+			}
+			else {
+				dynamicIds.push_back(i);
+				broadphase->AddProxy(i, scene.boxes[i].center, scene.boxes[i].halfExtents);
+			}
+		}
+		staticHash.Rebin();
+	}
+
+	void Step(std::vector<CollisionPairCache::PairTransition>& transitions)
+	{
+		pairCache.BeginFrame();
+		for (unsigned int id : dynamicIds) {
+			if (scene.moved[id]) stillUpdates[id] = 0;
+			else if (stillUpdates[id] < SLEEP_BENCH_SLEEP_UPDATES) stillUpdates[id]++;
+			isResting[id] = stillUpdates[id] >= SLEEP_BENCH_SLEEP_UPDATES;
+			if (isResting[id]) continue;
+
+			const BenchmarkBox& box = scene.boxes[id];
+			SetCollider(store, scene, id);
+			broadphase->UpdateProxy(id, box.center, box.halfExtents);
+
+			staticCandidates.clear();
+			staticHash.QueryBox(box.center, box.halfExtents, staticCandidates);
+			for (unsigned int staticId : staticCandidates)
+				pairCache.AddCandidate(id, staticId);
+		}
+
+		broadphase->FindPairs(pairCache);
+		const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+		pairCache.KeepRestingPairs(isResting);
+		tested += candidates.size();
+		FinishFrame(pairCache, narrowphase, store, candidates, transitions);
+	}
+
+	unsigned long long tested = 0;
+
+private:
+	const SleepScene& scene;
+	std::unique_ptr<Broadphase> broadphase;
+	SpatialHash staticHash;
+	std::vector<unsigned int> dynamicIds;
+	std::vector<unsigned int> staticCandidates;
+	std::vector<unsigned char> stillUpdates;
+	std::vector<unsigned char> isResting;
+	ColliderStore store;
+	CollisionPairCache pairCache;
+	Narrowphase narrowphase;
+};
+
+// Same transitions, leaving out the pairs of scenery only the every frame
+// path tests
+static bool SameTransitions(const SleepScene& scene, const std::vector<CollisionPairCache::PairTransition>& every,
+	const std::vector<CollisionPairCache::PairTransition>& b)
+{
+	std::vector<CollisionPairCache::PairTransition> a;
+	for (const CollisionPairCache::PairTransition& transition : every) {
+		if (!scene.isStatic[CollisionPairCache::GetFirst(transition.key)] || !scene.isStatic[CollisionPairCache::GetSecond(transition.key)])
+			a.push_back(transition);
+	}
+
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].key != b[i].key || a[i].event != b[i].event) return false;
+		if (memcmp(&a[i].point, &b[i].point, sizeof(XMFLOAT3)) != 0) return false;
+	}
+	return true;
+}
+
+int main()
+{
+	float worldHalfWidth = 40.0f;
+	const char* labels[] = { "spatial hash", "sweep and prune", "aabb tree" };
+	printf("%u colliders, %.0f%% static, %.0f%% always moving, the rest move in bursts\n", SLEEP_BENCH_COLLIDERS,
+		SLEEP_BENCH_STATIC_SHARE * 100, SLEEP_BENCH_MOVING_SHARE * 100);
+	printf("%16s %12s %12s %12s %12s %10s %6s\n", "broadphase", "every ms", "tested", "partition ms", "tested", "speedup", "same");
+
+	bool isSame = true;
+	for (int type = 0; type < 3; type++) {
+		// Same scene and motion for every broadphase
+		SleepScene scene;
+		scene.boxes = CreateBenchmarkBoxes(SLEEP_BENCH_COLLIDERS, worldHalfWidth, 0.1f, 0.5f, 2.0f);
+		scene.shapes.resize(SLEEP_BENCH_COLLIDERS);
+		scene.isStatic.resize(SLEEP_BENCH_COLLIDERS);
+		scene.moved.resize(SLEEP_BENCH_COLLIDERS);
+		std::vector<unsigned int> burstFrames(SLEEP_BENCH_COLLIDERS, 0);
+		std::mt19937 rng(99);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		for (unsigned int i = 0; i < SLEEP_BENCH_COLLIDERS; i++) {
+			scene.shapes[i] = i % 2 ? SHAPE_AABB : SHAPE_SPHERE;
+			float roll = chance(rng);
+			scene.isStatic[i] = roll < SLEEP_BENCH_STATIC_SHARE;
+			if (!scene.isStatic[i] && roll < SLEEP_BENCH_STATIC_SHARE + SLEEP_BENCH_MOVING_SHARE)
+				burstFrames[i] = 0xFFFFFFFF;
+		}
+
+		EveryFrameRunner every(scene, CreateBroadphase(type, worldHalfWidth));
+		PartitionedRunner partitioned(scene, CreateBroadphase(type, worldHalfWidth), worldHalfWidth);
+		std::vector<CollisionPairCache::PairTransition> everyTransitions, partitionedTransitions;
+
+		double everyMs = 0, partitionedMs = 0;
+		bool isSameHere = true;
+		for (unsigned int frame = 0; frame < SLEEP_BENCH_FRAMES; frame++) {
+			for (unsigned int i = 0; i < SLEEP_BENCH_COLLIDERS; i++) {
+				scene.moved[i] = 0;
+				if (scene.isStatic[i]) continue;
+				if (burstFrames[i] == 0 && chance(rng) < SLEEP_BENCH_WAKE_CHANCE)
+					burstFrames[i] = SLEEP_BENCH_BURST_FRAMES;
+				if (burstFrames[i] == 0) continue;
+
+				BenchmarkBox& box = scene.boxes[i];
+				box.center.x += box.velocity.x * SLEEP_BENCH_DELTA_TIME;
+				box.center.y += box.velocity.y * SLEEP_BENCH_DELTA_TIME;
+				box.center.z += box.velocity.z * SLEEP_BENCH_DELTA_TIME;
+				scene.moved[i] = 1;
+				if (burstFrames[i] != 0xFFFFFFFF) burstFrames[i]--;
+			}
+
+			BenchmarkTimer everyTimer;
+			every.Step(everyTransitions);
+			everyMs += everyTimer.ElapsedMs();
+
+			BenchmarkTimer partitionedTimer;
+			partitioned.Step(partitionedTransitions);
+			partitionedMs += partitionedTimer.ElapsedMs();
+
+			isSameHere = isSameHere && SameTransitions(scene, everyTransitions, partitionedTransitions);
+		}
+
+		printf("%16s %12.3f %12llu %12.3f %12llu %9.2fx %6s\n", labels[type],
+			everyMs / SLEEP_BENCH_FRAMES, every.tested / SLEEP_BENCH_FRAMES,
+			partitionedMs / SLEEP_BENCH_FRAMES, partitioned.tested / SLEEP_BENCH_FRAMES,
+			everyMs / partitionedMs, isSameHere ? "yes" : "NO");
+		fflush(stdout);
+		isSame = isSame && isSameHere;
+	}
+	return isSame ? 0 : 1;
+}
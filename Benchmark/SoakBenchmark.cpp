@@ -0,0 +1,314 @@
+// Soaks the entity and collision stack on the headless platform, the part of
+// the game that runs without a window or a Direct3D device. A scripted
+// player steers and fires the way Game::SoakInput presses the keys, enemies
+// chase it and die after a few hits, projectiles destroy themselves from
+// their collision callbacks, and the scene is torn down and built again
+// every few seconds. Entities belong to the benchmark's stand-in factory and
+// collide through the real CollisionManager. Frames of fixed length must
+// come out the same for every frame length adding up to the same ticks, and
+// no callback may reach an entity after it destroyed itself.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "BenchmarkCommon.h"
+#include "BenchmarkEntities.h"
+#include "CollisionManager.h"
+#include "FrameLoop.h"
+#include "Platform.h"
+
+#define SOAK_BENCH_SECONDS 30
+#define SOAK_BENCH_RELOAD_TICKS 600		// The scene loads again every ten seconds
+#define SOAK_BENCH_ENEMIES 400
+#define SOAK_BENCH_ENEMY_HEALTH 3
+#define SOAK_BENCH_ARENA 12.0f
+#define SOAK_BENCH_FIRE_RATE 0.05f
+#define SOAK_BENCH_PROJECTILE_SPEED 20.0f
+#define SOAK_BENCH_PROJECTILE_LIFE 1.0f
+
+// What happened over a run, compared between frame lengths
+struct SoakStats
+{
+	unsigned int shots = 0;
+	unsigned int hits = 0;			// Projectiles that hit an enemy
+	unsigned int kills = 0;
+	unsigned int playerHits = 0;
+	unsigned int loads = 0;
+	unsigned int lateCallbacks = 0;	// Callbacks to an entity that destroyed itself
+
+	bool operator==(const SoakStats& other) const
+	{
+		return shots == other.shots && hits == other.hits && kills == other.kills
+			&& playerHits == other.playerHits && loads == other.loads && lateCallbacks == other.lateCallbacks;
+	}
+};
+
+// Flies straight until it hits an enemy or runs out of time
+class SoakProjectile : public Entity
+{
+public:
+	SoakProjectile(EntityFactory* entityFactory, std::string name) : Entity(entityFactory, name), factory(entityFactory) {}
+
+	void Update(float deltaTime, float) override
+	{
+		transform.Move(direction.x * deltaTime, direction.y * deltaTime, 0.0f);
+		life -= deltaTime;
+		if (life <= 0) Destroy();
+	}
+
+	void OnCollisionEnter(const Collision& collision) override
+	{
+		if (isDestroyed) stats->lateCallbacks++;
+		if (collision.otherCollider->GetLayer() != LAYER_ENEMY) return;
+		stats->hits++;
+		Destroy();
+	}
+
+	XMFLOAT3 direction;
+	float life = SOAK_BENCH_PROJECTILE_LIFE;
+	SoakStats* stats = nullptr;
+
+private:
+	EntityFactory* factory;
+	bool isDestroyed = false;
+
+	void Destroy()
+	{
+		if (isDestroyed) return;
+		isDestroyed = true;
+		factory->DestroyEntity(this);
+	}
+};
+
+// Steers and fires from the input, as EntityPlayer
+class SoakPlayer : public Entity
+{
+public:
+	SoakPlayer(EntityFactory* entityFactory, std::string name) : Entity(entityFactory, name), factory(entityFactory) {}
+
+	void Update(float deltaTime, float) override
+	{
+		XMFLOAT3 movement = XMFLOAT3(0, 0, 0);
+		if (Input::IsKeyDown('W')) movement.y += 1.0f;
+		else if (Input::IsKeyDown('S')) movement.y -= 1.0f;
+		if (Input::IsKeyDown('D')) movement.x += 1.0f;
+		else if (Input::IsKeyDown('A')) movement.x -= 1.0f;
+		XMStoreFloat3(&movement, XMVector3Normalize(XMLoadFloat3(&movement)) * 3.0f * deltaTime);
+		transform.Move(movement.x, movement.y, 0.0f);
+
+		XMFLOAT3 fireDirection = XMFLOAT3(0, 0, 0);
+		if (Input::IsKeyDown(INPUT_KEY_UP)) fireDirection.y += 1.0f;
+		else if (Input::IsKeyDown(INPUT_KEY_DOWN)) fireDirection.y -= 1.0f;
+		if (Input::IsKeyDown(INPUT_KEY_RIGHT)) fireDirection.x += 1.0f;
+		else if (Input::IsKeyDown(INPUT_KEY_LEFT)) fireDirection.x -= 1.0f;
+		fireTimer += deltaTime;
+		if ((fireDirection.x != 0 || fireDirection.y != 0) && fireTimer > SOAK_BENCH_FIRE_RATE) {
+			fireTimer = 0;
+			SoakProjectile* projectile = factory->CreateEntity<SoakProjectile>("Projectile");
+			projectile->transform.SetPosition(*transform.GetPosition());
+			projectile->transform.SetRotation(0, 0, 0, 1);
+			XMStoreFloat3(&projectile->direction, XMVector3Normalize(XMLoadFloat3(&fireDirection)) * SOAK_BENCH_PROJECTILE_SPEED);
+			projectile->stats = stats;
+			projectile->SetCollider(Collider::SPHERE, XMFLOAT3(0.1f, 0.1f, 0.1f), XMFLOAT3(0, 0, 0), XMFLOAT4(0, 0, 0, 0), LAYER_PROJECTILE);
+			projectile->GetCollider()->SetIsFastMoving(true);
+			projectile->GetCollider()->SetIsPlanar(true);
+			stats->shots++;
+		}
+	}
+
+	void OnCollisionEnter(const Collision& collision) override
+	{
+		if (collision.otherCollider->GetLayer() == LAYER_ENEMY) stats->playerHits++;
+	}
+
+	SoakStats* stats = nullptr;
+
+private:
+	EntityFactory* factory;
+	float fireTimer = 0;
+};
+
+// Chases the player, turning as it goes, until shot enough
+class SoakEnemy : public Entity
+{
+public:
+	SoakEnemy(EntityFactory* entityFactory, std::string name) : Entity(entityFactory, name), factory(entityFactory) {}
+
+	void Update(float deltaTime, float totalTime) override
+	{
+		XMVECTOR toPlayer = XMLoadFloat3(target->transform.GetPosition()) - XMLoadFloat3(transform.GetPosition());
+		XMFLOAT3 step;
+		XMStoreFloat3(&step, XMVector3Normalize(toPlayer) * speed * deltaTime);
+		transform.Move(step.x, step.y, 0.0f);
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationAxis(XMVectorSet(0, 0, 1, 0), totalTime * speed));
+		transform.SetRotation(rotation);
+	}
+
+	void OnCollisionEnter(const Collision& collision) override
+	{
+		if (health <= 0) stats->lateCallbacks++;
+		if (collision.otherCollider->GetLayer() != LAYER_PROJECTILE || health <= 0) return;
+		if (--health == 0) {
+			stats->kills++;
+			factory->DestroyEntity(this);
+		}
+	}
+
+	const Entity* target = nullptr;
+	float speed = 1.0f;
+	int health = SOAK_BENCH_ENEMY_HEALTH;
+	SoakStats* stats = nullptr;
+
+private:
+	EntityFactory* factory;
+};
+
+// The game's update without the renderer: entities, then collisions, then
+// the scene refilling what was killed
+class Soak
+{
+public:
+	Soak()
+	{
+		collisionManager = CollisionManager::Initialize(0.5f, XMFLOAT3(SOAK_BENCH_ARENA * 2, SOAK_BENCH_ARENA * 2, 0.5f));
+		collisionManager->SetLayersCollide(LAYER_STATIC, LAYER_STATIC, false);
+		collisionManager->SetLayersCollide(LAYER_PROJECTILE, LAYER_PROJECTILE, false);
+		collisionManager->SetLayersCollide(LAYER_PROJECTILE, LAYER_PLAYER, false);
+		collisionManager->SetEntityRegistry(&entityFactory.GetRegistry());
+	}
+
+	~Soak()
+	{
+		entityFactory.Release();
+		CollisionManager::Shutdown();
+	}
+
+	void Update(float deltaTime, float totalTime)
+	{
+		if (ticks++ % SOAK_BENCH_RELOAD_TICKS == 0) Load();
+
+		entityFactory.UpdateEntities(deltaTime, totalTime);
+		collisionManager->CollisionUpdate();
+		entityFactory.FlushDestroyedEntities();
+
+		for (unsigned int i = 0; i < stats.kills - respawned; i++)
+			CreateEnemy();
+		respawned = stats.kills;
+	}
+
+	XMFLOAT3 GetPlayerPosition() const
+	{
+		return *player->transform.GetPosition();
+	}
+
+	size_t GetEntityCount() const
+	{
+		return entityFactory.GetRegistry().GetCount();
+	}
+
+	SoakStats stats;
+
+private:
+	CollisionManager* collisionManager;
+	EntityFactory entityFactory;
+	SoakPlayer* player = nullptr;
+	std::mt19937 rng;
+	unsigned int ticks = 0;
+	unsigned int respawned = 0;
+
+	// Unload whatever is there and place the player and enemies afresh
+	void Load()
+	{
+		entityFactory.Release();
+		rng.seed(stats.loads++);
+		respawned = stats.kills;
+
+		player = entityFactory.CreateEntity<SoakPlayer>("Player");
+		player->transform.SetRotation(0, 0, 0, 1);
+		player->stats = &stats;
+		player->SetCollider(Collider::SPHERE, XMFLOAT3(0.3f, 0.3f, 0.3f), XMFLOAT3(0, 0, 0), XMFLOAT4(0, 0, 0, 0), LAYER_PLAYER);
+		for (unsigned int i = 0; i < SOAK_BENCH_ENEMIES; i++)
+			CreateEnemy();
+	}
+
+	void CreateEnemy()
+	{
+		std::uniform_real_distribution<float> position(-SOAK_BENCH_ARENA, SOAK_BENCH_ARENA);
+		std::uniform_real_distribution<float> half(0.15f, 0.35f);
+		std::uniform_real_distribution<float> speed(0.5f, 1.5f);
+		SoakEnemy* enemy = entityFactory.CreateEntity<SoakEnemy>("Enemy");
+		enemy->transform.SetPosition(position(rng), position(rng), 0.0f);
+		enemy->transform.SetRotation(0, 0, 0, 1);
+		enemy->target = player;
+		enemy->speed = speed(rng);
+		enemy->stats = &stats;
+		enemy->SetCollider(Collider::OBB, XMFLOAT3(half(rng), half(rng), 0.3f), XMFLOAT3(0, 0, 0), XMFLOAT4(0, 0, 0, 0), LAYER_ENEMY);
+		enemy->GetCollider()->SetIsPlanar(true);
+	}
+};
+
+// Like Game::SoakInput, by the second so every frame length used presses the
+// same keys on the same ticks
+static void ScriptInput(float seconds, InputSnapshot& input)
+{
+	const char moves[] = { 'W', 'D', 'S', 'A' };
+	const unsigned int fires[] = { INPUT_KEY_UP, INPUT_KEY_RIGHT, INPUT_KEY_DOWN, INPUT_KEY_LEFT };
+	input.keys[(unsigned char)moves[(unsigned int)(seconds / 2.0f) % 4]] = true;
+	input.keys[fires[(unsigned int)(seconds * 2.0f) % 4]] = true;
+}
+
+struct SoakResult {
+	SoakStats stats;
+	XMFLOAT3 playerPosition;
+	size_t entities;
+	unsigned int ticks;
+	double ms;
+};
+
+static SoakResult RunSoak(unsigned int frames, float frameTime)
+{
+	PlatformHeadless platform(frames, frameTime);
+	platform.SetInputScript([frameTime](unsigned int frame, InputSnapshot& input) { ScriptInput(frame * frameTime, input); });
+
+	Soak soak;
+	FrameLoop loop;
+	BenchmarkTimer timer;
+	loop.Run(platform,
+		[&soak](float deltaTime, float totalTime) { soak.Update(deltaTime, totalTime); },
+		[](float, float) {});
+	SoakResult result = { soak.stats, soak.GetPlayerPosition(), soak.GetEntityCount(), loop.GetTickCount(), timer.ElapsedMs() };
+	return result;
+}
+
+int main()
+{
+	printf("%u s headless soak of %u enemies, a scripted player and its projectiles, reloading every %u ticks\n",
+		SOAK_BENCH_SECONDS, SOAK_BENCH_ENEMIES, SOAK_BENCH_RELOAD_TICKS);
+	printf("%10s %8s %10s %10s %8s %8s %8s %8s %9s %6s\n",
+		"frame ms", "ticks", "ms/tick", "entities", "shots", "hits", "kills", "bumps", "late", "same");
+
+	// Reference run, a frame a tick
+	const unsigned int ticks = (unsigned int)(SOAK_BENCH_SECONDS * FRAME_LOOP_DEFAULT_TICK_RATE);
+	SoakResult reference = RunSoak(ticks, 1.0f / FRAME_LOOP_DEFAULT_TICK_RATE);
+
+	// A whole number of ticks a frame, up to the max substeps
+	bool isSame = true;
+	unsigned int ticksPerFrame[] = { 1, 2, 4 };
+	for (unsigned int perFrame : ticksPerFrame) {
+		float frameTime = perFrame * (1.0f / FRAME_LOOP_DEFAULT_TICK_RATE);
+		SoakResult result = RunSoak(ticks / perFrame, frameTime);
+
+		// The same ticks of the same input, and nothing told after it was gone
+		bool isSameHere = result.ticks == ticks && result.stats == reference.stats && result.stats.lateCallbacks == 0
+			&& result.entities == reference.entities && result.playerPosition.x == reference.playerPosition.x
+			&& result.playerPosition.y == reference.playerPosition.y;
+		isSame = isSame && isSameHere;
+		printf("%10.2f %8u %10.3f %10u %8u %8u %8u %8u %9u %6s\n", frameTime * 1000.0f, result.ticks, result.ms / result.ticks,
+			static_cast<unsigned int>(result.entities), result.stats.shots, result.stats.hits, result.stats.kills,
+			result.stats.playerHits, result.stats.lateCallbacks, isSameHere ? "yes" : "NO");
+		fflush(stdout);
+	}
+
+	return isSame ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// Fires projectiles the size and speed of the game's at small oriented boxes
+// and counts how many are caught by testing only where the projectile is at
+// each update, against sweeping it between updates, at falling tick rates.
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "SweptCollision.h"
+
+#define SWEEP_BENCH_SHOTS 20000
+#define SWEEP_BENCH_RADIUS 0.075f
+#define SWEEP_BENCH_SPEED 5.0f
+#define SWEEP_BENCH_RANGE 3.0f
+
+struct SweepTarget
+{
+	XMFLOAT3 center;
+	XMFLOAT3 halfExtents;
+	XMFLOAT4X4 rotation;
+};
+
+struct SweepShot
+{
+	XMFLOAT3 start;
+	XMFLOAT3 direction;
+	float phase;	// Fraction of an update already travelled when the shot is fired
+	unsigned int target;
+};
+
+int main()
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> half(0.05f, 0.125f);
+	std::uniform_real_distribution<float> fraction(0.0f, 1.0f);
+
+	// Enemy sized boxes, rotated about z like the game's enemies
+	std::vector<SweepTarget> targets(64);
+	for (auto& target : targets) {
+		float h = half(rng);
+		target.center = XMFLOAT3(unit(rng) * 3, unit(rng) * 3, 0);
+		target.halfExtents = XMFLOAT3(h, h, h);
+		XMStoreFloat4x4(&target.rotation, XMMatrixRotationQuaternion(XMQuaternionRotationAxis(XMVectorSet(0, 0, 1, 0), unit(rng) * XM_PI)));
+	}
+
+	// Shots aimed somewhere across each target's face
+	std::vector<SweepShot> shots(SWEEP_BENCH_SHOTS);
+	for (auto& shot : shots) {
+		shot.target = rng() % targets.size();
+		const SweepTarget& target = targets[shot.target];
+		XMVECTOR aim = XMLoadFloat3(&target.center) + XMVectorSet(unit(rng), unit(rng), 0, 0) * target.halfExtents.x;
+		XMVECTOR direction = XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), 0, 0));
+		XMStoreFloat3(&shot.start, aim - direction * SWEEP_BENCH_RANGE);
+		XMStoreFloat3(&shot.direction, direction);
+		shot.phase = fraction(rng);
+	}
+
+	// Ground truth, a sweep over the whole flight
+	unsigned int reachable = 0;
+	std::vector<unsigned char> isReachable(shots.size());
+	for (size_t i = 0; i < shots.size(); i++) {
+		const SweepShot& shot = shots[i];
+		const SweepTarget& target = targets[shot.target];
+		XMFLOAT3 end;
+		XMStoreFloat3(&end, XMLoadFloat3(&shot.start) + XMLoadFloat3(&shot.direction) * SWEEP_BENCH_RANGE * 2);
+		isReachable[i] = SweepSphereVsOBB(shot.start, end, SWEEP_BENCH_RADIUS, target.center, target.halfExtents, target.rotation).isHit;
+		reachable += isReachable[i];
+	}
+
+	printf("%u shots, %u pass through their target, radius %.3f speed %.1f\n", SWEEP_BENCH_SHOTS, reachable, SWEEP_BENCH_RADIUS, SWEEP_BENCH_SPEED);
+	printf("%8s %10s %12s %12s %12s\n", "ticks/s", "step", "discrete", "swept", "ns/sweep");
+
+	const float tickRates[] = { 120, 60, 30, 20, 15, 10, 5 };
+	for (float tickRate : tickRates) {
+		float step = SWEEP_BENCH_SPEED / tickRate;
+		unsigned int discreteHits = 0, sweptHits = 0, sweeps = 0;
+
+		BenchmarkTimer timer;
+		for (size_t i = 0; i < shots.size(); i++) {
+			const SweepShot& shot = shots[i];
+			const SweepTarget& target = targets[shot.target];
+			XMVECTOR start = XMLoadFloat3(&shot.start);
+			XMVECTOR direction = XMLoadFloat3(&shot.direction);
+
+			bool isDiscreteHit = false, isSweptHit = false;
+			for (float travelled = shot.phase * step; travelled - step < SWEEP_BENCH_RANGE * 2; travelled += step) {
+				XMFLOAT3 from, to;
+				XMStoreFloat3(&from, start + direction * (travelled - step));
+				XMStoreFloat3(&to, start + direction * travelled);
+
+				// A sweep that does not move is the discrete test
+				isDiscreteHit = isDiscreteHit || SweepSphereVsOBB(to, to, SWEEP_BENCH_RADIUS, target.center, target.halfExtents, target.rotation).isHit;
+				isSweptHit = isSweptHit || SweepSphereVsOBB(from, to, SWEEP_BENCH_RADIUS, target.center, target.halfExtents, target.rotation).isHit;
+				sweeps++;
+			}
+			discreteHits += isDiscreteHit;
+			sweptHits += isSweptHit && isReachable[i];
+		}
+		double ns = timer.ElapsedMs() * 1e6 / (2.0 * sweeps);
+
+		printf("%8.0f %10.3f %11.1f%% %11.1f%% %12.1f\n", tickRate, step,
+			100.0 * discreteHits / reachable, 100.0 * sweptHits / reachable, ns);
+		fflush(stdout);
+		if (sweptHits != reachable) return 1;
+	}
+	return 0;
+}
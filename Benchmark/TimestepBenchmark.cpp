@@ -0,0 +1,184 @@
+// Runs the same seconds of enemy movement at several display rates, once as
+// DXWindow::Run used to, stepping the simulation once a frame by the
+// frame's time, and once with its fixed timestep accumulator, stepping in
+// ticks of the same length and drawing with the last two ticks blended.
+// With the variable step, where an enemy ends up depends on the frame rate
+// and every frame pays for a step. With the fixed step every display rate
+// must end on exactly the same transforms, and only the interpolated matrices
+// are paid for per frame.
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "EntityStore.h"
+#include "EntitySystems.h"
+#include "Transform.h"
+
+#define TIMESTEP_BENCH_ENTITIES 10000
+#define TIMESTEP_BENCH_SECONDS 5.0
+#define TIMESTEP_BENCH_TICK_RATE 60.0f
+#define TIMESTEP_BENCH_MAX_SUBSTEPS 5
+
+// Enemies chasing the target, all drawn
+static void CreateEntities(EntityStore& store, std::vector<Transform>& transforms, const Transform& target)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> axis(-50.0f, 50.0f);
+
+	for (unsigned int i = 0; i < transforms.size(); i++) {
+		transforms[i].SetPosition(position(rng), position(rng), 0.0f);
+		unsigned int id = store.Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY)
+			| COMPONENT_BIT(COMPONENT_SEEK) | COMPONENT_BIT(COMPONENT_SPIN), &transforms[i]);
+		store.GetVelocity(id)->speed = 0.5f + unit(rng);
+		store.GetSeek(id)->target = target.GetPosition();
+		store.GetSpin(id)->axis = XMFLOAT3(axis(rng), axis(rng), axis(rng));
+	}
+}
+
+// What Game::Update runs each step: the player, then the entities
+static void Step(EntityStore& store, Transform& target, float deltaTime, float totalTime)
+{
+	target.SetPosition(cosf(totalTime) * 5.0f, sinf(totalTime) * 5.0f, 0.0f);
+	UpdateSeek(store);
+	UpdateMovement(store, deltaTime);
+	UpdateSpin(store, totalTime);
+	WriteTransforms(store);
+}
+
+// What Renderer::Render reads of each entity
+static void Draw(std::vector<Transform>& transforms, float alpha)
+{
+	XMFLOAT4X4 world, inverseTransposeWorld;
+	for (Transform& transform : transforms)
+		transform.GetInterpolatedWorldMatrices(alpha, world, inverseTransposeWorld);
+}
+
+struct RunResult {
+	std::vector<XMFLOAT3> positions;
+	unsigned int steps;
+	double stepMs;
+	double drawMs;
+};
+
+// A display rate of zero has frames of 5 to 40 ms at random
+static double FrameTime(double displayRate, std::mt19937& rng)
+{
+	if (displayRate > 0)
+		return 1.0 / displayRate;
+	return std::uniform_real_distribution<double>(0.005, 0.040)(rng);
+}
+
+static RunResult RunVariable(double displayRate)
+{
+	EntityStore store;
+	Transform target;
+	std::vector<Transform> transforms(TIMESTEP_BENCH_ENTITIES);
+	CreateEntities(store, transforms, target);
+	std::mt19937 rng(7);
+
+	RunResult result = { {}, 0, 0, 0 };
+	double totalTime = 0;
+	while (totalTime < TIMESTEP_BENCH_SECONDS) {
+		float deltaTime = (float)FrameTime(displayRate, rng);
+		totalTime += deltaTime;
+
+		BenchmarkTimer timer;
+		Step(store, target, deltaTime, (float)totalTime);
+		result.stepMs += timer.ElapsedMs();
+		result.steps++;
+
+		timer.Reset();
+		Draw(transforms, 1.0f);
+		result.drawMs += timer.ElapsedMs();
+	}
+
+	for (Transform& transform : transforms)
+		result.positions.push_back(*transform.GetPosition());
+	return result;
+}
+
+// As FrameLoop::RunFrame, with the snapshot EntityFactory::UpdateEntities takes
+static RunResult RunFixed(double displayRate)
+{
+	EntityStore store;
+	Transform target;
+	std::vector<Transform> transforms(TIMESTEP_BENCH_ENTITIES);
+	CreateEntities(store, transforms, target);
+	std::mt19937 rng(7);
+
+	// Run until the same number of ticks, the last frame may not use all of its time
+	const float tickDelta = 1.0f / TIMESTEP_BENCH_TICK_RATE;
+	const unsigned int ticks = (unsigned int)(TIMESTEP_BENCH_SECONDS * TIMESTEP_BENCH_TICK_RATE);
+	RunResult result = { {}, 0, 0, 0 };
+	double simulationTime = 0;
+	float accumulator = 0;
+	while (result.steps < ticks) {
+		float deltaTime = (float)FrameTime(displayRate, rng);
+
+		accumulator += deltaTime;
+		if (accumulator > tickDelta * TIMESTEP_BENCH_MAX_SUBSTEPS)
+			accumulator = tickDelta * TIMESTEP_BENCH_MAX_SUBSTEPS;
+
+		BenchmarkTimer timer;
+		while (accumulator >= tickDelta && result.steps < ticks) {
+			for (Transform& transform : transforms)
+				transform.SavePrevious();
+			simulationTime += tickDelta;
+			Step(store, target, tickDelta, (float)simulationTime);
+			accumulator -= tickDelta;
+			result.steps++;
+		}
+		result.stepMs += timer.ElapsedMs();
+
+		timer.Reset();
+		Draw(transforms, accumulator / tickDelta);
+		result.drawMs += timer.ElapsedMs();
+	}
+
+	for (Transform& transform : transforms)
+		result.positions.push_back(*transform.GetPosition());
+	return result;
+}
+
+// Furthest any entity ended from where it did at the reference rate
+static float MaxDistance(const RunResult& a, const RunResult& b)
+{
+	float distance = 0;
+	for (size_t i = 0; i < a.positions.size(); i++) {
+		float dx = a.positions[i].x - b.positions[i].x;
+		float dy = a.positions[i].y - b.positions[i].y;
+		distance = fmaxf(distance, sqrtf(dx * dx + dy * dy));
+	}
+	return distance;
+}
+
+int main()
+{
+	double displayRates[] = { 30, 60, 144, 240, 0 };
+	printf("%.0f s of %u enemies chasing a target, %.0f ticks a second, display rate 0 has 5 to 40 ms frames\n",
+		TIMESTEP_BENCH_SECONDS, TIMESTEP_BENCH_ENTITIES, TIMESTEP_BENCH_TICK_RATE);
+	printf("%8s %10s %12s %12s %12s %10s %12s %12s %12s %6s\n", "display", "var steps", "var step ms", "var draw ms", "var drift",
+		"fix ticks", "fix step ms", "fix draw ms", "fix drift", "same");
+
+	RunResult variableReference = RunVariable(TIMESTEP_BENCH_TICK_RATE);
+	RunResult fixedReference = RunFixed(TIMESTEP_BENCH_TICK_RATE);
+	bool isSame = true;
+	for (double displayRate : displayRates) {
+		RunResult variable = RunVariable(displayRate);
+		RunResult fixed = RunFixed(displayRate);
+
+		// Only the ticks decide where entities end up
+		float fixedDrift = MaxDistance(fixed, fixedReference);
+		bool isSameHere = fixedDrift == 0.0f && fixed.steps == fixedReference.steps;
+		isSame = isSame && isSameHere;
+
+		printf("%8.0f %10u %12.2f %12.2f %12.4f %10u %12.2f %12.2f %12.4f %6s\n", displayRate,
+			variable.steps, variable.stepMs, variable.drawMs, MaxDistance(variable, variableReference),
+			fixed.steps, fixed.stepMs, fixed.drawMs, fixedDrift, isSameHere ? "yes" : "NO");
+	}
+
+	return isSame ? 0 : 1;
+}
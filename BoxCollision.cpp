@@ -0,0 +1,290 @@
+#include "BoxCollision.h"
+#include <cfloat>
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Added to the box rotation terms so near parallel edges do not produce a
+// zero cross product axis that separates everything
+#define BOX_ROTATION_EPSILON 1e-6f
+
+// Cross product axes shorter than this, squared, come from near parallel
+// edges. They still take part in the separation test through the padded
+// rotation terms, but are never picked as the contact normal.
+#define BOX_EDGE_AXIS_EPSILON 1e-6f
+
+// An edge axis has to beat the best face axis by this factor to be picked,
+// so resting boxes keep a steady face normal instead of flickering to an
+// edge one that is deeper by rounding error
+#define BOX_EDGE_TOLERANCE 0.95f
+
+// A quad clipped to the four sides of a face has at most eight corners
+#define BOX_MAX_CLIP_POINTS 8
+
+static inline float Sign(float value) { return value < 0 ? -1.0f : 1.0f; }
+
+static inline float Clamp(float value, float limit)
+{
+	if (value > limit) return limit;
+	if (value < -limit) return -limit;
+	return value;
+}
+
+// --------------------------------------------------------
+// Clips a polygon to the slab -limit <= x[axis] <= limit
+// --------------------------------------------------------
+static int ClipToSlab(const float in[][3], int count, int axis, float limit, float out[][3])
+{
+	int outCount = 0;
+	for (int side = 0; side < 2; side++) {
+		// Clip the previous pass's output on the second side
+		const float(*polygon)[3] = side == 0 ? in : out;
+		int polygonCount = side == 0 ? count : outCount;
+		float sign = side == 0 ? 1.0f : -1.0f;
+		float clipped[BOX_MAX_CLIP_POINTS][3];
+		int clippedCount = 0;
+
+		for (int v = 0; v < polygonCount; v++) {
+			const float* from = polygon[v];
+			const float* to = polygon[(v + 1) % polygonCount];
+			float fromDistance = from[axis] * sign - limit;
+			float toDistance = to[axis] * sign - limit;
+			if (fromDistance <= 0) {
+				for (int k = 0; k < 3; k++) clipped[clippedCount][k] = from[k];
+				clippedCount++;
+			}
+			if ((fromDistance < 0) != (toDistance < 0) && fromDistance != toDistance) {
+				float f = fromDistance / (fromDistance - toDistance);
+				for (int k = 0; k < 3; k++) clipped[clippedCount][k] = from[k] + (to[k] - from[k]) * f;
+				clippedCount++;
+			}
+		}
+
+		for (int v = 0; v < clippedCount; v++)
+			for (int k = 0; k < 3; k++) out[v][k] = clipped[v][k];
+		outCount = clippedCount;
+	}
+	return outCount;
+}
+
+// --------------------------------------------------------
+// Contact point of a face axis, in the reference box's frame.
+// The incident box's face most opposed to the reference face
+// is clipped to the sides of the reference face, and the
+// corners left below it are averaged, each moved halfway back
+// to the reference face. side is which way the reference face
+// points along axis, toward the incident box. The incident
+// box's axes are given in the reference frame.
+// --------------------------------------------------------
+static void FaceContactPoint(const float* refHalf, int axis, float side,
+	const float incCenter[3], const float incAxes[3][3], const float* incHalf, float point[3])
+{
+	// Incident face, its normal pointing back against the reference face's
+	int face = 0;
+	for (int j = 1; j < 3; j++)
+		if (fabsf(incAxes[j][axis]) > fabsf(incAxes[face][axis])) face = j;
+	float faceSign = -Sign(incAxes[face][axis] * side);
+	int j1 = (face + 1) % 3;
+	int j2 = (face + 2) % 3;
+
+	float polygon[BOX_MAX_CLIP_POINTS][3];
+	const float corners[4][2] = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+	for (int v = 0; v < 4; v++) {
+		for (int k = 0; k < 3; k++) {
+			polygon[v][k] = incCenter[k] + incAxes[face][k] * incHalf[face] * faceSign
+				+ incAxes[j1][k] * incHalf[j1] * corners[v][0]
+				+ incAxes[j2][k] * incHalf[j2] * corners[v][1];
+		}
+	}
+
+	int count = 4;
+	for (int k = 0; k < 3 && count > 0; k++) {
+		if (k != axis) count = ClipToSlab(polygon, count, k, refHalf[k], polygon);
+	}
+
+	int kept = 0;
+	point[0] = point[1] = point[2] = 0;
+	for (int v = 0; v < count; v++) {
+		float depth = refHalf[axis] - polygon[v][axis] * side;
+		if (depth < 0) continue;
+		for (int k = 0; k < 3; k++) point[k] += polygon[v][k];
+		point[axis] += side * depth * 0.5f;
+		kept++;
+	}
+
+	if (kept > 0) {
+		for (int k = 0; k < 3; k++) point[k] /= kept;
+		return;
+	}
+
+	// Only rounding keeps the boxes apart, fall back to the incident face's
+	// center dropped onto the reference face
+	for (int k = 0; k < 3; k++) point[k] = Clamp(incCenter[k] + incAxes[face][k] * incHalf[face] * faceSign, refHalf[k]);
+	point[axis] = refHalf[axis] * side;
+}
+
+// --------------------------------------------------------
+// Contact point, in a's frame, for the axis of least
+// penetration. Face axes clip the other box's nearest face
+// to the face of the axis, edge axes take the closest
+// points of the two edges.
+// --------------------------------------------------------
+static void ContactPoint(int axis, const float t[3], const float R[3][3], const float* aHalf, const float* bHalf,
+	const float n[3], float point[3])
+{
+	if (axis < 3) {
+		// Face of a, b's axes in a's frame are the columns of R
+		float bAxes[3][3];
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 3; k++) bAxes[j][k] = R[k][j];
+		FaceContactPoint(aHalf, axis, n[axis], t, bAxes, bHalf, point);
+		return;
+	}
+
+	if (axis < 6) {
+		// Face of b, worked in b's frame where a's axes are the rows of R
+		int j = axis - 3;
+		float aCenter[3];
+		for (int m = 0; m < 3; m++) aCenter[m] = -(t[0] * R[0][m] + t[1] * R[1][m] + t[2] * R[2][m]);
+		float side = -(n[0] * R[0][j] + n[1] * R[1][j] + n[2] * R[2][j]);
+		float bPoint[3];
+		FaceContactPoint(bHalf, j, Sign(side), aCenter, R, aHalf, bPoint);
+		for (int k = 0; k < 3; k++) point[k] = t[k] + R[k][0] * bPoint[0] + R[k][1] * bPoint[1] + R[k][2] * bPoint[2];
+		return;
+	}
+
+	// Edge i of a against edge j of b, each taken on the side facing the other
+	int i = (axis - 6) / 3;
+	int j = (axis - 6) % 3;
+	float pA[3], pB[3];
+	for (int k = 0; k < 3; k++) pA[k] = k == i ? 0.0f : aHalf[k] * Sign(n[k]);
+	for (int k = 0; k < 3; k++) pB[k] = t[k];
+	for (int m = 0; m < 3; m++) {
+		if (m == j) continue;
+		float along = n[0] * R[0][m] + n[1] * R[1][m] + n[2] * R[2][m];
+		for (int k = 0; k < 3; k++) pB[k] -= R[k][m] * bHalf[m] * Sign(along);
+	}
+
+	// Closest points of the two edge lines, a's edge runs along e_i and b's
+	// along column j of R, both unit length
+	float r[3] = { pA[0] - pB[0], pA[1] - pB[1], pA[2] - pB[2] };
+	float b = R[i][j];
+	float c = r[i];
+	float f = R[0][j] * r[0] + R[1][j] * r[1] + R[2][j] * r[2];
+	float s = Clamp((b * f - c) / (1.0f - b * b), aHalf[i]);
+	float u = Clamp(b * s + f, bHalf[j]);
+
+	pA[i] += s;
+	for (int k = 0; k < 3; k++) point[k] = (pA[k] + pB[k] + R[k][j] * u) * 0.5f;
+}
+
+// --------------------------------------------------------
+// Separating axis test of two oriented boxes, with b's axes
+// and center expressed in a's frame so the 15 axes cost a
+// few multiplies each
+// --------------------------------------------------------
+bool OrientedBoxesOverlap(const XMFLOAT3& aCenter, const XMFLOAT3* aAxes, const XMFLOAT3& aHalfExtents,
+	const XMFLOAT3& bCenter, const XMFLOAT3* bAxes, const XMFLOAT3& bHalfExtents, BoxContact* contact)
+{
+	const float* aHalf = &aHalfExtents.x;
+	const float* bHalf = &bHalfExtents.x;
+
+	// Rotation of b relative to a, and its absolute value padded by epsilon
+	float R[3][3], absR[3][3], t[3];
+	XMVECTOR offset = XMLoadFloat3(&bCenter) - XMLoadFloat3(&aCenter);
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR aAxis = XMLoadFloat3(&aAxes[i]);
+		for (int j = 0; j < 3; j++) {
+			R[i][j] = XMVectorGetX(XMVector3Dot(aAxis, XMLoadFloat3(&bAxes[j])));
+			absR[i][j] = fabsf(R[i][j]) + BOX_ROTATION_EPSILON;
+		}
+		t[i] = XMVectorGetX(XMVector3Dot(offset, aAxis));
+	}
+
+	// Least penetration so far, axes numbered a's faces, b's faces, then edges
+	float faceDepth = FLT_MAX, edgeDepth = FLT_MAX;
+	int faceAxis = 0, edgeAxis = -1;
+
+	// a's axes
+	for (int i = 0; i < 3; i++) {
+		float rb = bHalf[0] * absR[i][0] + bHalf[1] * absR[i][1] + bHalf[2] * absR[i][2];
+		float depth = aHalf[i] + rb - fabsf(t[i]);
+		if (depth < 0) return false;
+		if (depth < faceDepth) { faceDepth = depth; faceAxis = i; }
+	}
+
+	// b's axes
+	for (int j = 0; j < 3; j++) {
+		float ra = aHalf[0] * absR[0][j] + aHalf[1] * absR[1][j] + aHalf[2] * absR[2][j];
+		float depth = ra + bHalf[j] - fabsf(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]);
+		if (depth < 0) return false;
+		if (depth < faceDepth) { faceDepth = depth; faceAxis = 3 + j; }
+	}
+
+	// Cross products of a's axis i with b's axis j, which in a's frame is
+	// zero along i and has length sin of the angle between the edges
+	for (int i = 0; i < 3; i++) {
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; j++) {
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+			float ra = aHalf[i1] * absR[i2][j] + aHalf[i2] * absR[i1][j];
+			float rb = bHalf[j1] * absR[i][j2] + bHalf[j2] * absR[i][j1];
+			float depth = ra + rb - fabsf(t[i2] * R[i1][j] - t[i1] * R[i2][j]);
+			if (depth < 0) return false;
+
+			float lengthSq = R[i1][j] * R[i1][j] + R[i2][j] * R[i2][j];
+			if (lengthSq < BOX_EDGE_AXIS_EPSILON) continue;
+			depth /= sqrtf(lengthSq);
+			if (depth < edgeDepth) { edgeDepth = depth; edgeAxis = 6 + i * 3 + j; }
+		}
+	}
+
+	if (!contact) return true;
+
+	// Normal in a's frame, pointing from a to b
+	int axis = faceAxis;
+	float depth = faceDepth;
+	if (edgeAxis >= 0 && edgeDepth < faceDepth * BOX_EDGE_TOLERANCE) {
+		axis = edgeAxis;
+		depth = edgeDepth;
+	}
+
+	float n[3];
+	if (axis < 3) {
+		n[0] = n[1] = n[2] = 0;
+		n[axis] = Sign(t[axis]);
+	}
+	else if (axis < 6) {
+		int j = axis - 3;
+		float sign = Sign(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]);
+		for (int k = 0; k < 3; k++) n[k] = R[k][j] * sign;
+	}
+	else {
+		int i = (axis - 6) / 3;
+		int j = (axis - 6) % 3;
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		float length = sqrtf(R[i1][j] * R[i1][j] + R[i2][j] * R[i2][j]);
+		float sign = Sign(t[i2] * R[i1][j] - t[i1] * R[i2][j]);
+		n[i] = 0;
+		n[i1] = -R[i2][j] / length * sign;
+		n[i2] = R[i1][j] / length * sign;
+	}
+
+	float point[3];
+	ContactPoint(axis, t, R, aHalf, bHalf, n, point);
+
+	// Back out of a's frame
+	XMVECTOR worldNormal = XMVectorZero();
+	XMVECTOR worldPoint = XMLoadFloat3(&aCenter);
+	for (int k = 0; k < 3; k++) {
+		XMVECTOR aAxis = XMLoadFloat3(&aAxes[k]);
+		worldNormal += aAxis * n[k];
+		worldPoint += aAxis * point[k];
+	}
+	contact->depth = depth;
+	XMStoreFloat3(&contact->normal, worldNormal);
+	XMStoreFloat3(&contact->point, worldPoint);
+	return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Contact between two oriented boxes
+struct BoxContact {
+	float depth;		// Overlap along the normal
+	XMFLOAT3 normal;	// Axis of least penetration, pointing from box a to box b
+	XMFLOAT3 point;		// Midway between the two surfaces where they overlap
+};
+
+// Separating axis test of two oriented boxes. Box b is expressed in box a's
+// frame once, after which the 15 axes are a few scalar multiplies each, and
+// cross product axes of near parallel edges are skipped. When the boxes
+// overlap and contact is given, it is filled from the axis of least
+// penetration. Axes are the unit length box axes, as in ColliderWorldState.
+bool OrientedBoxesOverlap(const XMFLOAT3& aCenter, const XMFLOAT3* aAxes, const XMFLOAT3& aHalf,
+	const XMFLOAT3& bCenter, const XMFLOAT3* bAxes, const XMFLOAT3& bHalf, BoxContact* contact = nullptr);
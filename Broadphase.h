@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "CollisionPairCache.h"
+
+using namespace DirectX;
+
+// Broadphase backends the collision manager can be initialized with
+enum class BroadphaseType
+{
+	SPATIAL_HASH,		// Flat hash grid rebuilt every frame
+	SWEEP_AND_PRUNE,	// Sorted endpoint lists updated incrementally
+	AABB_TREE,			// Dynamic bounding volume tree, best for mixed collider sizes
+	HIERARCHICAL_GRID	// Spatial hashes of doubling cell sizes, each collider in the one that fits it
+};
+
+// Finds pairs of colliders whose bounds may overlap.
+// Colliders are identified by their proxy id in the collision manager.
+class Broadphase
+{
+public:
+	virtual ~Broadphase() {}
+
+	virtual void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) = 0;
+	virtual void RemoveProxy(unsigned int id) = 0;
+	virtual void RemoveAllProxies() = 0;	// Stop tracking every proxy at once, all ids can be reused
+	virtual void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) = 0;
+
+	// Add every pair that may overlap as a candidate, duplicates are allowed
+	virtual void FindPairs(CollisionPairCache& pairCache) = 0;
+
+	// Scene queries, answered from the bounds as of the last FindPairs.
+	// Ids are appended to results, duplicates are allowed and layers are not
+	// filtered. Proxies added since the last FindPairs may be missed.
+	//	QueryBox	- every proxy whose bounds overlap the box
+	//	QueryRay	- every proxy whose bounds the segment from origin along
+	//				  the unit length direction, up to maxDistance, crosses
+	virtual void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) = 0;
+	virtual void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) = 0;
+
+	// Layer of a proxy as a single bit, and the bits of every layer it
+	// collides with. FindPairs drops pairs whose layers do not collide before
+	// they reach the pair cache. Proxies never given a layer pair with anything.
+	void SetProxyLayer(unsigned int id, unsigned int layerBit, unsigned int layerMask)
+	{
+		if (id >= proxyLayers.size()) {
+			ProxyLayer everything = { 1, 0xFFFFFFFF };
+			proxyLayers.resize(id + 1, everything);
+		}
+		proxyLayers[id].bit = layerBit;
+		proxyLayers[id].mask = layerMask;
+	}
+
+protected:
+	// Layer filter for a candidate pair
+	bool CanPair(unsigned int a, unsigned int b) const
+	{
+		if (a >= proxyLayers.size() || b >= proxyLayers.size()) return true;
+		const ProxyLayer& layerA = proxyLayers[a];
+		const ProxyLayer& layerB = proxyLayers[b];
+		return (layerA.mask & layerB.bit) != 0 && (layerB.mask & layerA.bit) != 0;
+	}
+
+	// Narrow [tMin, tMax] to the part of the line origin + t * direction
+	// inside a box given by its corners, false when nothing is left
+	static bool ClipSegment(const XMFLOAT3& origin, const XMFLOAT3& direction, const XMFLOAT3& min, const XMFLOAT3& max, float& tMin, float& tMax)
+	{
+		const float* o = &origin.x;
+		const float* d = &direction.x;
+		const float* lo = &min.x;
+		const float* hi = &max.x;
+		for (int axis = 0; axis < 3; axis++) {
+			if (d[axis] == 0.0f) {
+				if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+				continue;
+			}
+			float t1 = (lo[axis] - o[axis]) / d[axis];
+			float t2 = (hi[axis] - o[axis]) / d[axis];
+			if (t1 > t2) { float swap = t1; t1 = t2; t2 = swap; }
+			if (t1 > tMin) tMin = t1;
+			if (t2 < tMax) tMax = t2;
+			if (tMin > tMax) return false;
+		}
+		return true;
+	}
+
+	// Whether the segment from origin along direction up to maxDistance
+	// touches the box
+	static bool SegmentOverlapsBounds(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, const XMFLOAT3& min, const XMFLOAT3& max)
+	{
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		return ClipSegment(origin, direction, min, max, tMin, tMax);
+	}
+
+private:
+	struct ProxyLayer {
+		unsigned int bit;
+		unsigned int mask;
+	};
+	std::vector<ProxyLayer> proxyLayers;	// Indexed by proxy id
+};
@@ -1,4 +1,5 @@
 #include "CameraDebug.h"
+#include "Platform.h"
 #include "MemoryDebug.h"
 
 CameraDebug::CameraDebug()
@@ -13,17 +14,17 @@ CameraDebug::~CameraDebug()
 void CameraDebug::Update(float deltaTime, float totalTime)
 {
 	// Move this camera around
-	if (GetAsyncKeyState('W') & 0x8000)
+	if (Input::IsKeyDown('W'))
 		transform.MoveForward(0.0f, 0.0f, 2.0f * deltaTime);
-	if (GetAsyncKeyState('S') & 0x8000)
+	if (Input::IsKeyDown('S'))
 		transform.MoveForward(0.0f, 0.0f, -2.0f * deltaTime);
-	if (GetAsyncKeyState('D') & 0x8000)
+	if (Input::IsKeyDown('D'))
 		transform.MoveForward(2.0f * deltaTime, 0.0f, 0.0f);
-	if (GetAsyncKeyState('A') & 0x8000)
+	if (Input::IsKeyDown('A'))
 		transform.MoveForward(-2.0f * deltaTime, 0.0f, 0.0f);
-	if (GetAsyncKeyState(' ') & 0x8000)
+	if (Input::IsKeyDown(INPUT_KEY_SPACE))
 		transform.Move(0.0f, 2.0f * deltaTime, 0.0f);
-	if (GetAsyncKeyState('X') & 0x8000)
+	if (Input::IsKeyDown('X'))
 		transform.Move(0.0f, -2.0f * deltaTime, 0.0f);
 
 	CalculateViewMatrix();
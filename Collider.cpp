@@ -1,43 +1,66 @@
 #include "Collider.h"
+#include <cassert>
+#include <cmath>
 #include "Entity.h"
+#include "CollisionManager.h"
 #include "MemoryDebug.h"
 
 Collider::Collider() : 
-	colType(OBB),
 	offset(0.0f, 0.0f, 0.0f),
 	scale(1.0f, 1.0f, 1.0f),
-	rotation(0.0f, 0.0f, 0.0f, 1.0f)
+	rotation(0.0f, 0.0f, 0.0f, 1.0f),
+	colType(OBB)
 {}
 
 Collider::Collider(ColliderType type) :
-	colType(type),
 	offset(0.0f, 0.0f, 0.0f),
 	scale(1.0f, 1.0f, 1.0f),
-	rotation(0.0f, 0.0f, 0.0f, 1.0f)
+	rotation(0.0f, 0.0f, 0.0f, 1.0f),
+	colType(type)
 {}
 
 Collider::Collider(ColliderType type, XMFLOAT3 & offset, XMFLOAT3 & scale, XMFLOAT4 & rotation) :
-	colType(type),
 	offset(offset),
 	scale(scale),
-	rotation(rotation)
+	rotation(rotation),
+	colType(type)
 {}
 
 
 Collider::Collider(ColliderType type, float offset[3], float scale[3], float rotation[4]) :
-	colType(type),
 	offset(offset),
 	scale(scale),
-	rotation(rotation)
+	rotation(rotation),
+	colType(type)
 {}
 
-Collider::Collider(ColliderType type, Mesh * mesh) :
-	colType(type)
+Collider::Collider(ColliderType type, const ConvexHull & meshHull) :
+	rotation(0.0f, 0.0f, 0.0f, 1.0f),
+	colType(type),
+	isMeshFitted(true)
 {
-	// Ensure we're starting out with a mesh
-	assert(mesh != nullptr);
-
 	//calculate offset, scale, and rotation using the mesh data
+	switch (type) {
+	case AABB:
+		offset = meshHull.GetAlignedCenter();
+		scale = meshHull.GetAlignedHalfExtents();
+		break;
+	case SPHERE: {
+		float radius = meshHull.GetSphereRadius();
+		offset = meshHull.GetAlignedCenter();
+		scale = XMFLOAT3(radius, radius, radius);
+		break;
+	}
+	default:
+		//boxes, half volumes and hulls all start from the principal axes box
+		offset = meshHull.GetBoxCenter();
+		scale = meshHull.GetBoxHalfExtents();
+		rotation = meshHull.GetBoxRotation();
+		break;
+	}
+
+	if (type == HULL && !meshHull.IsEmpty())
+		hull = &meshHull;
 }
 
 Collider::~Collider()
@@ -65,7 +88,7 @@ const XMFLOAT3 * const Collider::GetScale() const
 // --------------------------------------------------------
 float const Collider::GetMaxScale() const
 {
-	return max(abs(scale.x), max(abs(scale.y), abs(scale.z)));
+	return fmaxf(fabsf(scale.x), fmaxf(fabsf(scale.y), fabsf(scale.z)));
 }
 
 // --------------------------------------------------------
@@ -99,9 +122,14 @@ XMFLOAT4X4 Collider::GetRotationMatrix() const
 
 XMFLOAT3 const Collider::GetPosition() const
 {
-	//TODO: apply rotation of transform to the offset
+	//the offset is in the entity's space, so it turns and scales with the entity
 	XMVECTOR parentLocation = XMLoadFloat3(parentEntity->transform.GetPosition());
 	XMVECTOR colliderOffset = XMLoadFloat3(&offset);
+	if (isMeshFitted) colliderOffset *= XMLoadFloat3(parentEntity->transform.GetScale());
+
+	XMFLOAT4 entityRotation = GetEntityRotation();
+	XMVECTOR entityQ = XMLoadFloat4(&entityRotation);
+	if (XMVectorGetX(XMVector4LengthSq(entityQ)) != 0) colliderOffset = XMVector3Rotate(colliderOffset, entityQ);
 
 	XMFLOAT3 position;
 	XMStoreFloat3(&position, parentLocation + colliderOffset);
@@ -139,11 +167,76 @@ XMFLOAT4 const Collider::GetRotationColumn(int col) const
 void Collider::SetOffset(XMFLOAT3 offIn)
 {
 	offset = offIn;
+	isWorldStateDirty = true;
 }
 
 void Collider::SetScale(XMFLOAT3 scaleIn)
 {
 	scale = scaleIn;
+	isWorldStateDirty = true;
+}
+
+void Collider::SetIsFastMoving(bool isFastMoving)
+{
+	this->isFastMoving = isFastMoving;
+}
+
+bool Collider::GetIsFastMoving() const
+{
+	return isFastMoving;
+}
+
+void Collider::SetIsStatic(bool isStatic)
+{
+	if (this->isStatic == isStatic) return;
+
+	//static and moving colliders live in different structures
+	if (isStaged) {
+		CollisionManager::Instance()->UnstageCollider(this);
+		this->isStatic = isStatic;
+		CollisionManager::Instance()->StageCollider(this);
+	}
+	else {
+		this->isStatic = isStatic;
+	}
+}
+
+bool Collider::GetIsStatic() const
+{
+	return isStatic;
+}
+
+void Collider::SetIsPlanar(bool isPlanar)
+{
+	if (this->isPlanar == isPlanar) return;
+
+	//planar colliders live in their own grid and are stored as planar shapes
+	if (isStaged) {
+		CollisionManager::Instance()->UnstageCollider(this);
+		this->isPlanar = isPlanar;
+		CollisionManager::Instance()->StageCollider(this);
+	}
+	else {
+		this->isPlanar = isPlanar;
+	}
+}
+
+bool Collider::GetIsPlanar() const
+{
+	return isPlanar;
+}
+
+void Collider::SetLayer(unsigned int layer)
+{
+	assert(layer < COLLISION_LAYER_COUNT);
+	this->layer = layer;
+	//sleeping colliders are only looked at again once they wake
+	isWorldStateDirty = true;
+}
+
+unsigned int Collider::GetLayer() const
+{
+	return layer;
 }
 
 void Collider::SetParentEntity(Entity * parent)
@@ -162,6 +255,59 @@ const Entity * const Collider::GetBaseEntity() const
 	return parentEntity;
 }
 
+unsigned int Collider::GetProxyId() const
+{
+	return proxyId;
+}
+
+const ConvexHull * Collider::GetConvexHull() const
+{
+	return hull;
+}
+
+const ColliderWorldState & Collider::GetWorldState() const
+{
+	return worldState;
+}
+
+bool Collider::UpdateWorldState()
+{
+	Transform& transform = parentEntity->transform;
+	if (!isWorldStateDirty && !(transform.IsDirty() & IS_DIRTY_COL)) return false;
+
+	//fitted colliders are sized for the mesh, scale them with it
+	XMFLOAT3 halfExtents = scale;
+	XMVECTOR entityScale = XMLoadFloat3(transform.GetScale());
+	if (isMeshFitted) XMStoreFloat3(&halfExtents, XMLoadFloat3(&scale) * entityScale);
+
+	//only oriented shapes follow the entity's rotation
+	XMFLOAT4 worldRotation(0.0f, 0.0f, 0.0f, 1.0f);
+	if (colType == OBB || colType == HALFVOL || colType == HULL) {
+		//a zero quaternion is the default for no rotation on top of the entity's,
+		//the collider's own rotation is in the entity's space so it goes first
+		XMFLOAT4 entityRotation = GetEntityRotation();
+		XMVECTOR colliderQ = XMLoadFloat4(&rotation);
+		if (XMVectorGetX(XMVector4LengthSq(colliderQ)) == 0) colliderQ = XMQuaternionIdentity();
+		XMStoreFloat4(&worldRotation, XMQuaternionMultiply(colliderQ, XMLoadFloat4(&entityRotation)));
+
+		//a box turned inside the mesh is stretched along its own axes by the
+		//entity's scale, each by the length of that axis once scaled
+		if (isMeshFitted) {
+			float* halfAxes = &halfExtents.x;
+			const float* fittedAxes = &scale.x;
+			for (int i = 0; i < 3; i++) {
+				XMVECTOR axis = XMVector3Rotate(XMVectorSet(i == 0 ? 1.0f : 0.0f, i == 1 ? 1.0f : 0.0f, i == 2 ? 1.0f : 0.0f, 0), colliderQ);
+				halfAxes[i] = fittedAxes[i] * XMVectorGetX(XMVector3Length(axis * entityScale));
+			}
+		}
+	}
+
+	ComputeColliderWorldState(worldState, GetPosition(), worldRotation, halfExtents, colType == SPHERE);
+	isWorldStateDirty = false;
+	transform.ClearDirty(IS_DIRTY_COL);
+	return true;
+}
+
 XMFLOAT4 Collider::GetEntityRotation() const
 {
 	XMFLOAT4 rot = *(parentEntity->transform.GetRotation());
@@ -1,17 +1,20 @@
 #pragma once
 
-#include <d3d11.h>
 #include <DirectXMath.h>
 #include "Transform.h"
-#include "Mesh.h"
+#include "ConvexHull.h"
+#include "ColliderWorldState.h"
+#include "CollisionLayers.h"
 
 class Entity;
 
 class Collider
 {
+	friend class CollisionManager;
+
 public:
-	//types of colliders
-	enum ColliderType { OBB, AABB, SPHERE, HALFVOL };
+	//types of colliders, hulls are the simplified convex hull of a mesh
+	enum ColliderType { OBB, AABB, SPHERE, HALFVOL, HULL };
 
 	//0'd offset and rotation, 1 scale
 	Collider();
@@ -27,9 +30,12 @@ public:
 		float offset[3],
 		float scale[3],
 		float rotation[4]);
-	// Initialize based on mesh size
+	// Initialize based on mesh size, given the mesh's convex hull. Boxes are
+	// fitted along the mesh's principal axes, aligned boxes and spheres around
+	// its bounds, and hulls take the hull itself, which must outlive the
+	// collider. The fit follows the entity's scale the way the mesh does.
 	Collider(ColliderType type,
-		Mesh* mesh);
+		const ConvexHull& meshHull);
 
 	~Collider();
 
@@ -45,11 +51,49 @@ public:
 	void SetOffset(XMFLOAT3 offIn);
 	void SetScale(XMFLOAT3 scaleIn);
 
+	// Fast moving colliders are swept as their bounding sphere from where they
+	// were at the last update, so they cannot pass through thin colliders
+	void SetIsFastMoving(bool isFastMoving);
+	bool GetIsFastMoving() const;
+
+	// Static colliders are for scenery that never moves. They are kept apart
+	// from the moving ones, are never updated and never tested against each
+	// other. Changing this on a staged collider restages it, so whatever it
+	// is touching exits and enters again.
+	void SetIsStatic(bool isStatic);
+	bool GetIsStatic() const;
+
+	// Planar colliders are for gameplay on the z = 0 plane. Moving ones go in
+	// a 2D grid, and pairs of them are tested seen from above, spheres as
+	// circles and boxes as rectangles, ignoring depth. Against colliders that
+	// are not planar they are tested in 3D as usual. Half volumes and hulls ignore it.
+	// Changing this on a staged collider restages it.
+	void SetIsPlanar(bool isPlanar);
+	bool GetIsPlanar() const;
+
+	// Collision layer, below COLLISION_LAYER_COUNT. Which layers touch is set
+	// on the collision manager. Changing it wakes the collider.
+	void SetLayer(unsigned int layer);
+	unsigned int GetLayer() const;
+
 	//Part of all components
 	void SetParentEntity(Entity* parent);
 	Entity* const GetParentEntity() const;
 	const Entity* const GetBaseEntity() const;	//same as GetParentEntity unless heirarchy of entities is implemented
 
+	// Id of this collider in the collision manager, only valid while staged
+	unsigned int GetProxyId() const;
+
+	// Hull of the mesh a hull collider was fitted to, null for other colliders
+	const ConvexHull* GetConvexHull() const;
+
+	// World space shape as of the last UpdateWorldState
+	const ColliderWorldState& GetWorldState() const;
+
+	// Recompute the world state if the collider or its entity's transform
+	// changed since the last call, returns whether it did
+	bool UpdateWorldState();
+
 private:
 	XMFLOAT3 offset; // vec3
 	XMFLOAT3 scale; // vec3
@@ -57,6 +101,17 @@ private:
 
 	ColliderType colType;
 	Entity* parentEntity;
+	unsigned int proxyId = 0;
+	bool isFastMoving = false;
+	bool isStatic = false;
+	bool isPlanar = false;
+	bool isStaged = false;
+	unsigned int layer = LAYER_DEFAULT;
+	bool isMeshFitted = false;	// Offset and scale are in the mesh's space
+	const ConvexHull* hull = nullptr;
+
+	ColliderWorldState worldState;
+	bool isWorldStateDirty = true;
 
 	XMFLOAT4 GetEntityRotation() const;
 };
@@ -0,0 +1,88 @@
+#include "ColliderStore.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+ColliderStore::ColliderStore()
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+ColliderStore::~ColliderStore()
+{
+}
+
+// --------------------------------------------------------
+// Grow every array so ids below count can be set, arrays
+// never shrink so ids can be reused without reallocating
+// --------------------------------------------------------
+void ColliderStore::Resize(unsigned int count)
+{
+	if (count <= positions.size())
+		return;
+
+	positions.resize(count, XMFLOAT4(0, 0, 0, 0));
+	halfExtents.resize(count, XMFLOAT4(0, 0, 0, 0));
+	for (unsigned int id = static_cast<unsigned int>(axes.size() / 3); id < count; id++) {
+		axes.push_back(XMFLOAT3(1, 0, 0));
+		axes.push_back(XMFLOAT3(0, 1, 0));
+		axes.push_back(XMFLOAT3(0, 0, 1));
+	}
+	planarRects.resize(count, XMFLOAT4(1, 0, 0, 0));
+	hullVertices.resize(count, nullptr);
+	hullVertexCounts.resize(count, 0);
+	type.resize(count, 0);
+	layer.resize(count, 0);
+	owner.resize(count, nullptr);
+}
+
+// --------------------------------------------------------
+// Copy the current state of one collider into the arrays
+// --------------------------------------------------------
+void ColliderStore::Set(unsigned int id, const XMFLOAT3& position, const XMFLOAT3& halfExtents, float radius, unsigned char type, unsigned int layer, const void* owner)
+{
+	positions[id] = XMFLOAT4(position.x, position.y, position.z, radius);
+	this->halfExtents[id] = XMFLOAT4(halfExtents.x, halfExtents.y, halfExtents.z, 0.0f);
+	this->type[id] = type;
+	this->layer[id] = layer;
+	this->owner[id] = owner;
+}
+
+// --------------------------------------------------------
+// Copy the box axes of one collider, as found in its world
+// state
+// --------------------------------------------------------
+void ColliderStore::SetAxes(unsigned int id, const XMFLOAT3* boxAxes)
+{
+	axes[id * 3] = boxAxes[0];
+	axes[id * 3 + 1] = boxAxes[1];
+	axes[id * 3 + 2] = boxAxes[2];
+}
+
+// --------------------------------------------------------
+// Copy the rectangle of one oriented planar collider
+// --------------------------------------------------------
+void ColliderStore::SetPlanarRect(unsigned int id, const XMFLOAT2& axis, const XMFLOAT2& halfWidths)
+{
+	planarRects[id] = XMFLOAT4(axis.x, axis.y, halfWidths.x, halfWidths.y);
+}
+
+// --------------------------------------------------------
+// Point one hull collider at its hull's vertices
+// --------------------------------------------------------
+void ColliderStore::SetHull(unsigned int id, const XMFLOAT3* vertices, unsigned int vertexCount)
+{
+	hullVertices[id] = vertices;
+	hullVertexCounts[id] = vertexCount;
+}
+
+// --------------------------------------------------------
+// Number of ids the arrays have room for
+// --------------------------------------------------------
+unsigned int ColliderStore::GetCount() const
+{
+	return static_cast<unsigned int>(positions.size());
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Shape of a stored collider. The first five are the same values as
+// Collider::ColliderType, the planar shapes are the circle, axis aligned
+// rectangle and oriented rectangle planar colliders are tested as.
+enum ColliderShape { SHAPE_OBB, SHAPE_AABB, SHAPE_SPHERE, SHAPE_HALFVOL, SHAPE_HULL, SHAPE_CIRCLE, SHAPE_RECT, SHAPE_ORECT, SHAPE_COUNT };
+
+// Structure of arrays copy of every staged collider, indexed by proxy id.
+// The collision manager refreshes it once per frame, after which the
+// narrowphase kernels read positions and sizes straight from these arrays
+// instead of going through Collider and its parent Transform.
+// Positions and half extents are padded to four floats so a kernel lane can
+// fetch either with a single 16 byte load.
+class ColliderStore
+{
+public:
+	ColliderStore();
+	~ColliderStore();
+
+	// Make room for proxy ids below count
+	void Resize(unsigned int count);
+
+	// Refresh one collider
+	//	type	- ColliderShape
+	//	owner	- base entity, colliders with the same owner never collide
+	void Set(unsigned int id, const XMFLOAT3& position, const XMFLOAT3& halfExtents, float radius, unsigned char type, unsigned int layer, const void* owner);
+
+	// Refresh the three box axes of one collider, the world axes until set
+	void SetAxes(unsigned int id, const XMFLOAT3* boxAxes);
+
+	// Refresh the rectangle an oriented planar collider is tested as
+	void SetPlanarRect(unsigned int id, const XMFLOAT2& axis, const XMFLOAT2& halfWidths);
+
+	// Refresh the hull of a hull collider, its vertices in the box frame
+	// scaled to the box as kept by ConvexHull. The vertices are not copied.
+	void SetHull(unsigned int id, const XMFLOAT3* vertices, unsigned int vertexCount);
+
+	unsigned int GetCount() const;
+
+	std::vector<XMFLOAT4> positions;		// World space center, sphere radius in w
+	std::vector<XMFLOAT4> halfExtents;	// Box half extents, w unused
+	std::vector<XMFLOAT3> axes;			// Box axes, axes[id * 3 + i] for axis i
+	std::vector<XMFLOAT4> planarRects;	// Oriented rectangle, first axis in xy and half widths in zw
+	std::vector<const XMFLOAT3*> hullVertices;	// Hull colliders only
+	std::vector<unsigned int> hullVertexCounts;
+
+	std::vector<unsigned char> type;
+	std::vector<unsigned int> layer;
+	std::vector<const void*> owner;
+};
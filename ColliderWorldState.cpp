@@ -0,0 +1,51 @@
+#include "ColliderWorldState.h"
+#include <cmath>
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Fill a state from a center, rotation quaternion and half
+// extents
+// --------------------------------------------------------
+void ComputeColliderWorldState(ColliderWorldState & state, const XMFLOAT3 & center, const XMFLOAT4 & rotation, const XMFLOAT3 & halfExtents, bool isSphere)
+{
+	XMVECTOR rotationQ = XMLoadFloat4(&rotation);
+	XMVECTOR half = XMVectorAbs(XMLoadFloat3(&halfExtents));
+
+	state.center = center;
+	state.halfExtents = halfExtents;
+
+	// Box axes are the rotated world axes, the bounding box is every axis
+	// pushed out by its half extent
+	const float* halfAxes = &halfExtents.x;
+	XMVECTOR bounds = XMVectorZero();
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR axis = XMVector3Rotate(XMVectorSet(i == 0 ? 1.0f : 0.0f, i == 1 ? 1.0f : 0.0f, i == 2 ? 1.0f : 0.0f, 0), rotationQ);
+		XMStoreFloat3(&state.axes[i], axis);
+		bounds += XMVectorAbs(axis) * fabsf(halfAxes[i]);
+	}
+
+	if (isSphere) {
+		XMFLOAT3 h;
+		XMStoreFloat3(&h, half);
+		float largest = h.x > h.y ? h.x : h.y;
+		state.radius = largest > h.z ? largest : h.z;
+		XMStoreFloat3(&state.boundsExtents, XMVectorReplicate(state.radius));
+	}
+	else {
+		state.radius = XMVectorGetX(XMVector3Length(half));
+		XMStoreFloat3(&state.boundsExtents, bounds);
+	}
+}
+
+// --------------------------------------------------------
+// Rotation matrix with the box axes as its rows
+// --------------------------------------------------------
+XMFLOAT4X4 GetColliderWorldRotation(const ColliderWorldState & state)
+{
+	const XMFLOAT3* axes = state.axes;
+	return XMFLOAT4X4(
+		axes[0].x, axes[0].y, axes[0].z, 0,
+		axes[1].x, axes[1].y, axes[1].z, 0,
+		axes[2].x, axes[2].y, axes[2].z, 0,
+		0, 0, 0, 1);
+}
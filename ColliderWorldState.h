@@ -0,0 +1,22 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// World space shape of a collider. Computed once per update, when the collider
+// or its entity's transform changed, so the collision tests read plain vectors
+// instead of rebuilding rotation matrices for every axis they test.
+struct ColliderWorldState {
+	XMFLOAT3 center;
+	XMFLOAT3 axes[3];		// Orthonormal box axes, the world axes for unrotated shapes
+	XMFLOAT3 halfExtents;	// Along the box axes
+	XMFLOAT3 boundsExtents;	// Half extents of the world space bounding box
+	float radius;			// Bounding sphere radius, the radius itself for spheres
+};
+
+// Fill a state from a center, rotation quaternion and half extents. Spheres
+// take their largest half extent as the radius.
+void ComputeColliderWorldState(ColliderWorldState& state, const XMFLOAT3& center, const XMFLOAT4& rotation, const XMFLOAT3& halfExtents, bool isSphere);
+
+// Rotation matrix taking box space to world space
+XMFLOAT4X4 GetColliderWorldRotation(const ColliderWorldState& state);
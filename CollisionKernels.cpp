@@ -0,0 +1,215 @@
+#include <cmath>
+#include "CollisionKernels.h"
+
+// Pick the widest instruction set the build targets
+#if defined(__AVX2__)
+#define COLLISION_KERNELS_AVX2
+#include <immintrin.h>
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define COLLISION_KERNELS_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Single pair tests, used on targets without SIMD and for
+// the pairs left over after the last full batch
+// --------------------------------------------------------
+static inline float ClampToExtent(float value, float extent)
+{
+	return value < -extent ? -extent : (value > extent ? extent : value);
+}
+
+static inline bool SphereVsAABB(const ColliderStore& store, unsigned int sphere, unsigned int box)
+{
+	// Offset from the box center to the sphere, minus the nearest point on the box
+	const XMFLOAT4& ps = store.positions[sphere];
+	const XMFLOAT4& pb = store.positions[box];
+	const XMFLOAT4& hb = store.halfExtents[box];
+	float dx = ps.x - pb.x;
+	float dy = ps.y - pb.y;
+	float dz = ps.z - pb.z;
+	float ex = dx - ClampToExtent(dx, hb.x);
+	float ey = dy - ClampToExtent(dy, hb.y);
+	float ez = dz - ClampToExtent(dz, hb.z);
+	return ex * ex + ey * ey + ez * ez <= ps.w * ps.w;
+}
+
+static inline bool AABBVsAABB(const ColliderStore& store, unsigned int a, unsigned int b)
+{
+	const XMFLOAT4& pa = store.positions[a];
+	const XMFLOAT4& pb = store.positions[b];
+	const XMFLOAT4& ha = store.halfExtents[a];
+	const XMFLOAT4& hb = store.halfExtents[b];
+	return fabsf(pa.x - pb.x) <= ha.x + hb.x
+		&& fabsf(pa.y - pb.y) <= ha.y + hb.y
+		&& fabsf(pa.z - pb.z) <= ha.z + hb.z;
+}
+
+// Each lane of a KernelFloat holds one pair. Rows of the store are fetched
+// with one load per collider and transposed so x, y, z and w each fill a
+// register.
+#if defined(COLLISION_KERNELS_AVX2)
+
+#define KERNEL_LANES 8
+
+typedef __m256 KernelFloat;
+
+// --------------------------------------------------------
+// Load the rows of 8 colliders as x, y, z and w registers.
+// Rows 0-3 fill the low half and 4-7 the high half, then
+// both halves are transposed in place.
+// --------------------------------------------------------
+static inline void LoadRows(const XMFLOAT4* rows, const unsigned int* ids, KernelFloat& x, KernelFloat& y, KernelFloat& z, KernelFloat& w)
+{
+	__m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&rows[ids[0]].x)), _mm_loadu_ps(&rows[ids[4]].x), 1);
+	__m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&rows[ids[1]].x)), _mm_loadu_ps(&rows[ids[5]].x), 1);
+	__m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&rows[ids[2]].x)), _mm_loadu_ps(&rows[ids[6]].x), 1);
+	__m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&rows[ids[3]].x)), _mm_loadu_ps(&rows[ids[7]].x), 1);
+
+	__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	__m256 t1 = _mm256_unpackhi_ps(r0, r1);
+	__m256 t2 = _mm256_unpacklo_ps(r2, r3);
+	__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static inline KernelFloat Add(KernelFloat x, KernelFloat y) { return _mm256_add_ps(x, y); }
+static inline KernelFloat Sub(KernelFloat x, KernelFloat y) { return _mm256_sub_ps(x, y); }
+static inline KernelFloat Mul(KernelFloat x, KernelFloat y) { return _mm256_mul_ps(x, y); }
+static inline KernelFloat Min(KernelFloat x, KernelFloat y) { return _mm256_min_ps(x, y); }
+static inline KernelFloat Max(KernelFloat x, KernelFloat y) { return _mm256_max_ps(x, y); }
+static inline KernelFloat And(KernelFloat x, KernelFloat y) { return _mm256_and_ps(x, y); }
+static inline KernelFloat Negate(KernelFloat x) { return _mm256_xor_ps(x, _mm256_set1_ps(-0.0f)); }
+static inline KernelFloat Abs(KernelFloat x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+static inline KernelFloat LessEqual(KernelFloat x, KernelFloat y) { return _mm256_cmp_ps(x, y, _CMP_LE_OQ); }
+static inline int MoveMask(KernelFloat x) { return _mm256_movemask_ps(x); }
+
+#elif defined(COLLISION_KERNELS_SSE)
+
+#define KERNEL_LANES 4
+
+typedef __m128 KernelFloat;
+
+// --------------------------------------------------------
+// Load the rows of 4 colliders as x, y, z and w registers
+// --------------------------------------------------------
+static inline void LoadRows(const XMFLOAT4* rows, const unsigned int* ids, KernelFloat& x, KernelFloat& y, KernelFloat& z, KernelFloat& w)
+{
+	x = _mm_loadu_ps(&rows[ids[0]].x);
+	y = _mm_loadu_ps(&rows[ids[1]].x);
+	z = _mm_loadu_ps(&rows[ids[2]].x);
+	w = _mm_loadu_ps(&rows[ids[3]].x);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+}
+
+static inline KernelFloat Add(KernelFloat x, KernelFloat y) { return _mm_add_ps(x, y); }
+static inline KernelFloat Sub(KernelFloat x, KernelFloat y) { return _mm_sub_ps(x, y); }
+static inline KernelFloat Mul(KernelFloat x, KernelFloat y) { return _mm_mul_ps(x, y); }
+static inline KernelFloat Min(KernelFloat x, KernelFloat y) { return _mm_min_ps(x, y); }
+static inline KernelFloat Max(KernelFloat x, KernelFloat y) { return _mm_max_ps(x, y); }
+static inline KernelFloat And(KernelFloat x, KernelFloat y) { return _mm_and_ps(x, y); }
+static inline KernelFloat Negate(KernelFloat x) { return _mm_xor_ps(x, _mm_set1_ps(-0.0f)); }
+static inline KernelFloat Abs(KernelFloat x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+static inline KernelFloat LessEqual(KernelFloat x, KernelFloat y) { return _mm_cmple_ps(x, y); }
+static inline int MoveMask(KernelFloat x) { return _mm_movemask_ps(x); }
+
+#endif
+
+#ifdef KERNEL_LANES
+
+// --------------------------------------------------------
+// Expand a lane mask into one hit byte per pair
+// --------------------------------------------------------
+static inline void StoreHits(int mask, unsigned char* hits)
+{
+	for (int lane = 0; lane < KERNEL_LANES; lane++)
+		hits[lane] = static_cast<unsigned char>((mask >> lane) & 1);
+}
+
+#endif
+
+// --------------------------------------------------------
+// Sphere against box, clamps the sphere center to the box
+// and compares the distance to the clamped point with the
+// sphere radius
+// --------------------------------------------------------
+void BatchSphereVsAABB(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits)
+{
+	unsigned int i = 0;
+
+#ifdef KERNEL_LANES
+	const XMFLOAT4* positions = store.positions.data();
+	const XMFLOAT4* halfExtents = store.halfExtents.data();
+
+	for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+		KernelFloat ax, ay, az, ar, bx, by, bz, unused, ex, ey, ez;
+		LoadRows(positions, a + i, ax, ay, az, ar);
+		LoadRows(positions, b + i, bx, by, bz, unused);
+		LoadRows(halfExtents, b + i, ex, ey, ez, unused);
+
+		// Distance outside the box on each axis
+		KernelFloat dx = Sub(ax, bx);
+		KernelFloat dy = Sub(ay, by);
+		KernelFloat dz = Sub(az, bz);
+		dx = Sub(dx, Min(Max(dx, Negate(ex)), ex));
+		dy = Sub(dy, Min(Max(dy, Negate(ey)), ey));
+		dz = Sub(dz, Min(Max(dz, Negate(ez)), ez));
+
+		KernelFloat distanceSq = Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz));
+		StoreHits(MoveMask(LessEqual(distanceSq, Mul(ar, ar))), hits + i);
+	}
+#endif
+
+	for (; i < count; i++)
+		hits[i] = SphereVsAABB(store, a[i], b[i]);
+}
+
+// --------------------------------------------------------
+// Box against box, overlapping when the centers are within
+// the summed half extents on every axis
+// --------------------------------------------------------
+void BatchAABBVsAABB(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits)
+{
+	unsigned int i = 0;
+
+#ifdef KERNEL_LANES
+	const XMFLOAT4* positions = store.positions.data();
+	const XMFLOAT4* halfExtents = store.halfExtents.data();
+
+	for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+		KernelFloat ax, ay, az, bx, by, bz, aex, aey, aez, bex, bey, bez, unused;
+		LoadRows(positions, a + i, ax, ay, az, unused);
+		LoadRows(positions, b + i, bx, by, bz, unused);
+		LoadRows(halfExtents, a + i, aex, aey, aez, unused);
+		LoadRows(halfExtents, b + i, bex, bey, bez, unused);
+
+		KernelFloat overlapX = LessEqual(Abs(Sub(ax, bx)), Add(aex, bex));
+		KernelFloat overlapY = LessEqual(Abs(Sub(ay, by)), Add(aey, bey));
+		KernelFloat overlapZ = LessEqual(Abs(Sub(az, bz)), Add(aez, bez));
+		StoreHits(MoveMask(And(And(overlapX, overlapY), overlapZ)), hits + i);
+	}
+#endif
+
+	for (; i < count; i++)
+		hits[i] = AABBVsAABB(store, a[i], b[i]);
+}
+
+// --------------------------------------------------------
+// Name of the instruction set the kernels were built for
+// --------------------------------------------------------
+const char* GetCollisionKernelTarget()
+{
+#if defined(COLLISION_KERNELS_AVX2)
+	return "AVX2";
+#elif defined(COLLISION_KERNELS_SSE)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "ColliderStore.h"
+
+// Batched narrowphase tests over a ColliderStore.
+// Each kernel tests the pairs (a[i], b[i]) for i < count and writes 1 to
+// hits[i] if they overlap, 0 otherwise. Pairs are tested 8 at a time with
+// AVX2, 4 at a time with SSE, and one at a time on other targets. Sphere
+// pairs have no kernel, they are too little work per load to gain from one
+// and the narrowphase tests them in a plain loop.
+
+// a holds spheres, b holds boxes
+void BatchSphereVsAABB(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits);
+
+void BatchAABBVsAABB(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits);
+
+// Name of the instruction set the kernels were built for
+const char* GetCollisionKernelTarget();
@@ -0,0 +1,55 @@
+#include <cassert>
+#include "CollisionLayers.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor, every layer collides with every layer
+// --------------------------------------------------------
+CollisionLayerMatrix::CollisionLayerMatrix()
+{
+	for (unsigned int i = 0; i < COLLISION_LAYER_COUNT; i++)
+		masks[i] = 0xFFFFFFFF;
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+CollisionLayerMatrix::~CollisionLayerMatrix()
+{
+}
+
+// --------------------------------------------------------
+// Set whether two layers collide, both masks are updated
+// so the matrix stays symmetric
+// --------------------------------------------------------
+void CollisionLayerMatrix::SetCollides(unsigned int a, unsigned int b, bool collides)
+{
+	assert(a < COLLISION_LAYER_COUNT && b < COLLISION_LAYER_COUNT);
+
+	if (collides) {
+		masks[a] |= 1u << b;
+		masks[b] |= 1u << a;
+	}
+	else {
+		masks[a] &= ~(1u << b);
+		masks[b] &= ~(1u << a);
+	}
+}
+
+// --------------------------------------------------------
+// True when colliders on the two layers can touch
+// --------------------------------------------------------
+bool CollisionLayerMatrix::Collides(unsigned int a, unsigned int b) const
+{
+	assert(a < COLLISION_LAYER_COUNT && b < COLLISION_LAYER_COUNT);
+	return (masks[a] & (1u << b)) != 0;
+}
+
+// --------------------------------------------------------
+// Bits of every layer the given layer collides with
+// --------------------------------------------------------
+unsigned int CollisionLayerMatrix::GetMask(unsigned int layer) const
+{
+	assert(layer < COLLISION_LAYER_COUNT);
+	return masks[layer];
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Layers a layer matrix can hold, one bit of a mask each
+#define COLLISION_LAYER_COUNT 32
+
+// Layers used by the game's colliders
+enum CollisionLayer {
+	LAYER_DEFAULT,
+	LAYER_STATIC,		// Scenery that never moves
+	LAYER_PLAYER,
+	LAYER_ENEMY,
+	LAYER_PROJECTILE
+};
+
+// Symmetric layer against layer collision matrix, kept as one mask per layer
+// with a bit set for every layer it collides with, so filtering a pair is a
+// single AND. Every layer starts out colliding with every layer.
+class CollisionLayerMatrix
+{
+public:
+	CollisionLayerMatrix();
+	~CollisionLayerMatrix();
+
+	void SetCollides(unsigned int a, unsigned int b, bool collides);
+	bool Collides(unsigned int a, unsigned int b) const;
+
+	// Bits of every layer the given layer collides with
+	unsigned int GetMask(unsigned int layer) const;
+
+private:
+	unsigned int masks[COLLISION_LAYER_COUNT];
+};
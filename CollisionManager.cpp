@@ -1,19 +1,43 @@
+#include <algorithm>
+#include <cassert>
 #include "CollisionManager.h"
+#include "PlanarCollision.h"
+#include "EntityRegistry.h"
 #include "MemoryDebug.h"
 
 using namespace DirectX;
 
+// Updates in a row a moving collider has to go without moving before it
+// sleeps. The first still update settles its bounds and contacts at rest,
+// fast movers' swept bounds and sweep contacts included.
+#define COLLISION_SLEEP_UPDATES 2
+
 // Initialize instance to null
 CollisionManager* CollisionManager::instance = nullptr;
 
+// The collider store keeps collider types as ColliderShape
+static_assert(static_cast<int>(SHAPE_OBB) == Collider::OBB && static_cast<int>(SHAPE_AABB) == Collider::AABB
+	&& static_cast<int>(SHAPE_SPHERE) == Collider::SPHERE && static_cast<int>(SHAPE_HALFVOL) == Collider::HALFVOL
+	&& static_cast<int>(SHAPE_HULL) == Collider::HULL,
+	"ColliderShape must match Collider::ColliderType");
 
-CollisionManager * const CollisionManager::Initialize(float maxScale, XMFLOAT3 gridHalfWidth)
+// --------------------------------------------------------
+// Whether a collider is in the planar grid and stored as a
+// planar shape, half volumes and hulls never are
+// --------------------------------------------------------
+static inline bool IsPlanarCollider(const Collider* const c)
+{
+	return c->GetIsPlanar() && c->GetType() != Collider::HALFVOL && c->GetType() != Collider::HULL;
+}
+
+
+CollisionManager * const CollisionManager::Initialize(float maxScale, XMFLOAT3 gridHalfWidth, BroadphaseType broadphaseType)
 {
 	// Ensure not already initialized
 	assert(instance == nullptr);
 
 	// Initialize renderer
-	instance = new CollisionManager(maxScale, gridHalfWidth);
+	instance = new CollisionManager(maxScale, gridHalfWidth, broadphaseType);
 
 	// return instance after init
 	return instance;
@@ -39,464 +63,717 @@ void CollisionManager::Shutdown()
 
 void CollisionManager::StageCollider(Collider * const c)
 {
-	colliderVector.push_back(c);
+	//give the collider a proxy id, reusing freed ids first
+	unsigned int id;
+	if (freeProxies.empty()) {
+		id = static_cast<unsigned int>(proxies.size());
+		proxies.push_back(c);
+	}
+	else {
+		id = freeProxies.back();
+		freeProxies.pop_back();
+		proxies[id] = c;
+	}
+	c->proxyId = id;
+	c->isStaged = true;
+	colliderStore.Resize(static_cast<unsigned int>(proxies.size()));
+
+	//nothing to sweep until the collider has moved
+	c->UpdateWorldState();
+	const ColliderWorldState& state = c->GetWorldState();
+	XMFLOAT3 position = state.center;
+	previousPositions.resize(proxies.size());
+	motions.resize(proxies.size());
+	impacts.resize(proxies.size());
+	previousPositions[id] = position;
+	motions[id] = XMFLOAT3(0, 0, 0);
+	impacts[id].other = nullptr;
+
+	//new colliders start awake, static ones are always resting
+	stillUpdates.resize(proxies.size());
+	isResting.resize(proxies.size());
+	stillUpdates[id] = 0;
+	isResting[id] = c->isStatic;
+
+	if (c->isStatic) {
+		//static colliders are written to the store once, here
+		StoreCollider(id, c);
+		staticColliders.push_back(c);
+		staticHash.AddProxy(id, position, state.boundsExtents);
+		isStaticHashDirty = true;
+	}
+	else {
+		colliderVector.push_back(c);
+		Broadphase* structure = IsPlanarCollider(c) ? &planarGrid : broadphase;
+		structure->AddProxy(id, position, state.boundsExtents);
+	}
 }
 
 void CollisionManager::UnstageCollider(Collider * const c)
 {
 	//remove from whatever list is being used
-	for (size_t i = colliderVector.size() - 1; i < colliderVector.size(); i--) {
-		if (colliderVector[i] == c) {
+	std::vector<Collider*>& colliders = c->isStatic ? staticColliders : colliderVector;
+	bool found = false;
+	for (size_t i = colliders.size() - 1; i < colliders.size(); i--) {
+		if (colliders[i] == c) {
 			//swap so that the one to remove is at the back
-			std::swap(colliderVector[i], colliderVector.back());
+			std::swap(colliders[i], colliders.back());
 			//remove the back element
-			colliderVector.pop_back();
+			colliders.pop_back();
+			found = true;
+		}
+	}
+	if (!found) return;
+	c->isStaged = false;
+
+	//this collider no longer receives exits, and may be deleted
+	for (size_t i = pendingExits.size() - 1; i < pendingExits.size(); i--) {
+		if (pendingExits[i].receiver == c) {
+			std::swap(pendingExits[i], pendingExits.back());
+			pendingExits.pop_back();
 		}
 	}
-}
 
-void CollisionManager::CollisionUpdate()
-{
-	//add to grid
-	grid.clear();
-	for (size_t i = 0; i < colliderVector.size(); i++) {
-		//Collider* obj = (Collider*)collidableTags[i];
-		Collider* obj = colliderVector[i];
-		grid.insert(obj->GetPosition(), *obj->GetScale(), obj);
+	//impacts may not point at a collider that can be deleted
+	unsigned int id = c->proxyId;
+	impacts[id].other = nullptr;
+	for (size_t i = 0; i < impacts.size(); i++) {
+		if (impacts[i].other == c) impacts[i].other = nullptr;
 	}
 
-	//check for collisions
-	std::unordered_map<int, std::list<void*>>& map = grid.getMapRef();
-	//grid iterator
-	for (auto iterl = map.begin(); iterl != map.end(); ++iterl) {
+	//colliders still touching this one get an exit on the next update
+	removedPairs.clear();
+	pairCache.RemoveProxy(id, removedPairs);
+	for (size_t i = 0; i < removedPairs.size(); i++) {
+		unsigned int otherId = CollisionPairCache::GetFirst(removedPairs[i].key);
+		if (otherId == id) otherId = CollisionPairCache::GetSecond(removedPairs[i].key);
+		const CollisionPairCache::PairTransition& removed = removedPairs[i];
+		float normalSign = otherId == CollisionPairCache::GetFirst(removed.key) ? 1.0f : -1.0f;
+		PendingExit exit = { proxies[otherId], id, c->GetParentEntity()->GetHandle(), removed.point,
+			XMFLOAT3(removed.normal.x * normalSign, removed.normal.y * normalSign, removed.normal.z * normalSign), removed.depth };
+		pendingExits.push_back(exit);
+	}
 
-		std::list<void*>& bin = (*iterl).second;//list
+	//free the id, ids are not reused while collisions are being dispatched
+	if (c->isStatic) {
+		staticHash.RemoveProxy(id);
+		isStaticHashDirty = true;
+	}
+	else if (IsPlanarCollider(c)) {
+		planarGrid.RemoveProxy(id);
+	}
+	else {
+		broadphase->RemoveProxy(id);
+	}
+	proxies[id] = nullptr;
+	isDispatching ? deferredFreeProxies.push_back(id) : freeProxies.push_back(id);
+}
 
-												//list iterator
-		for (auto iteri = bin.begin(); iteri != bin.end(); iteri) {
+// --------------------------------------------------------
+// Unstage every collider without the searches of unstaging
+// them one by one. Each structure drops its proxies whole,
+// and every pair and exit owed goes with them since their
+// colliders are all leaving.
+// --------------------------------------------------------
+void CollisionManager::UnstageAll()
+{
+	//colliders may not be unstaged from under a dispatch
+	assert(!isDispatching);
 
-			Collider* obji = (Collider*)(*iteri);//1st object
+	for (size_t id = 0; id < proxies.size(); id++) {
+		if (proxies[id] != nullptr) proxies[id]->isStaged = false;
+	}
+	broadphase->RemoveAllProxies();
+	planarGrid.RemoveAllProxies();
+	staticHash.RemoveAllProxies();
+	isStaticHashDirty = false;
+
+	colliderVector.clear();
+	staticColliders.clear();
+	proxies.clear();
+	freeProxies.clear();
+	deferredFreeProxies.clear();
+	stillUpdates.clear();
+	isResting.clear();
+	previousPositions.clear();
+	motions.clear();
+	impacts.clear();
+
+	pairCache.Clear();
+	pendingExits.clear();
+	events.clear();
+	owedExitCount = 0;
+}
 
-			++iteri;
-			//list iterator 2
-			for (auto iterj = iteri; iterj != bin.end(); ++iterj) {
+void CollisionManager::CollisionUpdate()
+{
+	//refresh world states and the collider store, then move every collider that is awake in the
+	//broadphase. world states are only recomputed for colliders that moved, and are read only from here on.
+	//static colliders are paired with the awake colliders as they go, and never with each other
+	if (isStaticHashDirty) {
+		staticHash.Rebin();
+		isStaticHashDirty = false;
+	}
+	pairCache.BeginFrame();
+	awakeProxies.clear();
+	unsigned int planarCount = planarGrid.GetProxyCount();
+	bool isMixed = planarCount > 0 && planarCount < colliderVector.size();
+	for (size_t i = 0; i < colliderVector.size(); i++) {
+		Collider* obj = colliderVector[i];
+		unsigned int id = obj->proxyId;
+		if (obj->UpdateWorldState()) stillUpdates[id] = 0;
+		else if (stillUpdates[id] < COLLISION_SLEEP_UPDATES) stillUpdates[id]++;
+
+		//sleeping colliders keep their store entry, bounds and contacts
+		isResting[id] = stillUpdates[id] >= COLLISION_SLEEP_UPDATES;
+		impacts[id].other = nullptr;
+		if (isResting[id]) continue;
+
+		const ColliderWorldState& state = obj->GetWorldState();
+		unsigned int layer = obj->layer;
+		const XMFLOAT3& position = state.center;
+		bool isPlanar = IsPlanarCollider(obj);
+		Broadphase* structure = isPlanar ? &planarGrid : broadphase;
+		StoreCollider(id, obj);
+		structure->SetProxyLayer(id, 1u << layer, layerMatrix.GetMask(layer));
+
+		XMVECTOR positionVec = XMLoadFloat3(&position);
+		XMVECTOR motion = positionVec - XMLoadFloat3(&previousPositions[id]);
+		XMStoreFloat3(&motions[id], motion);
+		previousPositions[id] = position;
+
+		//bounds of fast movers cover the swept sphere so everything along the path becomes a candidate.
+		//fast movers are swept against where the others were when the update started, so the
+		//bounds of the others cover their motion too, or only a broadphase with loose cells finds those pairs
+		XMFLOAT3 center;
+		XMFLOAT3 halfExtents;
+		XMStoreFloat3(&center, positionVec - motion * 0.5f);
+		if (obj->isFastMoving)
+			XMStoreFloat3(&halfExtents, XMVectorReplicate(state.radius) + XMVectorAbs(motion) * 0.5f);
+		else
+			XMStoreFloat3(&halfExtents, XMLoadFloat3(&state.boundsExtents) + XMVectorAbs(motion) * 0.5f);
+		structure->UpdateProxy(id, center, halfExtents);
+		if (isMixed) {
+			AwakeProxy awake = { id, center, halfExtents, isPlanar };
+			awakeProxies.push_back(awake);
+		}
 
-				Collider* objj = (Collider*)(*iterj);//2nd object
-				if (collides(*obji, *objj))
-				{
-					//pass in collision data to the collision functions in the entities
-					Collision c = { objj->GetParentEntity(), objj, objj->GetParentEntity()->transform, collisionPoint };//want point in space of collision? normal if possible?
-					obji->GetParentEntity()->OnCollision(c);
-					Collision c2 = { obji->GetParentEntity(), obji, obji->GetParentEntity()->transform, collisionPoint };
-					objj->GetParentEntity()->OnCollision(c2);
+		if (!staticColliders.empty()) {
+			staticCandidates.clear();
+			staticHash.QueryBox(center, halfExtents, staticCandidates);
+			for (size_t j = 0; j < staticCandidates.size(); j++) {
+				unsigned int staticId = staticCandidates[j];
+				if (layerMatrix.Collides(layer, proxies[staticId]->layer))
+					pairCache.AddCandidate(id, staticId);
+			}
+		}
+	}
+
+	//gather candidate pairs among the moving colliders, planar ones in the planar grid,
+	//then between the two. pairs where neither collider is awake keep last frame's result
+	broadphase->FindPairs(pairCache);
+	if (planarCount > 0) planarGrid.FindPairs(pairCache);
+	for (size_t i = 0; i < awakeProxies.size(); i++) {
+		const AwakeProxy& awake = awakeProxies[i];
+		Broadphase* other = awake.isPlanar ? broadphase : &planarGrid;
+		unsigned int layer = proxies[awake.id]->layer;
+		crossCandidates.clear();
+		other->QueryBox(awake.center, awake.halfExtents, crossCandidates);
+		for (size_t j = 0; j < crossCandidates.size(); j++) {
+			unsigned int otherId = crossCandidates[j];
+			if (layerMatrix.Collides(layer, proxies[otherId]->layer))
+				pairCache.AddCandidate(awake.id, otherId);
+		}
+	}
+	const std::vector<CollisionPairKey>& candidates = pairCache.ResolveCandidates();
+	pairCache.KeepRestingPairs(isResting);
+
+	//narrowphase once per unique pair, results come back in candidate order
+	//however many threads ran it
+	narrowphase.Run(colliderStore, candidates);
+
+	const std::vector<unsigned char>& hits = narrowphase.GetHits();
+	const std::vector<XMFLOAT3>& points = narrowphase.GetPoints();
+	const std::vector<XMFLOAT3>& normals = narrowphase.GetNormals();
+	const std::vector<float>& depths = narrowphase.GetDepths();
+	for (size_t i = 0; i < candidates.size(); i++) {
+		bool isTouching = hits[i] != 0;
+		XMFLOAT3 point = points[i];
+		XMFLOAT3 normal = normals[i];
+		float depth = depths[i];
+
+		//fast movers are swept as well, catching what they passed through since the last update
+		unsigned int a = CollisionPairCache::GetFirst(candidates[i]);
+		unsigned int b = CollisionPairCache::GetSecond(candidates[i]);
+		bool isFastA = proxies[a]->isFastMoving;
+		bool isFastB = proxies[b]->isFastMoving;
+		if ((isFastA || isFastB) && colliderStore.owner[a] != colliderStore.owner[b]) {
+			unsigned int mover = isFastA ? a : b;
+			unsigned int target = isFastA ? b : a;
+			SweepResult sweep = SweepPair(mover, target);
+			if (sweep.isHit) {
+				RecordImpact(mover, target, sweep, 1.0f);
+				if (isFastA && isFastB) RecordImpact(target, mover, sweep, -1.0f);
+				if (!isTouching) {
+					//the sweep normal faces the mover, turn it to point from a to b
+					float normalSign = isFastA ? -1.0f : 1.0f;
+					isTouching = true;
+					point = sweep.point;
+					XMStoreFloat3(&normal, XMLoadFloat3(&sweep.normal) * normalSign);
+					depth = 0;
 				}
 			}
 		}
+
+		if (isTouching)
+			pairCache.AddContact(candidates[i], point, normal, depth);
 	}
+
+	//find enter/stay/exit transitions and tell the entities
+	transitions.clear();
+	pairCache.EndFrame(transitions);
+	BuildCollisionEvents();
+	DispatchCollisions();
 }
 
-CollisionManager::CollisionManager(float maxScale, XMFLOAT3 gridHalfWidth)
+// --------------------------------------------------------
+// Colliders unstaged now keep their memory until the
+// callbacks are done, as later events may still name them
+// --------------------------------------------------------
+bool CollisionManager::IsDispatching() const
 {
-	CollisionInit();
-	//instantiate grid
-	grid = Grid(maxScale, gridHalfWidth);
+	return isDispatching;
 }
 
-
-CollisionManager::~CollisionManager()
+// --------------------------------------------------------
+// Split the narrowphase across the job system's threads
+// --------------------------------------------------------
+void CollisionManager::SetJobSystem(JobSystem* jobSystem)
 {
+	narrowphase.SetJobSystem(jobSystem);
 }
 
-void CollisionManager::CollisionInit()
+// --------------------------------------------------------
+// Set whether colliders on two layers can touch, takes
+// effect on the next update
+// --------------------------------------------------------
+void CollisionManager::SetLayersCollide(unsigned int a, unsigned int b, bool collide)
 {
-	collisionTable[{Collider::SPHERE, Collider::SPHERE}] = &CollisionManager::collidesSpherevSphere;
-	collisionTable[{Collider::SPHERE, Collider::AABB}] = &CollisionManager::collidesSpherevAABB;
-	collisionTable[{Collider::AABB, Collider::SPHERE}] = &CollisionManager::collidesAABBvSphere;
-	collisionTable[{Collider::AABB, Collider::AABB}] = &CollisionManager::collidesAABBvAABB;
-	collisionTable[{Collider::OBB, Collider::OBB}] = &CollisionManager::collidesOBBvOBB;
-	collisionTable[{Collider::OBB, Collider::SPHERE}] = &CollisionManager::collidesOBBvSphere;
-	collisionTable[{Collider::SPHERE, Collider::OBB}] = &CollisionManager::collidesSpherevOBB;
-	collisionTable[{Collider::OBB, Collider::AABB}] = &CollisionManager::collidesOBBvAABB;
-	collisionTable[{Collider::AABB, Collider::OBB}] = &CollisionManager::collidesAABBvOBB;
-	collisionTable[{Collider::HALFVOL, Collider::AABB}] = &CollisionManager::collidesHalfvolvCollider;
-	collisionTable[{Collider::HALFVOL, Collider::OBB}] = &CollisionManager::collidesHalfvolvCollider;
-	collisionTable[{Collider::HALFVOL, Collider::SPHERE}] = &CollisionManager::collidesHalfvolvCollider;
-	collisionTable[{Collider::AABB, Collider::HALFVOL}] = &CollisionManager::collidesCollidervHalfvol;
-	collisionTable[{Collider::OBB, Collider::HALFVOL}] = &CollisionManager::collidesCollidervHalfvol;
-	collisionTable[{Collider::SPHERE, Collider::HALFVOL}] = &CollisionManager::collidesCollidervHalfvol;
+	layerMatrix.SetCollides(a, b, collide);
+}
 
-	radialProjections[Collider::SPHERE] = &CollisionManager::radialSphere;
-	radialProjections[Collider::AABB] = &CollisionManager::radialAABB;
-	radialProjections[Collider::OBB] = &CollisionManager::radialOBB;
-	radialProjections[Collider::HALFVOL] = &CollisionManager::radialHalfVol;
+// --------------------------------------------------------
+// Set the registry collision events resolve entities through
+// --------------------------------------------------------
+void CollisionManager::SetEntityRegistry(const EntityRegistry* entityRegistry)
+{
+	this->entityRegistry = entityRegistry;
 }
 
-XMFLOAT3 CollisionManager::radialSphere(const Collider & a, const XMFLOAT3 & axis)
+// --------------------------------------------------------
+// True when colliders on the two layers can touch
+// --------------------------------------------------------
+bool CollisionManager::DoLayersCollide(unsigned int a, unsigned int b) const
 {
-	XMVECTOR axisV = XMLoadFloat3(&axis);
-	XMFLOAT3 rad;
-	XMStoreFloat3(&rad, a.GetMaxScale()*axisV);
-	return rad;
+	return layerMatrix.Collides(a, b);
 }
 
-XMFLOAT3 CollisionManager::radialAABB(const Collider & a, const XMFLOAT3 & axis)
+// --------------------------------------------------------
+// Closest hit along a ray
+// --------------------------------------------------------
+bool CollisionManager::Raycast(const XMFLOAT3 & origin, const XMFLOAT3 & direction, float maxDistance, RaycastHit & hit, unsigned int layerMask)
 {
-	XMFLOAT3 L = axis;
-	L.x < 0 ? L.x = -1 : L.x = 1;
-	L.y < 0 ? L.y = -1 : L.y = 1;
-	L.z < 0 ? L.z = -1 : L.z = 1;
-	XMVECTOR radVec = XMLoadFloat3(&L);
-	XMVECTOR scaleVec = XMLoadFloat3(a.GetScale());
-	XMStoreFloat3(&L, scaleVec*radVec);
-	return L;
+	XMFLOAT3 unitDirection;
+	XMStoreFloat3(&unitDirection, XMVector3Normalize(XMLoadFloat3(&direction)));
+	return RaycastCandidates(origin, unitDirection, maxDistance, hit, layerMask);
 }
 
-XMFLOAT3 CollisionManager::radialOBB(const Collider & a, const XMFLOAT3 & axis)
+// --------------------------------------------------------
+// Every hit along a ray, sorted nearest first
+// --------------------------------------------------------
+void CollisionManager::RaycastAll(const XMFLOAT3 & origin, const XMFLOAT3 & direction, float maxDistance, std::vector<RaycastHit>& hits, unsigned int layerMask)
 {
-	XMVECTOR axisVec = XMLoadFloat3(&axis);
+	hits.clear();
+	XMFLOAT3 unitDirection;
+	XMStoreFloat3(&unitDirection, XMVector3Normalize(XMLoadFloat3(&direction)));
 
-	//transform axis into obb space
-	XMFLOAT4X4 rot = a.GetRotationMatrix();
-	XMMATRIX rotMat = XMLoadFloat4x4(&rot);
+	BeginQuery();
+	QueryRay(origin, unitDirection, maxDistance);
+	for (size_t i = 0; i < queryCandidates.size(); i++) {
+		Collider* c = AcceptCandidate(queryCandidates[i], layerMask);
+		if (c == nullptr) continue;
 
-	rotMat = XMMatrixInverse(&XMMatrixDeterminant(rotMat), rotMat);
-	//XMFLOAT3X3 rot3x3;
-	//XMStoreFloat3x3(&rot3x3, rotMat);
-	axisVec = XMVector3Transform(axisVec, rotMat);
+		RayHit rayHit = RaycastCollider(c->GetWorldState(), static_cast<unsigned char>(c->GetType()), origin, unitDirection, maxDistance);
+		if (rayHit.isHit) {
+			RaycastHit hit = { c, rayHit.distance, rayHit.point, rayHit.normal };
+			hits.push_back(hit);
+		}
+	}
 
-	XMFLOAT3 L;
-	XMStoreFloat3(&L, axisVec);
-	//find signs of axis
-	L.x < 0 ? L.x = -1 : L.x = 1;
-	L.y < 0 ? L.y = -1 : L.y = 1;
-	L.z < 0 ? L.z = -1 : L.z = 1;
-	//multiply by signs
-	XMVECTOR radVec = XMLoadFloat3(&L);
-	XMVECTOR scaleVec = XMLoadFloat3(a.GetScale());
-	radVec *= scaleVec;
-	//XMFLOAT3 radial = L*a.GetScale();
-	//undo obb rotation back in to world space
-	//radial = (XMFLOAT3X3)rotMat*radial;
-	radVec = DirectX::XMVector3Transform(radVec, rotMat);
-	XMStoreFloat3(&L, radVec);
-	return L;
+	std::sort(hits.begin(), hits.end(),
+		[](const RaycastHit& a, const RaycastHit& b) { return a.distance < b.distance; });
 }
 
-XMFLOAT3 CollisionManager::radialHalfVol(const Collider & a, const XMFLOAT3 & axis)
+// --------------------------------------------------------
+// Closest hit of each ray. Every ray shares the same
+// candidate and stamp buffers, so a batch of thousands
+// allocates nothing once they have grown.
+// --------------------------------------------------------
+void CollisionManager::RaycastBatch(const Ray * rays, unsigned int count, RaycastHit * hits, unsigned int layerMask)
 {
-	return XMFLOAT3(0, 0, 0);
+	for (unsigned int i = 0; i < count; i++) {
+		XMFLOAT3 unitDirection;
+		XMStoreFloat3(&unitDirection, XMVector3Normalize(XMLoadFloat3(&rays[i].direction)));
+		RaycastCandidates(rays[i].origin, unitDirection, rays[i].maxDistance, hits[i], layerMask);
+	}
 }
 
-bool CollisionManager::testAxis(const XMFLOAT3 & aCenter, const XMFLOAT3 & aRad, const XMFLOAT3 & bCenter, const XMFLOAT3 & bRad, const XMFLOAT3 & axis)
+// --------------------------------------------------------
+// Colliders touching a sphere
+// --------------------------------------------------------
+void CollisionManager::OverlapSphere(const XMFLOAT3 & center, float radius, std::vector<Collider*>& results, unsigned int layerMask)
 {
-	//vec3 L = glm::normalize(axis);
-
-	XMVECTOR axisVec = XMLoadFloat3(&axis);
-
-	XMVECTOR ac = XMLoadFloat3(&aCenter);
-	XMVECTOR ar = XMLoadFloat3(&aRad);
-	XMVECTOR bc = XMLoadFloat3(&bCenter);
-	XMVECTOR br = XMLoadFloat3(&bRad);
-
-	float greater, less, plus;
-	XMStoreFloat(&greater, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, (ac - bc))));
-	XMStoreFloat(&less, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, ar)));
-	XMStoreFloat(&plus, DirectX::XMVectorAbs(DirectX::XMVector3Dot(axisVec, br)));
-
-	if (greater > less + plus) {
-		return true;
+	results.clear();
+	BeginQuery();
+	QueryBox(center, XMFLOAT3(radius, radius, radius));
+	for (size_t i = 0; i < queryCandidates.size(); i++) {
+		Collider* c = AcceptCandidate(queryCandidates[i], layerMask);
+		if (c != nullptr && OverlapSphereCollider(c->GetWorldState(), static_cast<unsigned char>(c->GetType()), center, radius))
+			results.push_back(c);
 	}
-	return false;
 }
 
-bool CollisionManager::testAxis(const Collider & a, const Collider & b, XMFLOAT3 axis)
+// --------------------------------------------------------
+// Colliders touching an oriented box
+//
+// rotation	- unit quaternion taking box space to world space
+// --------------------------------------------------------
+void CollisionManager::OverlapBox(const XMFLOAT3 & center, const XMFLOAT3 & halfExtents, const XMFLOAT4 & rotation, std::vector<Collider*>& results, unsigned int layerMask)
 {
-	XMVECTOR axisVec = XMLoadFloat3(&axis);
+	ColliderWorldState box;
+	ComputeColliderWorldState(box, center, rotation, halfExtents, false);
 
-	axisVec = DirectX::XMVector3Normalize(axisVec);
-	XMStoreFloat3(&axis, axisVec);
-
-	XMFLOAT3 aRad = (this->*radialProjections[a.GetType()])(a, axis);
-	XMFLOAT3 bRad = (this->*radialProjections[b.GetType()])(b, axis);
-
-	return testAxis(a.GetPosition(), aRad, b.GetPosition(), bRad, axis);
+	results.clear();
+	BeginQuery();
+	QueryBox(center, box.boundsExtents);
+	for (size_t i = 0; i < queryCandidates.size(); i++) {
+		Collider* c = AcceptCandidate(queryCandidates[i], layerMask);
+		if (c != nullptr && OverlapBoxCollider(c->GetWorldState(), static_cast<unsigned char>(c->GetType()), box))
+			results.push_back(c);
+	}
 }
 
-XMFLOAT3 CollisionManager::nearPtOBB(const Collider & obb, XMFLOAT3 axisToC)
+// --------------------------------------------------------
+// Start a query with no candidates and nothing seen yet
+// --------------------------------------------------------
+void CollisionManager::BeginQuery()
 {
-	//transform into OBB space
-	XMVECTOR axisToCVec = XMLoadFloat3(&axisToC);
-
-	XMMATRIX rotMat = XMLoadFloat4x4(&obb.GetRotationMatrix());
-	axisToCVec = DirectX::XMVector3Transform(axisToCVec, DirectX::XMMatrixInverse(&XMMatrixDeterminant(rotMat), rotMat));
-
-	//clamp to halfwidths
-	XMVECTOR scaleVec = XMLoadFloat3(obb.GetScale());
-	axisToCVec = XMVector3ClampLengthV(axisToCVec, XMVectorZero(), scaleVec);
-
-	//back to world coordinates
-	axisToCVec = DirectX::XMVector3Transform(axisToCVec, rotMat);
+	queryCandidates.clear();
+	if (queryStamps.size() < proxies.size())
+		queryStamps.resize(proxies.size(), 0);
 
-	//add center location
-	XMVECTOR pos = XMLoadFloat3(&obb.GetPosition());
-	axisToCVec += pos;
-
-	XMStoreFloat3(&axisToC, axisToCVec);
-	collisionPoint = axisToC;
-	return axisToC;
+	//stamps are only cleared when the counter wraps
+	if (++queryStamp == 0) {
+		std::fill(queryStamps.begin(), queryStamps.end(), 0);
+		queryStamp = 1;
+	}
 }
 
-XMFLOAT3 CollisionManager::nearPtAABB(const Collider & aabb, XMFLOAT3 axis)
+// --------------------------------------------------------
+// Append the candidates of every structure overlapping a
+// box to the query
+// --------------------------------------------------------
+void CollisionManager::QueryBox(const XMFLOAT3 & center, const XMFLOAT3 & halfExtents)
 {
-	XMVECTOR axisVec = XMLoadFloat3(&axis);
-
-	//clamp to halfwidths
-	XMVECTOR scale = XMLoadFloat3(aabb.GetScale());
-	axisVec = XMVector3ClampLengthV(axisVec, -scale, scale);
-
-	//add center loc
-	XMVECTOR pos = XMLoadFloat3(&aabb.GetPosition());
-	axisVec += pos;
-	XMStoreFloat3(&axis, axisVec);
-	collisionPoint = axis;
-	return axis;
+	broadphase->QueryBox(center, halfExtents, queryCandidates);
+	staticHash.QueryBox(center, halfExtents, queryCandidates);
+	if (planarGrid.GetProxyCount() > 0) planarGrid.QueryBox(center, halfExtents, queryCandidates);
 }
 
-XMFLOAT3 CollisionManager::nearPtPlane(const Collider & plane, const Collider & other)
+// --------------------------------------------------------
+// Append the candidates of every structure along a segment
+// to the query
+// --------------------------------------------------------
+void CollisionManager::QueryRay(const XMFLOAT3 & origin, const XMFLOAT3 & direction, float maxDistance)
 {
-	//XMFLOAT3 normal = ((XMFLOAT3X3)plane.transform.getRotMat())[2];
-	XMFLOAT4X4 rot = plane.GetRotationMatrix();
-	XMFLOAT3 normal = XMFLOAT3(rot._31, rot._32, rot._33);
-
-	XMVECTOR nor = XMLoadFloat3(&normal);
-	XMVECTOR planePos = XMLoadFloat3(&plane.GetPosition());
-	XMVECTOR otherPos = XMLoadFloat3(&other.GetPosition());
-
-	nor = otherPos - DirectX::XMVector3Dot(nor, (otherPos - planePos))*nor;
-
-	XMFLOAT3 p;
-	XMStoreFloat3(&p, nor);
-	collisionPoint = p;
-	return p;
+	broadphase->QueryRay(origin, direction, maxDistance, queryCandidates);
+	staticHash.QueryRay(origin, direction, maxDistance, queryCandidates);
+	if (planarGrid.GetProxyCount() > 0) planarGrid.QueryRay(origin, direction, maxDistance, queryCandidates);
 }
 
-bool CollisionManager::collidesAABBvAABB(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// The staged collider behind a candidate, or null when it
+// was already tested this query, has since been unstaged or
+// is on a layer outside the mask
+// --------------------------------------------------------
+Collider * CollisionManager::AcceptCandidate(unsigned int id, unsigned int layerMask)
 {
-	XMFLOAT3 axis = XMFLOAT3(0, 0, 1);//z
-	if (testAxis(a, b, axis)) return false;
-	axis = XMFLOAT3(0, 1, 0);//y
-	if (testAxis(a, b, axis)) return false;
-	axis = XMFLOAT3(1, 0, 0);//x
-	if (testAxis(a, b, axis)) return false;
-	
-	//TODO: Calculate nearest point ... how?
+	if (queryStamps[id] == queryStamp) return nullptr;
+	queryStamps[id] = queryStamp;
 
-	return true;
+	Collider* c = proxies[id];
+	if (c == nullptr || (layerMask & (1u << c->layer)) == 0) return nullptr;
+	return c;
 }
 
-bool CollisionManager::collidesSpherevSphere(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Closest hit along a ray with a unit length direction.
+// Each hit shortens the ray for the candidates after it.
+// --------------------------------------------------------
+bool CollisionManager::RaycastCandidates(const XMFLOAT3 & origin, const XMFLOAT3 & direction, float maxDistance, RaycastHit & hit, unsigned int layerMask)
 {
-	XMVECTOR aPos = XMLoadFloat3(&a.GetPosition());
-	XMVECTOR bPos = XMLoadFloat3(&b.GetPosition());
-	XMFLOAT3 axis;
-	XMStoreFloat3(&axis, aPos - bPos);
-	if (testAxis(a, b, axis)) return false;
-
-	//calculate nearest point
-	//normalize axis
-	XMVECTOR axisVec = XMLoadFloat3(&axis);
-	axisVec = DirectX::XMVector3Normalize(axisVec);
-	//multiply by radius
-	axisVec *= a.GetMaxScale();
-	//add to position of object to get world coordinates?
-	XMVECTOR posVec = XMLoadFloat3(&a.GetPosition());
-	axisVec += posVec;
-	XMStoreFloat3(&axis, axisVec);
-	collisionPoint = axis;
+	hit.collider = nullptr;
+	BeginQuery();
+	QueryRay(origin, direction, maxDistance);
 
+	float closest = maxDistance;
+	for (size_t i = 0; i < queryCandidates.size(); i++) {
+		Collider* c = AcceptCandidate(queryCandidates[i], layerMask);
+		if (c == nullptr) continue;
 
-	return true;
+		RayHit rayHit = RaycastCollider(c->GetWorldState(), static_cast<unsigned char>(c->GetType()), origin, direction, closest);
+		if (rayHit.isHit && (hit.collider == nullptr || rayHit.distance < closest)) {
+			hit.collider = c;
+			hit.distance = rayHit.distance;
+			hit.point = rayHit.point;
+			hit.normal = rayHit.normal;
+			closest = rayHit.distance;
+		}
+	}
+	return hit.collider != nullptr;
 }
 
-bool CollisionManager::collidesAABBvSphere(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Earliest swept hit of a fast moving collider during the
+// last update
+// --------------------------------------------------------
+bool CollisionManager::GetTimeOfImpact(const Collider * const c, TimeOfImpact & impact) const
 {
-	//find nearest point on box
-	XMVECTOR aPos = XMLoadFloat3(&a.GetPosition());
-	XMVECTOR bPos = XMLoadFloat3(&b.GetPosition());
-	XMFLOAT3 pos;
-	XMStoreFloat3(&pos, bPos - aPos);
-	XMFLOAT3 aNearest = nearPtAABB(a, pos);
-	XMVECTOR aNear = XMLoadFloat3(&aNearest);
-
-	//check distance from nearest point to center of sphere
-	XMFLOAT3 axis;
-	XMStoreFloat3(&axis, XMVector3Normalize(aNear - bPos));
-	XMFLOAT3 bRad = (this->*radialProjections[b.GetType()])(b, axis);
-
-	if (testAxis(aNearest, XMFLOAT3(0, 0, 0), b.GetPosition(), bRad, axis)) return false;
+	unsigned int id = c->proxyId;
+	if (!c->isFastMoving || id >= proxies.size() || proxies[id] != c) return false;
+	if (impacts[id].other == nullptr) return false;
 
+	impact = impacts[id];
 	return true;
 }
 
-bool CollisionManager::collidesSpherevAABB(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Whether a staged collider is sleeping or static
+// --------------------------------------------------------
+bool CollisionManager::IsSleeping(const Collider * const c) const
 {
-	return collidesAABBvSphere(b, a);
+	unsigned int id = c->proxyId;
+	if (id >= proxies.size() || proxies[id] != c) return false;
+	return isResting[id] != 0;
 }
 
-bool CollisionManager::collidesOBBvOBB(const Collider & a, const Collider & b) {
-	XMFLOAT3 axis;
-	XMVECTOR axisVec;
-
-	for (int i = 0; i < 3; i++) {
-
-		axisVec = XMLoadFloat4(&a.GetRotationColumn(i));
-		XMStoreFloat3(&axis, axisVec);
-		if (testAxis(a, b, axis)) return false;
-
-		axisVec = XMLoadFloat4(&b.GetRotationColumn(i));
-		XMStoreFloat3(&axis, axisVec);
-		if (testAxis(a, b, axis)) return false;
+// --------------------------------------------------------
+// Copy a collider's world state into the store. Planar
+// colliders are stored as their planar shape, oriented
+// boxes with the rectangle covering them from above.
+// --------------------------------------------------------
+void CollisionManager::StoreCollider(unsigned int id, const Collider * const c)
+{
+	const ColliderWorldState& state = c->GetWorldState();
+	unsigned char shape = static_cast<unsigned char>(c->GetType());
+	if (IsPlanarCollider(c))
+		shape = shape == Collider::SPHERE ? SHAPE_CIRCLE : shape == Collider::AABB ? SHAPE_RECT : SHAPE_ORECT;
 
-		for (int j = 0; j < 3; j++) {
-			//cross product axes
-			axisVec = DirectX::XMVector3Cross(XMLoadFloat4(&a.GetRotationColumn(i)), XMLoadFloat4(&b.GetRotationColumn(j)));
-			XMStoreFloat3(&axis, axisVec);
-			//axis = glm::cross(((XMFLOAT3X3)a.transform.getRotMat())[i], ((XMFLOAT3X3)b.transform.getRotMat())[j]);
-			if (testAxis(a, b, axis)) return false;
-		}
+	colliderStore.Set(id, state.center, state.halfExtents, state.radius, shape, c->layer, c->GetBaseEntity());
+	colliderStore.SetAxes(id, state.axes);
+	if (shape == SHAPE_HULL) {
+		const ConvexHull* hull = c->GetConvexHull();
+		colliderStore.SetHull(id, hull ? hull->GetVertices().data() : nullptr, hull ? static_cast<unsigned int>(hull->GetVertices().size()) : 0);
+	}
+	if (shape == SHAPE_ORECT) {
+		XMFLOAT2 axis, halfWidths;
+		ComputePlanarRect(state, true, axis, halfWidths);
+		colliderStore.SetPlanarRect(id, axis, halfWidths);
 	}
-
-	//TODO: Calculate nearest point
-
-	return true;
 }
 
-bool CollisionManager::collidesOBBvSphere(const Collider & a, const Collider & b)
-{
-	//calc nearest point to sphere
-	XMVECTOR aPos = XMLoadFloat3(&a.GetPosition());
-	XMVECTOR bPos = XMLoadFloat3(&b.GetPosition());
-	XMFLOAT3 pos;
-	XMStoreFloat3(&pos, bPos - aPos);
-	XMFLOAT3 aNearest = nearPtOBB(a, pos);
-	XMVECTOR aNear = XMLoadFloat3(&aNearest);
-
-	//test axis from point to sphere center
-	XMFLOAT3 axis;
-	XMStoreFloat3(&axis, XMVector3Normalize(bPos - aNear));
-	XMFLOAT3 bRad = (this->*radialProjections[b.GetType()])(b, axis);
-
-	if (testAxis(aNearest, XMFLOAT3(0, 0, 0), b.GetPosition(), bRad, axis)) return false;
+// --------------------------------------------------------
+// Sweep the mover's bounding sphere through this update's
+// motion against the target. The target is held at its own
+// start position and the mover travels relative to it, so
+// two moving colliders are swept against each other.
+// --------------------------------------------------------
+SweepResult CollisionManager::SweepPair(unsigned int mover, unsigned int target) const
+{
+	XMVECTOR moverEnd = XMLoadFloat4(&colliderStore.positions[mover]);
+	XMVECTOR targetMotion = XMLoadFloat3(&motions[target]);
+
+	XMFLOAT3 start, end, center;
+	XMStoreFloat3(&start, moverEnd - XMLoadFloat3(&motions[mover]));
+	XMStoreFloat3(&end, moverEnd - targetMotion);
+	XMStoreFloat3(&center, XMLoadFloat4(&colliderStore.positions[target]) - targetMotion);
+	float radius = colliderStore.positions[mover].w;
+
+	const Collider& other = *proxies[target];
+	const ColliderWorldState& otherState = other.GetWorldState();
+	SweepResult sweep = { false };
+	switch (other.GetType()) {
+	case Collider::SPHERE:
+		sweep = SweepSphereVsSphere(start, end, radius, center, otherState.radius);
+		break;
+	case Collider::AABB:
+		sweep = SweepSphereVsAABB(start, end, radius, center, otherState.halfExtents);
+		break;
+	case Collider::OBB:
+	case Collider::HULL:
+		//hulls are swept against the box they were fitted in
+		sweep = SweepSphereVsOBB(start, end, radius, center, otherState.halfExtents, GetColliderWorldRotation(otherState));
+		break;
+	default:
+		//half volumes are only tested at the end of the motion
+		break;
+	}
 
-	return true;
+	//the contact moves with the target up to the time of impact
+	if (sweep.isHit)
+		XMStoreFloat3(&sweep.point, XMLoadFloat3(&sweep.point) + targetMotion * sweep.toi);
+	return sweep;
 }
 
-bool CollisionManager::collidesSpherevOBB(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Keep the earliest impact of a fast moving collider
+// --------------------------------------------------------
+void CollisionManager::RecordImpact(unsigned int id, unsigned int otherId, const SweepResult & sweep, float normalSign)
 {
-	return collidesOBBvSphere(b, a);
+	TimeOfImpact& impact = impacts[id];
+	if (impact.other != nullptr && impact.toi <= sweep.toi) return;
+
+	impact.other = proxies[otherId];
+	impact.toi = sweep.toi;
+	impact.point = sweep.point;
+	XMStoreFloat3(&impact.normal, XMLoadFloat3(&sweep.normal) * normalSign);
 }
 
-bool CollisionManager::collidesOBBvAABB(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Every contact change of the last update, valid until the
+// next update
+// --------------------------------------------------------
+const std::vector<CollisionManager::CollisionEvent>& CollisionManager::GetCollisionEvents() const
 {
-	return collidesOBBvOBB(a, b);
+	return events;
 }
 
-bool CollisionManager::collidesAABBvOBB(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Events at the front of the list that are exits owed to a
+// collider whose partner was unstaged
+// --------------------------------------------------------
+size_t CollisionManager::GetOwedExitCount() const
 {
-	return collidesOBBvAABB(b, a);
+	return owedExitCount;
 }
 
-bool CollisionManager::collidesHalfvolvCollider(const Collider & a, const Collider & b)
+// --------------------------------------------------------
+// Append the owed exits and the update's transitions to
+// the event list as compact records, before any callback
+// can stage or unstage colliders
+// --------------------------------------------------------
+void CollisionManager::BuildCollisionEvents()
 {
-	XMFLOAT3 axis;
-	XMVECTOR axisVec = XMLoadFloat4(&a.GetRotationColumn(2));
-	axisVec = XMVector4Normalize(axisVec);
-	XMStoreFloat3(&axis, axisVec);
-
-	XMFLOAT3 aRad = (this->*radialProjections[a.GetType()])(a, axis);
-	XMFLOAT3 bRad = (this->*radialProjections[b.GetType()])(b, axis);
-	XMFLOAT3 aNearest = nearPtPlane(a, b);//nearest point on plane
+	events.clear();
 
-										  //test collision
-	if (testAxis(aNearest, aRad, b.GetPosition(), bRad, axis)) {
-		//test half
-		XMVECTOR aPos = XMLoadFloat3(&a.GetPosition());
-		XMVECTOR bPos = XMLoadFloat3(&b.GetPosition());
-		float dot;
-		XMStoreFloat(&dot, XMVector3Dot(bPos - aPos, axisVec));
-		if (dot > 0) return true;
-		return false;
+	//exits for pairs that were broken by unstaging a collider
+	for (size_t i = 0; i < pendingExits.size(); i++) {
+		const PendingExit& exit = pendingExits[i];
+		CollisionEvent event = { CollisionPairCache::PAIR_EXIT, { exit.receiver->proxyId, exit.otherProxyId },
+			{ exit.receiver, nullptr }, { exit.receiver->GetParentEntity()->GetHandle(), exit.otherEntity },
+			exit.point, exit.normal, exit.depth };
+		events.push_back(event);
+	}
+	owedExitCount = events.size();
+	pendingExits.clear();
+
+	for (size_t i = 0; i < transitions.size(); i++) {
+		const CollisionPairCache::PairTransition& transition = transitions[i];
+		unsigned int idi = CollisionPairCache::GetFirst(transition.key);
+		unsigned int idj = CollisionPairCache::GetSecond(transition.key);
+		Collider* obji = proxies[idi];
+		Collider* objj = proxies[idj];
+		CollisionEvent event = { transition.event, { idi, idj }, { obji, objj }, { obji->GetParentEntity()->GetHandle(), objj->GetParentEntity()->GetHandle() },
+			transition.point, transition.normal, transition.depth };
+		events.push_back(event);
 	}
-
-	return true;
-}
-
-bool CollisionManager::collidesCollidervHalfvol(const Collider & a, const Collider & b)
-{
-	return collidesHalfvolvCollider(b, a);
 }
 
-bool CollisionManager::collides(const Collider & a, const Collider & b)
+void CollisionManager::DispatchCollisions()
 {
-	//no collisions when belonging to the same base entity -> unity children colliders do not collide with parent colliders
-	if (a.GetBaseEntity() == b.GetBaseEntity()) return false;
+	isDispatching = true;
 
-	// Use object a and object b's collider type
-	//		to get a function pointer from the jump table and call the function
-	if (collisionTable[{a.GetType(), b.GetType()}]) {
-		return (this->*collisionTable[{a.GetType(), b.GetType()}])(a, b);
-	}
+	for (size_t i = 0; i < events.size(); i++) {
+		const CollisionEvent& event = events[i];
+		bool isOwedExit = i < owedExitCount;
 
-	return false;
-}
+		//skip pairs that lost a collider earlier in the dispatch, an owed exit has no partner collider left to check
+		if (proxies[event.proxyIds[0]] != event.colliders[0]) continue;
+		if (!isOwedExit && proxies[event.proxyIds[1]] != event.colliders[1]) continue;
 
-Grid::Grid()
-{
-}
+		//and entities released earlier in the dispatch, whose handles no longer resolve
+		Entity* first = entityRegistry->Get(event.entities[0]);
+		Entity* second = entityRegistry->Get(event.entities[1]);
+		if (first == nullptr) continue;
 
-Grid::Grid(float maxScale, XMFLOAT3 halfWidth)
-{
-	this->halfWidth = halfWidth;
-	XMVECTOR hwVec = XMLoadFloat3(&halfWidth);
-	XMFLOAT3 temp;
-	XMStoreFloat3(&temp, hwVec / maxScale);
-	cols = static_cast<int>(temp.x);
-}
+		//pass in collision data to the collision functions in the entities
+		Collision c = { second, event.colliders[1], event.point, event.normal, event.depth };
+		if (isOwedExit) {
+			first->OnCollisionExit(c);
+			continue;
+		}
+		if (second == nullptr) continue;
+
+		XMFLOAT3 reversed(-event.normal.x, -event.normal.y, -event.normal.z);
+		Collision c2 = { first, event.colliders[0], event.point, reversed, event.depth };
+		switch (event.type) {
+		case CollisionPairCache::PAIR_ENTER:
+			first->OnCollisionEnter(c);
+			second->OnCollisionEnter(c2);
+			break;
+		case CollisionPairCache::PAIR_STAY:
+			first->OnCollisionStay(c);
+			second->OnCollisionStay(c2);
+			break;
+		case CollisionPairCache::PAIR_EXIT:
+			first->OnCollisionExit(c);
+			second->OnCollisionExit(c2);
+			break;
+		}
+	}
 
-Grid::~Grid()
-{
+	//ids freed by callbacks can be handed out again
+	isDispatching = false;
+	freeProxies.insert(freeProxies.end(), deferredFreeProxies.begin(), deferredFreeProxies.end());
+	deferredFreeProxies.clear();
 }
 
-std::unordered_map<int, std::list<void(*)>>& Grid::getMapRef()
+CollisionManager::CollisionManager(float maxScale, XMFLOAT3 gridHalfWidth, BroadphaseType broadphaseType) :
+	staticHash(maxScale, gridHalfWidth),
+	planarGrid(maxScale, gridHalfWidth)
 {
-	// TODO: insert return statement here
-	return grid;
+	//instantiate broadphase
+	switch (broadphaseType)
+	{
+	case BroadphaseType::SPATIAL_HASH:
+		broadphase = new SpatialHash(maxScale, gridHalfWidth);
+		break;
+	case BroadphaseType::SWEEP_AND_PRUNE:
+		broadphase = new SweepAndPrune();
+		break;
+	case BroadphaseType::AABB_TREE:
+		// Fat margin scales with the typical collider size
+		broadphase = new DynamicAABBTree(maxScale * 0.2f);
+		break;
+	case BroadphaseType::HIERARCHICAL_GRID:
+		// Colliders up to maxScale share the finest level, larger ones go above
+		broadphase = new HierarchicalGrid(maxScale, gridHalfWidth);
+		break;
+	}
 }
 
-void Grid::clear()
-{
-	grid.clear();
-}
 
-void Grid::insert(XMFLOAT3 colLoc, XMFLOAT3 colHalf, void(*colAddress))
+CollisionManager::~CollisionManager()
 {
-	//calc min and max ijk
-	float colFloat = static_cast<float>(cols);
-	XMVECTOR hwVec = XMLoadFloat3(&halfWidth);
-	XMVECTOR clVec = XMLoadFloat3(&colLoc);
-	XMVECTOR chVec = XMLoadFloat3(&colHalf);
-	XMFLOAT3 ijkMin, ijkMax;
-	XMStoreFloat3(&ijkMin, (clVec - chVec + hwVec)* XMLoadFloat3(&XMFLOAT3(colFloat, colFloat, colFloat)) / (2.0f * hwVec));
-	XMStoreFloat3(&ijkMax, (clVec + chVec + hwVec)*XMLoadFloat3(&XMFLOAT3(colFloat, colFloat, colFloat)) / (2.0f * hwVec));
-
-	//calc hash
-	for (int i = static_cast<int>(ijkMin.x); i <= static_cast<int>(ijkMax.x); i++) {
-		for (int j = static_cast<int>(ijkMin.y); j <= static_cast<int>(ijkMax.y); j++) {
-			for (int k = static_cast<int>(ijkMin.z); k <= static_cast<int>(ijkMax.z); k++) {
-				int h = i + cols*j + cols*cols*k;
-				//insert
-				grid[h].push_front(colAddress);
-			}
-		}
-	}
+	delete broadphase;
 }
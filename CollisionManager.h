@@ -1,95 +1,213 @@
 #pragma once
-#include <unordered_map>
-#include <d3d11.h>
 #include <DirectXMath.h>
 #include <vector>
 #include "Collider.h"
 #include "Entity.h"
+#include "SpatialHash.h"
+#include "PlanarGrid.h"
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+#include "HierarchicalGrid.h"
+#include "CollisionPairCache.h"
+#include "ColliderStore.h"
+#include "Narrowphase.h"
+#include "SweptCollision.h"
+#include "SceneQuery.h"
+#include "CollisionLayers.h"
 
+class EntityRegistry;
 
-class Grid
-{
-public:
-	Grid();
-	Grid(float maxScale, XMFLOAT3 halfWidth);
-	~Grid();
-
-	int cols = 1;
-	XMFLOAT3 halfWidth = XMFLOAT3(10, 10, 10);
-	std::unordered_map<int, std::list<void(*)>> grid;
-
-	std::unordered_map<int, std::list<void(*)>>& getMapRef();
-	void clear();
-	void insert(XMFLOAT3 colLoc, XMFLOAT3 colHalf, void(*colAddress));
-};
 
 class CollisionManager
 {
 public:
 	// Instance specific stuff
-	static CollisionManager * const Initialize(float maxScale, XMFLOAT3 gridHalfWidth);
+	static CollisionManager * const Initialize(float maxScale, XMFLOAT3 gridHalfWidth, BroadphaseType broadphaseType = BroadphaseType::SPATIAL_HASH);
 	static CollisionManager * const Instance();
 	static void Shutdown();
 
 	void StageCollider(Collider* const c);
 	void UnstageCollider(Collider* const c);
+
+	// Unstage every collider at once, for when the scene holding them all
+	// unloads. No collider is left to be owed an exit, so none are.
+	void UnstageAll();
 	void CollisionUpdate();
+	bool IsDispatching() const;	// True while collision callbacks run
+
+	// Job system the narrowphase is split across, null runs it on the calling
+	// thread. Collision callbacks happen in the same order for any thread count.
+	void SetJobSystem(JobSystem* jobSystem);
+
+	// Registry the entity handles of collision events resolve through, so an
+	// entity released by an earlier callback is not called
+	void SetEntityRegistry(const EntityRegistry* entityRegistry);
+
+	// Contact change of a pair of colliders in the last update
+	struct CollisionEvent {
+		CollisionPairCache::PairEvent type;
+		unsigned int proxyIds[2];
+		Collider* colliders[2];
+		EntityHandle entities[2];	// Resolved through the entity registry
+		XMFLOAT3 point;
+		XMFLOAT3 normal;	// From the first collider to the second
+		float depth;		// Penetration along the normal, 0 for swept contacts
+	};
+
+	// Every contact change of the last update in the order the callbacks ran,
+	// for systems that would rather read them in a batch. Exits owed to a
+	// collider whose partner was unstaged come first, only the first collider
+	// of those is told. Their second collider is null, and the second proxy
+	// id and entity handle may no longer resolve to anything. Valid until the
+	// next CollisionUpdate.
+	const std::vector<CollisionEvent>& GetCollisionEvents() const;
+	size_t GetOwedExitCount() const;
+
+	// Earliest hit along a fast moving collider's motion in the last update
+	struct TimeOfImpact {
+		Collider* other;
+		float toi;			// Fraction of the motion travelled before touching other
+		XMFLOAT3 point;		// Contact point on other
+		XMFLOAT3 normal;	// Other's surface normal at the point, facing the collider
+	};
+
+	// False when the collider is not fast moving or its sweep hit nothing
+	bool GetTimeOfImpact(const Collider* const c, TimeOfImpact& impact) const;
+
+	// Moving colliders whose transform has not changed for a couple of updates
+	// sleep. They keep their place in the broadphase and their contacts, and
+	// pairs of sleeping or static colliders are not tested again until one of
+	// them moves. Static colliders always count as sleeping.
+	bool IsSleeping(const Collider* const c) const;
+
+	// Whether colliders on two layers can touch, every pair of layers can by
+	// default. Pairs on layers that do not collide are dropped in the broadphase.
+	void SetLayersCollide(unsigned int a, unsigned int b, bool collide);
+	bool DoLayersCollide(unsigned int a, unsigned int b) const;
+
+	// Scene queries, answered through the broadphase from the colliders as
+	// they were at the last CollisionUpdate. Only colliders whose layer bit is
+	// set in layerMask are reported. Ray directions need not be unit length,
+	// distances are in world units.
+	struct RaycastHit {
+		Collider* collider;	// Null when nothing was hit
+		float distance;		// From the ray origin
+		XMFLOAT3 point;
+		XMFLOAT3 normal;	// Surface normal at the point, zero when the ray starts inside
+	};
+
+	struct Ray {
+		XMFLOAT3 origin;
+		XMFLOAT3 direction;
+		float maxDistance;
+	};
+
+	// Closest hit along the ray
+	bool Raycast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, RaycastHit& hit, unsigned int layerMask = 0xFFFFFFFF);
+
+	// Every hit along the ray, nearest first. hits is cleared first.
+	void RaycastAll(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<RaycastHit>& hits, unsigned int layerMask = 0xFFFFFFFF);
+
+	// Closest hit of each of count rays, hits must hold count entries
+	void RaycastBatch(const Ray* rays, unsigned int count, RaycastHit* hits, unsigned int layerMask = 0xFFFFFFFF);
+
+	// Colliders touching a sphere or an oriented box. results is cleared first.
+	void OverlapSphere(const XMFLOAT3& center, float radius, std::vector<Collider*>& results, unsigned int layerMask = 0xFFFFFFFF);
+	void OverlapBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, const XMFLOAT4& rotation, std::vector<Collider*>& results, unsigned int layerMask = 0xFFFFFFFF);
 private:
-	CollisionManager(float maxScale, XMFLOAT3 gridHalfWidth);
+	CollisionManager(float maxScale, XMFLOAT3 gridHalfWidth, BroadphaseType broadphaseType);
 	~CollisionManager();
 	static CollisionManager* instance;
-	Grid grid;
-	void CollisionInit();
+	Broadphase* broadphase;
 	std::vector<Collider*> colliderVector;
-	XMFLOAT3 collisionPoint;
-
-	//typedefs
-	typedef bool (CollisionManager::*collisionFunction)(const Collider&, const Collider&);
-	typedef std::pair<Collider::ColliderType, Collider::ColliderType> collisionPair;
-	//typedef XMFLOAT3 radialVector(const Collider& a, const XMFLOAT3& axis);
-
-	//	Collider-pair jump table
-	struct ColliderHasher {
-		template <typename C>
-		std::size_t operator()(const std::pair<C, C>& pair) const {
-			return pair.first * 4 + pair.second;
-			//4 collider types
-		}
+
+	// Static colliders are only in the static hash. It is rebinned when static
+	// colliders are staged or unstaged, never asked for pairs, and only
+	// queried with the bounds of moving colliders that are awake.
+	std::vector<Collider*> staticColliders;
+	SpatialHash staticHash;
+	bool isStaticHashDirty = false;
+	std::vector<unsigned int> staticCandidates;
+
+	// Moving planar colliders are only in the planar grid. Pairs of a planar
+	// and a solid moving collider are found by each awake one querying the
+	// other structure after both have found their own pairs.
+	PlanarGrid planarGrid;
+	struct AwakeProxy {
+		unsigned int id;
+		XMFLOAT3 center;
+		XMFLOAT3 halfExtents;
+		bool isPlanar;
+	};
+	std::vector<AwakeProxy> awakeProxies;
+	std::vector<unsigned int> crossCandidates;
+
+	// Sleeping, indexed by proxy id
+	std::vector<unsigned char> stillUpdates;	// Updates in a row without moving, stops counting once asleep
+	std::vector<unsigned char> isResting;		// Sleeping or static
+
+	// Staged colliders indexed by proxy id, null for free ids
+	std::vector<Collider*> proxies;
+	std::vector<unsigned int> freeProxies;
+	std::vector<unsigned int> deferredFreeProxies;	// Freed during dispatch, reused afterwards
+	bool isDispatching = false;
+
+	// Touching pairs carried between frames
+	CollisionPairCache pairCache;
+	std::vector<CollisionPairCache::PairTransition> transitions;
+	std::vector<CollisionPairCache::PairTransition> removedPairs;
+
+	// Exit owed to a collider whose partner was unstaged while touching. The
+	// partner may be deleted before the exit is sent, so only its proxy id
+	// and entity handle are kept, taken while it was still staged.
+	struct PendingExit {
+		Collider* receiver;
+		unsigned int otherProxyId;
+		EntityHandle otherEntity;
+		XMFLOAT3 point;
+		XMFLOAT3 normal;	// From the receiver to the other
+		float depth;
 	};
-	std::unordered_map<collisionPair, collisionFunction, ColliderHasher> collisionTable;
-
-	//	radial projection jump table
-	std::unordered_map<Collider::ColliderType, XMFLOAT3(CollisionManager::*)(const Collider&, const XMFLOAT3&)> radialProjections;
-
-	XMFLOAT3 radialSphere(const Collider& a, const XMFLOAT3& axis);
-	XMFLOAT3 radialAABB(const Collider& a, const XMFLOAT3& axis);
-	XMFLOAT3 radialOBB(const Collider& a, const XMFLOAT3& axis);
-	XMFLOAT3 radialHalfVol(const Collider& a, const XMFLOAT3& axis);
-
-	//		testAxis function
-	bool testAxis(const XMFLOAT3& aCenter, const XMFLOAT3& aRad, const XMFLOAT3& bCenter, const XMFLOAT3& bRad, const XMFLOAT3& axis);
-	bool testAxis(const Collider& a, const Collider& b, XMFLOAT3 axis);
-
-	//		calc nearest point on OBB
-	XMFLOAT3 nearPtOBB(const Collider & obb, XMFLOAT3 axisToC);
-	XMFLOAT3 nearPtAABB(const Collider& aabb, XMFLOAT3 axis);
-	XMFLOAT3 nearPtPlane(const Collider& plane, const Collider& other);
-
-	//		collision checks
-	bool collidesAABBvAABB(const Collider & a, const Collider & b);
-	bool collidesSpherevSphere(const Collider & a, const Collider & b);
-	bool collidesAABBvSphere(const Collider & a, const Collider & b);
-	bool collidesSpherevAABB(const Collider & a, const Collider & b);
-	bool collidesOBBvOBB(const Collider & a, const Collider & b);
-	bool collidesOBBvSphere(const Collider & a, const Collider & b);
-	bool collidesSpherevOBB(const Collider & a, const Collider & b);
-	bool collidesOBBvAABB(const Collider & a, const Collider & b);
-	bool collidesAABBvOBB(const Collider & a, const Collider & b);
-	bool collidesHalfvolvCollider(const Collider & a, const Collider & b);
-	bool collidesCollidervHalfvol(const Collider & a, const Collider & b);
-
-	//		collides
-	bool collides(const Collider& a, const Collider& b);
+	std::vector<PendingExit> pendingExits;
+
+	// The update's events, reused every update so dispatch allocates nothing
+	// once it has grown. Callbacks get a Collision built on the stack from
+	// the event, nothing is copied out of the entities.
+	std::vector<CollisionEvent> events;
+	size_t owedExitCount = 0;	// Events that are exits owed from an unstaged partner
+
+	void BuildCollisionEvents();
+	void DispatchCollisions();
+
+	const EntityRegistry* entityRegistry = nullptr;
+
+	CollisionLayerMatrix layerMatrix;
+
+	// Per frame copy of the staged colliders read by the narrowphase
+	ColliderStore colliderStore;
+	Narrowphase narrowphase;
+
+	void StoreCollider(unsigned int id, const Collider* const c);
+
+	// Continuous collision, indexed by proxy id
+	std::vector<XMFLOAT3> previousPositions;	// Position at the last update
+	std::vector<XMFLOAT3> motions;				// Displacement since the last update
+	std::vector<TimeOfImpact> impacts;			// Earliest hit of fast moving colliders
+
+	SweepResult SweepPair(unsigned int mover, unsigned int target) const;
+	void RecordImpact(unsigned int id, unsigned int otherId, const SweepResult& sweep, float normalSign);
+
+	// Scene query scratch, a proxy is tested once per query however many
+	// times the broadphase hands it back
+	std::vector<unsigned int> queryCandidates;
+	std::vector<unsigned int> queryStamps;	// Query that last saw each proxy id
+	unsigned int queryStamp = 0;
+
+	void BeginQuery();
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents);
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance);
+	Collider* AcceptCandidate(unsigned int id, unsigned int layerMask);
+	bool RaycastCandidates(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, RaycastHit& hit, unsigned int layerMask);
 };
 
 
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <iterator>
+#include "CollisionPairCache.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+CollisionPairCache::CollisionPairCache()
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+CollisionPairCache::~CollisionPairCache()
+{
+}
+
+// --------------------------------------------------------
+// Build the key of an unordered pair
+// --------------------------------------------------------
+CollisionPairKey CollisionPairCache::MakeKey(unsigned int a, unsigned int b)
+{
+	if (a > b) std::swap(a, b);
+	return (static_cast<CollisionPairKey>(a) << 32) | b;
+}
+
+// --------------------------------------------------------
+// Get the lower proxy id of a pair
+// --------------------------------------------------------
+unsigned int CollisionPairCache::GetFirst(CollisionPairKey key)
+{
+	return static_cast<unsigned int>(key >> 32);
+}
+
+// --------------------------------------------------------
+// Get the higher proxy id of a pair
+// --------------------------------------------------------
+unsigned int CollisionPairCache::GetSecond(CollisionPairKey key)
+{
+	return static_cast<unsigned int>(key & 0xFFFFFFFF);
+}
+
+// --------------------------------------------------------
+// Start collecting a new frame of candidates
+// --------------------------------------------------------
+void CollisionPairCache::BeginFrame()
+{
+	candidates.clear();
+	contacts.clear();
+	restingContacts.clear();
+}
+
+// --------------------------------------------------------
+// Add a broadphase candidate, duplicates are fine
+// --------------------------------------------------------
+void CollisionPairCache::AddCandidate(unsigned int a, unsigned int b)
+{
+	candidates.push_back(MakeKey(a, b));
+}
+
+// --------------------------------------------------------
+// Sort candidates and drop duplicates so each pair is
+// only tested once this frame
+// --------------------------------------------------------
+const std::vector<CollisionPairKey>& CollisionPairCache::ResolveCandidates()
+{
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	return candidates;
+}
+
+// --------------------------------------------------------
+// Skip the narrowphase for pairs where neither proxy moved,
+// their last result still holds
+// --------------------------------------------------------
+void CollisionPairCache::KeepRestingPairs(const std::vector<unsigned char>& isResting)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (!isResting[GetFirst(candidates[i])] || !isResting[GetSecond(candidates[i])])
+			candidates[kept++] = candidates[i];
+	}
+	candidates.resize(kept);
+
+	for (size_t i = 0; i < touching.size(); i++) {
+		if (isResting[GetFirst(touching[i].key)] && isResting[GetSecond(touching[i].key)])
+			restingContacts.push_back(touching[i]);
+	}
+}
+
+// --------------------------------------------------------
+// Record a pair that passed the narrowphase
+//
+// key		- pair from ResolveCandidates, in the same order
+// point	- point of contact
+// normal	- pointing from the key's first proxy to its second
+// depth	- penetration along the normal
+// --------------------------------------------------------
+void CollisionPairCache::AddContact(CollisionPairKey key, const XMFLOAT3& point, const XMFLOAT3& normal, float depth)
+{
+	PairContact contact = { key, point, normal, depth };
+	contacts.push_back(contact);
+}
+
+// --------------------------------------------------------
+// Merge this frame's contacts with the last frame's.
+// Pairs only in this frame enter, pairs in both stay and
+// pairs only in the last frame exit.
+// --------------------------------------------------------
+void CollisionPairCache::EndFrame(std::vector<PairTransition>& transitions)
+{
+	// Resting pairs were never candidates, so both lists are sorted and disjoint
+	if (!restingContacts.empty()) {
+		mergedContacts.clear();
+		std::merge(contacts.begin(), contacts.end(), restingContacts.begin(), restingContacts.end(), std::back_inserter(mergedContacts),
+			[](const PairContact& a, const PairContact& b) { return a.key < b.key; });
+		contacts.swap(mergedContacts);
+	}
+
+	size_t prev = 0, curr = 0;
+	while (prev < touching.size() || curr < contacts.size()) {
+		PairTransition transition;
+		if (curr == contacts.size() || (prev < touching.size() && touching[prev].key < contacts[curr].key)) {
+			transition = { touching[prev].key, PAIR_EXIT, touching[prev].point, touching[prev].normal, touching[prev].depth };
+			prev++;
+		}
+		else if (prev == touching.size() || contacts[curr].key < touching[prev].key) {
+			transition = { contacts[curr].key, PAIR_ENTER, contacts[curr].point, contacts[curr].normal, contacts[curr].depth };
+			curr++;
+		}
+		else {
+			transition = { contacts[curr].key, PAIR_STAY, contacts[curr].point, contacts[curr].normal, contacts[curr].depth };
+			prev++;
+			curr++;
+		}
+		transitions.push_back(transition);
+	}
+
+	// This frame becomes the last frame, swapping keeps both allocations
+	touching.swap(contacts);
+}
+
+// --------------------------------------------------------
+// Remove every touching pair that uses the given proxy.
+// Removed pairs are reported as exits so the other collider
+// can be told.
+// --------------------------------------------------------
+void CollisionPairCache::RemoveProxy(unsigned int id, std::vector<PairTransition>& removed)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < touching.size(); i++) {
+		if (GetFirst(touching[i].key) == id || GetSecond(touching[i].key) == id) {
+			PairTransition transition = { touching[i].key, PAIR_EXIT, touching[i].point, touching[i].normal, touching[i].depth };
+			removed.push_back(transition);
+		}
+		else {
+			touching[kept++] = touching[i];
+		}
+	}
+	touching.resize(kept);
+}
+
+// --------------------------------------------------------
+// Forget every candidate and touching pair
+// --------------------------------------------------------
+void CollisionPairCache::Clear()
+{
+	BeginFrame();
+	touching.clear();
+	mergedContacts.clear();
+}
+
+// --------------------------------------------------------
+// Number of pairs that touched last frame
+// --------------------------------------------------------
+size_t CollisionPairCache::GetTouchingCount() const
+{
+	return touching.size();
+}
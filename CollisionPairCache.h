@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Unordered pair of collider proxy ids, lower id in the high 32 bits so
+// sorting keys groups pairs by their first collider
+typedef unsigned long long CollisionPairKey;
+
+// Keeps the set of touching collider pairs between frames.
+// Each frame the broadphase candidates are deduplicated so the narrowphase
+// runs once per pair, and the touching set is diffed against the previous
+// frame to produce enter/stay/exit transitions.
+class CollisionPairCache
+{
+public:
+	enum PairEvent { PAIR_ENTER, PAIR_STAY, PAIR_EXIT };
+
+	// Pair that touched this frame, or stopped touching for PAIR_EXIT
+	struct PairTransition {
+		CollisionPairKey key;
+		PairEvent event;
+		XMFLOAT3 point;
+		XMFLOAT3 normal;	// From the key's first proxy to its second
+		float depth;
+	};
+
+	CollisionPairCache();
+	~CollisionPairCache();
+
+	static CollisionPairKey MakeKey(unsigned int a, unsigned int b);
+	static unsigned int GetFirst(CollisionPairKey key);
+	static unsigned int GetSecond(CollisionPairKey key);
+
+	// Broadphase output, may contain duplicates
+	void BeginFrame();
+	void AddCandidate(unsigned int a, unsigned int b);
+
+	// Sorted candidates with duplicates removed
+	const std::vector<CollisionPairKey>& ResolveCandidates();
+
+	// Drop resolved candidates whose proxies are both resting, indexed by
+	// proxy id. Resting pairs that touched last frame touch again with the
+	// same contact, without going through the narrowphase.
+	void KeepRestingPairs(const std::vector<unsigned char>& isResting);
+
+	// Narrowphase output, must be added in candidate order
+	void AddContact(CollisionPairKey key, const XMFLOAT3& point, const XMFLOAT3& normal, float depth);
+
+	// Diff this frame's contacts against the last frame, fills transitions sorted by key
+	void EndFrame(std::vector<PairTransition>& transitions);
+
+	// Forget every touching pair that uses the proxy, the pairs are appended to removed
+	void RemoveProxy(unsigned int id, std::vector<PairTransition>& removed);
+
+	// Forget every pair without reporting them, keeping allocations
+	void Clear();
+
+	size_t GetTouchingCount() const;
+
+private:
+	struct PairContact {
+		CollisionPairKey key;
+		XMFLOAT3 point;
+		XMFLOAT3 normal;
+		float depth;
+	};
+
+	std::vector<CollisionPairKey> candidates;
+	std::vector<PairContact> touching;	// Last frame's contacts, sorted by key
+	std::vector<PairContact> contacts;	// This frame's contacts, sorted by key
+	std::vector<PairContact> restingContacts;	// Carried from the last frame, sorted by key
+	std::vector<PairContact> mergedContacts;
+};
+
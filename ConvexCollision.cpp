@@ -0,0 +1,435 @@
+#include "ConvexCollision.h"
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Support points GJK takes before calling a pair apart, pairs that are
+// still undecided by then are only just touching
+#define GJK_MAX_ITERATIONS 32
+
+// A new support point has to reach this much further than the simplex to
+// count as progress, relative to the search direction's length
+#define GJK_TOLERANCE 1e-5f
+
+// Polytope growth steps of EPA, and how close the support point has to be
+// to the nearest face before it is taken as the surface
+#define EPA_MAX_ITERATIONS 64
+#define EPA_MAX_VERTICES (EPA_MAX_ITERATIONS + 4)
+#define EPA_MAX_FACES 256
+#define EPA_MAX_EDGES 96
+#define EPA_TOLERANCE 1e-4f
+
+// Point of the difference a - b, with the point of a it came from
+struct SupportPoint {
+	XMVECTOR point;
+	XMVECTOR onA;
+};
+
+// Up to four support points, the newest last
+struct Simplex {
+	SupportPoint points[4];
+	int count;
+};
+
+// Triangle of the EPA polytope, wound so its normal points out
+struct EpaFace {
+	int vertices[3];
+	XMFLOAT3 normal;
+	float distance;	// From the origin along the normal
+};
+
+static inline float Dot(FXMVECTOR a, FXMVECTOR b)
+{
+	return XMVectorGetX(XMVector3Dot(a, b));
+}
+
+static inline float LengthSq(FXMVECTOR v)
+{
+	return XMVectorGetX(XMVector3LengthSq(v));
+}
+
+// --------------------------------------------------------
+// Furthest point of a shape along a direction. Hulls look
+// through their vertices with the direction taken into the
+// scaled box frame they are kept in.
+// --------------------------------------------------------
+XMVECTOR ConvexSupport(const ConvexShape & shape, FXMVECTOR direction)
+{
+	XMVECTOR point = XMLoadFloat3(&shape.center);
+	const float* half = &shape.halfExtents.x;
+
+	switch (shape.kind) {
+	case CONVEX_SPHERE:
+		if (LengthSq(direction) == 0) return point;
+		return point + XMVector3Normalize(direction) * shape.radius;
+
+	case CONVEX_BOX:
+		for (int k = 0; k < 3; k++) {
+			XMVECTOR axis = XMLoadFloat3(&shape.axes[k]);
+			point += axis * (Dot(direction, axis) < 0 ? -half[k] : half[k]);
+		}
+		return point;
+
+	default: {
+		float local[3];
+		for (int k = 0; k < 3; k++)
+			local[k] = Dot(direction, XMLoadFloat3(&shape.axes[k])) * half[k];
+
+		unsigned int furthest = 0;
+		float furthestDistance = -1e30f;
+		for (unsigned int i = 0; i < shape.vertexCount; i++) {
+			const XMFLOAT3& v = shape.vertices[i];
+			float distance = v.x * local[0] + v.y * local[1] + v.z * local[2];
+			if (distance > furthestDistance) {
+				furthestDistance = distance;
+				furthest = i;
+			}
+		}
+
+		const float* v = &shape.vertices[furthest].x;
+		for (int k = 0; k < 3; k++)
+			point += XMLoadFloat3(&shape.axes[k]) * (half[k] * v[k]);
+		return point;
+	}
+	}
+}
+
+// --------------------------------------------------------
+// Support point of a - b along a direction
+// --------------------------------------------------------
+static inline SupportPoint MinkowskiSupport(const ConvexShape& a, const ConvexShape& b, FXMVECTOR direction)
+{
+	SupportPoint support;
+	support.onA = ConvexSupport(a, direction);
+	support.point = support.onA - ConvexSupport(b, -direction);
+	return support;
+}
+
+// --------------------------------------------------------
+// Segment simplex, the newest point is a. Keeps the part
+// nearest the origin and points direction at it. Returns
+// true when the origin is on the segment.
+// --------------------------------------------------------
+static bool DoLine(Simplex& simplex, XMVECTOR& direction)
+{
+	XMVECTOR a = simplex.points[1].point;
+	XMVECTOR ab = simplex.points[0].point - a;
+	XMVECTOR ao = -a;
+
+	if (Dot(ab, ao) > 0) {
+		direction = XMVector3Cross(XMVector3Cross(ab, ao), ab);
+		return LengthSq(direction) == 0;
+	}
+
+	simplex.points[0] = simplex.points[1];
+	simplex.count = 1;
+	direction = ao;
+	return false;
+}
+
+// --------------------------------------------------------
+// Triangle simplex, the newest point is a. Returns true
+// when the origin is on the triangle.
+// --------------------------------------------------------
+static bool DoTriangle(Simplex& simplex, XMVECTOR& direction)
+{
+	XMVECTOR a = simplex.points[2].point;
+	XMVECTOR ab = simplex.points[1].point - a;
+	XMVECTOR ac = simplex.points[0].point - a;
+	XMVECTOR ao = -a;
+	XMVECTOR abc = XMVector3Cross(ab, ac);
+
+	// Beyond edge ac
+	if (Dot(XMVector3Cross(abc, ac), ao) > 0) {
+		if (Dot(ac, ao) > 0) {
+			simplex.points[1] = simplex.points[2];
+			simplex.count = 2;
+			direction = XMVector3Cross(XMVector3Cross(ac, ao), ac);
+			return LengthSq(direction) == 0;
+		}
+		simplex.points[0] = simplex.points[1];
+		simplex.points[1] = simplex.points[2];
+		simplex.count = 2;
+		return DoLine(simplex, direction);
+	}
+
+	// Beyond edge ab
+	if (Dot(XMVector3Cross(ab, abc), ao) > 0) {
+		simplex.points[0] = simplex.points[1];
+		simplex.points[1] = simplex.points[2];
+		simplex.count = 2;
+		return DoLine(simplex, direction);
+	}
+
+	// Above or below the triangle
+	float side = Dot(abc, ao);
+	if (side == 0) return true;
+	direction = side > 0 ? abc : -abc;
+	return false;
+}
+
+// --------------------------------------------------------
+// Tetrahedron simplex, the newest point is a. Drops to the
+// face the origin is beyond, if any. Returns true when the
+// origin is inside.
+// --------------------------------------------------------
+static bool DoTetrahedron(Simplex& simplex, XMVECTOR& direction)
+{
+	// The three faces through a, each with the point opposite it
+	static const int faces[3][3] = { { 2, 1, 0 }, { 1, 0, 2 }, { 0, 2, 1 } };
+
+	XMVECTOR a = simplex.points[3].point;
+	XMVECTOR ao = -a;
+	for (int f = 0; f < 3; f++) {
+		const SupportPoint& p = simplex.points[faces[f][0]];
+		const SupportPoint& q = simplex.points[faces[f][1]];
+		XMVECTOR normal = XMVector3Cross(p.point - a, q.point - a);
+		if (Dot(normal, simplex.points[faces[f][2]].point - a) > 0) normal = -normal;
+		if (Dot(normal, ao) > 0) {
+			SupportPoint face[3] = { q, p, simplex.points[3] };
+			simplex.points[0] = face[0];
+			simplex.points[1] = face[1];
+			simplex.points[2] = face[2];
+			simplex.count = 3;
+			return DoTriangle(simplex, direction);
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Pick the simplex case for the number of points
+// --------------------------------------------------------
+static bool DoSimplex(Simplex& simplex, XMVECTOR& direction)
+{
+	switch (simplex.count) {
+	case 2: return DoLine(simplex, direction);
+	case 3: return DoTriangle(simplex, direction);
+	default: return DoTetrahedron(simplex, direction);
+	}
+}
+
+// --------------------------------------------------------
+// Grow a simplex that ended on a point, segment or triangle
+// around the origin into a tetrahedron for EPA, with support
+// points off its line or plane. Returns false for shapes too
+// flat to make one.
+// --------------------------------------------------------
+static bool BlowUpSimplex(const ConvexShape& a, const ConvexShape& b, Simplex& simplex)
+{
+	static const XMFLOAT3 worldAxes[3] = { XMFLOAT3(1, 0, 0), XMFLOAT3(0, 1, 0), XMFLOAT3(0, 0, 1) };
+	const float epsilon = 1e-10f;
+
+	if (simplex.count == 1) {
+		for (int i = 0; i < 6 && simplex.count == 1; i++) {
+			XMVECTOR direction = XMLoadFloat3(&worldAxes[i >> 1]) * (i & 1 ? -1.0f : 1.0f);
+			SupportPoint p = MinkowskiSupport(a, b, direction);
+			if (LengthSq(p.point - simplex.points[0].point) > epsilon) simplex.points[simplex.count++] = p;
+		}
+	}
+
+	if (simplex.count == 2) {
+		XMVECTOR ab = simplex.points[1].point - simplex.points[0].point;
+		for (int i = 0; i < 6 && simplex.count == 2; i++) {
+			XMVECTOR direction = XMVector3Cross(ab, XMLoadFloat3(&worldAxes[i >> 1])) * (i & 1 ? -1.0f : 1.0f);
+			if (LengthSq(direction) <= epsilon) continue;
+			SupportPoint p = MinkowskiSupport(a, b, direction);
+			if (LengthSq(XMVector3Cross(ab, p.point - simplex.points[0].point)) > epsilon) simplex.points[simplex.count++] = p;
+		}
+	}
+
+	if (simplex.count == 3) {
+		XMVECTOR normal = XMVector3Cross(simplex.points[1].point - simplex.points[0].point, simplex.points[2].point - simplex.points[0].point);
+		for (int i = 0; i < 2 && simplex.count == 3; i++) {
+			SupportPoint p = MinkowskiSupport(a, b, i ? -normal : normal);
+			float height = Dot(p.point - simplex.points[0].point, normal);
+			if (height * height > epsilon * LengthSq(normal)) simplex.points[simplex.count++] = p;
+		}
+	}
+
+	return simplex.count == 4;
+}
+
+// --------------------------------------------------------
+// Set up a polytope face through three vertices. Faces too
+// thin to have a normal are never the nearest.
+// --------------------------------------------------------
+static void MakeFace(EpaFace& face, const SupportPoint* vertices, int i, int j, int k)
+{
+	face.vertices[0] = i;
+	face.vertices[1] = j;
+	face.vertices[2] = k;
+
+	XMVECTOR normal = XMVector3Cross(vertices[j].point - vertices[i].point, vertices[k].point - vertices[i].point);
+	float length = sqrtf(LengthSq(normal));
+	if (length == 0) {
+		face.normal = XMFLOAT3(0, 0, 0);
+		face.distance = 1e30f;
+		return;
+	}
+	normal /= length;
+	XMStoreFloat3(&face.normal, normal);
+	face.distance = Dot(normal, vertices[i].point);
+}
+
+// --------------------------------------------------------
+// Add an edge of a face being removed to the horizon, or
+// take it off if the face across it was removed already
+// --------------------------------------------------------
+static void AddHorizonEdge(int edges[][2], int& edgeCount, int from, int to)
+{
+	for (int e = 0; e < edgeCount; e++) {
+		if (edges[e][0] == to && edges[e][1] == from) {
+			edges[e][0] = edges[edgeCount - 1][0];
+			edges[e][1] = edges[edgeCount - 1][1];
+			edgeCount--;
+			return;
+		}
+	}
+	if (edgeCount < EPA_MAX_EDGES) {
+		edges[edgeCount][0] = from;
+		edges[edgeCount][1] = to;
+		edgeCount++;
+	}
+}
+
+// --------------------------------------------------------
+// Expanding polytope. Grows the tetrahedron around the
+// origin toward the surface of a - b until the face nearest
+// the origin is on it, which gives the normal and depth.
+// The contact point is that face's nearest point to the
+// origin carried over to shape a.
+// --------------------------------------------------------
+static void ExpandPolytope(const ConvexShape& a, const ConvexShape& b, const Simplex& simplex, ConvexContact& contact)
+{
+	SupportPoint vertices[EPA_MAX_VERTICES];
+	EpaFace faces[EPA_MAX_FACES];
+	int edges[EPA_MAX_EDGES][2];
+	int vertexCount = 4;
+	int faceCount = 4;
+	for (int i = 0; i < 4; i++)
+		vertices[i] = simplex.points[i];
+
+	// Wind the tetrahedron's faces away from its middle
+	static const int tetrahedron[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } };
+	XMVECTOR middle = (vertices[0].point + vertices[1].point + vertices[2].point + vertices[3].point) * 0.25f;
+	for (int f = 0; f < 4; f++) {
+		const int* v = tetrahedron[f];
+		XMVECTOR normal = XMVector3Cross(vertices[v[1]].point - vertices[v[0]].point, vertices[v[2]].point - vertices[v[0]].point);
+		if (Dot(normal, vertices[v[0]].point - middle) < 0)
+			MakeFace(faces[f], vertices, v[0], v[2], v[1]);
+		else
+			MakeFace(faces[f], vertices, v[0], v[1], v[2]);
+	}
+
+	int nearest = 0;
+	for (int iteration = 0; iteration < EPA_MAX_ITERATIONS; iteration++) {
+		nearest = 0;
+		for (int f = 1; f < faceCount; f++) {
+			if (faces[f].distance < faces[nearest].distance) nearest = f;
+		}
+
+		XMVECTOR normal = XMLoadFloat3(&faces[nearest].normal);
+		SupportPoint p = MinkowskiSupport(a, b, normal);
+		if (Dot(p.point, normal) - faces[nearest].distance < EPA_TOLERANCE || vertexCount == EPA_MAX_VERTICES) break;
+
+		// Remove every face the new point can see, keeping the edges
+		// around the hole they leave
+		int newVertex = vertexCount++;
+		vertices[newVertex] = p;
+		int edgeCount = 0;
+		for (int f = faceCount - 1; f >= 0; f--) {
+			const EpaFace& face = faces[f];
+			if (Dot(XMLoadFloat3(&face.normal), p.point - vertices[face.vertices[0]].point) <= 0) continue;
+			for (int e = 0; e < 3; e++)
+				AddHorizonEdge(edges, edgeCount, face.vertices[e], face.vertices[(e + 1) % 3]);
+			faces[f] = faces[--faceCount];
+		}
+
+		// Close the hole with faces to the new point
+		if (faceCount + edgeCount > EPA_MAX_FACES) break;
+		for (int e = 0; e < edgeCount; e++)
+			MakeFace(faces[faceCount++], vertices, edges[e][0], edges[e][1], newVertex);
+
+		nearest = 0;
+		for (int f = 1; f < faceCount; f++) {
+			if (faces[f].distance < faces[nearest].distance) nearest = f;
+		}
+	}
+
+	const EpaFace& face = faces[nearest];
+	XMVECTOR normal = XMLoadFloat3(&face.normal);
+	contact.normal = face.normal;
+	contact.depth = face.distance > 0 ? face.distance : 0.0f;
+
+	// Barycentric coordinates of the origin's projection on the face
+	const SupportPoint& v0 = vertices[face.vertices[0]];
+	const SupportPoint& v1 = vertices[face.vertices[1]];
+	const SupportPoint& v2 = vertices[face.vertices[2]];
+	XMVECTOR e0 = v1.point - v0.point;
+	XMVECTOR e1 = v2.point - v0.point;
+	XMVECTOR e2 = normal * face.distance - v0.point;
+	float d00 = Dot(e0, e0), d01 = Dot(e0, e1), d11 = Dot(e1, e1);
+	float d20 = Dot(e2, e0), d21 = Dot(e2, e1);
+	float denominator = d00 * d11 - d01 * d01;
+	float u = 0, v = 0;
+	if (denominator != 0) {
+		u = (d11 * d20 - d01 * d21) / denominator;
+		v = (d00 * d21 - d01 * d20) / denominator;
+	}
+	XMStoreFloat3(&contact.point, v0.onA * (1.0f - u - v) + v1.onA * u + v2.onA * v);
+}
+
+// --------------------------------------------------------
+// GJK over the difference a - b, which holds the origin
+// exactly when the shapes overlap
+// --------------------------------------------------------
+bool ConvexShapesOverlap(const ConvexShape & a, const ConvexShape & b, XMFLOAT3 & direction, ConvexContact * contact)
+{
+	XMVECTOR search = XMLoadFloat3(&direction);
+	if (LengthSq(search) == 0) search = XMLoadFloat3(&b.center) - XMLoadFloat3(&a.center);
+	if (LengthSq(search) == 0) search = XMVectorSet(1, 0, 0, 0);
+
+	// A direction the shapes are still apart along exits here
+	Simplex simplex;
+	simplex.points[0] = MinkowskiSupport(a, b, search);
+	simplex.count = 1;
+	if (Dot(simplex.points[0].point, search) < 0) {
+		XMStoreFloat3(&direction, XMVector3Normalize(search));
+		return false;
+	}
+	search = -simplex.points[0].point;
+
+	bool isOverlapping = LengthSq(search) == 0;
+	for (int iteration = 0; iteration < GJK_MAX_ITERATIONS && !isOverlapping; iteration++) {
+		SupportPoint p = MinkowskiSupport(a, b, search);
+		float reach = Dot(p.point, search);
+		if (reach < 0) break;
+
+		// No further out than the simplex already was, the origin is on the surface at most
+		if (reach - Dot(simplex.points[simplex.count - 1].point, search) <= GJK_TOLERANCE * sqrtf(LengthSq(search))) break;
+
+		simplex.points[simplex.count++] = p;
+		isOverlapping = DoSimplex(simplex, search) || LengthSq(search) == 0;
+	}
+
+	if (!isOverlapping) {
+		if (LengthSq(search) > 0) XMStoreFloat3(&direction, XMVector3Normalize(search));
+		return false;
+	}
+
+	if (contact != nullptr) {
+		if (BlowUpSimplex(a, b, simplex)) {
+			ExpandPolytope(a, b, simplex, *contact);
+		}
+		else {
+			// Too flat for a polytope, push apart along the centers
+			XMVECTOR centers = XMLoadFloat3(&b.center) - XMLoadFloat3(&a.center);
+			if (LengthSq(centers) == 0) centers = XMVectorSet(0, 1, 0, 0);
+			XMStoreFloat3(&contact->normal, XMVector3Normalize(centers));
+			XMStoreFloat3(&contact->point, simplex.points[0].onA);
+			contact->depth = 0;
+		}
+		direction = contact->normal;
+	}
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// What a convex shape's support point is taken from
+enum ConvexKind { CONVEX_SPHERE, CONVEX_BOX, CONVEX_HULL };
+
+// Convex shape as GJK sees it, through its furthest point in any direction.
+// Hulls keep their vertices in the box frame scaled to the box, as built by
+// ConvexHull, so one hull can serve any number of colliders.
+struct ConvexShape {
+	XMFLOAT3 center;
+	const XMFLOAT3* axes;		// Unit length box axes, as in ColliderWorldState
+	XMFLOAT3 halfExtents;		// Along the box axes
+	float radius;				// Spheres only
+	const XMFLOAT3* vertices;	// Hulls only
+	unsigned int vertexCount;
+	ConvexKind kind;
+};
+
+// Contact between two convex shapes
+struct ConvexContact {
+	float depth;		// Overlap along the normal
+	XMFLOAT3 normal;	// Pointing from shape a to shape b
+	XMFLOAT3 point;		// On the surface of shape a
+};
+
+// Furthest point of a shape along a direction, which need not be unit length
+XMVECTOR ConvexSupport(const ConvexShape& shape, FXMVECTOR direction);
+
+// GJK intersection test of two convex shapes. The search starts along
+// direction, and when the shapes are apart it is left holding a direction
+// from a to b they are separated along, so handing it back in next frame
+// lets a pair that is still apart exit after a single support point. A zero
+// direction starts from the line between the centers. When the shapes
+// overlap and contact is given, EPA fills it and direction is set to the
+// contact normal.
+bool ConvexShapesOverlap(const ConvexShape& a, const ConvexShape& b, XMFLOAT3& direction, ConvexContact* contact = nullptr);
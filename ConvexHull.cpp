@@ -0,0 +1,292 @@
+#include "ConvexHull.h"
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Directions the hull looks for its furthest points along, spread evenly
+// over the sphere, on top of the six box axes
+#define HULL_SAMPLE_DIRECTIONS 48
+
+// Rotations of the eigen solver before it gives up on the last bit of
+// precision, a 3x3 matrix is normally done within 6
+#define HULL_JACOBI_SWEEPS 32
+
+// --------------------------------------------------------
+// Point i of a strided array
+// --------------------------------------------------------
+static inline const XMFLOAT3& PointAt(const XMFLOAT3* points, unsigned int stride, unsigned int i)
+{
+	return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const char*>(points) + static_cast<size_t>(i) * stride);
+}
+
+// --------------------------------------------------------
+// Eigenvectors of a symmetric 3x3 matrix by Jacobi
+// rotations, as the columns of vectors. The matrix is
+// destroyed on the way.
+// --------------------------------------------------------
+static void SymmetricEigenvectors(float a[3][3], float vectors[3][3])
+{
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			vectors[i][j] = i == j ? 1.0f : 0.0f;
+
+	for (int sweep = 0; sweep < HULL_JACOBI_SWEEPS; sweep++) {
+		float offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+		float diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+		if (offDiagonal <= diagonal * 1e-12f) break;
+
+		for (int p = 0; p < 2; p++) {
+			for (int q = p + 1; q < 3; q++) {
+				if (a[p][q] == 0) continue;
+
+				// Rotation in the pq plane that zeroes a[p][q]
+				float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+				float t = (theta < 0 ? -1.0f : 1.0f) / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+				float c = 1.0f / sqrtf(t * t + 1.0f);
+				float s = t * c;
+
+				for (int k = 0; k < 3; k++) {
+					float kp = a[k][p], kq = a[k][q];
+					a[k][p] = c * kp - s * kq;
+					a[k][q] = s * kp + c * kq;
+				}
+				for (int k = 0; k < 3; k++) {
+					float pk = a[p][k], qk = a[q][k];
+					a[p][k] = c * pk - s * qk;
+					a[q][k] = s * pk + c * qk;
+				}
+				for (int k = 0; k < 3; k++) {
+					float kp = vectors[k][p], kq = vectors[k][q];
+					vectors[k][p] = c * kp - s * kq;
+					vectors[k][q] = s * kp + c * kq;
+				}
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+ConvexHull::ConvexHull() :
+	boxCenter(0, 0, 0),
+	boxRotation(0, 0, 0, 1),
+	boxHalfExtents(0, 0, 0),
+	alignedCenter(0, 0, 0),
+	alignedHalfExtents(0, 0, 0),
+	sphereRadius(0)
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+ConvexHull::~ConvexHull()
+{
+}
+
+// --------------------------------------------------------
+// Fit the boxes, sphere and hull to a set of points.
+//
+// points	- first point
+// count	- number of points
+// stride	- bytes from one point to the next
+// --------------------------------------------------------
+void ConvexHull::Build(const XMFLOAT3 * points, unsigned int count, unsigned int stride)
+{
+	vertices.clear();
+	if (points == nullptr || count == 0) return;
+
+	// Aligned box and the mean of the points
+	XMVECTOR low = XMLoadFloat3(&PointAt(points, stride, 0));
+	XMVECTOR high = low;
+	XMVECTOR mean = XMVectorZero();
+	for (unsigned int i = 0; i < count; i++) {
+		XMVECTOR p = XMLoadFloat3(&PointAt(points, stride, i));
+		low = XMVectorMin(low, p);
+		high = XMVectorMax(high, p);
+		mean += p;
+	}
+	mean /= static_cast<float>(count);
+	XMStoreFloat3(&alignedCenter, (low + high) * 0.5f);
+	XMStoreFloat3(&alignedHalfExtents, (high - low) * 0.5f);
+
+	// Covariance of the points, its eigenvectors are the principal axes
+	float covariance[3][3] = {};
+	sphereRadius = 0;
+	XMVECTOR aligned = XMLoadFloat3(&alignedCenter);
+	for (unsigned int i = 0; i < count; i++) {
+		XMVECTOR p = XMLoadFloat3(&PointAt(points, stride, i));
+		XMFLOAT3 d;
+		XMStoreFloat3(&d, p - mean);
+		const float* offset = &d.x;
+		for (int r = 0; r < 3; r++)
+			for (int c = r; c < 3; c++)
+				covariance[r][c] += offset[r] * offset[c];
+
+		float distance = XMVectorGetX(XMVector3Length(p - aligned));
+		if (distance > sphereRadius) sphereRadius = distance;
+	}
+	covariance[1][0] = covariance[0][1];
+	covariance[2][0] = covariance[0][2];
+	covariance[2][1] = covariance[1][2];
+
+	float eigenvectors[3][3];
+	SymmetricEigenvectors(covariance, eigenvectors);
+
+	// Right handed, so the axes make a rotation
+	XMVECTOR axes[3];
+	axes[0] = XMVector3Normalize(XMVectorSet(eigenvectors[0][0], eigenvectors[1][0], eigenvectors[2][0], 0));
+	axes[1] = XMVector3Normalize(XMVectorSet(eigenvectors[0][1], eigenvectors[1][1], eigenvectors[2][1], 0));
+	axes[2] = XMVector3Normalize(XMVector3Cross(axes[0], axes[1]));
+
+	// Extent of the points along the principal axes
+	float axisLow[3], axisHigh[3];
+	for (int k = 0; k < 3; k++)
+		axisLow[k] = axisHigh[k] = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&PointAt(points, stride, 0)), axes[k]));
+	for (unsigned int i = 1; i < count; i++) {
+		XMVECTOR p = XMLoadFloat3(&PointAt(points, stride, i));
+		for (int k = 0; k < 3; k++) {
+			float distance = XMVectorGetX(XMVector3Dot(p, axes[k]));
+			if (distance < axisLow[k]) axisLow[k] = distance;
+			if (distance > axisHigh[k]) axisHigh[k] = distance;
+		}
+	}
+
+	// Keep whichever box is smaller, the principal axes of a cube are any
+	// three directions at all
+	float half[3] = { (axisHigh[0] - axisLow[0]) * 0.5f, (axisHigh[1] - axisLow[1]) * 0.5f, (axisHigh[2] - axisLow[2]) * 0.5f };
+	float boxVolume = half[0] * half[1] * half[2];
+	float alignedVolume = alignedHalfExtents.x * alignedHalfExtents.y * alignedHalfExtents.z;
+	if (alignedVolume <= boxVolume) {
+		boxCenter = alignedCenter;
+		boxRotation = XMFLOAT4(0, 0, 0, 1);
+		boxHalfExtents = alignedHalfExtents;
+		axes[0] = XMVectorSet(1, 0, 0, 0);
+		axes[1] = XMVectorSet(0, 1, 0, 0);
+		axes[2] = XMVectorSet(0, 0, 1, 0);
+	}
+	else {
+		XMVECTOR center = XMVectorZero();
+		for (int k = 0; k < 3; k++)
+			center += axes[k] * ((axisLow[k] + axisHigh[k]) * 0.5f);
+		XMStoreFloat3(&boxCenter, center);
+		boxHalfExtents = XMFLOAT3(half[0], half[1], half[2]);
+
+		// Rows of the matrix are where the rotation takes the world axes
+		XMMATRIX rotation = XMMatrixIdentity();
+		rotation.r[0] = axes[0];
+		rotation.r[1] = axes[1];
+		rotation.r[2] = axes[2];
+		XMStoreFloat4(&boxRotation, XMQuaternionNormalize(XMQuaternionRotationMatrix(rotation)));
+	}
+
+	// Points in the box frame, scaled to the box, flat axes stay at 0
+	std::vector<XMFLOAT3> local(count);
+	XMVECTOR center = XMLoadFloat3(&boxCenter);
+	const float* boxHalf = &boxHalfExtents.x;
+	for (unsigned int i = 0; i < count; i++) {
+		XMVECTOR offset = XMLoadFloat3(&PointAt(points, stride, i)) - center;
+		float l[3];
+		for (int k = 0; k < 3; k++)
+			l[k] = boxHalf[k] > 0 ? XMVectorGetX(XMVector3Dot(offset, axes[k])) / boxHalf[k] : 0.0f;
+		local[i] = XMFLOAT3(l[0], l[1], l[2]);
+	}
+
+	// Furthest point along each direction, the box axes first then a
+	// Fibonacci spiral over the sphere
+	std::vector<unsigned char> isHullVertex(count, 0);
+	const float goldenAngle = XM_PI * (3.0f - sqrtf(5.0f));
+	for (int s = 0; s < 6 + HULL_SAMPLE_DIRECTIONS; s++) {
+		XMFLOAT3 direction;
+		if (s < 6) {
+			float axis[3] = { 0, 0, 0 };
+			axis[s >> 1] = s & 1 ? -1.0f : 1.0f;
+			direction = XMFLOAT3(axis[0], axis[1], axis[2]);
+		}
+		else {
+			int n = s - 6;
+			float z = 1.0f - (n + 0.5f) * 2.0f / HULL_SAMPLE_DIRECTIONS;
+			float ring = sqrtf(1.0f - z * z);
+			direction = XMFLOAT3(cosf(goldenAngle * n) * ring, sinf(goldenAngle * n) * ring, z);
+		}
+
+		unsigned int furthest = 0;
+		float furthestDistance = -1e30f;
+		for (unsigned int i = 0; i < count; i++) {
+			float distance = local[i].x * direction.x + local[i].y * direction.y + local[i].z * direction.z;
+			if (distance > furthestDistance) {
+				furthestDistance = distance;
+				furthest = i;
+			}
+		}
+		isHullVertex[furthest] = 1;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (isHullVertex[i]) vertices.push_back(local[i]);
+	}
+}
+
+// --------------------------------------------------------
+// Whether Build has been given any points
+// --------------------------------------------------------
+bool ConvexHull::IsEmpty() const
+{
+	return vertices.empty();
+}
+
+// --------------------------------------------------------
+// Center of the fitted oriented box
+// --------------------------------------------------------
+const XMFLOAT3 & ConvexHull::GetBoxCenter() const
+{
+	return boxCenter;
+}
+
+// --------------------------------------------------------
+// Rotation quaternion of the fitted oriented box
+// --------------------------------------------------------
+const XMFLOAT4 & ConvexHull::GetBoxRotation() const
+{
+	return boxRotation;
+}
+
+// --------------------------------------------------------
+// Half extents of the fitted oriented box along its axes
+// --------------------------------------------------------
+const XMFLOAT3 & ConvexHull::GetBoxHalfExtents() const
+{
+	return boxHalfExtents;
+}
+
+// --------------------------------------------------------
+// Center of the axis aligned bounding box
+// --------------------------------------------------------
+const XMFLOAT3 & ConvexHull::GetAlignedCenter() const
+{
+	return alignedCenter;
+}
+
+// --------------------------------------------------------
+// Half extents of the axis aligned bounding box
+// --------------------------------------------------------
+const XMFLOAT3 & ConvexHull::GetAlignedHalfExtents() const
+{
+	return alignedHalfExtents;
+}
+
+// --------------------------------------------------------
+// Radius of the bounding sphere around the aligned center
+// --------------------------------------------------------
+float ConvexHull::GetSphereRadius() const
+{
+	return sphereRadius;
+}
+
+// --------------------------------------------------------
+// Hull vertices in the box frame, scaled to the box
+// --------------------------------------------------------
+const std::vector<XMFLOAT3>& ConvexHull::GetVertices() const
+{
+	return vertices;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Bounding shapes fitted to a point cloud, such as the vertices of a mesh,
+// and a simplified convex hull of it. Built once when the mesh is loaded so
+// colliders can be fitted to the mesh instead of sized by hand.
+// The oriented box is found from the principal axes of the points, and the
+// hull keeps only the points that are furthest out along a fixed set of
+// directions, so it is a little inside the true hull but never has more
+// than a few dozen vertices for the support function to go through.
+class ConvexHull
+{
+public:
+	ConvexHull();
+	~ConvexHull();
+
+	// Fit to count points, stride bytes apart, so positions can be read
+	// straight out of an array of vertices
+	void Build(const XMFLOAT3* points, unsigned int count, unsigned int stride = sizeof(XMFLOAT3));
+
+	bool IsEmpty() const;
+
+	// Box along the principal axes of the points, or the aligned box when
+	// that is the smaller of the two
+	const XMFLOAT3& GetBoxCenter() const;
+	const XMFLOAT4& GetBoxRotation() const;
+	const XMFLOAT3& GetBoxHalfExtents() const;
+
+	// Axis aligned bounding box
+	const XMFLOAT3& GetAlignedCenter() const;
+	const XMFLOAT3& GetAlignedHalfExtents() const;
+
+	// Bounding sphere around the center of the aligned box
+	float GetSphereRadius() const;
+
+	// Hull vertices in the oriented box's frame, scaled so the box spans
+	// -1 to 1 on every axis. Scaling the box scales the hull with it.
+	const std::vector<XMFLOAT3>& GetVertices() const;
+
+private:
+	XMFLOAT3 boxCenter;
+	XMFLOAT4 boxRotation;
+	XMFLOAT3 boxHalfExtents;
+	XMFLOAT3 alignedCenter;
+	XMFLOAT3 alignedHalfExtents;
+	float sphereRadius;
+	std::vector<XMFLOAT3> vertices;
+};
@@ -2,6 +2,7 @@
 
 #include <WindowsX.h>
 #include <sstream>
+#include "PlatformWin32.h"
 #include "MemoryDebug.h"
 
 // Define the static instance variable so our OS-level 
@@ -51,11 +52,6 @@ DXWindow::DXWindow(
 	// Initialize fields
 	fpsFrameCount = 0;
 	fpsTimeElapsed = 0.0f;
-
-	// Query performance counter for accurate timing information
-	__int64 perfFreq;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&perfFreq);
-	perfCounterSeconds = 1.0 / (double)perfFreq;
 }
 
 // --------------------------------------------------------
@@ -156,77 +152,83 @@ HRESULT DXWindow::InitWindow()
 // --------------------------------------------------------
 HRESULT DXWindow::Run()
 {
-	// Grab the start time now that
-	// the game loop is running
-	__int64 now;
-	QueryPerformanceCounter((LARGE_INTEGER*)&now);
-	startTime = now;
-	currentTime = now;
-	previousTime = now;
-
-	// Give subclass a chance to initialize
-	Init();
-
-	// Our overall game and message loop
-	MSG msg = {};
-	while (msg.message != WM_QUIT)
-	{
-		// Determine if there is a message waiting
-		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-		{
-			// Translate and dispatch the message
-			// to our custom WindowProc function
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
-		}
-		else
-		{
-			// Update timer and title bar (if necessary)
-			UpdateTimer();
-			if (titleBarStats)
-				UpdateTitleBarStats();
-
-			// The game loop
-			Update(deltaTime, totalTime);
-			Draw(deltaTime, totalTime);
-		}
-	}
+	PlatformWin32 platform;
+	RunOn(platform);
 
 	// We'll end up here once we get a WM_QUIT message,
 	// which usually comes from the user closing the window
-	return msg.wParam;
+	return platform.GetExitCode();
+}
+
+// --------------------------------------------------------
+// Runs the game for a set number of frames, then returns.
+// The window stays up for the renderer and is not drawn to,
+// but its messages are still handled so it keeps responding,
+// and closing it ends the run early. Without a window, as on
+// a Linux build machine, Benchmark/SoakBenchmark soaks the
+// entities and collisions on PlatformHeadless instead.
+//
+// frames		- frames to run
+// frameTime	- seconds each frame covers, 0 for real time
+// inputScript	- input of each frame, none without one
+// --------------------------------------------------------
+HRESULT DXWindow::RunHeadless(unsigned int frames, float frameTime, InputScript inputScript)
+{
+	PlatformWin32Headless platform(frames, frameTime);
+	platform.SetInputScript(inputScript);
+	RunOn(platform);
+	return platform.GetExitCode();
+}
+
+// --------------------------------------------------------
+// Gives the subclass a chance to initialize, then runs the
+// frame loop on the platform until it stops
+// --------------------------------------------------------
+void DXWindow::RunOn(Platform& platform)
+{
+	Init();
+
+	frameLoop.Run(platform,
+		[this](float deltaTime, float totalTime) { Update(deltaTime, totalTime); },
+		[this](float deltaTime, float totalTime) {
+		if (titleBarStats)
+			UpdateTitleBarStats();
+		Draw(deltaTime, totalTime);
+	});
 }
 
 // --------------------------------------------------------
-// Sends an OS-level Quit message to our process, which
-// will be handled by our message processing function
+// Stops the game loop once the current frame is done
 // --------------------------------------------------------
 void DXWindow::Quit()
 {
-	PostQuitMessage(0);
+	frameLoop.Quit();
 }
 
 // --------------------------------------------------------
-// Uses high resolution time stamps to get very accurate
-// timing information, and calculates useful time stats
+// Sets how many fixed ticks the simulation runs a second
 // --------------------------------------------------------
-void DXWindow::UpdateTimer()
+void DXWindow::SetTickRate(float ticksPerSecond)
 {
-	// Grab the current time
-	__int64 now;
-	QueryPerformanceCounter((LARGE_INTEGER*)&now);
-	currentTime = now;
+	frameLoop.SetTickRate(ticksPerSecond);
+}
 
-	// Calculate delta time and clamp to zero
-	//  - Could go negative if CPU goes into power save mode 
-	//    or the process itself gets moved to another core
-	deltaTime = max((float)((currentTime - previousTime) * perfCounterSeconds), 0.0f);
+// --------------------------------------------------------
+// Sets the most ticks run to catch up in one frame
+// --------------------------------------------------------
+void DXWindow::SetMaxSubsteps(unsigned int maxSubsteps)
+{
+	frameLoop.SetMaxSubsteps(maxSubsteps);
+}
 
-	// Calculate the total time from start to now
-	totalTime = (float)((currentTime - startTime) * perfCounterSeconds);
+float DXWindow::GetTickDelta() const
+{
+	return frameLoop.GetTickDelta();
+}
 
-	// Save current time for next frame
-	previousTime = currentTime;
+float DXWindow::GetInterpolationAlpha() const
+{
+	return frameLoop.GetInterpolationAlpha();
 }
 
 // --------------------------------------------------------
@@ -241,7 +243,7 @@ void DXWindow::UpdateTitleBarStats()
 	fpsFrameCount++;
 
 	// Only calc FPS and update title bar once per second
-	float timeDiff = totalTime - fpsTimeElapsed;
+	float timeDiff = frameLoop.GetTotalTime() - fpsTimeElapsed;
 	if (timeDiff < 1.0f)
 		return;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <Windows.h>
 #include <string>
+#include "FrameLoop.h"
 
 class DXWindow
 {
@@ -32,7 +33,17 @@ public:
 	HRESULT Run();
 	void Quit();
 
-	// Pure virtual methods for setup and game functionality
+	// Runs a set number of frames without drawing, each frameTime long, with
+	// input from the script. The window's messages are still handled, but
+	// their input is not used. For profiling and soak tests on Windows: the
+	// renderer and EntityFactory still need the window and its device, so
+	// Benchmark/SoakBenchmark soaks the entity and collision stack elsewhere.
+	HRESULT RunHeadless(unsigned int frames, float frameTime, InputScript inputScript = nullptr);
+
+	// Pure virtual methods for setup and game functionality. Update runs the
+	// simulation in fixed ticks, as many per frame as the time passed calls
+	// for, given the tick length and the simulated time. Draw runs once a
+	// frame with the real frame time.
 	virtual void Init() = 0;
 	virtual void Update(float deltaTime, float totalTime) = 0;
 	virtual void Draw(float deltaTime, float totalTime) = 0;
@@ -51,6 +62,11 @@ public:
 	const POINTS& GetWindowLocation() const;
 	const HWND& GetWindowReference() const;
 
+	// Fixed timestep of the simulation
+	void SetTickRate(float ticksPerSecond);
+	void SetMaxSubsteps(unsigned int maxSubsteps);
+	float GetTickDelta() const;
+
 protected:
 	HINSTANCE	hInstance;		// The handle to the application
 	HWND		hWnd;			// The handle to the window itself
@@ -59,6 +75,10 @@ protected:
 
 	// Helper function for allocating a console window
 	void CreateConsoleWindow(int bufferLines, int bufferColumns, int windowLines, int windowColumns);
+
+	// How far the frame being drawn is from the last tick toward the next,
+	// from 0 to 1, for blending the last two ticks' states
+	float GetInterpolationAlpha() const;
 private:
 	// Rectangle location of window in screen space
 	POINTS windowLocation;
@@ -67,19 +87,14 @@ private:
 	unsigned int width;
 	unsigned int height;
 
-	// Timing related data
-	double perfCounterSeconds;
-	float totalTime;
-	float deltaTime;
-	__int64 startTime;
-	__int64 currentTime;
-	__int64 previousTime;
+	// Timing, input and the fixed timestep
+	FrameLoop frameLoop;
 
 	// FPS calculation
 	int fpsFrameCount;
 	float fpsTimeElapsed;
 
-	void UpdateTimer();			// Updates the timer for this frame
+	void RunOn(Platform& platform);	// Initializes the game and runs the loop on the platform
 	void UpdateTitleBarStats();	// Puts debug info in the title bar
 };
 
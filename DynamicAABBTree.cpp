@@ -0,0 +1,574 @@
+#include <algorithm>
+#include "DynamicAABBTree.h"
+#include "MemoryDebug.h"
+
+#define AABB_TREE_NULL_NODE -1
+
+// Fat bounds are stretched this many frames ahead along the movement
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 2.0f
+
+// --------------------------------------------------------
+// Smallest box containing both boxes
+// --------------------------------------------------------
+static void CombineBounds(const XMFLOAT3& aMin, const XMFLOAT3& aMax, const XMFLOAT3& bMin, const XMFLOAT3& bMax, XMFLOAT3& outMin, XMFLOAT3& outMax)
+{
+	outMin = XMFLOAT3(std::min(aMin.x, bMin.x), std::min(aMin.y, bMin.y), std::min(aMin.z, bMin.z));
+	outMax = XMFLOAT3(std::max(aMax.x, bMax.x), std::max(aMax.y, bMax.y), std::max(aMax.z, bMax.z));
+}
+
+// --------------------------------------------------------
+// Surface area of a box, the cost used to pick siblings
+// --------------------------------------------------------
+static float SurfaceArea(const XMFLOAT3& min, const XMFLOAT3& max)
+{
+	float x = max.x - min.x;
+	float y = max.y - min.y;
+	float z = max.z - min.z;
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+// --------------------------------------------------------
+// Surface area of the union of two boxes
+// --------------------------------------------------------
+static float CombinedSurfaceArea(const XMFLOAT3& aMin, const XMFLOAT3& aMax, const XMFLOAT3& bMin, const XMFLOAT3& bMax)
+{
+	XMFLOAT3 min, max;
+	CombineBounds(aMin, aMax, bMin, bMax, min, max);
+	return SurfaceArea(min, max);
+}
+
+// --------------------------------------------------------
+// True if the outer box fully contains the inner box
+// --------------------------------------------------------
+static bool ContainsBounds(const XMFLOAT3& outerMin, const XMFLOAT3& outerMax, const XMFLOAT3& innerMin, const XMFLOAT3& innerMax)
+{
+	return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z
+		&& innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+}
+
+// --------------------------------------------------------
+// True if the boxes overlap or touch
+// --------------------------------------------------------
+static bool OverlapsBounds(const XMFLOAT3& aMin, const XMFLOAT3& aMax, const XMFLOAT3& bMin, const XMFLOAT3& bMax)
+{
+	return aMin.x <= bMax.x && bMin.x <= aMax.x
+		&& aMin.y <= bMax.y && bMin.y <= aMax.y
+		&& aMin.z <= bMax.z && bMin.z <= aMax.z;
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// fatMargin	- distance leaf bounds are grown by on every side,
+//				  larger margins mean fewer reinserts but more
+//				  candidate pairs to reject
+// --------------------------------------------------------
+DynamicAABBTree::DynamicAABBTree(float fatMargin) :
+	root(AABB_TREE_NULL_NODE),
+	freeList(AABB_TREE_NULL_NODE),
+	fatMargin(fatMargin)
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+DynamicAABBTree::~DynamicAABBTree()
+{
+}
+
+// --------------------------------------------------------
+// Start tracking a proxy with a new leaf
+// --------------------------------------------------------
+void DynamicAABBTree::AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	if (id >= proxies.size())
+		proxies.resize(id + 1, { XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0), AABB_TREE_NULL_NODE });
+
+	Proxy& proxy = proxies[id];
+	proxy.min = XMFLOAT3(center.x - halfExtents.x, center.y - halfExtents.y, center.z - halfExtents.z);
+	proxy.max = XMFLOAT3(center.x + halfExtents.x, center.y + halfExtents.y, center.z + halfExtents.z);
+
+	int leaf = AllocateNode();
+	nodes[leaf].id = id;
+	nodes[leaf].height = 0;
+	ComputeFatBounds(id, XMFLOAT3(0, 0, 0), nodes[leaf].min, nodes[leaf].max);
+	proxies[id].node = leaf;
+
+	InsertLeaf(leaf);
+}
+
+// --------------------------------------------------------
+// Stop tracking a proxy, its leaf is removed right away so
+// the id can be reused
+// --------------------------------------------------------
+void DynamicAABBTree::RemoveProxy(unsigned int id)
+{
+	int leaf = proxies[id].node;
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	proxies[id].node = AABB_TREE_NULL_NODE;
+}
+
+// --------------------------------------------------------
+// Stop tracking every proxy, dropping the whole tree
+// instead of removing leaves one by one
+// --------------------------------------------------------
+void DynamicAABBTree::RemoveAllProxies()
+{
+	nodes.clear();
+	proxies.clear();
+	root = AABB_TREE_NULL_NODE;
+	freeList = AABB_TREE_NULL_NODE;
+}
+
+// --------------------------------------------------------
+// Store new bounds for a proxy. The tree only changes when
+// the bounds escape the fat box, or the fat box has become
+// much larger than needed (shrinking colliders).
+// --------------------------------------------------------
+void DynamicAABBTree::UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	Proxy& proxy = proxies[id];
+	XMFLOAT3 displacement(
+		center.x - 0.5f * (proxy.min.x + proxy.max.x),
+		center.y - 0.5f * (proxy.min.y + proxy.max.y),
+		center.z - 0.5f * (proxy.min.z + proxy.max.z));
+	proxy.min = XMFLOAT3(center.x - halfExtents.x, center.y - halfExtents.y, center.z - halfExtents.z);
+	proxy.max = XMFLOAT3(center.x + halfExtents.x, center.y + halfExtents.y, center.z + halfExtents.z);
+
+	XMFLOAT3 fatMin, fatMax;
+	ComputeFatBounds(id, displacement, fatMin, fatMax);
+
+	int leaf = proxy.node;
+	if (ContainsBounds(nodes[leaf].min, nodes[leaf].max, proxy.min, proxy.max)) {
+		float huge = 4.0f * fatMargin;
+		XMFLOAT3 hugeMin(fatMin.x - huge, fatMin.y - huge, fatMin.z - huge);
+		XMFLOAT3 hugeMax(fatMax.x + huge, fatMax.y + huge, fatMax.z + huge);
+		if (ContainsBounds(hugeMin, hugeMax, nodes[leaf].min, nodes[leaf].max))
+			return;
+	}
+
+	RemoveLeaf(leaf);
+	nodes[leaf].min = fatMin;
+	nodes[leaf].max = fatMax;
+	InsertLeaf(leaf);
+}
+
+// --------------------------------------------------------
+// Enumerate every pair of leaves whose bounds overlap by
+// descending the tree against itself. Subtrees that do not
+// overlap are skipped as a whole, and pairs are checked
+// against the tight bounds before being added.
+// --------------------------------------------------------
+void DynamicAABBTree::FindPairs(CollisionPairCache& pairCache)
+{
+	if (root == AABB_TREE_NULL_NODE)
+		return;
+
+	pairStack.clear();
+	pairStack.push_back(root);
+	pairStack.push_back(root);
+
+	while (!pairStack.empty()) {
+		int b = pairStack.back(); pairStack.pop_back();
+		int a = pairStack.back(); pairStack.pop_back();
+		const Node& nodeA = nodes[a];
+		const Node& nodeB = nodes[b];
+
+		// A subtree against itself, pair up its children
+		if (a == b) {
+			if (nodeA.child1 == AABB_TREE_NULL_NODE)
+				continue;
+			int child1 = nodeA.child1;
+			int child2 = nodeA.child2;
+			pairStack.push_back(child1); pairStack.push_back(child1);
+			pairStack.push_back(child2); pairStack.push_back(child2);
+			pairStack.push_back(child1); pairStack.push_back(child2);
+			continue;
+		}
+
+		if (!OverlapsBounds(nodeA.min, nodeA.max, nodeB.min, nodeB.max))
+			continue;
+
+		bool isLeafA = nodeA.child1 == AABB_TREE_NULL_NODE;
+		bool isLeafB = nodeB.child1 == AABB_TREE_NULL_NODE;
+		if (isLeafA && isLeafB) {
+			const Proxy& proxyA = proxies[nodeA.id];
+			const Proxy& proxyB = proxies[nodeB.id];
+			if (CanPair(nodeA.id, nodeB.id) && OverlapsBounds(proxyA.min, proxyA.max, proxyB.min, proxyB.max))
+				pairCache.AddCandidate(nodeA.id, nodeB.id);
+		}
+		// Descend into the larger subtree
+		else if (isLeafB || (!isLeafA && nodeA.height >= nodeB.height)) {
+			int child1 = nodeA.child1;
+			int child2 = nodeA.child2;
+			pairStack.push_back(child1); pairStack.push_back(b);
+			pairStack.push_back(child2); pairStack.push_back(b);
+		}
+		else {
+			int child1 = nodeB.child1;
+			int child2 = nodeB.child2;
+			pairStack.push_back(a); pairStack.push_back(child1);
+			pairStack.push_back(a); pairStack.push_back(child2);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Append the id of every proxy whose tight bounds overlap
+// the box to results
+// --------------------------------------------------------
+void DynamicAABBTree::QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results)
+{
+	if (root == AABB_TREE_NULL_NODE)
+		return;
+
+	XMFLOAT3 min(center.x - halfExtents.x, center.y - halfExtents.y, center.z - halfExtents.z);
+	XMFLOAT3 max(center.x + halfExtents.x, center.y + halfExtents.y, center.z + halfExtents.z);
+
+	queryStack.clear();
+	queryStack.push_back(root);
+	while (!queryStack.empty()) {
+		const Node& node = nodes[queryStack.back()];
+		queryStack.pop_back();
+
+		if (!OverlapsBounds(node.min, node.max, min, max))
+			continue;
+
+		if (node.child1 == AABB_TREE_NULL_NODE) {
+			const Proxy& proxy = proxies[node.id];
+			if (OverlapsBounds(proxy.min, proxy.max, min, max))
+				results.push_back(node.id);
+		}
+		else {
+			queryStack.push_back(node.child1);
+			queryStack.push_back(node.child2);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Append the id of every proxy whose tight bounds the
+// segment crosses to results. Subtrees are skipped as soon
+// as the segment misses their fat bounds.
+// --------------------------------------------------------
+void DynamicAABBTree::QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results)
+{
+	if (root == AABB_TREE_NULL_NODE)
+		return;
+
+	queryStack.clear();
+	queryStack.push_back(root);
+	while (!queryStack.empty()) {
+		const Node& node = nodes[queryStack.back()];
+		queryStack.pop_back();
+
+		if (!SegmentOverlapsBounds(origin, direction, maxDistance, node.min, node.max))
+			continue;
+
+		if (node.child1 == AABB_TREE_NULL_NODE) {
+			const Proxy& proxy = proxies[node.id];
+			if (SegmentOverlapsBounds(origin, direction, maxDistance, proxy.min, proxy.max))
+				results.push_back(node.id);
+		}
+		else {
+			queryStack.push_back(node.child1);
+			queryStack.push_back(node.child2);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Height of the root, 0 for a single leaf or an empty tree
+// --------------------------------------------------------
+int DynamicAABBTree::GetHeight() const
+{
+	return root == AABB_TREE_NULL_NODE ? 0 : nodes[root].height;
+}
+
+// --------------------------------------------------------
+// Take a node from the free list, growing the pool if it
+// is empty. May reallocate nodes.
+// --------------------------------------------------------
+int DynamicAABBTree::AllocateNode()
+{
+	if (freeList == AABB_TREE_NULL_NODE) {
+		nodes.push_back(Node());
+		freeList = static_cast<int>(nodes.size()) - 1;
+		nodes[freeList].parent = AABB_TREE_NULL_NODE;
+	}
+
+	int node = freeList;
+	freeList = nodes[node].parent;
+
+	Node& allocated = nodes[node];
+	allocated.parent = AABB_TREE_NULL_NODE;
+	allocated.child1 = AABB_TREE_NULL_NODE;
+	allocated.child2 = AABB_TREE_NULL_NODE;
+	allocated.height = 0;
+	allocated.id = 0;
+	return node;
+}
+
+// --------------------------------------------------------
+// Return a node to the free list
+// --------------------------------------------------------
+void DynamicAABBTree::FreeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+// --------------------------------------------------------
+// Insert a leaf next to the sibling that grows the total
+// surface area of the tree the least, then refit up
+// --------------------------------------------------------
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (root == AABB_TREE_NULL_NODE) {
+		root = leaf;
+		nodes[root].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	XMFLOAT3 leafMin = nodes[leaf].min;
+	XMFLOAT3 leafMax = nodes[leaf].max;
+
+	// Walk down choosing the cheaper child until stopping here is cheapest
+	int index = root;
+	while (nodes[index].child1 != AABB_TREE_NULL_NODE) {
+		const Node& node = nodes[index];
+		float area = SurfaceArea(node.min, node.max);
+		float combinedArea = CombinedSurfaceArea(node.min, node.max, leafMin, leafMax);
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+
+		// Cost pushed down to every ancestor by the leaf going lower
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++) {
+			const Node& child = nodes[children[i]];
+			float childCombined = CombinedSurfaceArea(child.min, child.max, leafMin, leafMax);
+			if (child.child1 == AABB_TREE_NULL_NODE)
+				childCosts[i] = childCombined + inheritanceCost;
+			else
+				childCosts[i] = childCombined - SurfaceArea(child.min, child.max) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+	int sibling = index;
+
+	// Replace the sibling with a new parent holding it and the leaf
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocateNode();
+	Node& parentNode = nodes[newParent];
+	parentNode.parent = oldParent;
+	parentNode.height = nodes[sibling].height + 1;
+	CombineBounds(leafMin, leafMax, nodes[sibling].min, nodes[sibling].max, parentNode.min, parentNode.max);
+	parentNode.child1 = sibling;
+	parentNode.child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != AABB_TREE_NULL_NODE) {
+		if (nodes[oldParent].child1 == sibling)
+			nodes[oldParent].child1 = newParent;
+		else
+			nodes[oldParent].child2 = newParent;
+	}
+	else {
+		root = newParent;
+	}
+
+	RefitAncestors(nodes[leaf].parent);
+}
+
+// --------------------------------------------------------
+// Unlink a leaf, its sibling takes the place of their
+// parent. The leaf node itself is kept.
+// --------------------------------------------------------
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root) {
+		root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != AABB_TREE_NULL_NODE) {
+		if (nodes[grandParent].child1 == parent)
+			nodes[grandParent].child1 = sibling;
+		else
+			nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		RefitAncestors(grandParent);
+	}
+	else {
+		root = sibling;
+		nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		FreeNode(parent);
+	}
+}
+
+// --------------------------------------------------------
+// Rebalance and recompute bounds and heights from a node
+// up to the root
+// --------------------------------------------------------
+void DynamicAABBTree::RefitAncestors(int node)
+{
+	while (node != AABB_TREE_NULL_NODE) {
+		node = Balance(node);
+
+		Node& current = nodes[node];
+		const Node& child1 = nodes[current.child1];
+		const Node& child2 = nodes[current.child2];
+		current.height = 1 + std::max(child1.height, child2.height);
+		CombineBounds(child1.min, child1.max, child2.min, child2.max, current.min, current.max);
+
+		node = current.parent;
+	}
+}
+
+// --------------------------------------------------------
+// If one child of a node is more than one level taller than
+// the other, rotate the taller child up into its place.
+// Returns the node now at the top of this subtree.
+// --------------------------------------------------------
+int DynamicAABBTree::Balance(int iA)
+{
+	Node& A = nodes[iA];
+	if (A.child1 == AABB_TREE_NULL_NODE || A.height < 2)
+		return iA;
+
+	int iB = A.child1;
+	int iC = A.child2;
+	Node& B = nodes[iB];
+	Node& C = nodes[iC];
+	int balance = C.height - B.height;
+
+	// Rotate C up
+	if (balance > 1) {
+		int iF = C.child1;
+		int iG = C.child2;
+		Node& F = nodes[iF];
+		Node& G = nodes[iG];
+
+		// A becomes a child of C
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if (C.parent != AABB_TREE_NULL_NODE) {
+			if (nodes[C.parent].child1 == iA)
+				nodes[C.parent].child1 = iC;
+			else
+				nodes[C.parent].child2 = iC;
+		}
+		else {
+			root = iC;
+		}
+
+		// The taller grandchild stays under C, the other moves to A
+		if (F.height > G.height) {
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			CombineBounds(B.min, B.max, G.min, G.max, A.min, A.max);
+			CombineBounds(A.min, A.max, F.min, F.max, C.min, C.max);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		}
+		else {
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			CombineBounds(B.min, B.max, F.min, F.max, A.min, A.max);
+			CombineBounds(A.min, A.max, G.min, G.max, C.min, C.max);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1) {
+		int iD = B.child1;
+		int iE = B.child2;
+		Node& D = nodes[iD];
+		Node& E = nodes[iE];
+
+		// A becomes a child of B
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != AABB_TREE_NULL_NODE) {
+			if (nodes[B.parent].child1 == iA)
+				nodes[B.parent].child1 = iB;
+			else
+				nodes[B.parent].child2 = iB;
+		}
+		else {
+			root = iB;
+		}
+
+		// The taller grandchild stays under B, the other moves to A
+		if (D.height > E.height) {
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			CombineBounds(C.min, C.max, E.min, E.max, A.min, A.max);
+			CombineBounds(A.min, A.max, D.min, D.max, B.min, B.max);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		}
+		else {
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			CombineBounds(C.min, C.max, D.min, D.max, A.min, A.max);
+			CombineBounds(A.min, A.max, E.min, E.max, B.min, B.max);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+// --------------------------------------------------------
+// Tight bounds of a proxy grown by the margin and stretched
+// along its last movement, so fast colliders like
+// projectiles do not need reinserting every frame
+// --------------------------------------------------------
+void DynamicAABBTree::ComputeFatBounds(unsigned int id, const XMFLOAT3& displacement, XMFLOAT3& fatMin, XMFLOAT3& fatMax) const
+{
+	const Proxy& proxy = proxies[id];
+	fatMin = XMFLOAT3(proxy.min.x - fatMargin, proxy.min.y - fatMargin, proxy.min.z - fatMargin);
+	fatMax = XMFLOAT3(proxy.max.x + fatMargin, proxy.max.y + fatMargin, proxy.max.z + fatMargin);
+
+	const float* d = &displacement.x;
+	float* lo = &fatMin.x;
+	float* hi = &fatMax.x;
+	for (int axis = 0; axis < 3; axis++) {
+		float stretch = AABB_TREE_DISPLACEMENT_MULTIPLIER * d[axis];
+		if (stretch < 0)
+			lo[axis] += stretch;
+		else
+			hi[axis] += stretch;
+	}
+}
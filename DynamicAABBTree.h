@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "Broadphase.h"
+
+using namespace DirectX;
+
+// Dynamic bounding volume tree broadphase.
+// Every proxy is a leaf holding a fattened copy of its bounds, so small
+// movements do not touch the tree at all. A proxy that leaves its fat bounds
+// is removed and reinserted, which refits only the path from the leaf to the
+// root and rotates unbalanced nodes on the way up. Unlike the grids there is
+// no cell size, so colliders of very different sizes cost the same.
+class DynamicAABBTree :
+	public Broadphase
+{
+public:
+	DynamicAABBTree(float fatMargin = 0.05f);
+	~DynamicAABBTree();
+
+	// Inherited via Broadphase
+	void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void RemoveProxy(unsigned int id) override;
+	void RemoveAllProxies() override;
+	void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void FindPairs(CollisionPairCache& pairCache) override;
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) override;
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) override;
+
+	int GetHeight() const;	// Height of the root, 0 for a single leaf
+
+private:
+	struct Node {
+		XMFLOAT3 min;	// Fat bounds for leaves, union of children otherwise
+		XMFLOAT3 max;
+		int parent;		// Next free node while on the free list
+		int child1;		// -1 for leaves
+		int child2;
+		int height;		// 0 for leaves, -1 while free
+		unsigned int id;	// Proxy id of a leaf
+	};
+
+	// Tight bounds and leaf of every proxy, indexed by proxy id
+	struct Proxy {
+		XMFLOAT3 min;
+		XMFLOAT3 max;
+		int node;		// -1 when not tracked
+	};
+
+	std::vector<Node> nodes;
+	std::vector<Proxy> proxies;
+	int root;
+	int freeList;
+	float fatMargin;
+
+	// Traversal stacks, kept to avoid allocating every frame
+	std::vector<int> queryStack;
+	std::vector<int> pairStack;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	void RefitAncestors(int node);
+	int Balance(int node);
+	void ComputeFatBounds(unsigned int id, const XMFLOAT3& displacement, XMFLOAT3& fatMin, XMFLOAT3& fatMax) const;
+};
@@ -1,5 +1,7 @@
 #include "Entity.h"
 #include "EntityFactory.h"
+#include "Mesh.h"
+#include "Renderer.h"
 #include "MemoryDebug.h"
 
 // --------------------------------------------------------
@@ -26,7 +28,8 @@ Entity::Entity(EntityFactory* entityFactory, std::string name, Mesh* mesh, Mater
 // --------------------------------------------------------
 Entity::~Entity()
 {
-	if (collider != nullptr) delete collider;
+	// The collider is in the factory's arena, freed with the scene
+	if (storeId != ENTITY_STORE_NONE) entityFactory->GetEntityStore().Destroy(storeId);
 }
 
 /*
@@ -60,6 +63,16 @@ void Entity::SetEntityFactory(EntityFactory* entityFactory)
 	this->entityFactory = entityFactory;
 }
 
+EntityStore& Entity::GetEntityStore() const
+{
+	return entityFactory->GetEntityStore();
+}
+
+void Entity::EmitParticles(ParticleEmitter* emitter)
+{
+	entityFactory->EmitParticles(emitter);
+}
+
 void Entity::SetIsUpdating(bool isUpdating)
 {
 	// Adds/Removes entity from the list of updating entities
@@ -140,15 +153,32 @@ Material * const Entity::GetMaterial() const
 	return material;
 }
 
-void Entity::SetCollider(Collider::ColliderType type, XMFLOAT3 scale, XMFLOAT3 offset, XMFLOAT4 rotation)
+void Entity::SetCollider(Collider::ColliderType type, XMFLOAT3 scale, XMFLOAT3 offset, XMFLOAT4 rotation, unsigned int layer)
 {
 	// Check if the entity already has a collider (an existing collider can be edited directly)
 	if (collider != nullptr) {
 		return;
 	}
 	// Creates collider object
-	collider = new Collider(type, offset, scale, rotation);
+	collider = entityFactory->GetSceneArena().Create<Collider>(type, offset, scale, rotation);
 	collider->SetParentEntity(this);
+	collider->SetLayer(layer);
+
+	// Set the entity as collidable
+	entityFactory->SetEntityCollision(this, true);
+}
+
+void Entity::SetCollider(Collider::ColliderType type, Mesh * mesh, unsigned int layer)
+{
+	// Check if the entity already has a collider (an existing collider can be edited directly)
+	if (collider != nullptr) {
+		return;
+	}
+	// Creates collider object sized from the mesh, it follows the entity's scale from here on
+	assert(mesh != nullptr);
+	collider = entityFactory->GetSceneArena().Create<Collider>(type, mesh->GetConvexHull());
+	collider->SetParentEntity(this);
+	collider->SetLayer(layer);
 
 	// Set the entity as collidable
 	entityFactory->SetEntityCollision(this, true);
@@ -156,7 +186,8 @@ void Entity::SetCollider(Collider::ColliderType type, XMFLOAT3 scale, XMFLOAT3 o
 
 void Entity::SetName(std::string name)
 {
-	this->name = name;
+	// Renames the entity in the factory's name index
+	entityFactory->SetEntityName(this, name);
 }
 
 Collider * const Entity::GetCollider() const
@@ -169,24 +200,65 @@ std::string Entity::GetName() const
 	return this->name;
 }
 
-bool Entity::HasTag(std::string tag)
+EntityHandle Entity::GetHandle() const
+{
+	return this->handle;
+}
+
+bool Entity::HasTag(std::string tag) const
 {
-	return std::find(tags.begin(), tags.end(), tag) != tags.end();
+	// A name never interned is a tag nothing has
+	unsigned int index = TagTable::Find(tag);
+	return index != ENTITY_TAG_NONE && (tags & TAG_BIT(index)) != 0;
+}
+
+bool Entity::HasTag(TagMask tag) const
+{
+	return (tags & tag) != 0;
+}
+
+bool Entity::HasAnyTag(TagMask tags) const
+{
+	return (this->tags & tags) != 0;
+}
+
+bool Entity::HasAllTags(TagMask tags) const
+{
+	return (this->tags & tags) == tags;
 }
 
 void Entity::AddTag(std::string tag)
 {
-	this->tags.push_back(tag);
+	// Keeps the factory's tag lists in step
+	entityFactory->SetEntityTags(this, tags | TagTable::GetMask(tag));
 }
 
 void Entity::RemoveTag(std::string tag)
 {
-	auto iter = std::find(tags.begin(), tags.end(), tag);
-	
-	if (iter != tags.end())
-		tags.erase(iter);
+	unsigned int index = TagTable::Find(tag);
+	if (index != ENTITY_TAG_NONE)
+		entityFactory->SetEntityTags(this, tags & ~TAG_BIT(index));
+}
+
+TagMask Entity::GetTags() const
+{
+	return tags;
+}
+
+void Entity::OnCollision(const Collision& collision)
+{
+}
+
+void Entity::OnCollisionEnter(const Collision& collision)
+{
+	OnCollision(collision);
+}
+
+void Entity::OnCollisionStay(const Collision& collision)
+{
+	OnCollision(collision);
 }
 
-void Entity::OnCollision(Collision collision)
+void Entity::OnCollisionExit(const Collision& collision)
 {
 }
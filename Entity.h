@@ -1,20 +1,21 @@
 #pragma once
-#include "Mesh.h"
-#include "Material.h"
-#include "MaterialParallax.h"
 #include "Transform.h"
 #include "Collider.h"
-#include "Renderer.h"
+#include "EntityStore.h"
+#include "EntityRegistry.h"
 
-class Renderer; 
+class Mesh;
+class Material;
 class EntityFactory;
+class ParticleEmitter;
 
-// Created on a collision of two entities
+// Created on a collision of two entities, only valid during the callback
 struct Collision {
-	Entity* otherEntity;
-	Collider* otherCollider;
-	Transform otherTransform;
+	Entity* otherEntity;	// Null on an exit owed by an entity released since
+	Collider* otherCollider;	// Null on an exit owed by a collider unstaged since
 	XMFLOAT3 point;
+	XMFLOAT3 normal;	// Pointing from this entity's collider toward the other's
+	float depth;		// Penetration along the normal
 };
 
 // Base type of all entities.
@@ -37,8 +38,15 @@ public:
 	virtual void Update(float deltaTime, float totalTime) = 0;
 	//void PrepareMaterial(SimpleVertexShader* const vertexShader);
 
-	// Called when this entity collides with another entity.
-	virtual void OnCollision(Collision collision);
+	// Called once per frame for each entity this entity is touching.
+	virtual void OnCollision(const Collision& collision);
+
+	// Called on the first frame this entity touches another entity. Calls OnCollision by default.
+	virtual void OnCollisionEnter(const Collision& collision);
+	// Called on following frames while still touching. Calls OnCollision by default.
+	virtual void OnCollisionStay(const Collision& collision);
+	// Called once after this entity stops touching another entity.
+	virtual void OnCollisionExit(const Collision& collision);
 
 	// Public transform so we can access information!
 	Transform transform;
@@ -56,17 +64,42 @@ public:
 
 	void SetMesh(Mesh* mesh);
 	void SetMaterial(Material* material);
-	void SetCollider(Collider::ColliderType type, XMFLOAT3 scale = XMFLOAT3(0, 0, 0), XMFLOAT3 offset = XMFLOAT3(0, 0, 0), XMFLOAT4 rotation = XMFLOAT4(0, 0, 0, 0));
+	void SetCollider(Collider::ColliderType type, XMFLOAT3 scale = XMFLOAT3(0, 0, 0), XMFLOAT3 offset = XMFLOAT3(0, 0, 0), XMFLOAT4 rotation = XMFLOAT4(0, 0, 0, 0), unsigned int layer = LAYER_DEFAULT);
+	void SetCollider(Collider::ColliderType type, Mesh* mesh, unsigned int layer = LAYER_DEFAULT);	// Fitted to the mesh
 	void SetName(std::string name);
 	Mesh * const GetMesh() const;
 	Material * const GetMaterial() const;
 	Collider * const GetCollider() const;
 	std::string GetName() const;
+	EntityHandle GetHandle() const;	// Resolves through the entity factory
 
 	// Tags - Used mainly to identify during collisions
-	bool HasTag(std::string tag);
+	// Names are interned in the TagTable, code testing tags every contact
+	// keeps the mask from TagTable::GetMask and tests that instead.
+	bool HasTag(std::string tag) const;
+	bool HasTag(TagMask tag) const;
+	bool HasAnyTag(TagMask tags) const;
+	bool HasAllTags(TagMask tags) const;
 	void AddTag(std::string tag);
 	void RemoveTag(std::string tag);
+	TagMask GetTags() const;
+
+protected:
+	// Id in the factory's entity store of entities whose per frame movement
+	// runs as store systems, ENTITY_STORE_NONE for the rest
+	unsigned int storeId = ENTITY_STORE_NONE;
+
+	// Set by entities whose Update touches nothing but their own members,
+	// emitters and store row, which the factory then updates in parallel.
+	// Their changes to the factory's lists and their emits go through it
+	// and are replayed after.
+	bool isUpdateIndependent = false;
+
+	// Store of the factory holding this entity
+	EntityStore& GetEntityStore() const;
+
+	// Emits through the factory, deferred while updating in parallel
+	void EmitParticles(ParticleEmitter* emitter);
 
 private:
 	// Pointer to the entity factory that holds this entity
@@ -76,10 +109,12 @@ private:
 	bool isUpdating = false;
 	bool isRendering = false;
 	bool isColliding = false;
+	bool isDestroyed = false;	// Waiting in the factory to be freed
 
 	// Identifiers
+	EntityHandle handle = { ENTITY_SLOT_NONE, 0 };
 	std::string name;
-	std::vector<std::string> tags;
+	TagMask tags = 0;
 
 	// Mesh class this entity will draw with
 	Mesh* mesh = nullptr;
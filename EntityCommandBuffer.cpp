@@ -0,0 +1,88 @@
+#include "EntityCommandBuffer.h"
+#include <algorithm>
+#include "EntityFactory.h"
+#include "MemoryDebug.h"
+
+void EntityCommandBuffer::SetOrder(unsigned int order)
+{
+	this->order = order;
+}
+
+void EntityCommandBuffer::SetUpdating(Entity* entity, bool isUpdating)
+{
+	Record(ENTITY_COMMAND_UPDATING, entity, nullptr, isUpdating);
+}
+
+void EntityCommandBuffer::SetRendering(Entity* entity, bool isRendering)
+{
+	Record(ENTITY_COMMAND_RENDERING, entity, nullptr, isRendering);
+}
+
+void EntityCommandBuffer::SetColliding(Entity* entity, bool isColliding)
+{
+	Record(ENTITY_COMMAND_COLLIDING, entity, nullptr, isColliding);
+}
+
+void EntityCommandBuffer::Emit(ParticleEmitter* emitter)
+{
+	Record(ENTITY_COMMAND_EMIT, nullptr, emitter, true);
+}
+
+void EntityCommandBuffer::Destroy(Entity* entity)
+{
+	Record(ENTITY_COMMAND_DESTROY, entity, nullptr, true);
+}
+
+// --------------------------------------------------------
+// Apply every buffer's commands in the order of the
+// entities that recorded them. The factory must not be
+// deferring commands any more.
+// --------------------------------------------------------
+void EntityCommandBuffer::Replay(std::vector<EntityCommandBuffer>& buffers, std::vector<const EntityCommand*>& replayOrder, EntityFactory& entityFactory)
+{
+	// Each entity is updated on one thread, so its commands are together in
+	// one buffer and their place in it orders them. No two commands share
+	// both, so a plain sort gives the same order every time without the
+	// buffer a stable sort allocates.
+	std::vector<const EntityCommand*>& commands = replayOrder;
+	commands.clear();
+	for (size_t b = 0; b < buffers.size(); b++) {
+		for (size_t i = 0; i < buffers[b].commands.size(); i++)
+			commands.push_back(&buffers[b].commands[i]);
+	}
+	std::sort(commands.begin(), commands.end(), [](const EntityCommand* a, const EntityCommand* b) {
+		return a->order < b->order || (a->order == b->order && a->sequence < b->sequence);
+	});
+
+	for (size_t i = 0; i < commands.size(); i++) {
+		const EntityCommand& command = *commands[i];
+		switch (command.type)
+		{
+		case ENTITY_COMMAND_UPDATING:
+			entityFactory.SetEntityUpdating(command.entity, command.value);
+			break;
+		case ENTITY_COMMAND_RENDERING:
+			entityFactory.SetEntityRendering(command.entity, command.value);
+			break;
+		case ENTITY_COMMAND_COLLIDING:
+			entityFactory.SetEntityCollision(command.entity, command.value);
+			break;
+		case ENTITY_COMMAND_EMIT:
+			entityFactory.EmitParticles(command.emitter);
+			break;
+		case ENTITY_COMMAND_DESTROY:
+			entityFactory.DestroyEntity(command.entity);
+			break;
+		}
+	}
+
+	commands.clear();
+	for (size_t b = 0; b < buffers.size(); b++)
+		buffers[b].commands.clear();
+}
+
+void EntityCommandBuffer::Record(EntityCommandType type, Entity* entity, ParticleEmitter* emitter, bool value)
+{
+	EntityCommand command = { order, static_cast<unsigned int>(commands.size()), type, entity, emitter, value };
+	commands.push_back(command);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+
+class Entity;
+class EntityFactory;
+class ParticleEmitter;
+
+// What a deferred command does
+enum EntityCommandType {
+	ENTITY_COMMAND_UPDATING,	// SetIsUpdating
+	ENTITY_COMMAND_RENDERING,	// SetIsRendering
+	ENTITY_COMMAND_COLLIDING,	// SetIsColliding
+	ENTITY_COMMAND_EMIT,		// ParticleEmitter::Emit
+	ENTITY_COMMAND_DESTROY		// EntityFactory::DestroyEntity
+};
+
+struct EntityCommand {
+	unsigned int order;			// Place in the update of the entity recording it
+	unsigned int sequence;		// Place in the buffer recording it
+	EntityCommandType type;
+	Entity* entity;				// Null for emits
+	ParticleEmitter* emitter;	// Null for everything else
+	bool value;
+};
+
+// Changes to the factory's lists, the managers' staging and emitters, recorded
+// by one thread while entities update in parallel and replayed on the main
+// thread after. Commands are replayed in the order of the entities that
+// recorded them, whichever thread updated each, so staging and with it proxy
+// ids and collision order come out the same for any number of threads.
+class EntityCommandBuffer
+{
+public:
+	// Commands from here on are recorded by the entity at this place in the update
+	void SetOrder(unsigned int order);
+
+	void SetUpdating(Entity* entity, bool isUpdating);
+	void SetRendering(Entity* entity, bool isRendering);
+	void SetColliding(Entity* entity, bool isColliding);
+	void Emit(ParticleEmitter* emitter);
+	void Destroy(Entity* entity);
+
+	// Run the commands of every buffer through the factory, in entity order and
+	// the order recorded for each entity, and empty the buffers. The commands
+	// are sorted in replayOrder, kept by the caller so replaying every frame
+	// does not allocate once it has grown.
+	static void Replay(std::vector<EntityCommandBuffer>& buffers, std::vector<const EntityCommand*>& replayOrder, EntityFactory& entityFactory);
+
+private:
+	std::vector<EntityCommand> commands;
+	unsigned int order = 0;
+
+	void Record(EntityCommandType type, Entity* entity, ParticleEmitter* emitter, bool value);
+};
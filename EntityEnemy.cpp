@@ -1,4 +1,5 @@
 #include "EntityEnemy.h"
+#include "Renderer.h"
 #include "MemoryDebug.h"
 
 using namespace DirectX;
@@ -8,15 +9,25 @@ EntityEnemy::EntityEnemy(EntityFactory* entityFactory, std::string name, Mesh *
 {
 	// Add enemy tag
 	this->AddTag("Enemy");
+	this->target = nullptr;
+
+	// Movement, spin and regeneration run in the entity store
+	EntityStore& store = GetEntityStore();
+	storeId = store.Create(
+		COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY) | COMPONENT_BIT(COMPONENT_SEEK)
+		| COMPONENT_BIT(COMPONENT_SPIN) | COMPONENT_BIT(COMPONENT_HEALTH),
+		&transform);
 
 	// Default values
-	this->speed = 1.0f;
-	this->health = 0.000001f;
-	this->healthMax = 1.0f;
-	this->maxScale = 0.25;
+	store.GetVelocity(storeId)->speed = 1.0f;
+	HealthComponent* health = store.GetHealth(storeId);
+	health->health = 0.000001f;
+	health->healthMax = 1.0f;
+	health->maxScale = 0.25f;
+	health->regeneration = 0.25f;	// Regenerate health overtime
 
 	// Create a unique rotation axis for this enemy
-	this->rotationAxis = XMFLOAT3(rand() % 100 - 50.0f, rand() % 100 - 50.0f, rand() % 100 - 50.0f);
+	store.GetSpin(storeId)->axis = XMFLOAT3(rand() % 100 - 50.0f, rand() % 100 - 50.0f, rand() % 100 - 50.0f);
 
 	// Cast the current material into an Enemy Material so it can be modified as such.
 	this->enemyMaterial = dynamic_cast<MaterialEnemy*>(this->GetMaterial());
@@ -50,22 +61,8 @@ EntityEnemy::~EntityEnemy()
 
 void EntityEnemy::Update(float deltaTime, float totalTime)
 {
-	// If there is a target
-	if (target != NULL) {
-		XMStoreFloat3(
-			&direction,	// Store the direction towards the target
-			XMVector3Normalize(XMLoadFloat3( target->transform.GetPosition()) - XMLoadFloat3(transform.GetPosition()))
-			);
-
-		// Move towards target
-		transform.Move(direction.x * deltaTime * speed, direction.y * deltaTime * speed, direction.z * deltaTime * speed);
-	}
-
-	// Update the rotation of the entity
-	transform.SetRotation(rotationAxis.x, rotationAxis.y, rotationAxis.z, totalTime);
-
-	// Regenerate health overtime
-	ChangeHealth(0.25f * deltaTime);
+	// Moving towards the target, spinning and regenerating are done by the
+	// entity store systems before this runs
 
 	// If we have the enemy material, update the total time for it.
 	if (enemyMaterial != nullptr) {
@@ -76,71 +73,77 @@ void EntityEnemy::Update(float deltaTime, float totalTime)
 void EntityEnemy::MoveToRandomPosition()
 { 
 	// Find a random place to respawn the enemy.
-	transform.SetPosition(rand() % 10 - 5.0f, rand() % 10 - 5.0f, 0.0f);
+	EntityStore& store = GetEntityStore();
+	store.GetTransform(storeId)->position = XMFLOAT3(rand() % 10 - 5.0f, rand() % 10 - 5.0f, 0.0f);
+	store.WriteTransform(storeId);
+	transform.ResetPrevious();	// Appears there, rather than sliding over
 }
 
 void EntityEnemy::SetSpeed(float speed)
 {
-	this->speed = speed;
+	GetEntityStore().GetVelocity(storeId)->speed = speed;
 }
 
 float EntityEnemy::GetSpeed()
 {
-	return this->speed;
+	return GetEntityStore().GetVelocity(storeId)->speed;
 }
 
 void EntityEnemy::SetHealth(float health)
 {
-	this->health = health;
+	GetEntityStore().GetHealth(storeId)->health = health;
 }
 
 float EntityEnemy::GetHealth()
 {
-	return this->health;
+	return GetEntityStore().GetHealth(storeId)->health;
 }
 
 void EntityEnemy::SetMaxHealth(float healthMax)
 {
-	this->healthMax = healthMax;
+	GetEntityStore().GetHealth(storeId)->healthMax = healthMax;
 }
 
 float EntityEnemy::GetMaxHealth()
 {
-	return this->healthMax;
+	return GetEntityStore().GetHealth(storeId)->healthMax;
 }
 
 void EntityEnemy::ChangeHealth(float healthDelta)
 {
-	health += healthDelta;
+	EntityStore& store = GetEntityStore();
+	HealthComponent* health = store.GetHealth(storeId);
+	health->health += healthDelta;
 
 	// Check if the enemy has died
-	if (health <= 0) {
-		health = 0;
+	if (health->health <= 0) {
+		health->health = 0;
 
 		// Explosion Effect
-		const XMFLOAT3* position(transform.GetPosition());
+		const XMFLOAT3* position = &store.GetTransform(storeId)->position;
 
 		peExplosionDebris->SetPosition(*position);
 		peExplosionFireball->SetPosition(*position);
-		peExplosionDebris->Emit();
-		peExplosionFireball->Emit();
+		EmitParticles(peExplosionDebris);
+		EmitParticles(peExplosionFireball);
 
 		// Spawn in new location
 		MoveToRandomPosition();
 	}
-	else if (health > healthMax) {
-		health = healthMax;
+	else if (health->health > health->healthMax) {
+		health->health = health->healthMax;
 	}
 
-	// Set new scale
-	float scale = (health) / healthMax * this->maxScale;
-	transform.SetScale(DirectX::XMFLOAT3(scale, scale, scale));
-	GetCollider()->SetScale(DirectX::XMFLOAT3(scale/2, scale/2, scale/2));
+	// Set new scale, the collider is fitted to the mesh and scales with it
+	float scale = (health->health) / health->healthMax * health->maxScale;
+	store.GetTransform(storeId)->scale = XMFLOAT3(scale, scale, scale);
+	store.WriteTransform(storeId);
 }
 
 void EntityEnemy::SetTarget(Entity* target)
 {
 	this->target = target;
+	GetEntityStore().GetSeek(storeId)->target = target != nullptr ? target->transform.GetPosition() : nullptr;
 }
 
 Entity* EntityEnemy::GetTarget()
@@ -150,33 +153,32 @@ Entity* EntityEnemy::GetTarget()
 
 void EntityEnemy::SetDirection(XMFLOAT3 direction)
 {
-	this->direction = direction;
+	GetEntityStore().GetVelocity(storeId)->direction = direction;
 }
 
 const XMFLOAT3* const EntityEnemy::GetDirection() const
 {
-	return &this->direction;
+	return &GetEntityStore().GetVelocity(storeId)->direction;
 }
 
-void EntityEnemy::OnCollision(Collision collision) {
+void EntityEnemy::OnCollision(const Collision& collision) {
 	// Colliding with projectile
-	if (collision.otherEntity->HasTag("Projectile"))
+	if (collision.otherCollider->GetLayer() == LAYER_PROJECTILE)
 	{
 		// Take damage
 		ChangeHealth(-.2f);
 	}
 
 	// Colliding with enemy
-	else if (collision.otherEntity->HasTag("Enemy"))
+	else if (collision.otherCollider->GetLayer() == LAYER_ENEMY)
 	{
-		// Bounce off enemy
-		const XMFLOAT3* otherPosition = collision.otherTransform.GetPosition();
-		XMFLOAT3 bounce = XMFLOAT3();
-		XMVECTOR bounceVector = XMLoadFloat3(transform.GetPosition()) - XMLoadFloat3(otherPosition);
-		bounceVector = XMVector3Normalize(bounceVector) * 0.01f;
-		XMStoreFloat3(&bounce, bounceVector);
+		// Bounce off enemy, against the contact normal
+		EntityStore& store = GetEntityStore();
+		XMFLOAT3* position = &store.GetTransform(storeId)->position;
+		XMVECTOR bounceVector = XMLoadFloat3(&collision.normal) * -0.01f;
 
 		// Move away from other enemy
-		transform.Move(bounce.x, bounce.y, bounce.z);
+		XMStoreFloat3(position, XMLoadFloat3(position) + bounceVector);
+		store.WriteTransform(storeId);
 	}
 }
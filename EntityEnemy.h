@@ -3,7 +3,8 @@
 #include "MaterialEnemy.h"
 
 // Enemy entity
-// Goes straight towards the player.
+// Goes straight towards the player. Movement, spin and regeneration run as
+// entity store systems, the enemy keeps its state in its store components.
 // Does damage when it hits the player
 // Shrinks when damaged, grows when it heals
 // Heals gradually overtime
@@ -32,17 +33,10 @@ public:
 	void SetTarget(Entity* target);
 	Entity* GetTarget();
 	void SetDirection(XMFLOAT3 direction);
-	const XMFLOAT3* const GetDirection() const;
+	const XMFLOAT3* const GetDirection() const;	// Valid until the entity store next changes
 
 protected:
-	float maxScale;		// Max scale of enemy
-	float speed;		// Speed the enemy moves at
-	float health;		// The enemies current health.
-	float healthMax;	// The max health of the enemy
-
 	Entity* target;		// The target of the enemy
-	XMFLOAT3 direction;	// Direction the enemy is looking at
-	XMFLOAT3 rotationAxis;	// Axis the enemy rotates around
 
 	// Material
 	MaterialEnemy* enemyMaterial;
@@ -53,6 +47,6 @@ protected:
 
 
 	// Implements unique collision behavior
-	void OnCollision(Collision collision) override;
+	void OnCollision(const Collision& collision) override;
 };
 
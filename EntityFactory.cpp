@@ -1,5 +1,7 @@
 #include "EntityFactory.h"
+#include <cassert>
 #include "CollisionManager.h"
+#include "EntitySystems.h"
 #include "MemoryDebug.h"
 
 using namespace std;
@@ -12,27 +14,65 @@ Entity* EntityFactory::CreateEntity(EntityType entityType, std::string name, Mes
 	switch (entityType)
 	{
 	case EntityType::STATIC:
-		entity = new EntityStatic(this, name, mesh, material);
+		entity = sceneArena.Create<EntityStatic>(this, name, mesh, material);
 		break;
 	case EntityType::PLAYER:
-		entity = new EntityPlayer(this, name, mesh, material);
+		entity = sceneArena.Create<EntityPlayer>(this, name, mesh, material);
 		break;
 	case EntityType::ENEMY:
-		entity = new EntityEnemy(this, name, mesh, material);
+		entity = sceneArena.Create<EntityEnemy>(this, name, mesh, material);
 		break;
 	case EntityType::PROJECTILE:
-		entity = new EntityProjectile(this, name, mesh, material);
+		entity = sceneArena.Create<EntityProjectile>(this, name, mesh, material);
 		break;
 	case EntityType::MANAGER_PROJECTILE:
-		entity = new EntityManagerProjectile(this, name);
+		entity = sceneArena.Create<EntityManagerProjectile>(this, name);
 		break;
 	}
 
-	// Add entity to vector of entities
-	entities[entity->GetName()] = entity;
+	// Register the entity, and put it in the lists of what its constructor
+	// turned on, which it could not join before it had a handle
+	entity->handle = registry.Create(entity);
+	registry.SetName(entity->handle, entity->GetName());
+	registry.SetTags(entity->handle, entity->tags);
+	if (entity->isUpdating) registry.AddToList(entity->handle, ENTITY_LIST_UPDATING);
+	if (entity->isRendering) registry.AddToList(entity->handle, ENTITY_LIST_RENDERING);
+	if (entity->isColliding) registry.AddToList(entity->handle, ENTITY_LIST_COLLIDING);
 	return entity;
 }
 
+void EntityFactory::DestroyEntity(Entity* entity)
+{
+	// Entities updating in parallel destroy once they are all done
+	if (isDeferringCommands) {
+		commandBuffers[JobSystem::GetCurrentThread()].Destroy(entity);
+		return;
+	}
+	if (entity->isDestroyed) return;
+
+	// Leave the lists and managers now, so nothing updates, draws or touches
+	// the entity again, but keep it until no caller can still be using it
+	SetEntityUpdating(entity, false);
+	SetEntityRendering(entity, false);
+	SetEntityCollision(entity, false);
+	entity->isDestroyed = true;
+	destroyedEntities.push_back(entity);
+}
+
+void EntityFactory::FlushDestroyedEntities()
+{
+	// Free the handles, then the memory, which is only reclaimed with the
+	// rest of the scene's
+	assert(!isDeferringCommands && !CollisionManager::Instance()->IsDispatching());
+	for (size_t i = 0; i < destroyedEntities.size(); i++) {
+		Entity* entity = destroyedEntities[i];
+		registry.Destroy(entity->handle);
+		sceneArena.Destroy(entity->collider);
+		sceneArena.Destroy(entity);
+	}
+	destroyedEntities.clear();
+}
+
 vector<EntityProjectile*> EntityFactory::CreateProjectileEntities(unsigned int numberOfProjectiles, Mesh* mesh, Material* material)
 {
 	EntityProjectile* projectile;
@@ -44,7 +84,10 @@ vector<EntityProjectile*> EntityFactory::CreateProjectileEntities(unsigned int n
 			dynamic_cast<EntityProjectile*>(CreateEntity(EntityType::PROJECTILE, "Projectile_" + std::to_string(i), mesh, material));
 		projectile->transform.SetScale(0.15f, 0.15f, 0.15f);
 		projectile->transform.SetPosition(0, 0, -200.0f);
-		projectile->SetCollider(Collider::SPHERE, XMFLOAT3(0.15f / 2, 0.15f / 2, 0.15f / 2));
+		entityStore.ReadTransform(projectile->storeId);	// Projectiles move in the store, which would undo the above
+		projectile->SetCollider(Collider::SPHERE, XMFLOAT3(0.15f / 2, 0.15f / 2, 0.15f / 2), XMFLOAT3(0, 0, 0), XMFLOAT4(0, 0, 0, 0), LAYER_PROJECTILE);
+		projectile->GetCollider()->SetIsFastMoving(true);	// Small and fast, would tunnel through enemies on long frames
+		projectile->GetCollider()->SetIsPlanar(true);
 		SetEntityCollision(projectile, false);
 	}
 
@@ -53,14 +96,92 @@ vector<EntityProjectile*> EntityFactory::CreateProjectileEntities(unsigned int n
 
 void EntityFactory::UpdateEntities(float deltaTime, float totalTime)
 {
-	// Updates each entity in the updating entities list
-	for (auto iter = updatingEntities.begin(); iter != updatingEntities.end(); ++iter) {
-		iter->second->Update(deltaTime, totalTime);
+	// Keep where every drawn entity was at the end of the last tick, which
+	// frames drawn before the next tick blend from
+	const vector<Entity*>& renderingEntities = registry.GetList(ENTITY_LIST_RENDERING);
+	for (size_t i = 0; i < renderingEntities.size(); i++)
+		renderingEntities[i]->transform.SavePrevious();
+
+	// Step the entities kept in the store, and copy their transforms back
+	// before the entities' own updates read them
+	if (jobSystem == nullptr) {
+		UpdateSeek(entityStore);
+		UpdateMovement(entityStore, deltaTime);
+		UpdateSpin(entityStore, totalTime);
+		UpdateHealth(entityStore, deltaTime);
+		WriteTransforms(entityStore);
+	}
+	else {
+		// Movement reads the velocities seeking writes, the other systems
+		// touch columns of their own and run alongside both
+		JobCounter steered, stepped;
+		JobSystem* jobs = jobSystem;
+		jobSystem->Submit([this, jobs](unsigned int) { UpdateSeek(entityStore, jobs); }, &steered);
+		jobSystem->Submit([this, jobs, deltaTime](unsigned int) { UpdateMovement(entityStore, deltaTime, jobs); }, &stepped, &steered);
+		jobSystem->Submit([this, jobs, totalTime](unsigned int) { UpdateSpin(entityStore, totalTime, jobs); }, &stepped);
+		jobSystem->Submit([this, jobs, deltaTime](unsigned int) { UpdateHealth(entityStore, deltaTime, jobs); }, &stepped);
+		jobSystem->Wait(stepped);
+		WriteTransforms(entityStore, jobSystem);
+	}
+
+	const vector<Entity*>& updatingEntities = registry.GetList(ENTITY_LIST_UPDATING);
+
+	// Entities that only touch their own state update in parallel first, with
+	// what they change on the factory replayed once all are done
+	if (jobSystem != nullptr) {
+		independentEntities.clear();
+		for (size_t i = 0; i < updatingEntities.size(); i++) {
+			if (updatingEntities[i]->isUpdateIndependent)
+				independentEntities.push_back(updatingEntities[i]);
+		}
+
+		if (commandBuffers.size() != jobSystem->GetThreadCount())
+			commandBuffers.resize(jobSystem->GetThreadCount());
+		isDeferringCommands = true;
+		jobSystem->ParallelFor(static_cast<unsigned int>(independentEntities.size()), ENTITY_UPDATE_BATCH,
+			[this, deltaTime, totalTime](unsigned int begin, unsigned int end, unsigned int thread) {
+			for (unsigned int i = begin; i < end; i++) {
+				commandBuffers[thread].SetOrder(i);
+				independentEntities[i]->Update(deltaTime, totalTime);
+			}
+		});
+		isDeferringCommands = false;
+		EntityCommandBuffer::Replay(commandBuffers, replayOrder, *this);
 	}
+
+	// Updates each entity that was updating when the walk started. Entities
+	// can start or stop updating, or be released, during the walk, and an
+	// entity leaving the list moves the list's last entity into its place,
+	// which may be one the walk has already passed. So the walk goes over the
+	// handles as they were, skipping those that stopped since, and entities
+	// that start updating do so from the next tick.
+	updateOrder.clear();
+	for (size_t i = 0; i < updatingEntities.size(); i++) {
+		if (jobSystem == nullptr || !updatingEntities[i]->isUpdateIndependent)
+			updateOrder.push_back(updatingEntities[i]->handle);
+	}
+	for (size_t i = 0; i < updateOrder.size(); i++) {
+		if (registry.IsInList(updateOrder[i], ENTITY_LIST_UPDATING))
+			registry.Get(updateOrder[i])->Update(deltaTime, totalTime);
+	}
+
+	// Nothing walks the entities destroyed during the update any more
+	FlushDestroyedEntities();
+}
+
+void EntityFactory::SetJobSystem(JobSystem* jobSystem)
+{
+	this->jobSystem = jobSystem;
 }
 
 void EntityFactory::SetEntityCollision(Entity* entity, bool isColliding)
 {
+	// Entities updating in parallel change the lists once they are all done
+	if (isDeferringCommands) {
+		commandBuffers[JobSystem::GetCurrentThread()].SetColliding(entity, isColliding);
+		return;
+	}
+
 	// Check if value is already set
 	if (entity->isColliding == isColliding) {
 		return;
@@ -68,6 +189,7 @@ void EntityFactory::SetEntityCollision(Entity* entity, bool isColliding)
 
 	// Set entity property
 	entity->isColliding = isColliding;
+	isColliding ? registry.AddToList(entity->handle, ENTITY_LIST_COLLIDING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_COLLIDING);
 
 	// If the entity will now collide, add entity to vector of colliding entities
 	isColliding ? CollisionManager::Instance()->StageCollider(entity->GetCollider()) : CollisionManager::Instance()->UnstageCollider(entity->GetCollider());
@@ -75,6 +197,12 @@ void EntityFactory::SetEntityCollision(Entity* entity, bool isColliding)
 
 void EntityFactory::SetEntityRendering(Entity* entity, bool isRendering)
 {
+	// Entities updating in parallel change the lists once they are all done
+	if (isDeferringCommands) {
+		commandBuffers[JobSystem::GetCurrentThread()].SetRendering(entity, isRendering);
+		return;
+	}
+
 	// Check if value is already set
 	if (entity->isRendering == isRendering) {
 		return;
@@ -82,6 +210,7 @@ void EntityFactory::SetEntityRendering(Entity* entity, bool isRendering)
 
 	// Set entity property
 	entity->isRendering = isRendering;
+	isRendering ? registry.AddToList(entity->handle, ENTITY_LIST_RENDERING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_RENDERING);
 
 	// If the entity will now render, stage entity for rendering
 	isRendering ? Renderer::Instance()->StageEntity(entity) : Renderer::Instance()->UnstageEntity(entity);
@@ -89,6 +218,12 @@ void EntityFactory::SetEntityRendering(Entity* entity, bool isRendering)
 
 void EntityFactory::SetEntityUpdating(Entity* entity, bool isUpdating)
 {
+	// Entities updating in parallel change the lists once they are all done
+	if (isDeferringCommands) {
+		commandBuffers[JobSystem::GetCurrentThread()].SetUpdating(entity, isUpdating);
+		return;
+	}
+
 	// Check if value is already set
 	if (entity->isUpdating == isUpdating) {
 		return;
@@ -97,37 +232,89 @@ void EntityFactory::SetEntityUpdating(Entity* entity, bool isUpdating)
 	// Set entity property
 	entity->isUpdating = isUpdating;
 
-	// If the entity will now update, add entity to updating entities vector.
-	isUpdating ? AddEntityToUpdate(entity) :RemoveEntityFromUpdate(entity);
+	// If the entity will now update, add entity to updating entities list.
+	isUpdating ? registry.AddToList(entity->handle, ENTITY_LIST_UPDATING) : registry.RemoveFromList(entity->handle, ENTITY_LIST_UPDATING);
+
+	// Store systems skip disabled entities
+	if (entity->storeId != ENTITY_STORE_NONE) {
+		isUpdating ? entityStore.RemoveComponents(entity->storeId, COMPONENT_BIT(COMPONENT_DISABLED))
+			: entityStore.AddComponents(entity->storeId, COMPONENT_BIT(COMPONENT_DISABLED));
+	}
+}
+
+void EntityFactory::SetEntityName(Entity* entity, std::string name)
+{
+	entity->name = name;
+	registry.SetName(entity->handle, name);
+}
+
+void EntityFactory::SetEntityTags(Entity* entity, TagMask tags)
+{
+	entity->tags = tags;
+	registry.SetTags(entity->handle, tags);
+}
+
+void EntityFactory::EmitParticles(ParticleEmitter* emitter)
+{
+	// Replayed in order with the entities' other changes, as they were made
+	if (isDeferringCommands) {
+		commandBuffers[JobSystem::GetCurrentThread()].Emit(emitter);
+		return;
+	}
+	emitter->Emit();
+}
+
+Entity* EntityFactory::GetEntity(EntityHandle handle) const
+{
+	return registry.Get(handle);
+}
+
+Entity* EntityFactory::FindEntity(const std::string& name) const
+{
+	return registry.Find(name);
+}
+
+const std::vector<Entity*>& EntityFactory::GetEntities() const
+{
+	return registry.GetList(ENTITY_LIST_ALL);
 }
 
-std::unordered_map<std::string, Entity*> EntityFactory::GetEntities()
+const std::vector<Entity*>& EntityFactory::GetTaggedEntities(std::string tag)
 {
-	return entities;
+	return registry.GetTagged(TagTable::Intern(tag));
 }
 
-void EntityFactory::AddEntityToUpdate(Entity* entity)
+void EntityFactory::FindTaggedEntities(TagMask tags, std::vector<Entity*>& entities) const
 {
-	updatingEntities[entity->GetName()] = entity;
+	registry.FindTagged(tags, entities);
 }
 
-void EntityFactory::RemoveEntityFromUpdate(Entity* entity)
+EntityStore& EntityFactory::GetEntityStore()
 {
-	updatingEntities.erase(entity->GetName());
+	return entityStore;
+}
+
+const EntityRegistry& EntityFactory::GetRegistry() const
+{
+	return registry;
+}
+
+SceneArena& EntityFactory::GetSceneArena()
+{
+	return sceneArena;
 }
 
 void EntityFactory::Release()
 {
-	// Free all entities
-	for (auto iter = entities.begin(); iter != entities.end(); iter++) {
-		Entity* entity = iter->second;
-		if (entity->isUpdating)
-			RemoveEntityFromUpdate(entity);
-		if(entity->isColliding)
-			CollisionManager::Instance()->UnstageCollider(iter->second->GetCollider());
-		if(entity->isRendering)
-			Renderer::Instance()->UnstageEntity(iter->second);
-		delete entity;
-	}
-	entities.clear();
+	// Every entity of the scene goes, so the managers drop all of them at once
+	// rather than searching for each, then the entities and their colliders
+	// are freed together. The registry and store let go of them all after.
+	if (registry.GetCount() > 0) {
+		CollisionManager::Instance()->UnstageAll();
+		Renderer::Instance()->UnstageAllEntities();
+	}
+	destroyedEntities.clear();
+	sceneArena.Reset();
+	registry.Clear();
+	entityStore.Clear();
 }
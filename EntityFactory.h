@@ -1,5 +1,6 @@
 #pragma once
 #include <unordered_map>
+#include <vector>
 
 // Entities
 #include "Entity.h"
@@ -9,6 +10,15 @@
 #include "EntityStatic.h"
 #include "EntityManagerProjectile.h"
 
+// Entity store, registry and the arena entities are made in
+#include "EntityStore.h"
+#include "EntityRegistry.h"
+#include "SceneArena.h"
+
+// Threads the entities update on, and what they change meanwhile
+#include "JobSystem.h"
+#include "EntityCommandBuffer.h"
+
 // Managers
 #include "CollisionManager.h"
 #include "Renderer.h"
@@ -16,6 +26,10 @@
 class Mesh;
 class Material;
 
+// Independent entities updated per job, fewer than the rows of a store
+// system as an update does more
+#define ENTITY_UPDATE_BATCH 64
+
 // Enum of entity types
 enum EntityType {
 	STATIC,
@@ -30,28 +44,72 @@ enum EntityType {
 class EntityFactory
 {
 protected:
-	 std::unordered_map<std::string, Entity*> entities;
-	 std::unordered_map<std::string, Entity*> updatingEntities;
-	 
+	 // Every entity by handle, with the dense lists of entities that update,
+	 // render and collide
+	 EntityRegistry registry;
+
+	 // Components of entities whose movement runs as systems, stepped
+	 // before the remaining entities update
+	 EntityStore entityStore;
+
 	 CollisionManager* collisionManager;
 	 Renderer* renderer;
 
+	 // Runs the store systems and independent entity updates in parallel when
+	 // set. While those entities update, changes to the lists and emits are
+	 // recorded in the buffer of the thread making them instead.
+	 JobSystem* jobSystem = nullptr;
+	 std::vector<EntityCommandBuffer> commandBuffers;
+	 std::vector<const EntityCommand*> replayOrder;	// Replay's sort, kept between frames
+	 std::vector<Entity*> independentEntities;
+	 bool isDeferringCommands = false;
+
+	 // Entities updating as the serial walk of a tick started, kept between
+	 // ticks so the walk does not allocate
+	 std::vector<EntityHandle> updateOrder;
 
-	 void AddEntityToUpdate(Entity* entity);
-	 void RemoveEntityFromUpdate(Entity* entity);
+	 // Entities destroyed since the last flush. They have left every list but
+	 // keep their handle and memory, which updates and collision callbacks
+	 // still running may hold.
+	 std::vector<Entity*> destroyedEntities;
+
+	 // Entities and their colliders, all freed together on Release. Last so
+	 // the entities still left are destroyed before the store and registry.
+	 SceneArena sceneArena;
 
 public:
 	void Release();
 	
 	Entity* CreateEntity(EntityType entityType, std::string name, Mesh* mesh = nullptr, Material* material = nullptr);
+	// Takes the entity out of updating, rendering and collision at once, and
+	// frees it on the next flush. Recorded like the other changes while
+	// entities update in parallel.
+	void DestroyEntity(Entity* entity);
+	// Free the destroyed entities. Not while entities update or collision
+	// callbacks run, UpdateEntities flushes at its end and the game again
+	// after collisions are dispatched.
+	void FlushDestroyedEntities();
 	std::vector<EntityProjectile*> CreateProjectileEntities(unsigned int numberOfProjectiles, Mesh* mesh = nullptr, Material* material = nullptr);
 
 	void UpdateEntities(float deltaTime, float  totalTime);
+	void SetJobSystem(JobSystem* jobSystem);	// Null updates everything on the calling thread
 
 	void SetEntityCollision(Entity* entity, bool isColliding);
 	void SetEntityRendering(Entity* entity, bool isRendering);
 	void SetEntityUpdating(Entity* entity, bool isUpdating);
+	void SetEntityName(Entity* entity, std::string name);
+	void SetEntityTags(Entity* entity, TagMask tags);
+	void EmitParticles(ParticleEmitter* emitter);
+
+	Entity* GetEntity(EntityHandle handle) const;	// Null once the entity was destroyed
+	Entity* FindEntity(const std::string& name) const;
+	const std::vector<Entity*>& GetEntities() const;
 
-	std::unordered_map<std::string, Entity*> GetEntities();
+	// Every entity with a tag, or with all the tags of a mask
+	const std::vector<Entity*>& GetTaggedEntities(std::string tag);
+	void FindTaggedEntities(TagMask tags, std::vector<Entity*>& entities) const;
+	EntityStore& GetEntityStore();
+	const EntityRegistry& GetRegistry() const;	// For resolving handles without the factory
+	SceneArena& GetSceneArena();	// For objects living as long as the scene's entities
 };
 
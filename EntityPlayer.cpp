@@ -1,4 +1,6 @@
 #include "EntityPlayer.h"
+#include "Renderer.h"
+#include "Platform.h"
 #include "MemoryDebug.h"
 
 EntityPlayer::EntityPlayer(EntityFactory* entityFactory, std::string name, Mesh* mesh, Material* material) :
@@ -65,20 +67,20 @@ void EntityPlayer::Update(float deltaTime, float totalTime)
 	// Find the player movement direction
 	XMFLOAT3 movement = XMFLOAT3(0,0,0);
 	bool isSteering = false;
-	if (GetAsyncKeyState('W') & 0x8000) {
+	if (Input::IsKeyDown('W')) {
 		isSteering = true;
 		movement.y += 1.0;
 	}
-	else if (GetAsyncKeyState('S') & 0x8000)
+	else if (Input::IsKeyDown('S'))
 	{
 		isSteering = true;
 		movement.y -= 1.0;
 	}
-	if (GetAsyncKeyState('D') & 0x8000) {
+	if (Input::IsKeyDown('D')) {
 		isSteering = true;
 		movement.x += 1.0;
 	}
-	else if (GetAsyncKeyState('A') & 0x8000)
+	else if (Input::IsKeyDown('A'))
 	{
 		isSteering = true;
 		movement.x -= 1.0;
@@ -122,12 +124,12 @@ void EntityPlayer::Update(float deltaTime, float totalTime)
 		peEngineExhaust->SetDirectionRange(backwardsLeft, backwardsRight);
 		peEngineExhaust->SetPosition(*emitPosition);
 		peEngineExhaust->SetLoop(-1);
-		peEngineExhaust->Emit();
+		EmitParticles(peEngineExhaust);
 	}
 	else {
 		// End engine particle effect
 		peEngineExhaust->SetLoop(0);
-		peEngineExhaust->Emit();
+		EmitParticles(peEngineExhaust);
 	}
 
 	// Handle firing
@@ -136,22 +138,22 @@ void EntityPlayer::Update(float deltaTime, float totalTime)
 	// Find direction of firing
 	XMFLOAT3 fireDirection = XMFLOAT3(0, 0, 0);
 	bool isFiring = false;
-	if (GetAsyncKeyState(VK_UP) & 0x8000)
+	if (Input::IsKeyDown(INPUT_KEY_UP))
 	{
 		fireDirection.y += 1.0f;
 		isFiring = true;
 	}
-	else if (GetAsyncKeyState(VK_DOWN) & 0x8000)
+	else if (Input::IsKeyDown(INPUT_KEY_DOWN))
 	{
 		fireDirection.y -= 1.0f;
 		isFiring = true;
 	}
-	if (GetAsyncKeyState(VK_RIGHT) & 0x8000)
+	if (Input::IsKeyDown(INPUT_KEY_RIGHT))
 	{
 		fireDirection.x += 1.0f;
 		isFiring = true;
 	}
-	else if (GetAsyncKeyState(VK_LEFT) & 0x8000)
+	else if (Input::IsKeyDown(INPUT_KEY_LEFT))
 	{
 		fireDirection.x -= 1.0f;
 		isFiring = true;
@@ -193,8 +195,8 @@ void EntityPlayer::ChangeHealth(int healthDelta)
 		// Emit explosion effects
 		peExplosionDebris->SetPosition(*position);
 		peExplosionFireball->SetPosition(*position);
-		peExplosionDebris->Emit();
-		peExplosionFireball->Emit();
+		EmitParticles(peExplosionDebris);
+		EmitParticles(peExplosionFireball);
 	}
 	else if (health > maxHealth)	// Make sure max health is not exceeded
 	{
@@ -216,10 +218,10 @@ float EntityPlayer::GetSpeed()
 	return speed;
 }
 
-void EntityPlayer::OnCollision(Collision other)
+void EntityPlayer::OnCollision(const Collision& other)
 {
 	// Handles collision with enemy
-	if (other.otherEntity->HasTag("Enemy")) {
+	if (other.otherCollider->GetLayer() == LAYER_ENEMY) {
 		EntityEnemy* enemy = (EntityEnemy*)other.otherEntity;
 
 		// Sufficiently weak enemies inflict no damage.
@@ -255,5 +257,5 @@ void EntityPlayer::FireProjectile(XMFLOAT3 direction)
 	// Emit fire particle effect
 	peFireProjectile->SetDirectionRange(directionLeft, directionRight);
 	peFireProjectile->SetPosition(*position);
-	peFireProjectile->Emit();
+	EmitParticles(peFireProjectile);
 }
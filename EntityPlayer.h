@@ -46,6 +46,6 @@ protected:
 
 	void FireProjectile(XMFLOAT3 direction);	// Fire a projectile
 
-	void OnCollision(Collision collision) override;	
+	void OnCollision(const Collision& collision) override;	
 };
 
@@ -5,11 +5,14 @@
 EntityProjectile::EntityProjectile(EntityFactory* entityFactory, std::string name, Mesh* mesh, Material* material) :
 	Entity(entityFactory, name, mesh, material)
 {
-	// Default values
-	direction = XMFLOAT3(0, 0, 0);	// Set zero direction
-	speed = 5.0f;
+	// Movement runs in the entity store
+	storeId = GetEntityStore().Create(COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY), &transform);
+
+	// Default values, starting with a zero direction
+	GetEntityStore().GetVelocity(storeId)->speed = 5.0f;
 	this->AddTag("Projectile");
 	SetIsUpdating(true);
+	isUpdateIndependent = true;	// Update only moves its own trail
 
 	// Particle Effect
 	peTrail = Renderer::Instance()->CreateContinuousParticleEmitter("pe_" + name + "_trail", 5, 0.01f);
@@ -31,17 +34,14 @@ EntityProjectile::~EntityProjectile()
 
 void EntityProjectile::Update(float deltaTime, float totalTime)
 {
-	// Move projectile in set direction
-	XMFLOAT3 movement = XMFLOAT3();
-	XMStoreFloat3(&movement, XMLoadFloat3(&direction) * speed * deltaTime);
-	transform.Move(movement.x, movement.y, movement.z);
+	// The projectile was moved in its set direction by the entity store systems
 
 	// Particle Effect
 	const XMFLOAT3* position = transform.GetPosition();	// Get position to emit from
 	
 	// Find range of backward values
 	XMFLOAT3 backwards = XMFLOAT3();
-	XMStoreFloat3(&backwards, XMVector3Normalize(-XMLoadFloat3(&movement)));
+	XMStoreFloat3(&backwards, XMVector3Normalize(-XMLoadFloat3(GetDirection())));
 	XMFLOAT3 backwardsLeft = backwards;
 	XMFLOAT3 backwardsRight = backwards;
 	backwardsLeft.x -= 0.25f;
@@ -56,24 +56,36 @@ void EntityProjectile::Update(float deltaTime, float totalTime)
 
 void EntityProjectile::Fire(XMFLOAT3 position, XMFLOAT3 direction, float speed)
 {
+	// A projectile still in flight is restaged, so its collider is not swept
+	// from the old position to the new one
+	SetIsColliding(false);
+
+	// Set the projectile to be updating first, enabling it moves its store components
+	SetIsUpdating(true);
+
 	// Set projectile values
-	transform.SetPosition(position);
+	EntityStore& store = GetEntityStore();
+	store.GetTransform(storeId)->position = position;
+	store.WriteTransform(storeId);
+	transform.ResetPrevious();	// Not drawn flying in from where it was
 	SetDirection(direction);
 	SetSpeed(speed);
 
-	// Set the projectile to be updating and true
-	SetIsUpdating(true);
+	// Set the projectile to be colliding again at the new position
 	SetIsColliding(true);
 
 	// Restart particle effect
 	peTrail->SetPosition(position);
 	peTrail->SetLoop(-1);
-	peTrail->Emit();
+	EmitParticles(peTrail);
 }
 
 void EntityProjectile::Remove()
 {
-	transform.SetPosition(0, 0, -200);	// Move particle off screen
+	EntityStore& store = GetEntityStore();
+	store.GetTransform(storeId)->position = XMFLOAT3(0, 0, -200);	// Move particle off screen
+	store.WriteTransform(storeId);
+	transform.ResetPrevious();
 	SetIsUpdating(false);	// Set particle to stop updating
 	SetIsColliding(false);	// Set particle to stop colliding
 	peTrail->SetLoop(0);	// Turn off particle effect
@@ -81,28 +93,28 @@ void EntityProjectile::Remove()
 
 void EntityProjectile::SetSpeed(float speed)
 {
-	this->speed = speed;
+	GetEntityStore().GetVelocity(storeId)->speed = speed;
 }
 
 float EntityProjectile::GetSpeed()
 {
-	return this->speed;
+	return GetEntityStore().GetVelocity(storeId)->speed;
 }
 
 void EntityProjectile::SetDirection(XMFLOAT3 direction)
 {
-	this->direction = direction;
+	GetEntityStore().GetVelocity(storeId)->direction = direction;
 }
 
 XMFLOAT3 * EntityProjectile::GetDirection()
 {
-	return &this->direction;
+	return &GetEntityStore().GetVelocity(storeId)->direction;
 }
 
-void EntityProjectile::OnCollision(Collision collison)
+void EntityProjectile::OnCollision(const Collision& collison)
 {
 	// Remove projectile if it hits an enemy
-	if (collison.otherEntity->HasTag("Enemy")) {
+	if (collison.otherCollider->GetLayer() == LAYER_ENEMY) {
 		Remove();
 	}
 }
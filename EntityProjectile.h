@@ -2,6 +2,8 @@
 #include "Entity.h"
 
 // Entity that is fired by the player and does damage to enemies
+// Moves as an entity store system, with its speed and direction kept in its
+// store components.
 class EntityProjectile :
 	public virtual Entity
 {
@@ -20,14 +22,11 @@ public:
 	void SetSpeed(float speed);
 	float GetSpeed();
 	void SetDirection(XMFLOAT3 direction);
-	XMFLOAT3* GetDirection();
+	XMFLOAT3* GetDirection();	// Valid until the entity store next changes
 
 protected:
-	float speed;	// Speed the projectile moves at
-	XMFLOAT3 direction;	// Direction the projectile moves towards
-
 	ParticleEmitter* peTrail;	// Particle effect for trail
 
-	void OnCollision(Collision collison) override;
+	void OnCollision(const Collision& collison) override;
 };
 
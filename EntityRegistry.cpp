@@ -0,0 +1,254 @@
+#include "EntityRegistry.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+EntityRegistry::EntityRegistry()
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+EntityRegistry::~EntityRegistry()
+{
+}
+
+// --------------------------------------------------------
+// Give an entity a slot, reusing a freed one when there is
+// one, and add it to the list of all entities
+// --------------------------------------------------------
+EntityHandle EntityRegistry::Create(Entity* entity)
+{
+	unsigned int slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		slot = static_cast<unsigned int>(slots.size());
+		slots.push_back(Slot());
+		slots.back().generation = 0;
+	}
+
+	Slot& entry = slots[slot];
+	entry.entity = entity;
+	entry.tags = 0;
+
+	EntityHandle handle = { slot, entry.generation };
+	AddToList(lists[ENTITY_LIST_ALL], slot);
+	return handle;
+}
+
+// --------------------------------------------------------
+// Free an entity's slot. The generation moves on so any
+// handle still held to it stops resolving.
+// --------------------------------------------------------
+void EntityRegistry::Destroy(EntityHandle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	for (int list = 0; list < ENTITY_LIST_COUNT; list++)
+		RemoveFromList(lists[list], handle.slot);
+	SetTags(handle, 0);
+
+	Slot& entry = slots[handle.slot];
+	if (!entry.name.empty()) {
+		auto found = names.find(entry.name);
+		if (found != names.end() && found->second == handle)
+			names.erase(found);
+		entry.name.clear();
+	}
+
+	entry.entity = nullptr;
+	entry.generation++;
+	freeSlots.push_back(handle.slot);
+}
+
+// --------------------------------------------------------
+// Destroy every entity at once. Slots are kept with their
+// generations, so handles from before stay invalid.
+// --------------------------------------------------------
+void EntityRegistry::Clear()
+{
+	freeSlots.clear();
+	for (unsigned int slot = 0; slot < slots.size(); slot++) {
+		if (slots[slot].entity != nullptr) {
+			slots[slot].entity = nullptr;
+			slots[slot].generation++;
+		}
+		slots[slot].tags = 0;
+		slots[slot].name.clear();
+		freeSlots.push_back(slot);
+	}
+
+	for (int list = 0; list < ENTITY_LIST_COUNT; list++) {
+		lists[list].entities.clear();
+		lists[list].slots.clear();
+		lists[list].indices.clear();
+	}
+	for (int tag = 0; tag < ENTITY_TAG_COUNT; tag++) {
+		tagLists[tag].entities.clear();
+		tagLists[tag].slots.clear();
+		tagLists[tag].indices.clear();
+	}
+	names.clear();
+}
+
+Entity* EntityRegistry::Get(EntityHandle handle) const
+{
+	return IsValid(handle) ? slots[handle.slot].entity : nullptr;
+}
+
+bool EntityRegistry::IsValid(EntityHandle handle) const
+{
+	return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation
+		&& slots[handle.slot].entity != nullptr;
+}
+
+void EntityRegistry::AddToList(EntityHandle handle, EntityList list)
+{
+	if (IsValid(handle))
+		AddToList(lists[list], handle.slot);
+}
+
+void EntityRegistry::RemoveFromList(EntityHandle handle, EntityList list)
+{
+	if (IsValid(handle))
+		RemoveFromList(lists[list], handle.slot);
+}
+
+bool EntityRegistry::IsInList(EntityHandle handle, EntityList list) const
+{
+	return IsValid(handle) && IsInList(lists[list], handle.slot);
+}
+
+const std::vector<Entity*>& EntityRegistry::GetList(EntityList list) const
+{
+	return lists[list].entities;
+}
+
+// --------------------------------------------------------
+// Set an entity's tags, joining the lists of tags it gains
+// and leaving those of tags it lost
+// --------------------------------------------------------
+void EntityRegistry::SetTags(EntityHandle handle, TagMask tags)
+{
+	if (!IsValid(handle))
+		return;
+
+	Slot& entry = slots[handle.slot];
+	TagMask changed = entry.tags ^ tags;
+	for (unsigned int tag = 0; changed != 0; tag++, changed >>= 1) {
+		if ((changed & 1) == 0)
+			continue;
+		(tags & TAG_BIT(tag)) ? AddToList(tagLists[tag], handle.slot) : RemoveFromList(tagLists[tag], handle.slot);
+	}
+	entry.tags = tags;
+}
+
+TagMask EntityRegistry::GetTags(EntityHandle handle) const
+{
+	return IsValid(handle) ? slots[handle.slot].tags : 0;
+}
+
+const std::vector<Entity*>& EntityRegistry::GetTagged(unsigned int tag) const
+{
+	return tagLists[tag].entities;
+}
+
+// --------------------------------------------------------
+// Fill entities with every entity having all of the tags
+// --------------------------------------------------------
+void EntityRegistry::FindTagged(TagMask tags, std::vector<Entity*>& entities) const
+{
+	entities.clear();
+	if (tags == 0)
+		return;
+
+	// Walk the shortest list, any entity with all the tags is in it
+	const DenseList* shortest = nullptr;
+	for (unsigned int tag = 0; tag < ENTITY_TAG_COUNT; tag++) {
+		if ((tags & TAG_BIT(tag)) && (shortest == nullptr || tagLists[tag].entities.size() < shortest->entities.size()))
+			shortest = &tagLists[tag];
+	}
+
+	for (size_t i = 0; i < shortest->entities.size(); i++) {
+		if ((slots[shortest->slots[i]].tags & tags) == tags)
+			entities.push_back(shortest->entities[i]);
+	}
+}
+
+// --------------------------------------------------------
+// Index an entity under a name, dropping its old name
+// --------------------------------------------------------
+void EntityRegistry::SetName(EntityHandle handle, const std::string& name)
+{
+	if (!IsValid(handle))
+		return;
+
+	Slot& entry = slots[handle.slot];
+	if (!entry.name.empty()) {
+		auto found = names.find(entry.name);
+		if (found != names.end() && found->second == handle)
+			names.erase(found);
+	}
+
+	entry.name = name;
+	if (!name.empty())
+		names[name] = handle;
+}
+
+Entity* EntityRegistry::Find(const std::string& name) const
+{
+	auto found = names.find(name);
+	return found == names.end() ? nullptr : Get(found->second);
+}
+
+unsigned int EntityRegistry::GetCount() const
+{
+	return static_cast<unsigned int>(lists[ENTITY_LIST_ALL].entities.size());
+}
+
+// --------------------------------------------------------
+// Append a slot's entity to a list
+// --------------------------------------------------------
+void EntityRegistry::AddToList(DenseList& list, unsigned int slot)
+{
+	if (IsInList(list, slot))
+		return;
+
+	if (list.indices.size() <= slot)
+		list.indices.resize(slots.size(), ENTITY_SLOT_NONE);
+	list.indices[slot] = static_cast<unsigned int>(list.entities.size());
+	list.entities.push_back(slots[slot].entity);
+	list.slots.push_back(slot);
+}
+
+// --------------------------------------------------------
+// Take a slot's entity out of a list, moving the list's
+// last entity into its place
+// --------------------------------------------------------
+void EntityRegistry::RemoveFromList(DenseList& list, unsigned int slot)
+{
+	if (!IsInList(list, slot))
+		return;
+
+	unsigned int index = list.indices[slot];
+	unsigned int last = static_cast<unsigned int>(list.entities.size() - 1);
+	if (index != last) {
+		list.entities[index] = list.entities[last];
+		list.slots[index] = list.slots[last];
+		list.indices[list.slots[index]] = index;
+	}
+	list.entities.pop_back();
+	list.slots.pop_back();
+	list.indices[slot] = ENTITY_SLOT_NONE;
+}
+
+bool EntityRegistry::IsInList(const DenseList& list, unsigned int slot) const
+{
+	return slot < list.indices.size() && list.indices[slot] != ENTITY_SLOT_NONE;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "EntityTags.h"
+
+class Entity;
+
+// Handle to a registered entity. The generation is bumped every time a slot
+// is freed, so a handle kept past its entity's destruction no longer resolves
+// even after the slot is reused.
+struct EntityHandle {
+	unsigned int slot;
+	unsigned int generation;
+
+	bool operator==(const EntityHandle& other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+#define ENTITY_SLOT_NONE	0xFFFFFFFF	// Slot of no entity, and index of an entity not in a list
+
+// Dense lists an entity can be in
+enum EntityList {
+	ENTITY_LIST_ALL,		// Every registered entity
+	ENTITY_LIST_UPDATING,
+	ENTITY_LIST_RENDERING,
+	ENTITY_LIST_COLLIDING,
+	ENTITY_LIST_COUNT
+};
+
+// Slot map of entities. Creating, destroying and resolving a handle are
+// constant time, and each list is a packed array of entity pointers that an
+// entity joins by appending and leaves by moving the list's last entity into
+// its place, so toggling whether an entity updates is two array writes.
+// Every tag has a list of its own in the same way, kept in step with the tag
+// mask set for an entity. Names are an optional index on the side, only kept
+// for entities given one.
+class EntityRegistry
+{
+public:
+	EntityRegistry();
+	~EntityRegistry();
+
+	EntityHandle Create(Entity* entity);
+	void Destroy(EntityHandle handle);	// Leaves every list and the name index
+	void Clear();
+
+	// The entity of a handle, null once it was destroyed
+	Entity* Get(EntityHandle handle) const;
+	bool IsValid(EntityHandle handle) const;
+
+	// Join or leave a list, doing nothing when already in or out of it
+	void AddToList(EntityHandle handle, EntityList list);
+	void RemoveFromList(EntityHandle handle, EntityList list);
+	bool IsInList(EntityHandle handle, EntityList list) const;
+	const std::vector<Entity*>& GetList(EntityList list) const;
+
+	// Set an entity's tags, moving it in and out of the tag lists
+	void SetTags(EntityHandle handle, TagMask tags);
+	TagMask GetTags(EntityHandle handle) const;
+
+	// Every entity with a tag
+	const std::vector<Entity*>& GetTagged(unsigned int tag) const;
+
+	// Every entity with all the tags of a mask, walking the shortest of their lists
+	void FindTagged(TagMask tags, std::vector<Entity*>& entities) const;
+
+	// Index an entity by name, replacing whatever had the name before
+	void SetName(EntityHandle handle, const std::string& name);
+	Entity* Find(const std::string& name) const;
+
+	unsigned int GetCount() const;
+
+private:
+	struct Slot {
+		Entity* entity;
+		unsigned int generation;
+		TagMask tags;
+		std::string name;	// Empty when not indexed
+	};
+
+	// Packed entities, with the slot of each entry and the entry of each slot
+	struct DenseList {
+		std::vector<Entity*> entities;
+		std::vector<unsigned int> slots;
+		std::vector<unsigned int> indices;	// By slot, ENTITY_SLOT_NONE when not in the list
+	};
+
+	std::vector<Slot> slots;
+	std::vector<unsigned int> freeSlots;
+	DenseList lists[ENTITY_LIST_COUNT];
+	DenseList tagLists[ENTITY_TAG_COUNT];
+	std::unordered_map<std::string, EntityHandle> names;
+
+	void AddToList(DenseList& list, unsigned int slot);
+	void RemoveFromList(DenseList& list, unsigned int slot);
+	bool IsInList(const DenseList& list, unsigned int slot) const;
+};
@@ -0,0 +1,301 @@
+#include "EntityStore.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// True when the archetype has every component of include
+// and none of exclude
+// --------------------------------------------------------
+bool Archetype::Matches(unsigned int include, unsigned int exclude) const
+{
+	return (mask & include) == include && (mask & exclude) == 0;
+}
+
+unsigned int Archetype::GetCount() const
+{
+	return static_cast<unsigned int>(ids.size());
+}
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+EntityStore::EntityStore() :
+	count(0)
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+EntityStore::~EntityStore()
+{
+}
+
+// --------------------------------------------------------
+// Create an entity in the archetype of mask, reusing the
+// id of a destroyed entity when there is one
+// --------------------------------------------------------
+unsigned int EntityStore::Create(unsigned int mask, Transform* link)
+{
+	unsigned int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else {
+		id = static_cast<unsigned int>(locations.size());
+		locations.push_back(Location());
+	}
+
+	unsigned int archetype = FindArchetype(mask);
+	locations[id].archetype = archetype;
+	locations[id].row = AddRow(archetype, id, link);
+	count++;
+	return id;
+}
+
+// --------------------------------------------------------
+// Remove an entity, its id can be handed out again
+// --------------------------------------------------------
+void EntityStore::Destroy(unsigned int id)
+{
+	Location& location = locations[id];
+	RemoveRow(location.archetype, location.row);
+	location.archetype = ENTITY_STORE_NONE;
+	freeIds.push_back(id);
+	count--;
+}
+
+// --------------------------------------------------------
+// Remove every entity. Archetypes are kept with their
+// capacity, so refilling the store does not reallocate.
+// --------------------------------------------------------
+void EntityStore::Clear()
+{
+	for (auto& archetype : archetypes) {
+		archetype.ids.clear();
+		archetype.links.clear();
+		archetype.transforms.clear();
+		archetype.velocities.clear();
+		archetype.seeks.clear();
+		archetype.spins.clear();
+		archetype.healths.clear();
+		archetype.colliders.clear();
+	}
+	locations.clear();
+	freeIds.clear();
+	count = 0;
+}
+
+void EntityStore::AddComponents(unsigned int id, unsigned int mask)
+{
+	MoveTo(id, archetypes[locations[id].archetype].mask | mask);
+}
+
+void EntityStore::RemoveComponents(unsigned int id, unsigned int mask)
+{
+	MoveTo(id, archetypes[locations[id].archetype].mask & ~mask);
+}
+
+bool EntityStore::HasComponents(unsigned int id, unsigned int mask) const
+{
+	return (archetypes[locations[id].archetype].mask & mask) == mask;
+}
+
+TransformComponent* EntityStore::GetTransform(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.transforms.empty() ? nullptr : &archetype.transforms[locations[id].row];
+}
+
+VelocityComponent* EntityStore::GetVelocity(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.velocities.empty() ? nullptr : &archetype.velocities[locations[id].row];
+}
+
+SeekComponent* EntityStore::GetSeek(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.seeks.empty() ? nullptr : &archetype.seeks[locations[id].row];
+}
+
+SpinComponent* EntityStore::GetSpin(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.spins.empty() ? nullptr : &archetype.spins[locations[id].row];
+}
+
+HealthComponent* EntityStore::GetHealth(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.healths.empty() ? nullptr : &archetype.healths[locations[id].row];
+}
+
+ColliderComponent* EntityStore::GetCollider(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	return archetype.colliders.empty() ? nullptr : &archetype.colliders[locations[id].row];
+}
+
+// --------------------------------------------------------
+// Copy one entity's transform component to its link
+// --------------------------------------------------------
+void EntityStore::WriteTransform(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	Transform* link = archetype.links[locations[id].row];
+	if (link == nullptr || archetype.transforms.empty())
+		return;
+
+	const TransformComponent& transform = archetype.transforms[locations[id].row];
+	link->SetPosition(transform.position);
+	link->SetScale(transform.scale);
+	link->SetRotation(transform.rotation);
+}
+
+// --------------------------------------------------------
+// Copy one entity's link to its transform component
+// --------------------------------------------------------
+void EntityStore::ReadTransform(unsigned int id)
+{
+	Archetype& archetype = archetypes[locations[id].archetype];
+	Transform* link = archetype.links[locations[id].row];
+	if (link == nullptr || archetype.transforms.empty())
+		return;
+
+	TransformComponent& transform = archetype.transforms[locations[id].row];
+	transform.position = *link->GetPosition();
+	transform.scale = *link->GetScale();
+	transform.rotation = *link->GetRotation();
+}
+
+std::vector<Archetype>& EntityStore::GetArchetypes()
+{
+	return archetypes;
+}
+
+unsigned int EntityStore::GetCount() const
+{
+	return count;
+}
+
+// --------------------------------------------------------
+// Index of the archetype with exactly the components of
+// mask, made when no entity had them yet. There are only
+// ever a handful, so a linear search is enough.
+// --------------------------------------------------------
+unsigned int EntityStore::FindArchetype(unsigned int mask)
+{
+	for (unsigned int i = 0; i < archetypes.size(); i++) {
+		if (archetypes[i].mask == mask)
+			return i;
+	}
+
+	archetypes.push_back(Archetype());
+	archetypes.back().mask = mask;
+	return static_cast<unsigned int>(archetypes.size() - 1);
+}
+
+// --------------------------------------------------------
+// Append a row of default components, the transform
+// starting from the link when there is one
+// --------------------------------------------------------
+unsigned int EntityStore::AddRow(unsigned int archetypeIndex, unsigned int id, Transform* link)
+{
+	Archetype& archetype = archetypes[archetypeIndex];
+	unsigned int mask = archetype.mask;
+
+	archetype.ids.push_back(id);
+	archetype.links.push_back(link);
+	if (mask & COMPONENT_BIT(COMPONENT_TRANSFORM)) {
+		TransformComponent transform = { XMFLOAT3(0, 0, 0), XMFLOAT3(1, 1, 1), XMFLOAT4(0, 0, 0, 1) };
+		if (link != nullptr) {
+			transform.position = *link->GetPosition();
+			transform.scale = *link->GetScale();
+			transform.rotation = *link->GetRotation();
+		}
+		archetype.transforms.push_back(transform);
+	}
+	if (mask & COMPONENT_BIT(COMPONENT_VELOCITY)) {
+		VelocityComponent velocity = { XMFLOAT3(0, 0, 0), 0.0f };
+		archetype.velocities.push_back(velocity);
+	}
+	if (mask & COMPONENT_BIT(COMPONENT_SEEK)) {
+		SeekComponent seek = { nullptr };
+		archetype.seeks.push_back(seek);
+	}
+	if (mask & COMPONENT_BIT(COMPONENT_SPIN)) {
+		SpinComponent spin = { XMFLOAT3(0, 0, 1) };
+		archetype.spins.push_back(spin);
+	}
+	if (mask & COMPONENT_BIT(COMPONENT_HEALTH)) {
+		HealthComponent health = { 1.0f, 1.0f, 1.0f, 0.0f };
+		archetype.healths.push_back(health);
+	}
+	if (mask & COMPONENT_BIT(COMPONENT_COLLIDER)) {
+		ColliderComponent collider = { XMFLOAT3(0, 0, 0), XMFLOAT3(0.5f, 0.5f, 0.5f), 0, XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0) };
+		archetype.colliders.push_back(collider);
+	}
+	return archetype.GetCount() - 1;
+}
+
+// --------------------------------------------------------
+// Copy the components two archetypes share from one row
+// to another
+// --------------------------------------------------------
+void EntityStore::CopyRow(const Archetype& from, unsigned int fromRow, Archetype& to, unsigned int toRow)
+{
+	unsigned int shared = from.mask & to.mask;
+
+	to.links[toRow] = from.links[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_TRANSFORM)) to.transforms[toRow] = from.transforms[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_VELOCITY)) to.velocities[toRow] = from.velocities[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_SEEK)) to.seeks[toRow] = from.seeks[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_SPIN)) to.spins[toRow] = from.spins[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_HEALTH)) to.healths[toRow] = from.healths[fromRow];
+	if (shared & COMPONENT_BIT(COMPONENT_COLLIDER)) to.colliders[toRow] = from.colliders[fromRow];
+}
+
+// --------------------------------------------------------
+// Fill a row with the archetype's last row and drop the
+// last row, keeping every array packed
+// --------------------------------------------------------
+void EntityStore::RemoveRow(unsigned int archetypeIndex, unsigned int row)
+{
+	Archetype& archetype = archetypes[archetypeIndex];
+	unsigned int last = archetype.GetCount() - 1;
+	if (row != last) {
+		archetype.ids[row] = archetype.ids[last];
+		CopyRow(archetype, last, archetype, row);
+		locations[archetype.ids[row]].row = row;
+	}
+
+	archetype.ids.pop_back();
+	archetype.links.pop_back();
+	if (!archetype.transforms.empty()) archetype.transforms.pop_back();
+	if (!archetype.velocities.empty()) archetype.velocities.pop_back();
+	if (!archetype.seeks.empty()) archetype.seeks.pop_back();
+	if (!archetype.spins.empty()) archetype.spins.pop_back();
+	if (!archetype.healths.empty()) archetype.healths.pop_back();
+	if (!archetype.colliders.empty()) archetype.colliders.pop_back();
+}
+
+// --------------------------------------------------------
+// Move an entity's row to the archetype of mask, keeping
+// the components both have
+// --------------------------------------------------------
+void EntityStore::MoveTo(unsigned int id, unsigned int mask)
+{
+	Location& location = locations[id];
+	if (archetypes[location.archetype].mask == mask)
+		return;
+
+	// Finding the archetype can grow the list, so rows are looked up after
+	unsigned int to = FindArchetype(mask);
+	unsigned int toRow = AddRow(to, id, archetypes[location.archetype].links[location.row]);
+	CopyRow(archetypes[location.archetype], location.row, archetypes[to], toRow);
+	RemoveRow(location.archetype, location.row);
+
+	location.archetype = to;
+	location.row = toRow;
+}
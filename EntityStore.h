@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "Transform.h"
+
+using namespace DirectX;
+
+// Components an entity in the store can have, as bits of an archetype mask
+enum ComponentType {
+	COMPONENT_TRANSFORM,
+	COMPONENT_VELOCITY,
+	COMPONENT_SEEK,
+	COMPONENT_SPIN,
+	COMPONENT_HEALTH,
+	COMPONENT_COLLIDER,
+	COMPONENT_DISABLED,	// Tag only, every system skips entities that have it
+	COMPONENT_COUNT
+};
+
+#define COMPONENT_BIT(component)	(1u << (component))
+#define ENTITY_STORE_NONE			0xFFFFFFFF	// Id of no entity
+
+// Position, scale and rotation, copied to a linked Transform once systems ran
+struct TransformComponent {
+	XMFLOAT3 position;
+	XMFLOAT3 scale;
+	XMFLOAT4 rotation;
+};
+
+// Moves the transform along direction every frame
+struct VelocityComponent {
+	XMFLOAT3 direction;	// Unit length, or zero to stand still
+	float speed;
+};
+
+// Points the velocity at a position every frame
+struct SeekComponent {
+	const XMFLOAT3* target;	// Not owned, stands still when null
+};
+
+// Spins the transform around an axis, one radian a second
+struct SpinComponent {
+	XMFLOAT3 axis;
+};
+
+// Regenerates health and scales the transform with it
+struct HealthComponent {
+	float health;
+	float healthMax;
+	float maxScale;		// Scale at full health
+	float regeneration;	// Health gained a second
+};
+
+// Box collider following the transform, and the world aligned box around it
+struct ColliderComponent {
+	XMFLOAT3 offset;			// From the transform, before scaling
+	XMFLOAT3 halfExtents;		// Before scaling
+	unsigned int layer;
+	XMFLOAT3 worldCenter;		// Written by UpdateColliderBounds
+	XMFLOAT3 worldHalfExtents;
+};
+
+// Every entity with the same set of components, each component in its own
+// dense array. Arrays of components outside the mask stay empty, so a system
+// walks one contiguous array per component it touches.
+struct Archetype {
+	unsigned int mask;
+	std::vector<unsigned int> ids;		// Entity id of each row
+	std::vector<Transform*> links;		// Transform a row is copied to, may be null
+	std::vector<TransformComponent> transforms;
+	std::vector<VelocityComponent> velocities;
+	std::vector<SeekComponent> seeks;
+	std::vector<SpinComponent> spins;
+	std::vector<HealthComponent> healths;
+	std::vector<ColliderComponent> colliders;
+
+	// True when the archetype has every component of include and none of exclude
+	bool Matches(unsigned int include, unsigned int exclude = COMPONENT_BIT(COMPONENT_DISABLED)) const;
+	unsigned int GetCount() const;
+};
+
+// Archetype storage for entities whose per frame work runs as systems over
+// dense component arrays instead of through virtual Entity::Update calls.
+// Entities are plain ids; adding or removing components moves an entity's
+// row to the archetype of its new mask, and rows are kept packed by moving
+// the last row of an archetype into any hole. Component pointers handed out
+// are only valid until the next call that creates, destroys or moves an entity.
+class EntityStore
+{
+public:
+	EntityStore();
+	~EntityStore();
+
+	// Create an entity with the given components, at their defaults. With a
+	// link, the transform component starts from it and is copied back to it
+	// by WriteTransforms.
+	unsigned int Create(unsigned int mask, Transform* link = nullptr);
+	void Destroy(unsigned int id);
+	void Clear();
+
+	// Move an entity to the archetype with the given components added or removed
+	void AddComponents(unsigned int id, unsigned int mask);
+	void RemoveComponents(unsigned int id, unsigned int mask);
+	bool HasComponents(unsigned int id, unsigned int mask) const;
+
+	// Components of one entity, null when it does not have them
+	TransformComponent* GetTransform(unsigned int id);
+	VelocityComponent* GetVelocity(unsigned int id);
+	SeekComponent* GetSeek(unsigned int id);
+	SpinComponent* GetSpin(unsigned int id);
+	HealthComponent* GetHealth(unsigned int id);
+	ColliderComponent* GetCollider(unsigned int id);
+
+	// Copy one entity's transform component to its link now, for changes made
+	// outside the systems that have to show up before the next frame
+	void WriteTransform(unsigned int id);
+
+	// Copy an entity's link to its transform component, for changes made to
+	// the Transform directly that the systems must not overwrite
+	void ReadTransform(unsigned int id);
+
+	std::vector<Archetype>& GetArchetypes();
+	unsigned int GetCount() const;
+
+private:
+	// Where an entity's row is
+	struct Location {
+		unsigned int archetype;
+		unsigned int row;
+	};
+
+	std::vector<Archetype> archetypes;
+	std::vector<Location> locations;	// By entity id
+	std::vector<unsigned int> freeIds;
+	unsigned int count;
+
+	unsigned int FindArchetype(unsigned int mask);
+	unsigned int AddRow(unsigned int archetype, unsigned int id, Transform* link);
+	void CopyRow(const Archetype& from, unsigned int fromRow, Archetype& to, unsigned int toRow);
+	void RemoveRow(unsigned int archetype, unsigned int row);
+	void MoveTo(unsigned int id, unsigned int mask);
+};
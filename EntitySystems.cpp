@@ -0,0 +1,166 @@
+#include "EntitySystems.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Call rows(archetype, begin, end) over the rows of every
+// archetype holding the included components, in batches
+// across the job system when there is one
+// --------------------------------------------------------
+template<typename RowFunction>
+static void ForEachRows(EntityStore& store, unsigned int include, JobSystem* jobs, RowFunction rows)
+{
+	for (auto& archetype : store.GetArchetypes()) {
+		if (!archetype.Matches(include))
+			continue;
+
+		unsigned int count = archetype.GetCount();
+		if (jobs == nullptr) {
+			rows(archetype, 0u, count);
+			continue;
+		}
+		jobs->ParallelFor(count, ENTITY_SYSTEM_BATCH, [&](unsigned int begin, unsigned int end, unsigned int) {
+			rows(archetype, begin, end);
+		});
+	}
+}
+
+// --------------------------------------------------------
+// Point each seeking velocity at its target, entities with
+// no target stand still
+// --------------------------------------------------------
+void UpdateSeek(EntityStore& store, JobSystem* jobs)
+{
+	const unsigned int include = COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY) | COMPONENT_BIT(COMPONENT_SEEK);
+	ForEachRows(store, include, jobs, [](Archetype& archetype, unsigned int begin, unsigned int end) {
+		const TransformComponent* transforms = archetype.transforms.data();
+		VelocityComponent* velocities = archetype.velocities.data();
+		const SeekComponent* seeks = archetype.seeks.data();
+		for (unsigned int i = begin; i < end; i++) {
+			if (seeks[i].target == nullptr) {
+				velocities[i].direction = XMFLOAT3(0, 0, 0);
+				continue;
+			}
+
+			XMStoreFloat3(&velocities[i].direction,
+				XMVector3Normalize(XMLoadFloat3(seeks[i].target) - XMLoadFloat3(&transforms[i].position)));
+		}
+	});
+}
+
+// --------------------------------------------------------
+// Move each transform by its velocity
+// --------------------------------------------------------
+void UpdateMovement(EntityStore& store, float deltaTime, JobSystem* jobs)
+{
+	const unsigned int include = COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_VELOCITY);
+	ForEachRows(store, include, jobs, [deltaTime](Archetype& archetype, unsigned int begin, unsigned int end) {
+		TransformComponent* transforms = archetype.transforms.data();
+		const VelocityComponent* velocities = archetype.velocities.data();
+		for (unsigned int i = begin; i < end; i++) {
+			float step = velocities[i].speed * deltaTime;
+			transforms[i].position.x += velocities[i].direction.x * step;
+			transforms[i].position.y += velocities[i].direction.y * step;
+			transforms[i].position.z += velocities[i].direction.z * step;
+		}
+	});
+}
+
+// --------------------------------------------------------
+// Rotate each spinning transform by totalTime radians
+// around its axis
+// --------------------------------------------------------
+void UpdateSpin(EntityStore& store, float totalTime, JobSystem* jobs)
+{
+	const unsigned int include = COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_SPIN);
+	ForEachRows(store, include, jobs, [totalTime](Archetype& archetype, unsigned int begin, unsigned int end) {
+		TransformComponent* transforms = archetype.transforms.data();
+		const SpinComponent* spins = archetype.spins.data();
+		for (unsigned int i = begin; i < end; i++)
+			XMStoreFloat4(&transforms[i].rotation, XMQuaternionRotationAxis(XMLoadFloat3(&spins[i].axis), totalTime));
+	});
+}
+
+// --------------------------------------------------------
+// Regenerate health up to the max and scale each transform
+// with its share of it. Damage and death are left to
+// whoever changes the health.
+// --------------------------------------------------------
+void UpdateHealth(EntityStore& store, float deltaTime, JobSystem* jobs)
+{
+	const unsigned int include = COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_HEALTH);
+	ForEachRows(store, include, jobs, [deltaTime](Archetype& archetype, unsigned int begin, unsigned int end) {
+		TransformComponent* transforms = archetype.transforms.data();
+		HealthComponent* healths = archetype.healths.data();
+		for (unsigned int i = begin; i < end; i++) {
+			HealthComponent& health = healths[i];
+			health.health += health.regeneration * deltaTime;
+			if (health.health > health.healthMax)
+				health.health = health.healthMax;
+
+			float scale = health.health / health.healthMax * health.maxScale;
+			transforms[i].scale = XMFLOAT3(scale, scale, scale);
+		}
+	});
+}
+
+// --------------------------------------------------------
+// Find the world aligned box around each collider, scaled
+// and rotated with its transform
+// --------------------------------------------------------
+void UpdateColliderBounds(EntityStore& store, JobSystem* jobs)
+{
+	const unsigned int include = COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_COLLIDER);
+	ForEachRows(store, include, jobs, [](Archetype& archetype, unsigned int begin, unsigned int end) {
+		const TransformComponent* transforms = archetype.transforms.data();
+		ColliderComponent* colliders = archetype.colliders.data();
+		for (unsigned int i = begin; i < end; i++) {
+			XMVECTOR scale = XMLoadFloat3(&transforms[i].scale);
+			XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&transforms[i].rotation));
+
+			XMVECTOR offset = XMVector3Rotate(XMLoadFloat3(&colliders[i].offset) * scale, XMLoadFloat4(&transforms[i].rotation));
+			XMStoreFloat3(&colliders[i].worldCenter, XMLoadFloat3(&transforms[i].position) + offset);
+
+			// Each world extent is the box's extents projected onto that axis
+			XMVECTOR half = XMVectorAbs(XMLoadFloat3(&colliders[i].halfExtents) * scale);
+			XMVECTOR extents = XMVectorAbs(rotation.r[0]) * XMVectorSplatX(half)
+				+ XMVectorAbs(rotation.r[1]) * XMVectorSplatY(half)
+				+ XMVectorAbs(rotation.r[2]) * XMVectorSplatZ(half);
+			XMStoreFloat3(&colliders[i].worldHalfExtents, extents);
+		}
+	});
+}
+
+// --------------------------------------------------------
+// Copy every linked transform component that differs from
+// its Transform. Setting a Transform marks its world matrix
+// and collider dirty, so rows the systems left alone must
+// not be written, or their colliders' cached world state
+// is rebuilt and sleeping bodies are woken every frame.
+// --------------------------------------------------------
+void WriteTransforms(EntityStore& store, JobSystem* jobs)
+{
+	ForEachRows(store, COMPONENT_BIT(COMPONENT_TRANSFORM), jobs, [](Archetype& archetype, unsigned int begin, unsigned int end) {
+		const TransformComponent* transforms = archetype.transforms.data();
+		Transform* const* links = archetype.links.data();
+		for (unsigned int i = begin; i < end; i++) {
+			Transform* link = links[i];
+			if (link == nullptr)
+				continue;
+
+			const XMFLOAT3& position = transforms[i].position;
+			const XMFLOAT3* linkPosition = link->GetPosition();
+			if (position.x != linkPosition->x || position.y != linkPosition->y || position.z != linkPosition->z)
+				link->SetPosition(position);
+
+			const XMFLOAT3& scale = transforms[i].scale;
+			const XMFLOAT3* linkScale = link->GetScale();
+			if (scale.x != linkScale->x || scale.y != linkScale->y || scale.z != linkScale->z)
+				link->SetScale(scale);
+
+			const XMFLOAT4& rotation = transforms[i].rotation;
+			const XMFLOAT4* linkRotation = link->GetRotation();
+			if (rotation.x != linkRotation->x || rotation.y != linkRotation->y || rotation.z != linkRotation->z || rotation.w != linkRotation->w)
+				link->SetRotation(rotation);
+		}
+	});
+}
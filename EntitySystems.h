@@ -0,0 +1,32 @@
+#pragma once
+#include "EntityStore.h"
+#include "JobSystem.h"
+
+// Rows of an archetype a system steps in one job
+#define ENTITY_SYSTEM_BATCH 256
+
+// Systems stepping the entity store once a frame. Each is one pass over the
+// component arrays of every archetype holding what it reads, skipping
+// disabled entities. Run in the order declared. Given a job system, each
+// archetype's rows are split into batches stepped in parallel; rows only
+// read and write their own components, apart from seek targets, which no
+// system writes.
+
+// Turn velocities toward their seek targets
+void UpdateSeek(EntityStore& store, JobSystem* jobs = nullptr);
+
+// Move transforms along their velocities
+void UpdateMovement(EntityStore& store, float deltaTime, JobSystem* jobs = nullptr);
+
+// Set spinning transforms to their rotation at totalTime
+void UpdateSpin(EntityStore& store, float totalTime, JobSystem* jobs = nullptr);
+
+// Regenerate health and scale transforms to match it
+void UpdateHealth(EntityStore& store, float deltaTime, JobSystem* jobs = nullptr);
+
+// Place collider boxes around their transforms
+void UpdateColliderBounds(EntityStore& store, JobSystem* jobs = nullptr);
+
+// Copy transform components to the Transforms they are linked to, leaving
+// Transforms that already hold the same values untouched and clean
+void WriteTransforms(EntityStore& store, JobSystem* jobs = nullptr);
@@ -0,0 +1,58 @@
+#include "EntityTags.h"
+#include <assert.h>
+#include <unordered_map>
+#include "MemoryDebug.h"
+
+// Interned names, made on first use so interning from static initializers works
+static std::unordered_map<std::string, unsigned int>& GetTagIndices()
+{
+	static std::unordered_map<std::string, unsigned int> indices;
+	return indices;
+}
+
+static std::string* GetTagNames()
+{
+	static std::string names[ENTITY_TAG_COUNT];
+	return names;
+}
+
+// --------------------------------------------------------
+// Bit index of a name, the next free bit for a new name
+// --------------------------------------------------------
+unsigned int TagTable::Intern(const std::string& name)
+{
+	std::unordered_map<std::string, unsigned int>& indices = GetTagIndices();
+	auto found = indices.find(name);
+	if (found != indices.end())
+		return found->second;
+
+	// Every bit of a tag mask is taken
+	assert(indices.size() < ENTITY_TAG_COUNT);
+
+	unsigned int tag = static_cast<unsigned int>(indices.size());
+	indices[name] = tag;
+	GetTagNames()[tag] = name;
+	return tag;
+}
+
+TagMask TagTable::GetMask(const std::string& name)
+{
+	return TAG_BIT(Intern(name));
+}
+
+unsigned int TagTable::Find(const std::string& name)
+{
+	std::unordered_map<std::string, unsigned int>& indices = GetTagIndices();
+	auto found = indices.find(name);
+	return found == indices.end() ? ENTITY_TAG_NONE : found->second;
+}
+
+const std::string& TagTable::GetName(unsigned int tag)
+{
+	return GetTagNames()[tag];
+}
+
+unsigned int TagTable::GetCount()
+{
+	return static_cast<unsigned int>(GetTagIndices().size());
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+
+// Tags an entity can have, one bit of a mask each
+#define ENTITY_TAG_COUNT	64
+#define ENTITY_TAG_NONE		0xFFFFFFFF	// Index of a name never interned
+
+typedef unsigned long long TagMask;
+
+#define TAG_BIT(tag)	(1ull << (tag))
+
+// Program wide table interning tag names as bit indices, handed out in the
+// order names are first seen. Tests against a mask are a single AND, so code
+// checking tags often keeps the mask instead of the name. Not thread safe,
+// tags are meant to be interned on the main thread.
+class TagTable
+{
+public:
+	// Bit index of a name, interning it if new
+	static unsigned int Intern(const std::string& name);
+
+	// Mask with the bit of a name, interning it if new
+	static TagMask GetMask(const std::string& name);
+
+	// Bit index of a name, ENTITY_TAG_NONE when it was never interned
+	static unsigned int Find(const std::string& name);
+
+	static const std::string& GetName(unsigned int tag);
+	static unsigned int GetCount();
+};
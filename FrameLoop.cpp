@@ -0,0 +1,121 @@
+#include "FrameLoop.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+FrameLoop::FrameLoop() :
+	tickDelta(1.0f / FRAME_LOOP_DEFAULT_TICK_RATE),
+	maxSubsteps(FRAME_LOOP_DEFAULT_MAX_SUBSTEPS),
+	accumulator(0.0f),
+	simulationTime(0.0),
+	startTime(0.0),
+	previousTime(0.0),
+	deltaTime(0.0f),
+	totalTime(0.0f),
+	frameCount(0),
+	tickCount(0),
+	isQuitting(false)
+{
+}
+
+// --------------------------------------------------------
+// Runs frames on the platform until it has no more or the
+// loop is told to quit
+// --------------------------------------------------------
+void FrameLoop::Run(Platform& platform, const FrameFunction& update, const FrameFunction& draw)
+{
+	// Time starts now that the loop is running
+	startTime = platform.GetSeconds();
+	previousTime = startTime;
+	isQuitting = false;
+
+	while (!isQuitting && platform.ProcessMessages())
+		RunFrame(platform, update, draw);
+}
+
+// --------------------------------------------------------
+// Runs the simulation in fixed ticks until it has caught
+// up with real time, then draws the frame. Leftover time
+// carries over to the next frame, and what is beyond the
+// max substeps is dropped, so a long frame slows the game
+// down instead of making the next frame longer still.
+// --------------------------------------------------------
+void FrameLoop::RunFrame(Platform& platform, const FrameFunction& update, const FrameFunction& draw)
+{
+	// Calculate delta time and clamp to zero, in case the clock
+	// is read on another core
+	double now = platform.GetSeconds();
+	deltaTime = now > previousTime ? (float)(now - previousTime) : 0.0f;
+	totalTime = (float)(now - startTime);
+	previousTime = now;
+	frameCount++;
+
+	// Every tick and draw of the frame sees the same input
+	platform.PollInput(Input::snapshot);
+
+	accumulator += deltaTime;
+	if (accumulator > tickDelta * maxSubsteps)
+		accumulator = tickDelta * maxSubsteps;
+
+	while (accumulator >= tickDelta && !isQuitting) {
+		simulationTime += tickDelta;
+		update(tickDelta, (float)simulationTime);
+		accumulator -= tickDelta;
+		tickCount++;
+	}
+
+	if (platform.IsDrawing() && !isQuitting)
+		draw(deltaTime, totalTime);
+}
+
+void FrameLoop::Quit()
+{
+	isQuitting = true;
+}
+
+// --------------------------------------------------------
+// Sets how many fixed ticks the simulation runs a second
+// --------------------------------------------------------
+void FrameLoop::SetTickRate(float ticksPerSecond)
+{
+	tickDelta = 1.0f / ticksPerSecond;
+}
+
+// --------------------------------------------------------
+// Sets the most ticks run to catch up in one frame
+// --------------------------------------------------------
+void FrameLoop::SetMaxSubsteps(unsigned int maxSubsteps)
+{
+	this->maxSubsteps = maxSubsteps > 0 ? maxSubsteps : 1;
+}
+
+float FrameLoop::GetTickDelta() const
+{
+	return tickDelta;
+}
+
+float FrameLoop::GetInterpolationAlpha() const
+{
+	return accumulator / tickDelta;
+}
+
+float FrameLoop::GetDeltaTime() const
+{
+	return deltaTime;
+}
+
+float FrameLoop::GetTotalTime() const
+{
+	return totalTime;
+}
+
+unsigned int FrameLoop::GetFrameCount() const
+{
+	return frameCount;
+}
+
+unsigned int FrameLoop::GetTickCount() const
+{
+	return tickCount;
+}
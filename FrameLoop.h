@@ -0,0 +1,60 @@
+#pragma once
+#include <functional>
+#include "Platform.h"
+
+// Simulation ticks per second, and the most ticks run for one frame before
+// the simulation falls behind real time rather than taking ever longer frames
+#define FRAME_LOOP_DEFAULT_TICK_RATE 60.0f
+#define FRAME_LOOP_DEFAULT_MAX_SUBSTEPS 5
+
+// Called with the time it covers and the time since the loop started
+typedef std::function<void(float deltaTime, float totalTime)> FrameFunction;
+
+// The game loop, apart from any window. Each frame it handles the platform's
+// messages, takes one input snapshot, runs the simulation in fixed ticks as
+// far as time has passed, then draws once if the platform draws.
+class FrameLoop
+{
+public:
+	FrameLoop();
+
+	// Run frames until the platform or Quit stops them. Update gets the tick
+	// length and the simulated time, draw the real frame time.
+	void Run(Platform& platform, const FrameFunction& update, const FrameFunction& draw);
+
+	// Stop once the current frame is done
+	void Quit();
+
+	// Fixed timestep of the simulation
+	void SetTickRate(float ticksPerSecond);
+	void SetMaxSubsteps(unsigned int maxSubsteps);
+	float GetTickDelta() const;
+
+	// How far the frame being drawn is from the last tick toward the next,
+	// from 0 to 1, for blending the last two ticks' states
+	float GetInterpolationAlpha() const;
+
+	float GetDeltaTime() const;		// Real time of the current frame
+	float GetTotalTime() const;		// Real time since the loop started
+	unsigned int GetFrameCount() const;
+	unsigned int GetTickCount() const;
+
+private:
+	// Fixed timestep, the real time not yet simulated and the simulated time
+	float tickDelta;
+	unsigned int maxSubsteps;
+	float accumulator;
+	double simulationTime;
+
+	// Real time
+	double startTime;
+	double previousTime;
+	float deltaTime;
+	float totalTime;
+
+	unsigned int frameCount;
+	unsigned int tickCount;
+	bool isQuitting;
+
+	void RunFrame(Platform& platform, const FrameFunction& update, const FrameFunction& draw);
+};
@@ -28,8 +28,13 @@ Game::Game(HINSTANCE hInstance)
 	pixelShader_parallax = 0;
 	renderer = nullptr;
 	collisionManager = nullptr;
+	jobSystem = nullptr;
 	stateManager = StateManager();
 
+	// Entities, collisions and scenes step at a fixed rate whatever the frame rate
+	SetTickRate(GAME_TICK_RATE);
+	SetMaxSubsteps(GAME_MAX_SUBSTEPS);
+
 #if defined(DEBUG) || defined(_DEBUG)
 	// Do we want a console window?  Probably only in debug mode
 	CreateConsoleWindow(500, 120, 32, 120);
@@ -44,8 +49,10 @@ Game::Game(HINSTANCE hInstance)
 // --------------------------------------------------------
 Game::~Game()
 {
-	// Free all entities
+	// Free all entities, then stop the threads they and the narrowphase ran on
 	entityFactory.Release();
+	if (collisionManager) collisionManager->SetJobSystem(nullptr);
+	delete jobSystem;
 
 	// Free all meshes
 	for (auto it = meshes.begin(); it != meshes.end(); it++)
@@ -89,6 +96,18 @@ void Game::Init()
 	renderer = Renderer::Initialize(this);
 	collisionManager = CollisionManager::Initialize(0.25f, XMFLOAT3(3, 3, 0.5));
 
+	// Scenery never tests against scenery, and projectiles pass through each
+	// other and the player firing them
+	collisionManager->SetLayersCollide(LAYER_STATIC, LAYER_STATIC, false);
+	collisionManager->SetLayersCollide(LAYER_PROJECTILE, LAYER_PROJECTILE, false);
+	collisionManager->SetLayersCollide(LAYER_PROJECTILE, LAYER_PLAYER, false);
+	collisionManager->SetEntityRegistry(&entityFactory.GetRegistry());
+
+
+	// Entities update and collisions are tested on a thread per core
+	jobSystem = new JobSystem(std::thread::hardware_concurrency());
+	entityFactory.SetJobSystem(jobSystem);
+	collisionManager->SetJobSystem(jobSystem);
 
 	// Setup Scenes and State Manager
 	stateManager.SetEntityFactory(&entityFactory);
@@ -235,6 +254,40 @@ void Game::LoadDefaultScene()
 	stateManager.SetState(GameState::MAIN_MENU);
 }
 
+// --------------------------------------------------------
+// Writes how long the last scene switch took to the debug
+// console, unloading and loading separately
+// --------------------------------------------------------
+void Game::PrintSceneSwitchTime()
+{
+#if defined(DEBUG) || defined(_DEBUG)
+	printf("\nScene switch: %.3f ms unload, %.3f ms load",
+		stateManager.GetLastUnloadMilliseconds(), stateManager.GetLastLoadMilliseconds());
+#endif
+}
+
+
+// --------------------------------------------------------
+// Scripted input of a soak test
+//
+// frame - index of the frame the input is for
+// input - cleared snapshot to press keys in
+// --------------------------------------------------------
+void Game::SoakInput(unsigned int frame, InputSnapshot& input)
+{
+	// Back to the menu and into the game again, which starts it the first time
+	unsigned int reloadFrame = frame % GAME_SOAK_RELOAD_FRAMES;
+	if (reloadFrame == GAME_SOAK_RELOAD_FRAMES - 1)
+		input.keys['3'] = true;
+	if (reloadFrame == 0)
+		input.keys['4'] = true;
+
+	// Turn every two seconds, fire in turn each way for half a second
+	const char moves[] = { 'W', 'D', 'S', 'A' };
+	const unsigned int fires[] = { INPUT_KEY_UP, INPUT_KEY_RIGHT, INPUT_KEY_DOWN, INPUT_KEY_LEFT };
+	input.keys[(unsigned char)moves[frame / 120 % 4]] = true;
+	input.keys[fires[frame / 30 % 4]] = true;
+}
 
 // --------------------------------------------------------
 // Handle resizing DirectX "stuff" to match the new window size.
@@ -260,57 +313,48 @@ void Game::OnResize(unsigned int width, unsigned int height)
 void Game::Update(float deltaTime, float totalTime)
 {
 	// Quit if the escape key is pressed
-	if (GetAsyncKeyState(VK_ESCAPE))
+	if (Input::IsKeyDown(INPUT_KEY_ESCAPE))
 		Quit();
 
-	if (GetAsyncKeyState('1') & 0x8000)
+	if (Input::IsKeyDown('1'))
 	{
 		activeCamera = gameCamera;
 	}
-	if (GetAsyncKeyState('2') & 0x8000)
+	if (Input::IsKeyDown('2'))
 	{
 		activeCamera = debugCamera;
 	}
 
-	if (GetAsyncKeyState('3') & 0x8000)
+	// Every tick of a frame sees the same keys, so switch on the press only
+	bool isMenuKeyDown = Input::IsKeyDown('3');
+	bool isGameKeyDown = Input::IsKeyDown('4');
+	if (isMenuKeyDown && !wasMenuKeyDown)
 	{
 		stateManager.SetState(GameState::MAIN_MENU);
+		PrintSceneSwitchTime();
 	}
-	if (GetAsyncKeyState('4') & 0x8000)
+	if (isGameKeyDown && !wasGameKeyDown)
 	{
 		stateManager.SetState(GameState::GAME);
+		PrintSceneSwitchTime();
 	}
+	wasMenuKeyDown = isMenuKeyDown;
+	wasGameKeyDown = isGameKeyDown;
 
 	//mouse pos
-	POINT cursorPos;
-	GetCursorPos(&cursorPos);
-	mouseX = static_cast<float>(cursorPos.x);
-	mouseY = static_cast<float>(cursorPos.y);
-
-
-	// Update camera
-	activeCamera->Update(deltaTime, totalTime);
+	mouseX = static_cast<float>(Input::GetSnapshot().mouseX);
+	mouseY = static_cast<float>(Input::GetSnapshot().mouseY);
 
 	// Update all entities
 	entityFactory.UpdateEntities(deltaTime, totalTime);
-	
-	// set cursor to center of screen
-	if(activeCamera == debugCamera)
-		SetCursorPos(
-			GetWindowLocation().x + GetWidth() / 2,
-			GetWindowLocation().y + GetHeight() / 2
-		);
-
 
 	//check for collisions
 	collisionManager->CollisionUpdate();
+	entityFactory.FlushDestroyedEntities();	// Entities destroyed by collision callbacks
 
 	// Update Scene
 	if(stateManager.GetCurrentScene() != nullptr)
 		stateManager.GetCurrentScene()->UpdateScene(deltaTime, totalTime);
-
-	// Dispatch compute shaders
-	renderer->UpdateCS(deltaTime, totalTime);
 }
 
 // --------------------------------------------------------
@@ -318,8 +362,21 @@ void Game::Update(float deltaTime, float totalTime)
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime)
 {
-	// Render to active camera
-	renderer->Render(activeCamera);
+	// The camera and particles move every frame, not just on ticks
+	activeCamera->Update(deltaTime, totalTime);
+
+	// set cursor to center of screen
+	if(activeCamera == debugCamera)
+		SetCursorPos(
+			GetWindowLocation().x + GetWidth() / 2,
+			GetWindowLocation().y + GetHeight() / 2
+		);
+
+	// Dispatch compute shaders
+	renderer->UpdateCS(deltaTime, totalTime);
+
+	// Render to active camera, entities blended between the last two ticks
+	renderer->Render(activeCamera, GetInterpolationAlpha());
 }
 
 
@@ -15,6 +15,7 @@
 
 // Rendering
 #include "Renderer.h"
+#include "MaterialParallax.h"
 
 //Collisions
 #include "CollisionManager.h"
@@ -31,6 +32,13 @@
 #define GAME_HEIGHT 4.0f
 #define GAME_HEIGHT_HALF GAME_HEIGHT * 0.5f
 
+// Simulation ticks per second, frames between ticks are interpolated
+#define GAME_TICK_RATE 60.0f
+#define GAME_MAX_SUBSTEPS 5
+
+// Frames between scene reloads of a soak test
+#define GAME_SOAK_RELOAD_FRAMES 1800
+
 class Game 
 	: public DXWindow
 {
@@ -51,6 +59,10 @@ public:
 	void OnMouseMove (WPARAM buttonState, int x, int y);
 	void OnMouseWheel(float wheelDelta,   int x, int y);
 
+	// Input of a headless soak test: starts the game, flies the player around
+	// firing every way, and reloads the scene now and then
+	static void SoakInput(unsigned int frame, InputSnapshot& input);
+
 private:
 
 	// Initialization helper methods - feel free to customize, combine, etc.
@@ -58,9 +70,11 @@ private:
 	void CreateCameras();
 	void CreateBasicGeometry();
 	void LoadDefaultScene();
+	void PrintSceneSwitchTime();
 
-	// Entities
+	// Entities, and the threads they update on
 	EntityFactory entityFactory;
+	JobSystem* jobSystem;
 
 	// Renderers
 	Renderer* renderer;
@@ -96,5 +110,10 @@ private:
 	//mouse x and y positions
 	float mouseY;
 	float mouseX;
+
+	// Scene keys as of the last tick, a scene is switched once when its key
+	// goes down, not on every tick it is held for
+	bool wasMenuKeyDown = false;
+	bool wasGameKeyDown = false;
 };
 
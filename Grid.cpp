@@ -0,0 +1,53 @@
+#include "Grid.h"
+#include "MemoryDebug.h"
+
+Grid::Grid()
+{
+}
+
+Grid::Grid(float maxScale, XMFLOAT3 halfWidth)
+{
+	this->halfWidth = halfWidth;
+	XMVECTOR hwVec = XMLoadFloat3(&halfWidth);
+	XMFLOAT3 temp;
+	XMStoreFloat3(&temp, hwVec / maxScale);
+	cols = static_cast<int>(temp.x);
+}
+
+Grid::~Grid()
+{
+}
+
+std::unordered_map<int, std::list<void(*)>>& Grid::getMapRef()
+{
+	return grid;
+}
+
+void Grid::clear()
+{
+	grid.clear();
+}
+
+void Grid::insert(XMFLOAT3 colLoc, XMFLOAT3 colHalf, void(*colAddress))
+{
+	//calc min and max ijk
+	float colFloat = static_cast<float>(cols);
+	XMVECTOR hwVec = XMLoadFloat3(&halfWidth);
+	XMVECTOR clVec = XMLoadFloat3(&colLoc);
+	XMVECTOR chVec = XMLoadFloat3(&colHalf);
+	XMVECTOR colVec = XMVectorReplicate(colFloat);
+	XMFLOAT3 ijkMin, ijkMax;
+	XMStoreFloat3(&ijkMin, (clVec - chVec + hwVec) * colVec / (2.0f * hwVec));
+	XMStoreFloat3(&ijkMax, (clVec + chVec + hwVec) * colVec / (2.0f * hwVec));
+
+	//calc hash
+	for (int i = static_cast<int>(ijkMin.x); i <= static_cast<int>(ijkMax.x); i++) {
+		for (int j = static_cast<int>(ijkMin.y); j <= static_cast<int>(ijkMax.y); j++) {
+			for (int k = static_cast<int>(ijkMin.z); k <= static_cast<int>(ijkMax.z); k++) {
+				int h = i + cols*j + cols*cols*k;
+				//insert
+				grid[h].push_front(colAddress);
+			}
+		}
+	}
+}
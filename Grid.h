@@ -0,0 +1,26 @@
+#pragma once
+#include <unordered_map>
+#include <list>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Uniform grid stored as a map of cell hash -> list of colliders.
+// Kept as the reference broadphase for benchmarking, the collision manager
+// uses the flat SpatialHash instead.
+class Grid
+{
+public:
+	Grid();
+	Grid(float maxScale, XMFLOAT3 halfWidth);
+	~Grid();
+
+	int cols = 1;
+	XMFLOAT3 halfWidth = XMFLOAT3(10, 10, 10);
+	std::unordered_map<int, std::list<void(*)>> grid;
+
+	std::unordered_map<int, std::list<void(*)>>& getMapRef();
+	void clear();
+	void insert(XMFLOAT3 colLoc, XMFLOAT3 colHalf, void(*colAddress));
+};
+
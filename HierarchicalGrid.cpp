@@ -0,0 +1,226 @@
+#include "HierarchicalGrid.h"
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Cap on the levels, cells of the last one are 2^15 times the first's
+#define HIERARCHICAL_GRID_MAX_LEVELS 16
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+HierarchicalGrid::HierarchicalGrid()
+{
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// minScale		- cell half width of the finest level, the smallest
+//				  expected collider half width
+// halfWidth	- half extents of the world the grid covers
+//
+// Levels are added until one cell spans the world on every
+// axis. Each level splits every axis by its own extent.
+// --------------------------------------------------------
+HierarchicalGrid::HierarchicalGrid(float minScale, XMFLOAT3 halfWidth) :
+	minScale(minScale),
+	halfWidth(halfWidth)
+{
+	float widest = halfWidth.x > halfWidth.y ? halfWidth.x : halfWidth.y;
+	if (halfWidth.z > widest) widest = halfWidth.z;
+
+	float scale = minScale;
+	do {
+		levels.push_back(SpatialHash(scale, halfWidth));
+		scale *= 2.0f;
+	} while (scale < widest * 2.0f && levels.size() < HIERARCHICAL_GRID_MAX_LEVELS);
+	levelCounts.assign(levels.size(), 0);
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+HierarchicalGrid::~HierarchicalGrid()
+{
+}
+
+// --------------------------------------------------------
+// Start tracking a proxy in the level that fits it
+// --------------------------------------------------------
+void HierarchicalGrid::AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	if (id >= proxies.size()) {
+		ProxyBounds untracked = { XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0), -1 };
+		proxies.resize(id + 1, untracked);
+	}
+
+	int level = FindLevel(halfExtents);
+	proxies[id] = { center, halfExtents, level };
+	levels[level].AddProxy(id, center, halfExtents);
+	levelCounts[level]++;
+}
+
+// --------------------------------------------------------
+// Stop tracking a proxy
+// --------------------------------------------------------
+void HierarchicalGrid::RemoveProxy(unsigned int id)
+{
+	int level = proxies[id].level;
+	levels[level].RemoveProxy(id);
+	levelCounts[level]--;
+	proxies[id].level = -1;
+}
+
+// --------------------------------------------------------
+// Stop tracking every proxy in every level
+// --------------------------------------------------------
+void HierarchicalGrid::RemoveAllProxies()
+{
+	for (size_t level = 0; level < levels.size(); level++)
+		levels[level].RemoveAllProxies();
+	levelCounts.assign(levels.size(), 0);
+	proxies.clear();
+}
+
+// --------------------------------------------------------
+// Store new bounds for a proxy, moving it to another level
+// when its size changed enough
+// --------------------------------------------------------
+void HierarchicalGrid::UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	ProxyBounds& proxy = proxies[id];
+	proxy.center = center;
+	proxy.halfExtents = halfExtents;
+
+	int level = FindLevel(halfExtents);
+	if (level == proxy.level) {
+		levels[level].UpdateProxy(id, center, halfExtents);
+		return;
+	}
+
+	levels[proxy.level].RemoveProxy(id);
+	levelCounts[proxy.level]--;
+	levels[level].AddProxy(id, center, halfExtents);
+	levelCounts[level]++;
+	proxy.level = level;
+}
+
+// --------------------------------------------------------
+// Rebin every level, then add the pairs sharing a cell in a
+// level and the pairs each proxy finds in coarser levels
+// --------------------------------------------------------
+void HierarchicalGrid::FindPairs(CollisionPairCache& pairCache)
+{
+	int top = -1;
+	for (unsigned int level = 0; level < levels.size(); level++) {
+		if (levelCounts[level] == 0) continue;
+		levels[level].Rebin();
+		top = static_cast<int>(level);
+	}
+
+	// Within a level, bounds are checked first since colliders much
+	// smaller than the level's cells share them with many others
+	for (unsigned int level = 0; level < levels.size(); level++) {
+		if (levelCounts[level] < 2) continue;
+		SpatialHash& hash = levels[level];
+		unsigned int cellCount = hash.GetCellCount();
+		for (unsigned int cell = 0; cell < cellCount; cell++) {
+			unsigned int count;
+			const unsigned int* ids = hash.GetCell(cell, count);
+
+			for (unsigned int i = 0; i < count; i++) {
+				const ProxyBounds& a = proxies[ids[i]];
+				for (unsigned int j = i + 1; j < count; j++) {
+					const ProxyBounds& b = proxies[ids[j]];
+					if (ids[i] == ids[j] ||
+						fabsf(a.center.x - b.center.x) > a.halfExtents.x + b.halfExtents.x ||
+						fabsf(a.center.y - b.center.y) > a.halfExtents.y + b.halfExtents.y ||
+						fabsf(a.center.z - b.center.z) > a.halfExtents.z + b.halfExtents.z ||
+						!CanPair(ids[i], ids[j]))
+						continue;
+					pairCache.AddCandidate(ids[i], ids[j]);
+				}
+			}
+		}
+	}
+
+	// Across levels, only toward coarser ones so each pair is looked for once
+	for (unsigned int id = 0; id < proxies.size(); id++) {
+		const ProxyBounds& proxy = proxies[id];
+		if (proxy.level < 0) continue;
+
+		for (int level = proxy.level + 1; level <= top; level++) {
+			if (levelCounts[level] == 0) continue;
+			levelCandidates.clear();
+			levels[level].QueryBox(proxy.center, proxy.halfExtents, levelCandidates);
+			for (size_t i = 0; i < levelCandidates.size(); i++) {
+				if (CanPair(id, levelCandidates[i]))
+					pairCache.AddCandidate(id, levelCandidates[i]);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Append every proxy whose bounds overlap the box, from
+// every level holding anything
+// --------------------------------------------------------
+void HierarchicalGrid::QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results)
+{
+	for (unsigned int level = 0; level < levels.size(); level++) {
+		if (levelCounts[level] > 0)
+			levels[level].QueryBox(center, halfExtents, results);
+	}
+}
+
+// --------------------------------------------------------
+// Append every proxy whose bounds the segment crosses, from
+// every level holding anything
+// --------------------------------------------------------
+void HierarchicalGrid::QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results)
+{
+	for (unsigned int level = 0; level < levels.size(); level++) {
+		if (levelCounts[level] > 0)
+			levels[level].QueryRay(origin, direction, maxDistance, results);
+	}
+}
+
+// --------------------------------------------------------
+// Number of levels, finest first
+// --------------------------------------------------------
+unsigned int HierarchicalGrid::GetLevelCount() const
+{
+	return static_cast<unsigned int>(levels.size());
+}
+
+// --------------------------------------------------------
+// Proxies currently in a level
+// --------------------------------------------------------
+unsigned int HierarchicalGrid::GetLevelProxyCount(unsigned int level) const
+{
+	return levelCounts[level];
+}
+
+// --------------------------------------------------------
+// Finest level whose cells are at least as large as the
+// bounds. Extents beyond the world on an axis are clamped
+// to its border cells, so only the part inside counts.
+// --------------------------------------------------------
+int HierarchicalGrid::FindLevel(const XMFLOAT3& halfExtents) const
+{
+	const float* h = &halfExtents.x;
+	const float* w = &halfWidth.x;
+	float largest = 0;
+	for (int axis = 0; axis < 3; axis++) {
+		float inside = h[axis] < w[axis] ? h[axis] : w[axis];
+		if (inside > largest) largest = inside;
+	}
+
+	int level = 0;
+	float scale = minScale;
+	while (scale < largest && level + 1 < static_cast<int>(levels.size())) {
+		scale *= 2.0f;
+		level++;
+	}
+	return level;
+}
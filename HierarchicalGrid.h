@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "Broadphase.h"
+#include "SpatialHash.h"
+
+using namespace DirectX;
+
+// Stack of spatial hashes whose cells double in size from one level to the
+// next, for colliders of very different sizes. Each collider lives in the
+// finest level whose cells are at least as large as it is, so it covers at
+// most two cells per axis there and small colliders never share cells with
+// large ones. Pairs are found in each level's cells, and across levels by
+// every collider querying the coarser levels that hold anything.
+class HierarchicalGrid :
+	public Broadphase
+{
+public:
+	HierarchicalGrid();
+	HierarchicalGrid(float minScale, XMFLOAT3 halfWidth);
+	~HierarchicalGrid();
+
+	// Inherited via Broadphase, every level is rebuilt in FindPairs
+	void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void RemoveProxy(unsigned int id) override;
+	void RemoveAllProxies() override;
+	void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void FindPairs(CollisionPairCache& pairCache) override;
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) override;
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) override;
+
+	unsigned int GetLevelCount() const;
+
+	// Proxies in a level
+	unsigned int GetLevelProxyCount(unsigned int level) const;
+
+private:
+	float minScale = 1.0f;
+	XMFLOAT3 halfWidth = XMFLOAT3(10, 10, 10);
+
+	std::vector<SpatialHash> levels;		// Finest first, cell half widths of minScale * 2^level
+	std::vector<unsigned int> levelCounts;	// Proxies in each level
+
+	// Bounds and level of every proxy, indexed by proxy id
+	struct ProxyBounds {
+		XMFLOAT3 center;
+		XMFLOAT3 halfExtents;
+		int level;	// -1 when not tracked
+	};
+	std::vector<ProxyBounds> proxies;
+	std::vector<unsigned int> levelCandidates;
+
+	int FindLevel(const XMFLOAT3& halfExtents) const;
+};
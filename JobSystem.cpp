@@ -0,0 +1,226 @@
+#include "JobSystem.h"
+#include "MemoryDebug.h"
+
+// Index of the running thread in the job system it works for
+static thread_local unsigned int currentThread = 0;
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+JobCounter::JobCounter()
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+JobCounter::~JobCounter()
+{
+}
+
+// --------------------------------------------------------
+// Whether every job counted has finished
+// --------------------------------------------------------
+bool JobCounter::IsDone()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return count == 0;
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// threadCount	- threads running jobs, including the one
+//				  creating the system
+// --------------------------------------------------------
+JobSystem::JobSystem(unsigned int threadCount) :
+	workers(new Worker[threadCount > 0 ? threadCount : 1]),
+	threadCount(threadCount > 0 ? threadCount : 1),
+	queuedJobs(0)
+{
+	for (unsigned int i = 1; i < this->threadCount; i++)
+		threads.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+}
+
+// --------------------------------------------------------
+// Destructor, joins every worker. Jobs still queued are
+// dropped without running.
+// --------------------------------------------------------
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		isShuttingDown = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+}
+
+unsigned int JobSystem::GetThreadCount() const
+{
+	return threadCount;
+}
+
+unsigned int JobSystem::GetCurrentThread()
+{
+	return currentThread;
+}
+
+// --------------------------------------------------------
+// Count the job toward its signal, then queue it, or hand
+// it to the counter it waits on when that is not done yet
+// --------------------------------------------------------
+void JobSystem::Submit(JobFunction work, JobCounter* signal, JobCounter* after)
+{
+	Job job = { std::move(work), signal };
+	if (signal != nullptr) {
+		std::lock_guard<std::mutex> lock(signal->mutex);
+		signal->count++;
+	}
+
+	if (after != nullptr) {
+		std::lock_guard<std::mutex> lock(after->mutex);
+		if (after->count != 0) {
+			after->waiting.push_back(std::move(job));
+			return;
+		}
+	}
+	Push(job);
+}
+
+// --------------------------------------------------------
+// Help run jobs until the counter reaches zero, yielding
+// when there is nothing to take
+// --------------------------------------------------------
+void JobSystem::Wait(JobCounter& counter)
+{
+	unsigned int thread = currentThread;
+	while (!counter.IsDone()) {
+		if (!RunOne(thread))
+			std::this_thread::yield();
+	}
+}
+
+// --------------------------------------------------------
+// Split a loop into a job per batch and wait for them
+// --------------------------------------------------------
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int, unsigned int)>& task)
+{
+	if (batchSize == 0) batchSize = 1;
+	if (threads.empty() || count <= batchSize) {
+		if (count > 0) task(0, count, currentThread);
+		return;
+	}
+
+	JobCounter counter;
+	for (unsigned int begin = 0; begin < count; begin += batchSize) {
+		unsigned int end = count - begin > batchSize ? begin + batchSize : count;
+		Submit([&task, begin, end](unsigned int thread) { task(begin, end, thread); }, &counter);
+	}
+	Wait(counter);
+}
+
+// --------------------------------------------------------
+// Queue a job on the back of the calling thread's deque
+// and wake a worker for it
+// --------------------------------------------------------
+void JobSystem::Push(const Job& job)
+{
+	// Counted before it can be taken, so the count never drops below zero
+	queuedJobs++;
+	Worker& worker = workers[currentThread < threadCount ? currentThread : 0];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(job);
+	}
+
+	// Taking the lock orders this after a worker's check that nothing is queued
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+// --------------------------------------------------------
+// Take the newest job of the thread's own deque, or steal
+// the oldest of another's, trying each in turn from the
+// next thread over
+// --------------------------------------------------------
+bool JobSystem::Take(unsigned int thread, Job& job)
+{
+	{
+		Worker& own = workers[thread];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			queuedJobs--;
+			return true;
+		}
+	}
+
+	for (unsigned int i = 1; i < threadCount; i++) {
+		Worker& victim = workers[(thread + i) % threadCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			queuedJobs--;
+			return true;
+		}
+	}
+	return false;
+}
+
+// --------------------------------------------------------
+// Run one job if any can be taken
+// --------------------------------------------------------
+bool JobSystem::RunOne(unsigned int thread)
+{
+	Job job;
+	if (!Take(thread, job))
+		return false;
+
+	job.work(thread);
+	Finish(job);
+	return true;
+}
+
+// --------------------------------------------------------
+// Count a finished job off its signal, queueing the jobs
+// that waited on the signal once it reaches zero
+// --------------------------------------------------------
+void JobSystem::Finish(const Job& job)
+{
+	if (job.signal == nullptr)
+		return;
+
+	std::vector<Job> released;
+	{
+		std::lock_guard<std::mutex> lock(job.signal->mutex);
+		if (--job.signal->count == 0)
+			released.swap(job.signal->waiting);
+	}
+
+	// The signal may be gone from here on, a waiter could have seen it reach zero
+	for (size_t i = 0; i < released.size(); i++)
+		Push(released[i]);
+}
+
+// --------------------------------------------------------
+// Worker loop, runs jobs and sleeps while none are queued
+// --------------------------------------------------------
+void JobSystem::WorkerMain(unsigned int thread)
+{
+	currentThread = thread;
+	while (true) {
+		if (RunOne(thread))
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this] { return isShuttingDown || queuedJobs > 0; });
+		if (isShuttingDown) return;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+// Work run by a job, given the index of the thread running it
+typedef std::function<void(unsigned int thread)> JobFunction;
+
+struct Job {
+	JobFunction work;
+	JobCounter* signal;	// Counted down when the job finishes, may be null
+};
+
+// Number of unfinished jobs submitted with it. Jobs can be held back until a
+// counter reaches zero, which is how one job is made to wait for others.
+// Counters are cheap and meant to live on the stack of whoever waits on them.
+class JobCounter
+{
+public:
+	JobCounter();
+	~JobCounter();
+
+	bool IsDone();
+
+private:
+	friend class JobSystem;
+
+	// Both guarded by the mutex, so a waiter that sees zero knows the job
+	// that got it there is done with the counter
+	std::mutex mutex;
+	unsigned int count = 0;
+	std::vector<Job> waiting;	// Submitted once the count reaches zero
+};
+
+// Work stealing job system. Every thread has its own deque of jobs: a thread
+// pushes the jobs it submits onto the back of its own deque and takes its
+// next job from there too, so it keeps working on what it just made while it
+// is still in cache. A thread whose deque is empty steals from the front of
+// another's, taking the oldest and usually largest piece of work. Workers
+// sleep while nothing is queued. The thread creating the system is thread 0
+// and only runs jobs while it waits on a counter.
+class JobSystem
+{
+public:
+	// threadCount includes the creating thread
+	JobSystem(unsigned int threadCount);
+	~JobSystem();
+
+	unsigned int GetThreadCount() const;
+
+	// Index of the thread calling, 0 for every thread that is not a worker.
+	// Unique among threads running jobs at the same time, for picking per
+	// thread data.
+	static unsigned int GetCurrentThread();
+
+	// Queue a job on the calling thread's deque. It counts toward signal
+	// until it finishes, and is not queued before after reaches zero.
+	void Submit(JobFunction work, JobCounter* signal = nullptr, JobCounter* after = nullptr);
+
+	// Run jobs until the counter reaches zero. Only call from the creating
+	// thread or from within a job.
+	void Wait(JobCounter& counter);
+
+	// Run task(begin, end, thread) over [0, count) in batches of batchSize
+	// and wait for them all. A count of one batch or less runs inline.
+	void ParallelFor(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int begin, unsigned int end, unsigned int thread)>& task);
+
+private:
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::unique_ptr<Worker[]> workers;	// One per thread, indexed by thread
+	std::vector<std::thread> threads;
+	unsigned int threadCount;
+
+	// Workers sleep on this while nothing is queued
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<unsigned int> queuedJobs;
+	bool isShuttingDown = false;
+
+	void Push(const Job& job);
+	bool Take(unsigned int thread, Job& job);
+	bool RunOne(unsigned int thread);
+	void Finish(const Job& job);
+	void WorkerMain(unsigned int thread);
+};
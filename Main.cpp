@@ -1,4 +1,8 @@
 #include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "Game.h"
 #include "MemoryDebug.h"
 
@@ -40,6 +44,24 @@ int WINAPI WinMain(
 	//hr = dxGame.InitDirectX();
 	//if(FAILED(hr)) return hr;
 
+	// "-frames N" runs N frames of scripted input without drawing, each a
+	// tick long, then quits. For profiling and soak tests. This still opens
+	// the window and device the renderer needs; Benchmark/SoakBenchmark is
+	// the windowless soak of the entities and collisions.
+	const char* framesArgument = strstr(lpCmdLine, "-frames ");
+	if (framesArgument != nullptr) {
+		unsigned int frames = (unsigned int)strtoul(framesArgument + strlen("-frames "), nullptr, 10);
+#if defined(DEBUG) || defined(_DEBUG)
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+		hr = dxGame.RunHeadless(frames, 1.0f / GAME_TICK_RATE, Game::SoakInput);
+#if defined(DEBUG) || defined(_DEBUG)
+		printf("\nRan %u headless frames in %.3f s", frames,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+#endif
+		return hr;
+	}
+
 	// Begin the message and game loop, and then return
 	// whatever we get back once the game loop is over
 	return dxGame.Run();
@@ -1,6 +1,7 @@
 // Simple new override that will track the file name and location of malloc.
 
 #pragma once
+#ifdef _WIN32
 #define _CRTDBG_MAP_ALLOC
 #include <cstdlib>
 #include <crtdbg.h>
@@ -9,4 +10,5 @@
 #define new new ( _NORMAL_BLOCK , __FILE__ , __LINE__ )
 // Replace _NORMAL_BLOCK with _CLIENT_BLOCK if you want the
 // allocations to be of _CLIENT_BLOCK type
-#endif
\ No newline at end of file
+#endif
+#endif
@@ -76,6 +76,15 @@ const int Mesh::GetIndexCount() const
 	return numIndices;
 }
 
+// --------------------------------------------------------
+// Get the bounding shapes and convex hull fitted to the
+// vertices of this mesh
+// --------------------------------------------------------
+const ConvexHull & Mesh::GetConvexHull() const
+{
+	return convexHull;
+}
+
 
 // --------------------------------------------------------
 // Loads an OBJ file onto the stack then uploads the model
@@ -517,6 +526,9 @@ bool Mesh::UploadModel(const MeshParameters& params, ID3D11Device* const device)
 	vertexBuffer = nullptr;
 	indexBuffer = nullptr;
 
+	// Fit the collision shapes while the vertices are still on the CPU
+	convexHull.Build(&params.vertices[0].Position, params.numVerts, sizeof(Vertex));
+
 	// Create the VERTEX BUFFER description -----------------------------------
 	// - The description is created on the stack because we only need
 	//    it to create the buffer.  The description is then useless.
@@ -4,6 +4,7 @@
 #include <vector>
 #include <fstream>
 #include "Vertex.h"
+#include "ConvexHull.h"
 #include <assimp\Importer.hpp>
 #include <assimp\postprocess.h>
 #include <assimp\scene.h>
@@ -32,6 +33,10 @@ public:
 	ID3D11Buffer* const GetIndexBuffer() const;
 	const int GetIndexCount() const;
 
+	// Bounding shapes and simplified convex hull of the vertex positions,
+	// fitted when the model is uploaded, for colliders fitted to the mesh
+	const ConvexHull& GetConvexHull() const;
+
 private:
 	// Use this struct when passing parameters around
 	struct MeshParameters
@@ -53,5 +58,8 @@ private:
 	ID3D11Buffer* indexBuffer;
 	int numIndices;
 
+	// Fitted before the vertices are let go of
+	ConvexHull convexHull;
+
 };
 
@@ -0,0 +1,881 @@
+#include <cmath>
+#include <algorithm>
+#include "Narrowphase.h"
+#include "BoxCollision.h"
+#include "ConvexCollision.h"
+#include "PlanarCollision.h"
+#include "CollisionKernels.h"
+#include "MemoryDebug.h"
+
+// Candidates handed to a thread at a time
+#define NARROWPHASE_CHUNK_SIZE 512
+
+static const ContactResult noContact = { false, XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0), 0 };
+
+// --------------------------------------------------------
+// Axis of least penetration for a point inside a box, given
+// as its offset along the box axes. Returns the axis, sets
+// gap to the distance to the nearest face and sign to the
+// side of that face.
+// --------------------------------------------------------
+static inline int NearestFace(const float* offset, const float* halfWidths, int axisCount, float& gap, float& sign)
+{
+	int nearest = 0;
+	gap = halfWidths[0] - fabsf(offset[0]);
+	for (int i = 1; i < axisCount; i++) {
+		float g = halfWidths[i] - fabsf(offset[i]);
+		if (g < gap) { gap = g; nearest = i; }
+	}
+	sign = offset[nearest] < 0 ? -1.0f : 1.0f;
+	return nearest;
+}
+
+// --------------------------------------------------------
+// Point on the surface of sphere a facing sphere b, along
+// the line between their centers
+// --------------------------------------------------------
+static void ContactSphereVsSphere(const ColliderStore& store, unsigned int a, unsigned int b, ContactResult& result)
+{
+	const XMFLOAT4& aRow = store.positions[a];
+	const XMFLOAT4& bRow = store.positions[b];
+	XMVECTOR aPos = XMLoadFloat4(&aRow);
+	XMVECTOR bPos = XMLoadFloat4(&bRow);
+	XMVECTOR normal = XMVector3Normalize(bPos - aPos);
+	XMVECTOR point = aPos + normal * aRow.w;
+
+	// Concentric spheres have no direction, use the center and push b up
+	if (XMVector3Equal(aPos, bPos)) {
+		point = aPos;
+		normal = XMVectorSet(0, 1, 0, 0);
+	}
+
+	result.isTouching = true;
+	result.depth = aRow.w + bRow.w - XMVectorGetX(XMVector3Length(bPos - aPos));
+	XMStoreFloat3(&result.point, point);
+	XMStoreFloat3(&result.normal, normal);
+}
+
+// --------------------------------------------------------
+// Point on box b nearest to the center of sphere a. With
+// the center inside the box, b is pushed out of its nearest
+// face.
+// --------------------------------------------------------
+static void ContactSphereVsAABB(const ColliderStore& store, unsigned int a, unsigned int b, ContactResult& result)
+{
+	const XMFLOAT4& aRow = store.positions[a];
+	XMVECTOR aPos = XMLoadFloat4(&aRow);
+	XMVECTOR bPos = XMLoadFloat4(&store.positions[b]);
+	XMVECTOR extent = XMLoadFloat4(&store.halfExtents[b]);
+	XMVECTOR clamped = XMVectorClamp(aPos - bPos, -extent, extent);
+	XMVECTOR nearest = bPos + clamped;
+
+	result.isTouching = true;
+	XMStoreFloat3(&result.point, nearest);
+
+	// Measured in b's frame, nearest - aPos need not round to zero outside the box
+	XMVECTOR toNearest = clamped - (aPos - bPos);
+	if (!XMVector3Equal(toNearest, XMVectorZero())) {
+		float distance = XMVectorGetX(XMVector3Length(toNearest));
+		XMStoreFloat3(&result.normal, toNearest / distance);
+		result.depth = aRow.w - distance;
+		return;
+	}
+
+	const XMFLOAT4& bRow = store.positions[b];
+	float offset[3] = { aRow.x - bRow.x, aRow.y - bRow.y, aRow.z - bRow.z };
+	float gap, sign;
+	int axis = NearestFace(offset, &store.halfExtents[b].x, 3, gap, sign);
+	float normal[3] = { 0, 0, 0 };
+	normal[axis] = -sign;
+	result.normal = XMFLOAT3(normal[0], normal[1], normal[2]);
+	result.depth = aRow.w + gap;
+}
+
+// --------------------------------------------------------
+// Center of the region where boxes a and b overlap, pushed
+// apart along the axis they overlap least on
+// --------------------------------------------------------
+static void ContactAABBVsAABB(const ColliderStore& store, unsigned int a, unsigned int b, ContactResult& result)
+{
+	XMVECTOR aPos = XMLoadFloat4(&store.positions[a]);
+	XMVECTOR bPos = XMLoadFloat4(&store.positions[b]);
+	XMVECTOR aExtent = XMLoadFloat4(&store.halfExtents[a]);
+	XMVECTOR bExtent = XMLoadFloat4(&store.halfExtents[b]);
+
+	XMVECTOR low = XMVectorMax(aPos - aExtent, bPos - bExtent);
+	XMVECTOR high = XMVectorMin(aPos + aExtent, bPos + bExtent);
+
+	result.isTouching = true;
+	XMStoreFloat3(&result.point, (low + high) * 0.5f);
+
+	const XMFLOAT4& aRow = store.positions[a];
+	const XMFLOAT4& bRow = store.positions[b];
+	const XMFLOAT4& aHalf = store.halfExtents[a];
+	const XMFLOAT4& bHalf = store.halfExtents[b];
+	float offset[3] = { bRow.x - aRow.x, bRow.y - aRow.y, bRow.z - aRow.z };
+	float reach[3] = { aHalf.x + bHalf.x, aHalf.y + bHalf.y, aHalf.z + bHalf.z };
+	float sign;
+	int axis = NearestFace(offset, reach, 3, result.depth, sign);
+	float normal[3] = { 0, 0, 0 };
+	normal[axis] = sign;
+	result.normal = XMFLOAT3(normal[0], normal[1], normal[2]);
+}
+
+// --------------------------------------------------------
+// Half width of a box along a unit axis. Axis aligned boxes
+// keep the world axes in the store, so this serves both.
+// --------------------------------------------------------
+static inline float BoxRadius(const ColliderStore& store, unsigned int box, FXMVECTOR axis)
+{
+	const XMFLOAT4& h = store.halfExtents[box];
+	const XMFLOAT3* boxAxes = &store.axes[box * 3];
+	return h.x * fabsf(XMVectorGetX(XMVector3Dot(axis, XMLoadFloat3(&boxAxes[0]))))
+		+ h.y * fabsf(XMVectorGetX(XMVector3Dot(axis, XMLoadFloat3(&boxAxes[1]))))
+		+ h.z * fabsf(XMVectorGetX(XMVector3Dot(axis, XMLoadFloat3(&boxAxes[2]))));
+}
+
+// --------------------------------------------------------
+// Oriented box against oriented or axis aligned box, on the
+// face axes of both and the cross products of their edges
+// --------------------------------------------------------
+static ContactResult BoxVsBox(const ColliderStore& store, unsigned int a, unsigned int b)
+{
+	const XMFLOAT4& aPos = store.positions[a];
+	const XMFLOAT4& bPos = store.positions[b];
+	const XMFLOAT4& aHalf = store.halfExtents[a];
+	const XMFLOAT4& bHalf = store.halfExtents[b];
+
+	BoxContact contact;
+	if (!OrientedBoxesOverlap(XMFLOAT3(aPos.x, aPos.y, aPos.z), &store.axes[a * 3], XMFLOAT3(aHalf.x, aHalf.y, aHalf.z),
+		XMFLOAT3(bPos.x, bPos.y, bPos.z), &store.axes[b * 3], XMFLOAT3(bHalf.x, bHalf.y, bHalf.z), &contact))
+		return noContact;
+
+	ContactResult result = { true, contact.point, contact.normal, contact.depth };
+	return result;
+}
+
+// --------------------------------------------------------
+// Oriented box against sphere, through the point on the box
+// nearest the sphere's center
+// --------------------------------------------------------
+static ContactResult BoxVsSphere(const ColliderStore& store, unsigned int box, unsigned int sphere)
+{
+	const XMFLOAT4& sphereRow = store.positions[sphere];
+	XMVECTOR boxPos = XMLoadFloat4(&store.positions[box]);
+	XMVECTOR spherePos = XMLoadFloat4(&sphereRow);
+	XMVECTOR offset = spherePos - boxPos;
+	const XMFLOAT3* boxAxes = &store.axes[box * 3];
+	const float* halfWidths = &store.halfExtents[box].x;
+
+	//clamp the offset along each box axis to its half width
+	XMVECTOR nearest = boxPos;
+	float local[3];
+	bool isInside = true;
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&boxAxes[i]);
+		float distance = XMVectorGetX(XMVector3Dot(offset, boxAxis));
+		local[i] = distance;
+		if (distance > halfWidths[i]) { distance = halfWidths[i]; isInside = false; }
+		if (distance < -halfWidths[i]) { distance = -halfWidths[i]; isInside = false; }
+		nearest += boxAxis * distance;
+	}
+
+	float distanceSq = XMVectorGetX(XMVector3LengthSq(spherePos - nearest));
+	if (distanceSq > sphereRow.w * sphereRow.w) return noContact;
+
+	ContactResult result = { true };
+	XMStoreFloat3(&result.point, nearest);
+	if (!isInside && distanceSq > 0) {
+		float distance = sqrtf(distanceSq);
+		XMStoreFloat3(&result.normal, (spherePos - nearest) / distance);
+		result.depth = sphereRow.w - distance;
+		return result;
+	}
+
+	// Center inside the box, push the sphere out of the nearest face
+	float gap, sign;
+	int axis = NearestFace(local, halfWidths, 3, gap, sign);
+	XMStoreFloat3(&result.normal, XMLoadFloat3(&boxAxes[axis]) * sign);
+	result.depth = sphereRow.w + gap;
+	return result;
+}
+
+// --------------------------------------------------------
+// Half volume against a collider reaching radius along the
+// plane normal. The volume is the side the normal, its
+// third axis, points into. The contact is the collider's
+// center dropped onto the plane, and the collider is pushed
+// back out against the normal.
+// --------------------------------------------------------
+static ContactResult HalfVolVsCollider(const ColliderStore& store, unsigned int plane, unsigned int other, FXMVECTOR normal, float radius)
+{
+	XMVECTOR planePos = XMLoadFloat4(&store.positions[plane]);
+	XMVECTOR otherPos = XMLoadFloat4(&store.positions[other]);
+
+	float distance = XMVectorGetX(XMVector3Dot(otherPos - planePos, normal));
+	if (distance < 0 && -distance > radius) return noContact;
+
+	ContactResult result = { true };
+	XMStoreFloat3(&result.point, otherPos - normal * distance);
+	XMStoreFloat3(&result.normal, -normal);
+	result.depth = radius + distance;
+	return result;
+}
+
+// --------------------------------------------------------
+// Planar contact raised to the height between the two
+// colliders' centers, the normal stays in the plane
+// --------------------------------------------------------
+static inline ContactResult PlanarContactResult(const ColliderStore& store, unsigned int a, unsigned int b, float x, float y, float normalX, float normalY, float depth)
+{
+	ContactResult result = { true, XMFLOAT3(x, y, (store.positions[a].z + store.positions[b].z) * 0.5f), XMFLOAT3(normalX, normalY, 0), depth };
+	return result;
+}
+
+// --------------------------------------------------------
+// Circle against circle, the contact is on a's edge facing
+// b
+// --------------------------------------------------------
+static ContactResult CircleVsCircle(const ColliderStore& store, unsigned int a, unsigned int b)
+{
+	const XMFLOAT4& aRow = store.positions[a];
+	const XMFLOAT4& bRow = store.positions[b];
+	float dx = bRow.x - aRow.x;
+	float dy = bRow.y - aRow.y;
+	float distanceSq = dx * dx + dy * dy;
+	float reach = aRow.w + bRow.w;
+	if (distanceSq > reach * reach) return noContact;
+
+	// Concentric circles have no direction, use the center and push b up
+	if (distanceSq == 0) return PlanarContactResult(store, a, b, aRow.x, aRow.y, 0, 1, reach);
+	float distance = sqrtf(distanceSq);
+	float scale = aRow.w / distance;
+	return PlanarContactResult(store, a, b, aRow.x + dx * scale, aRow.y + dy * scale, dx / distance, dy / distance, reach - distance);
+}
+
+// --------------------------------------------------------
+// Circle against axis aligned rectangle, through the point
+// of the rectangle nearest the circle's center
+// --------------------------------------------------------
+static ContactResult CircleVsRect(const ColliderStore& store, unsigned int circle, unsigned int rect)
+{
+	const XMFLOAT4& circleRow = store.positions[circle];
+	const XMFLOAT4& rectRow = store.positions[rect];
+	const XMFLOAT4& h = store.halfExtents[rect];
+	float offset[2] = { circleRow.x - rectRow.x, circleRow.y - rectRow.y };
+	float x = offset[0] > h.x ? h.x : offset[0] < -h.x ? -h.x : offset[0];
+	float y = offset[1] > h.y ? h.y : offset[1] < -h.y ? -h.y : offset[1];
+
+	float dx = offset[0] - x;
+	float dy = offset[1] - y;
+	float distanceSq = dx * dx + dy * dy;
+	if (distanceSq > circleRow.w * circleRow.w) return noContact;
+
+	if (distanceSq > 0) {
+		float distance = sqrtf(distanceSq);
+		return PlanarContactResult(store, circle, rect, rectRow.x + x, rectRow.y + y, -dx / distance, -dy / distance, circleRow.w - distance);
+	}
+
+	// Center inside the rectangle, push it out of the nearest edge
+	float gap, sign;
+	int axis = NearestFace(offset, &h.x, 2, gap, sign);
+	return PlanarContactResult(store, circle, rect, rectRow.x + x, rectRow.y + y, axis == 0 ? -sign : 0, axis == 1 ? -sign : 0, circleRow.w + gap);
+}
+
+// --------------------------------------------------------
+// Axis aligned rectangles, the contact is the middle of
+// their overlap
+// --------------------------------------------------------
+static ContactResult RectVsRect(const ColliderStore& store, unsigned int a, unsigned int b)
+{
+	const XMFLOAT4& aPos = store.positions[a];
+	const XMFLOAT4& bPos = store.positions[b];
+	const XMFLOAT4& aHalf = store.halfExtents[a];
+	const XMFLOAT4& bHalf = store.halfExtents[b];
+	if (fabsf(aPos.x - bPos.x) > aHalf.x + bHalf.x || fabsf(aPos.y - bPos.y) > aHalf.y + bHalf.y) return noContact;
+
+	float lowX = aPos.x - aHalf.x > bPos.x - bHalf.x ? aPos.x - aHalf.x : bPos.x - bHalf.x;
+	float highX = aPos.x + aHalf.x < bPos.x + bHalf.x ? aPos.x + aHalf.x : bPos.x + bHalf.x;
+	float lowY = aPos.y - aHalf.y > bPos.y - bHalf.y ? aPos.y - aHalf.y : bPos.y - bHalf.y;
+	float highY = aPos.y + aHalf.y < bPos.y + bHalf.y ? aPos.y + aHalf.y : bPos.y + bHalf.y;
+
+	float offset[2] = { bPos.x - aPos.x, bPos.y - aPos.y };
+	float reach[2] = { aHalf.x + bHalf.x, aHalf.y + bHalf.y };
+	float depth, sign;
+	int axis = NearestFace(offset, reach, 2, depth, sign);
+	return PlanarContactResult(store, a, b, (lowX + highX) * 0.5f, (lowY + highY) * 0.5f, axis == 0 ? sign : 0, axis == 1 ? sign : 0, depth);
+}
+
+// --------------------------------------------------------
+// Oriented rectangle against oriented or axis aligned
+// rectangle, on the 4 edge normals of both. Axis aligned
+// rectangles take the world x axis.
+// --------------------------------------------------------
+template <bool IsBOriented>
+static ContactResult ORectVsRect(const ColliderStore& store, unsigned int a, unsigned int b)
+{
+	const XMFLOAT4& aPos = store.positions[a];
+	const XMFLOAT4& bPos = store.positions[b];
+	const XMFLOAT4& aRect = store.planarRects[a];
+	const XMFLOAT4& bRect = IsBOriented ? store.planarRects[b] : XMFLOAT4(1, 0, store.halfExtents[b].x, store.halfExtents[b].y);
+
+	PlanarContact contact;
+	if (!OrientedRectsOverlap(XMFLOAT2(aPos.x, aPos.y), XMFLOAT2(aRect.x, aRect.y), XMFLOAT2(aRect.z, aRect.w),
+		XMFLOAT2(bPos.x, bPos.y), XMFLOAT2(bRect.x, bRect.y), XMFLOAT2(bRect.z, bRect.w), &contact))
+		return noContact;
+	return PlanarContactResult(store, a, b, contact.point.x, contact.point.y, contact.normal.x, contact.normal.y, contact.depth);
+}
+
+// --------------------------------------------------------
+// Oriented rectangle against circle
+// --------------------------------------------------------
+static ContactResult ORectVsCircle(const ColliderStore& store, unsigned int rect, unsigned int circle)
+{
+	const XMFLOAT4& rectRow = store.positions[rect];
+	const XMFLOAT4& circleRow = store.positions[circle];
+	const XMFLOAT4& r = store.planarRects[rect];
+
+	XMFLOAT2 nearest;
+	if (!OrientedRectOverlapsCircle(XMFLOAT2(rectRow.x, rectRow.y), XMFLOAT2(r.x, r.y), XMFLOAT2(r.z, r.w),
+		XMFLOAT2(circleRow.x, circleRow.y), circleRow.w, nearest))
+		return noContact;
+
+	// Inside is decided in the rectangle's frame, nearest need not round to the center
+	float ox = circleRow.x - rectRow.x;
+	float oy = circleRow.y - rectRow.y;
+	float local[2] = { ox * r.x + oy * r.y, oy * r.x - ox * r.y };
+	float dx = circleRow.x - nearest.x;
+	float dy = circleRow.y - nearest.y;
+	if ((fabsf(local[0]) > r.z || fabsf(local[1]) > r.w) && dx * dx + dy * dy > 0) {
+		float distance = sqrtf(dx * dx + dy * dy);
+		return PlanarContactResult(store, rect, circle, nearest.x, nearest.y, dx / distance, dy / distance, circleRow.w - distance);
+	}
+
+	// Center inside the rectangle, push the circle out of the nearest edge
+	float gap, sign;
+	int axis = NearestFace(local, &r.z, 2, gap, sign);
+	float normalX = axis == 0 ? r.x : -r.y;
+	float normalY = axis == 0 ? r.y : r.x;
+	return PlanarContactResult(store, rect, circle, nearest.x, nearest.y, normalX * sign, normalY * sign, circleRow.w + gap);
+}
+
+// --------------------------------------------------------
+// Any stored collider as GJK sees it. Planar shapes meeting
+// a hull stand in for their solid shapes.
+// --------------------------------------------------------
+static inline ConvexShape LoadConvexShape(const ColliderStore& store, unsigned int id)
+{
+	const XMFLOAT4& row = store.positions[id];
+	const XMFLOAT4& half = store.halfExtents[id];
+	ConvexShape shape = { XMFLOAT3(row.x, row.y, row.z), &store.axes[id * 3], XMFLOAT3(half.x, half.y, half.z), row.w,
+		store.hullVertices[id], store.hullVertexCounts[id], CONVEX_BOX };
+
+	unsigned char type = store.type[id];
+	if (type == SHAPE_SPHERE || type == SHAPE_CIRCLE) shape.kind = CONVEX_SPHERE;
+	else if (type == SHAPE_HULL && shape.vertexCount > 0) shape.kind = CONVEX_HULL;
+	return shape;
+}
+
+// --------------------------------------------------------
+// Single pair test of a bucket, a holds shape A and b shape
+// B. Only the buckets listed in PairBucket are specialized.
+// --------------------------------------------------------
+template <unsigned char A, unsigned char B>
+struct PairTest;
+
+template <>
+struct PairTest<SHAPE_OBB, SHAPE_OBB> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return BoxVsBox(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_OBB, SHAPE_AABB> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return BoxVsBox(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_OBB, SHAPE_SPHERE> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return BoxVsSphere(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_HALFVOL, SHAPE_SPHERE> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b)
+	{
+		return HalfVolVsCollider(store, a, b, XMLoadFloat3(&store.axes[a * 3 + 2]), store.positions[b].w);
+	}
+};
+
+// Either kind of box, BoxRadius reads the axes of both
+template <unsigned char Box>
+struct HalfVolVsBoxTest {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b)
+	{
+		XMVECTOR normal = XMLoadFloat3(&store.axes[a * 3 + 2]);
+		return HalfVolVsCollider(store, a, b, normal, BoxRadius(store, b, normal));
+	}
+};
+
+template <>
+struct PairTest<SHAPE_HALFVOL, SHAPE_OBB> : HalfVolVsBoxTest<SHAPE_OBB> {};
+
+// The hull reaches as far as its support point against the normal
+template <>
+struct PairTest<SHAPE_HALFVOL, SHAPE_HULL> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b)
+	{
+		XMVECTOR normal = XMLoadFloat3(&store.axes[a * 3 + 2]);
+		XMVECTOR deepest = ConvexSupport(LoadConvexShape(store, b), -normal);
+		float radius = XMVectorGetX(XMVector3Dot(XMLoadFloat4(&store.positions[b]) - deepest, normal));
+		return HalfVolVsCollider(store, a, b, normal, radius);
+	}
+};
+
+template <>
+struct PairTest<SHAPE_HALFVOL, SHAPE_AABB> : HalfVolVsBoxTest<SHAPE_AABB> {};
+
+template <>
+struct PairTest<SHAPE_CIRCLE, SHAPE_CIRCLE> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return CircleVsCircle(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_CIRCLE, SHAPE_RECT> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return CircleVsRect(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_RECT, SHAPE_RECT> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return RectVsRect(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_ORECT, SHAPE_ORECT> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return ORectVsRect<true>(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_ORECT, SHAPE_RECT> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return ORectVsRect<false>(store, a, b); }
+};
+
+template <>
+struct PairTest<SHAPE_ORECT, SHAPE_CIRCLE> {
+	static ContactResult Test(const ColliderStore& store, unsigned int a, unsigned int b) { return ORectVsCircle(store, a, b); }
+};
+
+// --------------------------------------------------------
+// Bucket kernel, runs PairTest<A, B> over every pair of the
+// bucket. The test is resolved at compile time so it is
+// inlined into the loop.
+// --------------------------------------------------------
+template <unsigned char A, unsigned char B>
+static void TestBucket(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3*)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		ContactResult result = PairTest<A, B>::Test(store, a[i], b[i]);
+		hits[i] = result.isTouching;
+		contacts[i] = result;
+	}
+}
+
+// --------------------------------------------------------
+// Sphere pairs are one row load per collider and a few
+// flops, too little work for the SIMD kernel's transposes
+// to pay for, which measured from 0.78x to 1.5x the speed
+// of this loop depending on the machine. Contacts are only
+// found for the hits.
+// --------------------------------------------------------
+template <>
+void TestBucket<SHAPE_SPHERE, SHAPE_SPHERE>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3*)
+{
+	const XMFLOAT4* positions = store.positions.data();
+	for (unsigned int i = 0; i < count; i++) {
+		const XMFLOAT4& pa = positions[a[i]];
+		const XMFLOAT4& pb = positions[b[i]];
+		float dx = pa.x - pb.x;
+		float dy = pa.y - pb.y;
+		float dz = pa.z - pb.z;
+		float r = pa.w + pb.w;
+		hits[i] = dx * dx + dy * dy + dz * dz <= r * r;
+		if (hits[i]) ContactSphereVsSphere(store, a[i], b[i], contacts[i]);
+	}
+}
+
+// --------------------------------------------------------
+// Sphere against aligned box and aligned box pair buckets go
+// through the SIMD kernels, contacts are only found for the hits
+// --------------------------------------------------------
+
+template <>
+void TestBucket<SHAPE_SPHERE, SHAPE_AABB>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3*)
+{
+	BatchSphereVsAABB(store, a, b, count, hits);
+	for (unsigned int i = 0; i < count; i++) {
+		if (hits[i]) ContactSphereVsAABB(store, a[i], b[i], contacts[i]);
+	}
+}
+
+template <>
+void TestBucket<SHAPE_AABB, SHAPE_AABB>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3*)
+{
+	BatchAABBVsAABB(store, a, b, count, hits);
+	for (unsigned int i = 0; i < count; i++) {
+		if (hits[i]) ContactAABBVsAABB(store, a[i], b[i], contacts[i]);
+	}
+}
+
+// --------------------------------------------------------
+// Hull buckets go through GJK, each pair starting from the
+// direction it ended on last time and EPA finding contacts
+// --------------------------------------------------------
+static void TestConvexBucket(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3* directions)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		ConvexContact contact;
+		hits[i] = ConvexShapesOverlap(LoadConvexShape(store, a[i]), LoadConvexShape(store, b[i]), directions[i], &contact);
+		if (!hits[i]) continue;
+		ContactResult result = { true, contact.point, contact.normal, contact.depth };
+		contacts[i] = result;
+	}
+}
+
+template <>
+void TestBucket<SHAPE_HULL, SHAPE_HULL>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3* directions)
+{
+	TestConvexBucket(store, a, b, count, hits, contacts, directions);
+}
+
+template <>
+void TestBucket<SHAPE_HULL, SHAPE_OBB>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3* directions)
+{
+	TestConvexBucket(store, a, b, count, hits, contacts, directions);
+}
+
+template <>
+void TestBucket<SHAPE_HULL, SHAPE_AABB>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3* directions)
+{
+	TestConvexBucket(store, a, b, count, hits, contacts, directions);
+}
+
+template <>
+void TestBucket<SHAPE_HULL, SHAPE_SPHERE>(const ColliderStore& store, const unsigned int* a, const unsigned int* b, unsigned int count, unsigned char* hits, ContactResult* contacts, XMFLOAT3* directions)
+{
+	TestConvexBucket(store, a, b, count, hits, contacts, directions);
+}
+
+// Shapes of each bucket, in PairBucket order
+struct BucketInfo {
+	unsigned char first;
+	unsigned char second;
+};
+
+static constexpr BucketInfo bucketShapes[BUCKET_COUNT] = {
+	{ SHAPE_SPHERE, SHAPE_SPHERE },
+	{ SHAPE_SPHERE, SHAPE_AABB },
+	{ SHAPE_AABB, SHAPE_AABB },
+	{ SHAPE_OBB, SHAPE_OBB },
+	{ SHAPE_OBB, SHAPE_AABB },
+	{ SHAPE_OBB, SHAPE_SPHERE },
+	{ SHAPE_HALFVOL, SHAPE_OBB },
+	{ SHAPE_HALFVOL, SHAPE_AABB },
+	{ SHAPE_HALFVOL, SHAPE_SPHERE },
+	{ SHAPE_HULL, SHAPE_HULL },
+	{ SHAPE_HULL, SHAPE_OBB },
+	{ SHAPE_HULL, SHAPE_AABB },
+	{ SHAPE_HULL, SHAPE_SPHERE },
+	{ SHAPE_HALFVOL, SHAPE_HULL },
+	{ SHAPE_CIRCLE, SHAPE_CIRCLE },
+	{ SHAPE_CIRCLE, SHAPE_RECT },
+	{ SHAPE_RECT, SHAPE_RECT },
+	{ SHAPE_ORECT, SHAPE_ORECT },
+	{ SHAPE_ORECT, SHAPE_RECT },
+	{ SHAPE_ORECT, SHAPE_CIRCLE },
+};
+
+#define BUCKET_KERNEL(bucket) TestBucket<bucketShapes[bucket].first, bucketShapes[bucket].second>
+
+// Buckets whose pairs carry a GJK direction, every hull bucket but the half
+// volume one has the hull first
+static constexpr bool UsesDirections(int bucket)
+{
+	return bucketShapes[bucket].first == SHAPE_HULL;
+}
+
+static const BucketKernel bucketKernels[BUCKET_COUNT] = {
+	BUCKET_KERNEL(BUCKET_SPHERE_SPHERE),
+	BUCKET_KERNEL(BUCKET_SPHERE_AABB),
+	BUCKET_KERNEL(BUCKET_AABB_AABB),
+	BUCKET_KERNEL(BUCKET_OBB_OBB),
+	BUCKET_KERNEL(BUCKET_OBB_AABB),
+	BUCKET_KERNEL(BUCKET_OBB_SPHERE),
+	BUCKET_KERNEL(BUCKET_HALFVOL_OBB),
+	BUCKET_KERNEL(BUCKET_HALFVOL_AABB),
+	BUCKET_KERNEL(BUCKET_HALFVOL_SPHERE),
+	BUCKET_KERNEL(BUCKET_HULL_HULL),
+	BUCKET_KERNEL(BUCKET_HULL_OBB),
+	BUCKET_KERNEL(BUCKET_HULL_AABB),
+	BUCKET_KERNEL(BUCKET_HULL_SPHERE),
+	BUCKET_KERNEL(BUCKET_HALFVOL_HULL),
+	BUCKET_KERNEL(BUCKET_CIRCLE_CIRCLE),
+	BUCKET_KERNEL(BUCKET_CIRCLE_RECT),
+	BUCKET_KERNEL(BUCKET_RECT_RECT),
+	BUCKET_KERNEL(BUCKET_ORECT_ORECT),
+	BUCKET_KERNEL(BUCKET_ORECT_RECT),
+	BUCKET_KERNEL(BUCKET_ORECT_CIRCLE),
+};
+
+// --------------------------------------------------------
+// Bucket of a pair of types times two, plus one when the
+// pair has to be swapped to match the bucket. -1 for types
+// that never touch.
+// --------------------------------------------------------
+static constexpr int FindBucket(unsigned int first, unsigned int second)
+{
+	for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+		if (bucketShapes[bucket].first == first && bucketShapes[bucket].second == second) return bucket * 2;
+		if (bucketShapes[bucket].first == second && bucketShapes[bucket].second == first) return bucket * 2 + 1;
+	}
+	return -1;
+}
+
+// Planar shapes, and the solid shape each is tested as against solid ones
+static constexpr bool IsPlanarShape(unsigned int shape)
+{
+	return shape == SHAPE_CIRCLE || shape == SHAPE_RECT || shape == SHAPE_ORECT;
+}
+
+static constexpr unsigned int SolidShape(unsigned int shape)
+{
+	return shape == SHAPE_CIRCLE ? static_cast<unsigned int>(SHAPE_SPHERE)
+		: shape == SHAPE_RECT ? static_cast<unsigned int>(SHAPE_AABB)
+		: shape == SHAPE_ORECT ? static_cast<unsigned int>(SHAPE_OBB) : shape;
+}
+
+// --------------------------------------------------------
+// FindBucket for any two stored shapes, a planar shape
+// meeting a solid one goes to the solid shapes' bucket
+// --------------------------------------------------------
+static constexpr int FindPairBucket(unsigned int first, unsigned int second)
+{
+	return IsPlanarShape(first) == IsPlanarShape(second) ? FindBucket(first, second) : FindBucket(SolidShape(first), SolidShape(second));
+}
+
+#define BUCKET_ROW(first) { \
+	FindPairBucket(first, SHAPE_OBB), FindPairBucket(first, SHAPE_AABB), FindPairBucket(first, SHAPE_SPHERE), FindPairBucket(first, SHAPE_HALFVOL), \
+	FindPairBucket(first, SHAPE_HULL), FindPairBucket(first, SHAPE_CIRCLE), FindPairBucket(first, SHAPE_RECT), FindPairBucket(first, SHAPE_ORECT) }
+
+// Indexed by [type of a][type of b]
+static constexpr int pairBuckets[SHAPE_COUNT][SHAPE_COUNT] = {
+	BUCKET_ROW(SHAPE_OBB),
+	BUCKET_ROW(SHAPE_AABB),
+	BUCKET_ROW(SHAPE_SPHERE),
+	BUCKET_ROW(SHAPE_HALFVOL),
+	BUCKET_ROW(SHAPE_HULL),
+	BUCKET_ROW(SHAPE_CIRCLE),
+	BUCKET_ROW(SHAPE_RECT),
+	BUCKET_ROW(SHAPE_ORECT),
+};
+static_assert(SHAPE_COUNT == 8, "pairBuckets needs a row and column per shape");
+static_assert(pairBuckets[SHAPE_HALFVOL][SHAPE_HALFVOL] == -1, "half volumes never touch each other");
+static_assert(pairBuckets[SHAPE_CIRCLE][SHAPE_ORECT] == BUCKET_ORECT_CIRCLE * 2 + 1, "planar pairs stay in the planar buckets");
+static_assert(pairBuckets[SHAPE_CIRCLE][SHAPE_OBB] == BUCKET_OBB_SPHERE * 2 + 1, "planar shapes meet solid ones as solid shapes");
+static_assert(pairBuckets[SHAPE_CIRCLE][SHAPE_HULL] == BUCKET_HULL_SPHERE * 2 + 1, "planar shapes meet hulls as solid shapes");
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+Narrowphase::Narrowphase() :
+	scratch(1)
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+// --------------------------------------------------------
+// Run on the job system's threads, with scratch buckets for
+// each of them
+// --------------------------------------------------------
+void Narrowphase::SetJobSystem(JobSystem* jobSystem)
+{
+	this->jobSystem = jobSystem;
+	scratch.resize(GetThreadCount());
+}
+
+// --------------------------------------------------------
+// Threads used by Run
+// --------------------------------------------------------
+unsigned int Narrowphase::GetThreadCount() const
+{
+	return jobSystem ? jobSystem->GetThreadCount() : 1;
+}
+
+// --------------------------------------------------------
+// Test every candidate. With a job system the candidates
+// are split into fixed chunks, every chunk writes only its
+// own result slots so the output does not depend on which
+// thread ran it.
+// --------------------------------------------------------
+void Narrowphase::Run(const ColliderStore & store, const std::vector<CollisionPairKey>& candidates)
+{
+	unsigned int count = static_cast<unsigned int>(candidates.size());
+	hits.assign(count, 0);
+	points.resize(count);
+	normals.resize(count);
+	depths.resize(count);
+	directions.resize(count);
+	hasDirection.assign(count, 0);
+
+	if (jobSystem == nullptr) {
+		RunRange(store, candidates, 0, count, scratch[0]);
+	}
+	else {
+		jobSystem->ParallelFor(count, NARROWPHASE_CHUNK_SIZE, [&](unsigned int begin, unsigned int end, unsigned int thread) {
+			RunRange(store, candidates, begin, end, scratch[thread]);
+		});
+	}
+
+	// Keep the directions of this Run's GJK pairs for the next one. Pairs
+	// that are no longer candidates drop out.
+	cachedDirections.clear();
+	for (unsigned int i = 0; i < count; i++) {
+		if (!hasDirection[i]) continue;
+		CachedDirection cached = { candidates[i], directions[i] };
+		cachedDirections.push_back(cached);
+	}
+
+	// Candidates from the pair cache come sorted already
+	auto byKey = [](const CachedDirection& a, const CachedDirection& b) { return a.key < b.key; };
+	if (!std::is_sorted(cachedDirections.begin(), cachedDirections.end(), byKey))
+		std::sort(cachedDirections.begin(), cachedDirections.end(), byKey);
+}
+
+// --------------------------------------------------------
+// Per candidate results of the last Run, 1 for touching
+// --------------------------------------------------------
+const std::vector<unsigned char>& Narrowphase::GetHits() const
+{
+	return hits;
+}
+
+// --------------------------------------------------------
+// Per candidate contact points of the last Run, only valid
+// where the candidate hit
+// --------------------------------------------------------
+const std::vector<XMFLOAT3>& Narrowphase::GetPoints() const
+{
+	return points;
+}
+
+// --------------------------------------------------------
+// Per candidate contact normals of the last Run, pointing
+// from the candidate's first collider to its second. Only
+// valid where the candidate hit.
+// --------------------------------------------------------
+const std::vector<XMFLOAT3>& Narrowphase::GetNormals() const
+{
+	return normals;
+}
+
+// --------------------------------------------------------
+// Per candidate penetration depths of the last Run, only
+// valid where the candidate hit
+// --------------------------------------------------------
+const std::vector<float>& Narrowphase::GetDepths() const
+{
+	return depths;
+}
+
+// --------------------------------------------------------
+// Sort a range of candidates into their type pair buckets,
+// then run every bucket through its kernel
+// --------------------------------------------------------
+void Narrowphase::RunRange(const ColliderStore & store, const std::vector<CollisionPairKey>& candidates, unsigned int begin, unsigned int end, ThreadScratch & threadScratch)
+{
+	for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+		threadScratch.buckets[bucket].Clear();
+	size_t cacheCursor = cachedDirections.size();
+
+	for (unsigned int i = begin; i < end; i++) {
+		unsigned int a = CollisionPairCache::GetFirst(candidates[i]);
+		unsigned int b = CollisionPairCache::GetSecond(candidates[i]);
+
+		// No collisions when belonging to the same base entity
+		if (store.owner[a] == store.owner[b]) continue;
+
+		int bucket = pairBuckets[store.type[a]][store.type[b]];
+		if (bucket < 0) continue;
+		KernelBatch& batch = threadScratch.buckets[bucket >> 1];
+		if (bucket & 1)
+			batch.Add(b, a, i, true);
+		else
+			batch.Add(a, b, i, false);
+
+		// Start GJK where this pair left off, turned to the bucket's order
+		if (UsesDirections(bucket >> 1)) {
+			XMFLOAT3 direction = FindCachedDirection(candidates[i], cacheCursor);
+			if (bucket & 1) direction = XMFLOAT3(-direction.x, -direction.y, -direction.z);
+			batch.directions.push_back(direction);
+		}
+	}
+
+	for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+		RunBucket(store, threadScratch.buckets[bucket], bucketKernels[bucket]);
+}
+
+// --------------------------------------------------------
+// Test a bucket with its kernel and record every hit and
+// its contact against the candidate it came from. Normals of
+// swapped pairs are turned back to the candidate's order.
+// --------------------------------------------------------
+void Narrowphase::RunBucket(const ColliderStore & store, KernelBatch & batch, BucketKernel kernel)
+{
+	unsigned int count = static_cast<unsigned int>(batch.a.size());
+	if (count == 0) return;
+
+	batch.hits.resize(count);
+	batch.contacts.resize(count);
+	kernel(store, batch.a.data(), batch.b.data(), count, batch.hits.data(), batch.contacts.data(), batch.directions.data());
+
+	// Directions are kept for every pair GJK tested, touching or not
+	if (!batch.directions.empty()) {
+		for (unsigned int i = 0; i < count; i++) {
+			const XMFLOAT3& direction = batch.directions[i];
+			unsigned int candidate = batch.candidate[i];
+			directions[candidate] = batch.isSwapped[i] ? XMFLOAT3(-direction.x, -direction.y, -direction.z) : direction;
+			hasDirection[candidate] = 1;
+		}
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (!batch.hits[i]) continue;
+		const ContactResult& contact = batch.contacts[i];
+		unsigned int candidate = batch.candidate[i];
+		hits[candidate] = 1;
+		points[candidate] = contact.point;
+		normals[candidate] = batch.isSwapped[i] ? XMFLOAT3(-contact.normal.x, -contact.normal.y, -contact.normal.z) : contact.normal;
+		depths[candidate] = contact.depth;
+	}
+}
+
+// --------------------------------------------------------
+// Direction a pair ended the last Run on, zero for pairs
+// GJK did not test then. Candidates come sorted, so the
+// cursor walks on from the last pair looked up and only
+// falls back to a binary search when a key goes backwards.
+// --------------------------------------------------------
+XMFLOAT3 Narrowphase::FindCachedDirection(CollisionPairKey key, size_t& cursor) const
+{
+	size_t count = cachedDirections.size();
+	if (cursor < count && cachedDirections[cursor].key <= key) {
+		while (cursor < count && cachedDirections[cursor].key < key) cursor++;
+	}
+	else {
+		cursor = std::lower_bound(cachedDirections.begin(), cachedDirections.end(), key,
+			[](const CachedDirection& cached, CollisionPairKey k) { return cached.key < k; }) - cachedDirections.begin();
+	}
+
+	if (cursor == count || cachedDirections[cursor].key != key) return XMFLOAT3(0, 0, 0);
+	return cachedDirections[cursor].direction;
+}
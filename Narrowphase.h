@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "ColliderStore.h"
+#include "CollisionPairCache.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+// Result of testing one pair of colliders
+struct ContactResult {
+	bool isTouching;
+	XMFLOAT3 point;
+	XMFLOAT3 normal;	// Unit length, pointing from the first collider to the second
+	float depth;		// How far the second has to move along the normal to stop touching
+};
+
+// Type pairs that can touch, each tested as its own bucket. The first shape
+// in the name is the one stored in a, candidates in the other order are
+// swapped on the way in. Half volumes never touch each other. Pairs of
+// planar shapes are tested in 2D, a planar shape paired with a solid one
+// is tested as the solid shape it stands for. Hulls meeting anything but a
+// half volume go through GJK.
+enum PairBucket {
+	BUCKET_SPHERE_SPHERE,
+	BUCKET_SPHERE_AABB,
+	BUCKET_AABB_AABB,
+	BUCKET_OBB_OBB,
+	BUCKET_OBB_AABB,
+	BUCKET_OBB_SPHERE,
+	BUCKET_HALFVOL_OBB,
+	BUCKET_HALFVOL_AABB,
+	BUCKET_HALFVOL_SPHERE,
+	BUCKET_HULL_HULL,
+	BUCKET_HULL_OBB,
+	BUCKET_HULL_AABB,
+	BUCKET_HULL_SPHERE,
+	BUCKET_HALFVOL_HULL,
+	BUCKET_CIRCLE_CIRCLE,
+	BUCKET_CIRCLE_RECT,
+	BUCKET_RECT_RECT,
+	BUCKET_ORECT_ORECT,
+	BUCKET_ORECT_RECT,
+	BUCKET_ORECT_CIRCLE,
+	BUCKET_COUNT
+};
+
+// Tests the pairs (a[i], b[i]) of one bucket, writing hits[i] and, for the
+// hits, contacts[i]. GJK buckets start each pair from directions[i] and
+// leave the direction it ended on there, the others ignore it.
+typedef void (*BucketKernel)(const ColliderStore&, const unsigned int*, const unsigned int*, unsigned int, unsigned char*, ContactResult*, XMFLOAT3*);
+
+// Tests every broadphase candidate of a frame.
+// Candidates are sorted into buckets by their pair of collider types and
+// each bucket is run by a kernel built for exactly those two types, so the
+// type switch happens once per bucket rather than once per pair. Aligned
+// box buckets, against spheres or each other, use the batched SIMD kernels,
+// sphere against sphere a plain loop. Results land in one slot per
+// candidate, so splitting the candidates across threads gives exactly the
+// same output as a single thread.
+// Pairs tested with GJK keep the direction they ended on from one Run to
+// the next, so a pair that is still apart is usually settled by the first
+// support point along it.
+class Narrowphase
+{
+public:
+	Narrowphase();
+
+	// Job system Run splits the candidates across, null runs everything on
+	// the calling thread. Run must be called from a thread that may wait on it.
+	void SetJobSystem(JobSystem* jobSystem);
+	unsigned int GetThreadCount() const;
+
+	// Test every candidate against the colliders in the store
+	void Run(const ColliderStore& store, const std::vector<CollisionPairKey>& candidates);
+
+	// Per candidate results of the last Run
+	const std::vector<unsigned char>& GetHits() const;
+	const std::vector<XMFLOAT3>& GetPoints() const;
+	const std::vector<XMFLOAT3>& GetNormals() const;
+	const std::vector<float>& GetDepths() const;
+
+private:
+	// Candidates tested by one batched kernel, with their index in the candidate list
+	struct KernelBatch {
+		std::vector<unsigned int> a;
+		std::vector<unsigned int> b;
+		std::vector<unsigned int> candidate;
+		std::vector<unsigned char> isSwapped;	// a and b are the candidate's second and first
+		std::vector<XMFLOAT3> directions;		// GJK buckets only, from a to b
+		std::vector<unsigned char> hits;
+		std::vector<ContactResult> contacts;
+
+		void Clear() { a.clear(); b.clear(); candidate.clear(); isSwapped.clear(); directions.clear(); }
+		void Add(unsigned int idA, unsigned int idB, unsigned int index, bool swapped)
+		{
+			a.push_back(idA); b.push_back(idB); candidate.push_back(index); isSwapped.push_back(swapped);
+		}
+	};
+
+	// Direction a GJK pair ended the last Run on, from the key's first
+	// collider to its second
+	struct CachedDirection {
+		CollisionPairKey key;
+		XMFLOAT3 direction;
+	};
+
+	// Buckets owned by one thread
+	struct ThreadScratch {
+		KernelBatch buckets[BUCKET_COUNT];
+	};
+
+	JobSystem* jobSystem = nullptr;
+	std::vector<ThreadScratch> scratch;
+
+	std::vector<unsigned char> hits;
+	std::vector<XMFLOAT3> points;
+	std::vector<XMFLOAT3> normals;
+	std::vector<float> depths;
+
+	std::vector<XMFLOAT3> directions;			// Per candidate, where hasDirection is set
+	std::vector<unsigned char> hasDirection;
+	std::vector<CachedDirection> cachedDirections;	// Sorted by key
+
+	void RunRange(const ColliderStore& store, const std::vector<CollisionPairKey>& candidates, unsigned int begin, unsigned int end, ThreadScratch& threadScratch);
+	void RunBucket(const ColliderStore& store, KernelBatch& batch, BucketKernel kernel);
+	XMFLOAT3 FindCachedDirection(CollisionPairKey key, size_t& cursor) const;
+};
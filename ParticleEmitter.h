@@ -18,6 +18,8 @@ class ParticleEmitter
 {
 	// Allow particle renderer to directly reference emitter information
 	friend class ParticleRenderer;
+	// Emitters are constructed in the particle renderer's arena
+	friend class SceneArena;
 public:
 	// Non-random
 	void SetTint(DirectX::XMFLOAT3& initialTint);
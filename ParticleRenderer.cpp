@@ -304,10 +304,9 @@ HRESULT ParticleRenderer::Shutdown()
 // --------------------------------------------------------
 void ParticleRenderer::Release()
 {
-	// Free all emitters and reset map
-	for (auto it = particleEmitters.begin(); it != particleEmitters.end(); it++)
-		delete it->second;
+	// Free all emitters at once and reset map
 	particleEmitters.clear();
+	emitterArena.Reset();
 }
 
 // --------------------------------------------------------
@@ -328,7 +327,7 @@ ParticleEmitter * const ParticleRenderer::CreateContinuousParticleEmitter(std::s
 {
 	// Ensure name doesn't already exist
 	assert(particleEmitters.count(name) == 0);
-	ParticleEmitter* particleEmitter = new ParticleEmitter(particlesPerSeconds, seconds);
+	ParticleEmitter* particleEmitter = emitterArena.Create<ParticleEmitter>(particlesPerSeconds, seconds);
 	particleEmitters[name] = particleEmitter;
 	return particleEmitter;
 }
@@ -349,7 +348,7 @@ ParticleEmitter * const ParticleRenderer::CreateBurstParticleEmitter(std::string
 {
 	// Ensure name doesn't already exist
 	assert(particleEmitters.count(name) == 0);
-	ParticleEmitter* particleEmitter = new ParticleEmitter(numParticles);
+	ParticleEmitter* particleEmitter = emitterArena.Create<ParticleEmitter>(numParticles);
 	particleEmitters[name] = particleEmitter;
 	return particleEmitter;
 }
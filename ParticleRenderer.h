@@ -11,6 +11,7 @@
 #include "ParticleLayout.h"
 #include "EmitterLayout.h"
 #include "ParticleEmitter.h"
+#include "SceneArena.h"
 #include "Renderer.h"
 
 // Figures out how many groups to dispatch. To dispatch enough threads for each
@@ -51,8 +52,9 @@ private:
 	inline void ProcessDrawArgs();
 	inline void RenderParticles(const Camera * const camera);
 
-	// Particle emitter map
+	// Particle emitter map, the emitters live in the arena until Release
 	std::unordered_map<std::string, ParticleEmitter*> particleEmitters;
+	SceneArena emitterArena;
 
 	// Reference to renderer which will be used to setup buffers
 	Renderer& renderer;
@@ -0,0 +1,195 @@
+#include "PlanarCollision.h"
+#include <cfloat>
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Added to the rectangle rotation terms, as for boxes
+#define PLANAR_ROTATION_EPSILON 1e-6f
+
+// Squared length below which a box axis is taken to point along z
+#define PLANAR_AXIS_EPSILON 1e-6f
+
+static inline float Sign(float value) { return value < 0 ? -1.0f : 1.0f; }
+
+static inline float Clamp(float value, float limit)
+{
+	if (value > limit) return limit;
+	if (value < -limit) return -limit;
+	return value;
+}
+
+// --------------------------------------------------------
+// Rectangle covering the outline of a box on the z = 0
+// plane
+// --------------------------------------------------------
+void ComputePlanarRect(const ColliderWorldState& state, bool isOriented, XMFLOAT2& axis, XMFLOAT2& halfWidths)
+{
+	if (!isOriented) {
+		axis = XMFLOAT2(1, 0);
+		halfWidths = XMFLOAT2(state.halfExtents.x, state.halfExtents.y);
+		return;
+	}
+
+	// First box axis that does not point along z
+	XMFLOAT2 u(state.axes[0].x, state.axes[0].y);
+	if (u.x * u.x + u.y * u.y < PLANAR_AXIS_EPSILON) u = XMFLOAT2(state.axes[1].x, state.axes[1].y);
+	float length = sqrtf(u.x * u.x + u.y * u.y);
+	axis = XMFLOAT2(u.x / length, u.y / length);
+
+	// Half widths of the box's outline along the axis and its perpendicular
+	const float* h = &state.halfExtents.x;
+	halfWidths = XMFLOAT2(0, 0);
+	for (int i = 0; i < 3; i++) {
+		const XMFLOAT3& boxAxis = state.axes[i];
+		halfWidths.x += h[i] * fabsf(boxAxis.x * axis.x + boxAxis.y * axis.y);
+		halfWidths.y += h[i] * fabsf(boxAxis.y * axis.x - boxAxis.x * axis.y);
+	}
+}
+
+// --------------------------------------------------------
+// Contact point of an edge normal, in the reference
+// rectangle's frame. The incident rectangle's edge most
+// opposed to the reference edge is clipped to the reference
+// edge's length, and the ends left below it are averaged,
+// each moved halfway back to the reference edge. side is
+// which way the reference edge faces along axis, toward the
+// incident rectangle.
+// --------------------------------------------------------
+static void EdgeContactPoint(const float* refHalf, int axis, float side,
+	const float incCenter[2], const float incAxes[2][2], const float* incHalf, float point[2])
+{
+	int edge = fabsf(incAxes[1][axis]) > fabsf(incAxes[0][axis]) ? 1 : 0;
+	float edgeSign = -Sign(incAxes[edge][axis] * side);
+	int other = 1 - edge;
+	int tangent = 1 - axis;
+
+	// Edge ends, then clipped along the reference edge
+	float ends[2][2];
+	for (int v = 0; v < 2; v++) {
+		float along = v == 0 ? incHalf[other] : -incHalf[other];
+		for (int k = 0; k < 2; k++)
+			ends[v][k] = incCenter[k] + incAxes[edge][k] * incHalf[edge] * edgeSign + incAxes[other][k] * along;
+	}
+	float limit = refHalf[tangent];
+	float run = ends[1][tangent] - ends[0][tangent];
+	for (int v = 0; v < 2; v++) {
+		float outside = fabsf(ends[v][tangent]) - limit;
+		if (outside <= 0 || run == 0) continue;
+		float target = Clamp(ends[v][tangent], limit);
+		float f = (target - ends[0][tangent]) / run;
+		float clipped[2] = { ends[0][0] + (ends[1][0] - ends[0][0]) * f, ends[0][1] + (ends[1][1] - ends[0][1]) * f };
+		ends[v][0] = clipped[0];
+		ends[v][1] = clipped[1];
+	}
+
+	int kept = 0;
+	point[0] = point[1] = 0;
+	for (int v = 0; v < 2; v++) {
+		float depth = refHalf[axis] - ends[v][axis] * side;
+		if (depth < 0) continue;
+		point[0] += ends[v][0];
+		point[1] += ends[v][1];
+		point[axis] += side * depth * 0.5f;
+		kept++;
+	}
+
+	if (kept > 0) {
+		point[0] /= kept;
+		point[1] /= kept;
+		return;
+	}
+
+	// Only rounding keeps them apart, use the edge's middle on the reference edge
+	for (int k = 0; k < 2; k++) point[k] = Clamp(incCenter[k] + incAxes[edge][k] * incHalf[edge] * edgeSign, refHalf[k]);
+	point[axis] = refHalf[axis] * side;
+}
+
+// --------------------------------------------------------
+// Separating axis test of two oriented rectangles, with b's
+// axes and center expressed in a's frame
+// --------------------------------------------------------
+bool OrientedRectsOverlap(const XMFLOAT2& aCenter, const XMFLOAT2& aAxis, const XMFLOAT2& aHalfWidths,
+	const XMFLOAT2& bCenter, const XMFLOAT2& bAxis, const XMFLOAT2& bHalfWidths, PlanarContact* contact)
+{
+	const float* aHalf = &aHalfWidths.x;
+	const float* bHalf = &bHalfWidths.x;
+
+	// Axes of both as rows, the second is the first turned a quarter
+	const float aAxes[2][2] = { { aAxis.x, aAxis.y }, { -aAxis.y, aAxis.x } };
+	const float bAxes[2][2] = { { bAxis.x, bAxis.y }, { -bAxis.y, bAxis.x } };
+
+	// Rotation of b relative to a, padded absolute value, and b's center in a's frame
+	float R[2][2], absR[2][2], t[2];
+	float offset[2] = { bCenter.x - aCenter.x, bCenter.y - aCenter.y };
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			R[i][j] = aAxes[i][0] * bAxes[j][0] + aAxes[i][1] * bAxes[j][1];
+			absR[i][j] = fabsf(R[i][j]) + PLANAR_ROTATION_EPSILON;
+		}
+		t[i] = offset[0] * aAxes[i][0] + offset[1] * aAxes[i][1];
+	}
+
+	// a's edge normals, then b's, numbered 0 to 3
+	float bestDepth = FLT_MAX;
+	int bestAxis = 0;
+	for (int i = 0; i < 2; i++) {
+		float depth = aHalf[i] + bHalf[0] * absR[i][0] + bHalf[1] * absR[i][1] - fabsf(t[i]);
+		if (depth < 0) return false;
+		if (depth < bestDepth) { bestDepth = depth; bestAxis = i; }
+	}
+	for (int j = 0; j < 2; j++) {
+		float depth = aHalf[0] * absR[0][j] + aHalf[1] * absR[1][j] + bHalf[j] - fabsf(t[0] * R[0][j] + t[1] * R[1][j]);
+		if (depth < 0) return false;
+		if (depth < bestDepth) { bestDepth = depth; bestAxis = 2 + j; }
+	}
+
+	if (!contact) return true;
+
+	// Normal and point in a's frame
+	float n[2], point[2];
+	if (bestAxis < 2) {
+		int i = bestAxis;
+		n[0] = n[1] = 0;
+		n[i] = Sign(t[i]);
+
+		// b's axes in a's frame are the columns of R
+		const float bInA[2][2] = { { R[0][0], R[1][0] }, { R[0][1], R[1][1] } };
+		EdgeContactPoint(aHalf, i, n[i], t, bInA, bHalf, point);
+	}
+	else {
+		int j = bestAxis - 2;
+		float sign = Sign(t[0] * R[0][j] + t[1] * R[1][j]);
+		n[0] = R[0][j] * sign;
+		n[1] = R[1][j] * sign;
+
+		// Worked in b's frame, where a's axes are the rows of R
+		float aInB[2] = { -(t[0] * R[0][0] + t[1] * R[1][0]), -(t[0] * R[0][1] + t[1] * R[1][1]) };
+		float bPoint[2];
+		EdgeContactPoint(bHalf, j, -sign, aInB, R, aHalf, bPoint);
+		for (int k = 0; k < 2; k++) point[k] = t[k] + R[k][0] * bPoint[0] + R[k][1] * bPoint[1];
+	}
+
+	// Back out of a's frame
+	contact->depth = bestDepth;
+	contact->normal = XMFLOAT2(aAxes[0][0] * n[0] + aAxes[1][0] * n[1], aAxes[0][1] * n[0] + aAxes[1][1] * n[1]);
+	contact->point = XMFLOAT2(aCenter.x + aAxes[0][0] * point[0] + aAxes[1][0] * point[1],
+		aCenter.y + aAxes[0][1] * point[0] + aAxes[1][1] * point[1]);
+	return true;
+}
+
+// --------------------------------------------------------
+// Circle against oriented rectangle, through the point of
+// the rectangle nearest the circle's center
+// --------------------------------------------------------
+bool OrientedRectOverlapsCircle(const XMFLOAT2& rectCenter, const XMFLOAT2& rectAxis, const XMFLOAT2& rectHalf,
+	const XMFLOAT2& circleCenter, float radius, XMFLOAT2& nearest)
+{
+	float offset[2] = { circleCenter.x - rectCenter.x, circleCenter.y - rectCenter.y };
+	float u = Clamp(offset[0] * rectAxis.x + offset[1] * rectAxis.y, rectHalf.x);
+	float v = Clamp(offset[1] * rectAxis.x - offset[0] * rectAxis.y, rectHalf.y);
+
+	nearest = XMFLOAT2(rectCenter.x + rectAxis.x * u - rectAxis.y * v, rectCenter.y + rectAxis.y * u + rectAxis.x * v);
+	float dx = circleCenter.x - nearest.x;
+	float dy = circleCenter.y - nearest.y;
+	return dx * dx + dy * dy <= radius * radius;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <DirectXMath.h>
+#include "ColliderWorldState.h"
+
+using namespace DirectX;
+
+// Tests for colliders flattened onto the z = 0 plane. Boxes become
+// rectangles given by the direction of their first axis and their half
+// widths along it and its perpendicular, spheres become circles.
+
+// Contact between two oriented rectangles
+struct PlanarContact {
+	float depth;		// Overlap along the normal
+	XMFLOAT2 normal;	// Axis of least penetration, pointing from rectangle a to rectangle b
+	XMFLOAT2 point;		// Midway between the two edges where they overlap
+};
+
+// Rectangle covering a box seen from above. Boxes turned only about z map
+// exactly, anything else is covered by the rectangle around its outline.
+// Unoriented boxes keep the world x axis.
+void ComputePlanarRect(const ColliderWorldState& state, bool isOriented, XMFLOAT2& axis, XMFLOAT2& halfWidths);
+
+// Separating axis test of two oriented rectangles on their 4 edge normals,
+// with b expressed in a's frame once. When they overlap and contact is
+// given, it is filled from the axis of least penetration.
+bool OrientedRectsOverlap(const XMFLOAT2& aCenter, const XMFLOAT2& aAxis, const XMFLOAT2& aHalf,
+	const XMFLOAT2& bCenter, const XMFLOAT2& bAxis, const XMFLOAT2& bHalf, PlanarContact* contact = nullptr);
+
+// Circle against oriented rectangle, nearest is set to the point of the
+// rectangle nearest the circle's center
+bool OrientedRectOverlapsCircle(const XMFLOAT2& rectCenter, const XMFLOAT2& rectAxis, const XMFLOAT2& rectHalf,
+	const XMFLOAT2& circleCenter, float radius, XMFLOAT2& nearest);
@@ -0,0 +1,299 @@
+#include "PlanarGrid.h"
+#include <cfloat>
+#include <cmath>
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+PlanarGrid::PlanarGrid()
+{
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// maxScale		- size of a cell, the largest expected collider half width
+// halfWidth	- half extents of the world the grid covers, z is unused
+// --------------------------------------------------------
+PlanarGrid::PlanarGrid(float maxScale, XMFLOAT3 halfWidth) :
+	halfWidth(halfWidth.x, halfWidth.y)
+{
+	cols = static_cast<int>(halfWidth.x / maxScale);
+	rows = static_cast<int>(halfWidth.y / maxScale);
+	if (cols < 1) cols = 1;
+	if (rows < 1) rows = 1;
+
+	cellsPerUnit = XMFLOAT2(
+		static_cast<float>(cols) / (2.0f * halfWidth.x),
+		static_cast<float>(rows) / (2.0f * halfWidth.y));
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+PlanarGrid::~PlanarGrid()
+{
+}
+
+// --------------------------------------------------------
+// Start tracking a proxy
+// --------------------------------------------------------
+void PlanarGrid::AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	if (id >= proxies.size()) {
+		proxies.resize(id + 1);
+		rects.resize(id + 1);
+	}
+	proxies[id] = { center, halfExtents, true };
+	proxyCount++;
+}
+
+// --------------------------------------------------------
+// Stop tracking a proxy
+// --------------------------------------------------------
+void PlanarGrid::RemoveProxy(unsigned int id)
+{
+	proxies[id].isActive = false;
+	proxyCount--;
+}
+
+// --------------------------------------------------------
+// Stop tracking every proxy, and empty the cells so queries
+// before the next FindPairs find nothing
+// --------------------------------------------------------
+void PlanarGrid::RemoveAllProxies()
+{
+	proxies.clear();
+	rects.clear();
+	proxyCount = 0;
+	Rebin();
+}
+
+// --------------------------------------------------------
+// Store new bounds for a proxy
+// --------------------------------------------------------
+void PlanarGrid::UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	proxies[id].center = center;
+	proxies[id].halfExtents = halfExtents;
+}
+
+// --------------------------------------------------------
+// Refill the cells and add each pair whose outlines
+// overlap, from the one cell holding the overlap's low
+// corner
+// --------------------------------------------------------
+void PlanarGrid::FindPairs(CollisionPairCache& pairCache)
+{
+	Rebin();
+
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < cols; column++) {
+			unsigned int count;
+			const unsigned int* ids = GetCell(column, row, count);
+
+			for (unsigned int i = 0; i < count; i++) {
+				const XMFLOAT4& a = rects[ids[i]];
+				for (unsigned int j = i + 1; j < count; j++) {
+					const XMFLOAT4& b = rects[ids[j]];
+					if (a.x > b.z || b.x > a.z || a.y > b.w || b.y > a.w) continue;
+
+					// Every cell both share holds the pair, only the one
+					// holding the low corner of the overlap adds it
+					float lowX = a.x > b.x ? a.x : b.x;
+					float lowY = a.y > b.y ? a.y : b.y;
+					if (ClampColumn(lowX) != column || ClampRow(lowY) != row) continue;
+
+					if (CanPair(ids[i], ids[j]))
+						pairCache.AddCandidate(ids[i], ids[j]);
+				}
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Append every proxy in the cells the box covers whose
+// bounds overlap the box
+// --------------------------------------------------------
+void PlanarGrid::QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results)
+{
+	if (cellOffsets.empty())
+		return;
+
+	int iMin = ClampColumn(center.x - halfExtents.x);
+	int iMax = ClampColumn(center.x + halfExtents.x);
+	int jMin = ClampRow(center.y - halfExtents.y);
+	int jMax = ClampRow(center.y + halfExtents.y);
+
+	for (int j = jMin; j <= jMax; j++) {
+		for (int i = iMin; i <= iMax; i++) {
+			unsigned int count;
+			const unsigned int* ids = GetCell(i, j, count);
+			for (unsigned int e = 0; e < count; e++) {
+				const ProxyBounds& proxy = proxies[ids[e]];
+				if (proxy.isActive &&
+					fabsf(proxy.center.x - center.x) <= proxy.halfExtents.x + halfExtents.x &&
+					fabsf(proxy.center.y - center.y) <= proxy.halfExtents.y + halfExtents.y &&
+					fabsf(proxy.center.z - center.z) <= proxy.halfExtents.z + halfExtents.z)
+					results.push_back(ids[e]);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Walk the cells under the segment in order, appending the
+// proxies whose bounds it crosses. Only x and y are walked,
+// a segment along z stays in one cell.
+// --------------------------------------------------------
+void PlanarGrid::QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results)
+{
+	if (cellOffsets.empty())
+		return;
+
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	XMFLOAT3 worldMin(-halfWidth.x, -halfWidth.y, -FLT_MAX);
+	XMFLOAT3 worldMax(halfWidth.x, halfWidth.y, FLT_MAX);
+	if (!ClipSegment(origin, direction, worldMin, worldMax, tMin, tMax))
+		return;
+
+	// Cell the clipped segment starts in, and the distance along the
+	// segment to the next cell boundary on each axis
+	const float* o = &origin.x;
+	const float* d = &direction.x;
+	const float* w = &halfWidth.x;
+	const float* perUnit = &cellsPerUnit.x;
+	const int limits[2] = { cols, rows };
+	int cell[2], step[2];
+	float tNext[2], tDelta[2];
+	for (int axis = 0; axis < 2; axis++) {
+		float coord = (o[axis] + d[axis] * tMin + w[axis]) * perUnit[axis];
+		float speed = d[axis] * perUnit[axis];
+		cell[axis] = axis == 0 ? ClampColumn(o[0] + d[0] * tMin) : ClampRow(o[1] + d[1] * tMin);
+		if (speed > 0) {
+			step[axis] = 1;
+			tNext[axis] = tMin + (cell[axis] + 1 - coord) / speed;
+			tDelta[axis] = 1.0f / speed;
+		}
+		else if (speed < 0) {
+			step[axis] = -1;
+			tNext[axis] = tMin + (cell[axis] - coord) / speed;
+			tDelta[axis] = -1.0f / speed;
+		}
+		else {
+			step[axis] = 0;
+			tNext[axis] = FLT_MAX;
+			tDelta[axis] = 0;
+		}
+	}
+
+	while (true) {
+		unsigned int count;
+		const unsigned int* ids = GetCell(cell[0], cell[1], count);
+		for (unsigned int e = 0; e < count; e++) {
+			const ProxyBounds& proxy = proxies[ids[e]];
+			if (!proxy.isActive) continue;
+			XMFLOAT3 min(proxy.center.x - proxy.halfExtents.x, proxy.center.y - proxy.halfExtents.y, proxy.center.z - proxy.halfExtents.z);
+			XMFLOAT3 max(proxy.center.x + proxy.halfExtents.x, proxy.center.y + proxy.halfExtents.y, proxy.center.z + proxy.halfExtents.z);
+			if (SegmentOverlapsBounds(origin, direction, maxDistance, min, max))
+				results.push_back(ids[e]);
+		}
+
+		// Step across the nearest boundary
+		int axis = tNext[0] < tNext[1] ? 0 : 1;
+		if (tNext[axis] > tMax) break;
+		cell[axis] += step[axis];
+		if (cell[axis] < 0 || cell[axis] >= limits[axis]) break;
+		tNext[axis] += tDelta[axis];
+	}
+}
+
+// --------------------------------------------------------
+// Stage every active proxy into the cells its outline
+// covers and group them by cell with a counting sort.
+// Proxies outside the world are clamped to the border
+// cells.
+// --------------------------------------------------------
+void PlanarGrid::Rebin()
+{
+	entryCells.clear();
+	entryIds.clear();
+	for (unsigned int id = 0; id < proxies.size(); id++) {
+		const ProxyBounds& proxy = proxies[id];
+		if (!proxy.isActive) continue;
+
+		XMFLOAT4& rect = rects[id];
+		rect = XMFLOAT4(proxy.center.x - proxy.halfExtents.x, proxy.center.y - proxy.halfExtents.y,
+			proxy.center.x + proxy.halfExtents.x, proxy.center.y + proxy.halfExtents.y);
+
+		int iMin = ClampColumn(rect.x);
+		int iMax = ClampColumn(rect.z);
+		int jMin = ClampRow(rect.y);
+		int jMax = ClampRow(rect.w);
+		for (int j = jMin; j <= jMax; j++) {
+			for (int i = iMin; i <= iMax; i++) {
+				entryCells.push_back(static_cast<unsigned int>(i + cols * j));
+				entryIds.push_back(id);
+			}
+		}
+	}
+
+	// Histogram, prefix sum to start offsets, then scatter walks each
+	// start forward to the end of its cell
+	unsigned int cellCount = static_cast<unsigned int>(cols * rows);
+	cellOffsets.assign(cellCount + 1, 0);
+	for (size_t e = 0; e < entryCells.size(); e++)
+		cellOffsets[entryCells[e] + 1]++;
+	for (unsigned int c = 0; c < cellCount; c++)
+		cellOffsets[c + 1] += cellOffsets[c];
+
+	sortedIds.resize(entryIds.size());
+	for (size_t e = 0; e < entryIds.size(); e++)
+		sortedIds[cellOffsets[entryCells[e]]++] = entryIds[e];
+}
+
+// --------------------------------------------------------
+// Proxies added and not removed
+// --------------------------------------------------------
+unsigned int PlanarGrid::GetProxyCount() const
+{
+	return proxyCount;
+}
+
+// --------------------------------------------------------
+// Column of a world x, clamped to [0, cols)
+// --------------------------------------------------------
+int PlanarGrid::ClampColumn(float x) const
+{
+	float coord = (x + halfWidth.x) * cellsPerUnit.x;
+	int c = static_cast<int>(coord);
+	if (coord < 0) c = 0;
+	if (c >= cols) c = cols - 1;
+	return c;
+}
+
+// --------------------------------------------------------
+// Row of a world y, clamped to [0, rows)
+// --------------------------------------------------------
+int PlanarGrid::ClampRow(float y) const
+{
+	float coord = (y + halfWidth.y) * cellsPerUnit.y;
+	int r = static_cast<int>(coord);
+	if (coord < 0) r = 0;
+	if (r >= rows) r = rows - 1;
+	return r;
+}
+
+// --------------------------------------------------------
+// Ids sorted into a cell by the last Rebin
+// --------------------------------------------------------
+const unsigned int * PlanarGrid::GetCell(int column, int row, unsigned int& count) const
+{
+	unsigned int cell = static_cast<unsigned int>(column + cols * row);
+	unsigned int start = cell == 0 ? 0 : cellOffsets[cell - 1];
+	count = cellOffsets[cell] - start;
+	return sortedIds.data() + start;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "Broadphase.h"
+
+using namespace DirectX;
+
+// Uniform grid over the z = 0 plane, the broadphase for planar colliders.
+// Cells are indexed directly by column and row, each axis with its own
+// resolution, and filled with a counting sort on every FindPairs. Depth is
+// ignored when pairing, planar colliders pair whenever their outlines seen
+// from above overlap. Each overlapping pair is added once, from the cell
+// holding the low corner of the overlap, so candidates need no dedup.
+class PlanarGrid :
+	public Broadphase
+{
+public:
+	PlanarGrid();
+	PlanarGrid(float maxScale, XMFLOAT3 halfWidth);
+	~PlanarGrid();
+
+	// Inherited via Broadphase, the cells are refilled in FindPairs
+	void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void RemoveProxy(unsigned int id) override;
+	void RemoveAllProxies() override;
+	void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void FindPairs(CollisionPairCache& pairCache) override;
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) override;
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) override;
+
+	void Rebin();	// Refill the cells from every proxy's bounds, without looking for pairs
+
+	// Proxies currently tracked
+	unsigned int GetProxyCount() const;
+
+private:
+	int cols = 1;
+	int rows = 1;
+	XMFLOAT2 halfWidth = XMFLOAT2(10, 10);
+	XMFLOAT2 cellsPerUnit = XMFLOAT2(0.05f, 0.05f);
+
+	// Bounds of every proxy, indexed by proxy id
+	struct ProxyBounds {
+		XMFLOAT3 center;
+		XMFLOAT3 halfExtents;
+		bool isActive;
+	};
+	std::vector<ProxyBounds> proxies;
+	unsigned int proxyCount = 0;
+
+	// Outline of every proxy as of the last Rebin, (min x, min y, max x, max y)
+	std::vector<XMFLOAT4> rects;
+
+	// Staged entries, then the counting sort output
+	std::vector<unsigned int> entryCells;
+	std::vector<unsigned int> entryIds;
+	std::vector<unsigned int> cellOffsets;	// cellOffsets[c] is the end of cell c in sortedIds
+	std::vector<unsigned int> sortedIds;
+
+	int ClampColumn(float x) const;
+	int ClampRow(float y) const;
+	const unsigned int* GetCell(int column, int row, unsigned int& count) const;
+};
@@ -0,0 +1,107 @@
+#include "Platform.h"
+#include <cstring>
+#include "MemoryDebug.h"
+
+InputSnapshot Input::snapshot = {};
+
+// --------------------------------------------------------
+// Whether a key was held at the start of the frame
+// --------------------------------------------------------
+bool InputSnapshot::IsKeyDown(unsigned int key) const
+{
+	return key < INPUT_KEY_COUNT && keys[key];
+}
+
+// --------------------------------------------------------
+// Release every key and put the mouse at the origin
+// --------------------------------------------------------
+void InputSnapshot::Clear()
+{
+	memset(keys, 0, sizeof(keys));
+	mouseX = 0;
+	mouseY = 0;
+}
+
+const InputSnapshot& Input::GetSnapshot()
+{
+	return snapshot;
+}
+
+bool Input::IsKeyDown(unsigned int key)
+{
+	return snapshot.IsKeyDown(key);
+}
+
+// --------------------------------------------------------
+// Constructor, starts the clock
+// --------------------------------------------------------
+Platform::Platform() :
+	start(std::chrono::steady_clock::now())
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+Platform::~Platform()
+{
+}
+
+double Platform::GetSeconds() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// frames		- frames to run before the loop stops
+// frameTime	- seconds each frame takes on the clock, 0
+//				  for real time
+// --------------------------------------------------------
+PlatformHeadless::PlatformHeadless(unsigned int frames, float frameTime) :
+	frames(frames),
+	frameTime(frameTime)
+{
+}
+
+void PlatformHeadless::SetInputScript(InputScript script)
+{
+	inputScript = script;
+}
+
+unsigned int PlatformHeadless::GetFrame() const
+{
+	return frame;
+}
+
+double PlatformHeadless::GetSeconds() const
+{
+	if (frameTime > 0.0f)
+		return (double)frame * frameTime;
+	return Platform::GetSeconds();
+}
+
+// --------------------------------------------------------
+// There are no messages, each call starts a frame until
+// all of them have run
+// --------------------------------------------------------
+bool PlatformHeadless::ProcessMessages()
+{
+	if (frame >= frames)
+		return false;
+	frame++;
+	return true;
+}
+
+void PlatformHeadless::PollInput(InputSnapshot& input)
+{
+	input.Clear();
+	if (inputScript)
+		inputScript(frame - 1, input);
+}
+
+bool PlatformHeadless::IsDrawing() const
+{
+	return false;
+}
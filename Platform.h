@@ -0,0 +1,90 @@
+#pragma once
+#include <chrono>
+#include <functional>
+
+// Keys of an input snapshot. Letters and digits are their upper case
+// characters, the rest match the Win32 virtual key codes so that backend
+// reads them straight into place.
+#define INPUT_KEY_COUNT 256
+#define INPUT_KEY_ESCAPE 0x1B
+#define INPUT_KEY_SPACE 0x20
+#define INPUT_KEY_LEFT 0x25
+#define INPUT_KEY_UP 0x26
+#define INPUT_KEY_RIGHT 0x27
+#define INPUT_KEY_DOWN 0x28
+
+// Keyboard and mouse as they were at the start of a frame
+struct InputSnapshot {
+	bool keys[INPUT_KEY_COUNT];
+	int mouseX;		// Screen space
+	int mouseY;
+
+	bool IsKeyDown(unsigned int key) const;
+	void Clear();
+};
+
+// Input of the current frame, the same for every tick and draw of it. Filled
+// once a frame by the frame loop from the platform it runs on.
+class Input
+{
+	friend class FrameLoop;
+
+public:
+	static const InputSnapshot& GetSnapshot();
+	static bool IsKeyDown(unsigned int key);
+
+private:
+	static InputSnapshot snapshot;
+};
+
+// The system a frame loop runs on: its clock, messages and input
+class Platform
+{
+public:
+	Platform();
+	virtual ~Platform();
+
+	// Seconds since the platform was created, from a steady high resolution clock
+	virtual double GetSeconds() const;
+
+	// Handle whatever the system sent since the last frame. False once the
+	// loop should stop.
+	virtual bool ProcessMessages() = 0;
+
+	// Fill the snapshot with the input as it is now
+	virtual void PollInput(InputSnapshot& input) = 0;
+
+	// Whether frames are drawn on this platform
+	virtual bool IsDrawing() const = 0;
+
+private:
+	std::chrono::steady_clock::time_point start;
+};
+
+// Sets the input of a headless frame, given the frame's index
+typedef std::function<void(unsigned int frame, InputSnapshot& input)> InputScript;
+
+// Runs a set number of frames with no window, messages or drawing, for
+// profiling and soak tests. With a frame time every frame takes exactly that
+// long on the platform's clock, so every run ticks the same; without one the
+// clock is real time.
+class PlatformHeadless : public Platform
+{
+public:
+	PlatformHeadless(unsigned int frames, float frameTime = 0.0f);
+
+	// Keys pressed by frame, none are without a script
+	void SetInputScript(InputScript script);
+	unsigned int GetFrame() const;	// Frames started so far
+
+	double GetSeconds() const override;
+	bool ProcessMessages() override;
+	void PollInput(InputSnapshot& input) override;
+	bool IsDrawing() const override;
+
+private:
+	unsigned int frames;
+	float frameTime;
+	unsigned int frame = 0;
+	InputScript inputScript;
+};
@@ -0,0 +1,93 @@
+#include "PlatformWin32.h"
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Dispatches every waiting message to its window's
+// procedure, stopping at the quit message
+//
+// exitCode - set to the quit message's code
+// --------------------------------------------------------
+static bool DispatchMessages(int& exitCode)
+{
+	MSG msg = {};
+	while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+	{
+		if (msg.message == WM_QUIT) {
+			exitCode = (int)msg.wParam;
+			return false;
+		}
+
+		// Translate and dispatch the message
+		// to our custom WindowProc function
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+PlatformWin32::PlatformWin32()
+{
+}
+
+int PlatformWin32::GetExitCode() const
+{
+	return exitCode;
+}
+
+bool PlatformWin32::ProcessMessages()
+{
+	return DispatchMessages(exitCode);
+}
+
+// --------------------------------------------------------
+// Reads every key in one call and the cursor position. The
+// key states are the ones of the messages dispatched so
+// far, which ProcessMessages has just caught up on.
+// --------------------------------------------------------
+void PlatformWin32::PollInput(InputSnapshot& input)
+{
+	BYTE keyStates[INPUT_KEY_COUNT];
+	if (!GetKeyboardState(keyStates)) {
+		input.Clear();
+		return;
+	}
+	for (int key = 0; key < INPUT_KEY_COUNT; key++)
+		input.keys[key] = (keyStates[key] & 0x80) != 0;
+
+	POINT cursorPos;
+	GetCursorPos(&cursorPos);
+	input.mouseX = cursorPos.x;
+	input.mouseY = cursorPos.y;
+}
+
+bool PlatformWin32::IsDrawing() const
+{
+	return true;
+}
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+PlatformWin32Headless::PlatformWin32Headless(unsigned int frames, float frameTime) :
+	PlatformHeadless(frames, frameTime)
+{
+}
+
+int PlatformWin32Headless::GetExitCode() const
+{
+	return exitCode;
+}
+
+// --------------------------------------------------------
+// Handles the window's messages, then starts the next of
+// the scripted frames
+// --------------------------------------------------------
+bool PlatformWin32Headless::ProcessMessages()
+{
+	if (!DispatchMessages(exitCode))
+		return false;
+	return PlatformHeadless::ProcessMessages();
+}
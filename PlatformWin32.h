@@ -0,0 +1,38 @@
+#pragma once
+#include <Windows.h>
+#include "Platform.h"
+
+// A window's platform: its message queue, the keyboard and the cursor, with
+// every frame drawn
+class PlatformWin32 : public Platform
+{
+public:
+	PlatformWin32();
+
+	// Exit code of the quit message, once there was one
+	int GetExitCode() const;
+
+	bool ProcessMessages() override;
+	void PollInput(InputSnapshot& input) override;
+	bool IsDrawing() const override;
+
+private:
+	int exitCode = 0;
+};
+
+// The headless platform run in a process that still has a window. Its frames
+// and input are the script's, but the window's messages are still handled
+// so it stays responsive, and closing it ends the run.
+class PlatformWin32Headless : public PlatformHeadless
+{
+public:
+	PlatformWin32Headless(unsigned int frames, float frameTime = 0.0f);
+
+	// Exit code of the quit message, once there was one
+	int GetExitCode() const;
+
+	bool ProcessMessages() override;
+
+private:
+	int exitCode = 0;
+};
@@ -667,12 +667,24 @@ void Renderer::UnstageEntity(Entity * const entity)
 	}
 }
 
+// --------------------------------------------------------
+// Removes every entity from the render batches at once
+// instead of searching each one's batch for it. Buckets
+// are kept for the next scene.
+// --------------------------------------------------------
+void Renderer::UnstageAllEntities()
+{
+	renderBatches.clear();
+}
+
 // --------------------------------------------------------
 // Renders currently staged objects to a given camera
 //
-// camera - view point to use when rendering objects
+// camera				- view point to use when rendering objects
+// interpolationAlpha	- how far to draw entities from their
+//						  last tick's transforms to their current
 // --------------------------------------------------------
-void Renderer::Render(const Camera * const camera)
+void Renderer::Render(const Camera * const camera, float interpolationAlpha)
 {
 	// Shaders we will work with for each bucket
 	SimpleVertexShader* vertexShader;
@@ -685,6 +697,8 @@ void Renderer::Render(const Camera * const camera)
 	ID3D11Buffer* currVertBuff;
 	UINT stride = sizeof(Vertex);
 	UINT offset = 0;
+	XMFLOAT4X4 world;
+	XMFLOAT4X4 inverseTransposeWorld;
 
 	// Camera information that will not change mid-render
 	XMFLOAT4X4 view = camera->GetViewMatrix();
@@ -733,10 +747,9 @@ void Renderer::Render(const Camera * const camera)
 
 			// -- Set entity specific info --
 			// below exist for every entity.
-			vertexShader->SetMatrix4x4("world",
-				currEntity->transform.GetWorldMatrix());
-			vertexShader->SetMatrix4x4("inverseTransposeWorld",
-				currEntity->transform.GetInverseTransposeWorldMatrix());
+			currEntity->transform.GetInterpolatedWorldMatrices(interpolationAlpha, world, inverseTransposeWorld);
+			vertexShader->SetMatrix4x4("world", world);
+			vertexShader->SetMatrix4x4("inverseTransposeWorld", inverseTransposeWorld);
 
 			// -- Copy vertex data --
 			vertexShader->CopyAllBufferData();
@@ -47,7 +47,8 @@ public:
 	// Renderer functions
 	void StageEntity(Entity* const entity);
 	void UnstageEntity(Entity * const entity);
-	void Render(const Camera * const camera);
+	void UnstageAllEntities();	// Empties every render batch, for when the scene unloads
+	void Render(const Camera * const camera, float interpolationAlpha = 1.0f);	// Alpha blends entities from their last tick's transforms
 	void UpdateCS(float dt, float totalTime); // update exclusively for compute shader use
 	void OnResize(unsigned int width, unsigned int height);
 
@@ -0,0 +1,79 @@
+#include "SceneArena.h"
+#include <cstdint>
+#include "MemoryDebug.h"
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+SceneArena::SceneArena()
+{
+}
+
+// --------------------------------------------------------
+// Destructor - Destroys what is left and frees the chunks
+// --------------------------------------------------------
+SceneArena::~SceneArena()
+{
+	Reset();
+	for (size_t i = 0; i < chunks.size(); i++)
+		delete[] chunks[i].memory;
+}
+
+// --------------------------------------------------------
+// Destroy every object still alive, newest first so each
+// can still reach what was made before it, and start
+// filling the first chunk again
+// --------------------------------------------------------
+void SceneArena::Reset()
+{
+	for (Finalizer* finalizer = lastFinalizer; finalizer != nullptr; finalizer = finalizer->previous) {
+		if (finalizer->destroy != nullptr)
+			finalizer->destroy(finalizer + 1);
+	}
+	lastFinalizer = nullptr;
+	chunk = 0;
+	offset = 0;
+	usedBytes = 0;
+}
+
+size_t SceneArena::GetUsedBytes() const
+{
+	return usedBytes;
+}
+
+size_t SceneArena::GetReservedBytes() const
+{
+	size_t bytes = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+		bytes += chunks[i].size;
+	return bytes;
+}
+
+// --------------------------------------------------------
+// Take aligned bytes from the chunk being filled, moving
+// on to the next kept chunk when it is full and adding a
+// chunk when none is left
+// --------------------------------------------------------
+void* SceneArena::Allocate(size_t size, size_t alignment)
+{
+	while (chunk < chunks.size()) {
+		Chunk& current = chunks[chunk];
+		uintptr_t address = reinterpret_cast<uintptr_t>(current.memory) + offset;
+		size_t padding = (alignment - address % alignment) % alignment;
+		if (offset + padding + size <= current.size) {
+			char* memory = current.memory + offset + padding;
+			offset += padding + size;
+			usedBytes += padding + size;
+			return memory;
+		}
+		chunk++;
+		offset = 0;
+	}
+
+	// Room for the worst padding, heap blocks are only aligned to the platform default
+	Chunk added;
+	added.size = size + alignment > SCENE_ARENA_CHUNK_SIZE ? size + alignment : SCENE_ARENA_CHUNK_SIZE;
+	added.memory = new char[added.size];
+	chunks.push_back(added);
+	return Allocate(size, alignment);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bytes of each chunk, an object larger than this gets a chunk of its own size
+#define SCENE_ARENA_CHUNK_SIZE	(64 * 1024)
+
+// Bump allocator for objects that live exactly as long as a scene. Objects
+// are placed one after another in large chunks and are all freed together by
+// Reset when the scene unloads, instead of one heap free each. Chunks are
+// kept across resets, so loading a scene again reuses the memory of the last
+// one. Objects whose type has a destructor get a small header in front that
+// links them newest first, and Reset runs those destructors in that order;
+// trivially destructible objects cost nothing to free.
+class SceneArena
+{
+public:
+	SceneArena();
+	~SceneArena();
+
+	// Construct an object in the arena
+	template<typename T, typename... Args>
+	T* Create(Args&&... args);
+
+	// Run an object's destructor now, its memory is only reclaimed by Reset.
+	// The object must have been created as T, or as a type derived from a
+	// polymorphic T in any way, virtual bases included, since its header is
+	// found in front of the complete object rather than in front of T.
+	template<typename T>
+	void Destroy(T* object);
+
+	// Destroy every object still alive and rewind to the first chunk
+	void Reset();
+
+	size_t GetUsedBytes() const;		// Bytes handed out since the last reset
+	size_t GetReservedBytes() const;	// Bytes of every chunk
+
+private:
+	// In front of every object with a destructor, right before its first byte
+	struct Finalizer {
+		void (*destroy)(void* object);	// Null once destroyed early
+		Finalizer* previous;			// Made before this one
+	};
+
+	struct Chunk {
+		char* memory;
+		size_t size;
+	};
+
+	std::vector<Chunk> chunks;
+	size_t chunk = 0;	// Chunk being filled
+	size_t offset = 0;	// Bytes used of it
+	size_t usedBytes = 0;
+	Finalizer* lastFinalizer = nullptr;
+
+	void* Allocate(size_t size, size_t alignment);
+
+	template<typename T>
+	static void DestroyObject(void* object);
+
+	// Address the object was created at, which a base of it may not start at
+	template<typename T>
+	static void* GetCompleteObject(T* object, std::true_type isPolymorphic);
+	template<typename T>
+	static void* GetCompleteObject(T* object, std::false_type isPolymorphic);
+
+	// Neither copied nor moved, objects point into its chunks
+	SceneArena(const SceneArena&) = delete;
+	SceneArena& operator=(const SceneArena&) = delete;
+};
+
+template<typename T, typename... Args>
+T* SceneArena::Create(Args&&... args)
+{
+	if (std::is_trivially_destructible<T>::value)
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+	// Pad the header to the object's alignment so it ends where the object starts
+	size_t alignment = alignof(T) > alignof(Finalizer) ? alignof(T) : alignof(Finalizer);
+	size_t header = (sizeof(Finalizer) + alignment - 1) / alignment * alignment;
+	char* memory = static_cast<char*>(Allocate(header + sizeof(T), alignment));
+
+	// Linked once constructed, objects the constructor made are destroyed after it
+	T* object = new (memory + header) T(std::forward<Args>(args)...);
+	Finalizer* finalizer = reinterpret_cast<Finalizer*>(memory + header) - 1;
+	finalizer->destroy = &DestroyObject<T>;
+	finalizer->previous = lastFinalizer;
+	lastFinalizer = finalizer;
+	return object;
+}
+
+template<typename T>
+void SceneArena::Destroy(T* object)
+{
+	if (std::is_trivially_destructible<T>::value || object == nullptr)
+		return;
+
+	// The finalizer destroys the type it was created as, from the complete object
+	void* completeObject = GetCompleteObject(object, std::is_polymorphic<T>());
+	Finalizer* finalizer = static_cast<Finalizer*>(completeObject) - 1;
+	if (finalizer->destroy != nullptr) {
+		finalizer->destroy(completeObject);
+		finalizer->destroy = nullptr;
+	}
+}
+
+template<typename T>
+void* SceneArena::GetCompleteObject(T* object, std::true_type)
+{
+	return dynamic_cast<void*>(object);
+}
+
+template<typename T>
+void* SceneArena::GetCompleteObject(T* object, std::false_type)
+{
+	return object;
+}
+
+template<typename T>
+void SceneArena::DestroyObject(void* object)
+{
+	static_cast<T*>(object)->~T();
+}
@@ -31,7 +31,7 @@ void SceneGame::CreateSceneEntities(EntityFactory& entityFactory, std::unordered
 	player->SetProjectileManager(projectileManager);
 	player->transform.SetPosition(0, 0, 0.0f);
 	player->transform.SetScale(0.25f, 0.25f, 0.25f);
-	player->SetCollider(Collider::ColliderType::SPHERE, XMFLOAT3(0.125f, 0.125f, 0.125f));
+	player->SetCollider(Collider::ColliderType::HULL, meshes["player"], LAYER_PLAYER);	// Hulls are always tested in 3D
 
 	EntityEnemy* enemy;
 	for (auto i = 0u; i < 10; ++i) {
@@ -40,7 +40,8 @@ void SceneGame::CreateSceneEntities(EntityFactory& entityFactory, std::unordered
 		enemy->SetTarget(player);
 		enemy->MoveToRandomPosition();
 		enemy->transform.SetScale(0.15f, 0.15f, 0.15f);
-		enemy->SetCollider(Collider::ColliderType::OBB);
+		enemy->SetCollider(Collider::ColliderType::OBB, meshes["enemy"], LAYER_ENEMY);
+		enemy->GetCollider()->SetIsPlanar(true);
 	}
 
 	//// Background entity
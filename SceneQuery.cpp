@@ -0,0 +1,210 @@
+#include "SceneQuery.h"
+#include <cmath>
+#include "BoxCollision.h"
+#include "MemoryDebug.h"
+
+// Rays closer to parallel with a box face than this never cross its slab
+#define QUERY_EPSILON 1e-6f
+
+static const RayHit noRayHit = { false, 0.0f, XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0) };
+
+// --------------------------------------------------------
+// Hit at the ray origin, for rays starting inside a shape
+// --------------------------------------------------------
+static RayHit StartsInside(const XMFLOAT3& origin)
+{
+	RayHit hit = { true, 0.0f, origin, XMFLOAT3(0, 0, 0) };
+	return hit;
+}
+
+// --------------------------------------------------------
+// Ray against a sphere
+// --------------------------------------------------------
+static RayHit RaycastSphere(const ColliderWorldState& state, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance)
+{
+	XMVECTOR centerVec = XMLoadFloat3(&state.center);
+	XMVECTOR originVec = XMLoadFloat3(&origin);
+	XMVECTOR directionVec = XMLoadFloat3(&direction);
+	XMVECTOR m = originVec - centerVec;
+
+	float c = XMVectorGetX(XMVector3LengthSq(m)) - state.radius * state.radius;
+	if (c <= 0) return StartsInside(origin);
+
+	// Outside and pointing away
+	float b = XMVectorGetX(XMVector3Dot(m, directionVec));
+	if (b > 0) return noRayHit;
+
+	float discriminant = b * b - c;
+	if (discriminant < 0) return noRayHit;
+
+	float t = -b - sqrtf(discriminant);
+	if (t > maxDistance) return noRayHit;
+
+	XMVECTOR point = originVec + directionVec * t;
+	RayHit hit = { true, t };
+	XMStoreFloat3(&hit.point, point);
+	XMStoreFloat3(&hit.normal, XMVector3Normalize(point - centerVec));
+	return hit;
+}
+
+// --------------------------------------------------------
+// Ray against an oriented box, a slab test along each box
+// axis. The last slab entered is the face that was hit.
+// --------------------------------------------------------
+static RayHit RaycastBox(const ColliderWorldState& state, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance)
+{
+	XMVECTOR originVec = XMLoadFloat3(&origin);
+	XMVECTOR directionVec = XMLoadFloat3(&direction);
+	XMVECTOR offset = originVec - XMLoadFloat3(&state.center);
+	const float* halfWidths = &state.halfExtents.x;
+
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	int entryAxis = -1;
+	float entrySign = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&state.axes[i]);
+		float e = XMVectorGetX(XMVector3Dot(boxAxis, offset));
+		float f = XMVectorGetX(XMVector3Dot(boxAxis, directionVec));
+		float h = halfWidths[i];
+
+		if (fabsf(f) < QUERY_EPSILON) {
+			if (fabsf(e) > h) return noRayHit;
+			continue;
+		}
+
+		// t1 enters through the negative face unless the ray runs backwards
+		float t1 = (-h - e) / f;
+		float t2 = (h - e) / f;
+		float sign = -1.0f;
+		if (t1 > t2) { float swap = t1; t1 = t2; t2 = swap; sign = 1.0f; }
+		if (t1 > tMin) { tMin = t1; entryAxis = i; entrySign = sign; }
+		if (t2 < tMax) tMax = t2;
+		if (tMin > tMax) return noRayHit;
+	}
+
+	if (entryAxis < 0) return StartsInside(origin);
+
+	RayHit hit = { true, tMin };
+	XMStoreFloat3(&hit.point, originVec + directionVec * tMin);
+	XMStoreFloat3(&hit.normal, XMLoadFloat3(&state.axes[entryAxis]) * entrySign);
+	return hit;
+}
+
+// --------------------------------------------------------
+// Ray against a half volume
+// --------------------------------------------------------
+static RayHit RaycastHalfVol(const ColliderWorldState& state, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance)
+{
+	XMVECTOR normal = XMLoadFloat3(&state.axes[2]);
+	XMVECTOR originVec = XMLoadFloat3(&origin);
+	XMVECTOR directionVec = XMLoadFloat3(&direction);
+
+	float distance = XMVectorGetX(XMVector3Dot(originVec - XMLoadFloat3(&state.center), normal));
+	if (distance >= 0) return StartsInside(origin);
+
+	float speed = XMVectorGetX(XMVector3Dot(directionVec, normal));
+	if (speed <= 0) return noRayHit;
+
+	float t = -distance / speed;
+	if (t > maxDistance) return noRayHit;
+
+	RayHit hit = { true, t };
+	XMStoreFloat3(&hit.point, originVec + directionVec * t);
+	XMStoreFloat3(&hit.normal, -normal);
+	return hit;
+}
+
+// --------------------------------------------------------
+// Sphere against an oriented box, through the point on the
+// box nearest the sphere's center
+// --------------------------------------------------------
+static bool SphereOverlapsBox(const ColliderWorldState& box, const XMFLOAT3& center, float radius)
+{
+	XMVECTOR offset = XMLoadFloat3(&center) - XMLoadFloat3(&box.center);
+	const float* halfWidths = &box.halfExtents.x;
+
+	XMVECTOR nearest = XMVectorZero();
+	for (int i = 0; i < 3; i++) {
+		XMVECTOR boxAxis = XMLoadFloat3(&box.axes[i]);
+		float distance = XMVectorGetX(XMVector3Dot(offset, boxAxis));
+		if (distance > halfWidths[i]) distance = halfWidths[i];
+		if (distance < -halfWidths[i]) distance = -halfWidths[i];
+		nearest += boxAxis * distance;
+	}
+	return XMVectorGetX(XMVector3LengthSq(offset - nearest)) <= radius * radius;
+}
+
+// --------------------------------------------------------
+// Ray against any collider shape
+// --------------------------------------------------------
+RayHit RaycastCollider(const ColliderWorldState & state, unsigned char shape, const XMFLOAT3 & origin, const XMFLOAT3 & direction, float maxDistance)
+{
+	switch (shape) {
+	case SHAPE_SPHERE:
+		return RaycastSphere(state, origin, direction, maxDistance);
+	case SHAPE_AABB:
+	case SHAPE_OBB:
+	case SHAPE_HULL:
+		return RaycastBox(state, origin, direction, maxDistance);
+	case SHAPE_HALFVOL:
+		return RaycastHalfVol(state, origin, direction, maxDistance);
+	default:
+		return noRayHit;
+	}
+}
+
+// --------------------------------------------------------
+// Sphere against any collider shape
+// --------------------------------------------------------
+bool OverlapSphereCollider(const ColliderWorldState & state, unsigned char shape, const XMFLOAT3 & center, float radius)
+{
+	switch (shape) {
+	case SHAPE_SPHERE: {
+		float reach = state.radius + radius;
+		return XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&center) - XMLoadFloat3(&state.center))) <= reach * reach;
+	}
+	case SHAPE_AABB:
+	case SHAPE_OBB:
+	case SHAPE_HULL:
+		return SphereOverlapsBox(state, center, radius);
+	case SHAPE_HALFVOL:
+		return XMVectorGetX(XMVector3Dot(XMLoadFloat3(&center) - XMLoadFloat3(&state.center), XMLoadFloat3(&state.axes[2]))) >= -radius;
+	default:
+		return false;
+	}
+}
+
+// --------------------------------------------------------
+// Oriented box against any collider shape
+// --------------------------------------------------------
+bool OverlapBoxCollider(const ColliderWorldState & state, unsigned char shape, const ColliderWorldState & box)
+{
+	switch (shape) {
+	case SHAPE_SPHERE:
+		return SphereOverlapsBox(box, state.center, state.radius);
+	case SHAPE_AABB:
+	case SHAPE_OBB:
+	case SHAPE_HULL:
+		return BoxesOverlap(state, box);
+	case SHAPE_HALFVOL: {
+		// Box radius along the plane normal
+		XMVECTOR normal = XMLoadFloat3(&state.axes[2]);
+		const float* halfWidths = &box.halfExtents.x;
+		float reach = 0;
+		for (int i = 0; i < 3; i++)
+			reach += fabsf(halfWidths[i] * XMVectorGetX(XMVector3Dot(XMLoadFloat3(&box.axes[i]), normal)));
+		return XMVectorGetX(XMVector3Dot(XMLoadFloat3(&box.center) - XMLoadFloat3(&state.center), normal)) >= -reach;
+	}
+	default:
+		return false;
+	}
+}
+
+// --------------------------------------------------------
+// Separating axis test of two oriented boxes
+// --------------------------------------------------------
+bool BoxesOverlap(const ColliderWorldState & a, const ColliderWorldState & b)
+{
+	return OrientedBoxesOverlap(a.center, a.axes, a.halfExtents, b.center, b.axes, b.halfExtents);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <DirectXMath.h>
+#include "ColliderStore.h"
+#include "ColliderWorldState.h"
+
+using namespace DirectX;
+
+// First hit of a ray on one collider
+struct RayHit {
+	bool isHit;
+	float distance;		// Along the ray from its origin
+	XMFLOAT3 point;		// On the collider's surface
+	XMFLOAT3 normal;	// Surface normal at the point, zero when the ray starts inside
+};
+
+// Exact scene query tests against a single collider's world state, shape is a
+// ColliderShape. Half volumes fill the side of the plane through their center
+// that their third axis points into. Hulls are tested as the box they were
+// fitted in, which holds the whole hull.
+
+// direction must be unit length, hits past maxDistance are misses
+RayHit RaycastCollider(const ColliderWorldState& state, unsigned char shape, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance);
+
+bool OverlapSphereCollider(const ColliderWorldState& state, unsigned char shape, const XMFLOAT3& center, float radius);
+
+// box is an oriented box, as ComputeColliderWorldState builds for a box collider
+bool OverlapBoxCollider(const ColliderWorldState& state, unsigned char shape, const ColliderWorldState& box);
+
+// Separating axis test of two oriented boxes
+bool BoxesOverlap(const ColliderWorldState& a, const ColliderWorldState& b);
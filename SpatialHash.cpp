@@ -0,0 +1,354 @@
+#include "SpatialHash.h"
+#include <cfloat>
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Smallest bucket table is 2^6 buckets
+#define SPATIAL_HASH_MIN_BUCKET_BITS 6
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+SpatialHash::SpatialHash()
+{
+}
+
+// --------------------------------------------------------
+// Constructor
+//
+// maxScale		- half the size of a cell, the largest expected collider half width
+// halfWidth	- half extents of the world the grid covers
+// --------------------------------------------------------
+SpatialHash::SpatialHash(float maxScale, XMFLOAT3 halfWidth) :
+	halfWidth(halfWidth)
+{
+	// Each axis gets as many cells as fit its own extent, so a thin world
+	// is not cut into slivers along its short axis
+	const float* w = &halfWidth.x;
+	float* perUnit = &cellsPerUnit.x;
+	for (int axis = 0; axis < 3; axis++) {
+		cols[axis] = static_cast<int>(w[axis] / maxScale);
+		if (cols[axis] < 1) cols[axis] = 1;
+		perUnit[axis] = static_cast<float>(cols[axis]) / (2.0f * w[axis]);
+	}
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+SpatialHash::~SpatialHash()
+{
+}
+
+// --------------------------------------------------------
+// Start tracking a proxy
+// --------------------------------------------------------
+void SpatialHash::AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	if (id >= proxies.size())
+		proxies.resize(id + 1);
+	proxies[id] = { center, halfExtents, true };
+}
+
+// --------------------------------------------------------
+// Stop tracking a proxy
+// --------------------------------------------------------
+void SpatialHash::RemoveProxy(unsigned int id)
+{
+	proxies[id].isActive = false;
+}
+
+// --------------------------------------------------------
+// Stop tracking every proxy, and empty the cells so queries
+// before the next FindPairs find nothing
+// --------------------------------------------------------
+void SpatialHash::RemoveAllProxies()
+{
+	proxies.clear();
+	Rebin();
+}
+
+// --------------------------------------------------------
+// Store new bounds for a proxy
+// --------------------------------------------------------
+void SpatialHash::UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	proxies[id].center = center;
+	proxies[id].halfExtents = halfExtents;
+}
+
+// --------------------------------------------------------
+// Rebin every proxy and add each pair sharing a cell
+// --------------------------------------------------------
+void SpatialHash::FindPairs(CollisionPairCache& pairCache)
+{
+	Rebin();
+
+	unsigned int cellCount = GetCellCount();
+	for (unsigned int cell = 0; cell < cellCount; cell++) {
+		unsigned int count;
+		const unsigned int* ids = GetCell(cell, count);
+
+		for (unsigned int i = 0; i < count; i++) {
+			for (unsigned int j = i + 1; j < count; j++) {
+				// Hashed cells can hold the same proxy twice
+				if (ids[i] == ids[j] || !CanPair(ids[i], ids[j])) continue;
+				pairCache.AddCandidate(ids[i], ids[j]);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Append every proxy in the cells the box overlaps whose
+// bounds overlap the box
+// --------------------------------------------------------
+void SpatialHash::QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results)
+{
+	if (bucketOffsets.empty())
+		return;
+
+	int iMin = ClampCell((center.x - halfExtents.x + halfWidth.x) * cellsPerUnit.x, 0);
+	int iMax = ClampCell((center.x + halfExtents.x + halfWidth.x) * cellsPerUnit.x, 0);
+	int jMin = ClampCell((center.y - halfExtents.y + halfWidth.y) * cellsPerUnit.y, 1);
+	int jMax = ClampCell((center.y + halfExtents.y + halfWidth.y) * cellsPerUnit.y, 1);
+	int kMin = ClampCell((center.z - halfExtents.z + halfWidth.z) * cellsPerUnit.z, 2);
+	int kMax = ClampCell((center.z + halfExtents.z + halfWidth.z) * cellsPerUnit.z, 2);
+
+	for (int k = kMin; k <= kMax; k++) {
+		for (int j = jMin; j <= jMax; j++) {
+			for (int i = iMin; i <= iMax; i++) {
+				unsigned int count;
+				const unsigned int* ids = GetBucket(CellKey(i, j, k), count);
+				for (unsigned int e = 0; e < count; e++) {
+					const ProxyBounds& proxy = proxies[ids[e]];
+					if (proxy.isActive &&
+						fabsf(proxy.center.x - center.x) <= proxy.halfExtents.x + halfExtents.x &&
+						fabsf(proxy.center.y - center.y) <= proxy.halfExtents.y + halfExtents.y &&
+						fabsf(proxy.center.z - center.z) <= proxy.halfExtents.z + halfExtents.z)
+						results.push_back(ids[e]);
+				}
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Walk the cells along the segment in order, appending the
+// proxies whose bounds it crosses. The segment is clipped
+// to the world first, colliders outside it were clamped to
+// the border cells the segment passes through.
+// --------------------------------------------------------
+void SpatialHash::QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results)
+{
+	if (bucketOffsets.empty())
+		return;
+
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	XMFLOAT3 worldMin(-halfWidth.x, -halfWidth.y, -halfWidth.z);
+	if (!ClipSegment(origin, direction, worldMin, halfWidth, tMin, tMax))
+		return;
+
+	// Cell the clipped segment starts in, and the distance along the
+	// segment to the next cell boundary on each axis
+	const float* o = &origin.x;
+	const float* d = &direction.x;
+	const float* w = &halfWidth.x;
+	const float* perUnit = &cellsPerUnit.x;
+	int cell[3], step[3];
+	float tNext[3], tDelta[3];
+	for (int axis = 0; axis < 3; axis++) {
+		float coord = (o[axis] + d[axis] * tMin + w[axis]) * perUnit[axis];
+		float speed = d[axis] * perUnit[axis];
+		cell[axis] = ClampCell(coord, axis);
+		if (speed > 0) {
+			step[axis] = 1;
+			tNext[axis] = tMin + (cell[axis] + 1 - coord) / speed;
+			tDelta[axis] = 1.0f / speed;
+		}
+		else if (speed < 0) {
+			step[axis] = -1;
+			tNext[axis] = tMin + (cell[axis] - coord) / speed;
+			tDelta[axis] = -1.0f / speed;
+		}
+		else {
+			step[axis] = 0;
+			tNext[axis] = FLT_MAX;
+			tDelta[axis] = 0;
+		}
+	}
+
+	while (true) {
+		unsigned int count;
+		const unsigned int* ids = GetBucket(CellKey(cell[0], cell[1], cell[2]), count);
+		for (unsigned int e = 0; e < count; e++) {
+			const ProxyBounds& proxy = proxies[ids[e]];
+			if (!proxy.isActive) continue;
+			XMFLOAT3 min(proxy.center.x - proxy.halfExtents.x, proxy.center.y - proxy.halfExtents.y, proxy.center.z - proxy.halfExtents.z);
+			XMFLOAT3 max(proxy.center.x + proxy.halfExtents.x, proxy.center.y + proxy.halfExtents.y, proxy.center.z + proxy.halfExtents.z);
+			if (SegmentOverlapsBounds(origin, direction, maxDistance, min, max))
+				results.push_back(ids[e]);
+		}
+
+		// Step across the nearest boundary
+		int axis = tNext[0] < tNext[1] ? 0 : 1;
+		if (tNext[2] < tNext[axis]) axis = 2;
+		if (tNext[axis] > tMax) break;
+		cell[axis] += step[axis];
+		if (cell[axis] < 0 || cell[axis] >= cols[axis]) break;
+		tNext[axis] += tDelta[axis];
+	}
+}
+
+// --------------------------------------------------------
+// Stage every active proxy and sort them into cells, for
+// queries on proxies that are never paired with each other
+// --------------------------------------------------------
+void SpatialHash::Rebin()
+{
+	Clear();
+	for (unsigned int id = 0; id < proxies.size(); id++) {
+		if (proxies[id].isActive)
+			Insert(proxies[id].center, proxies[id].halfExtents, id);
+	}
+	Build();
+}
+
+// --------------------------------------------------------
+// Remove all entries without freeing memory
+// --------------------------------------------------------
+void SpatialHash::Clear()
+{
+	entryCells.clear();
+	entryIds.clear();
+	cellRanges.clear();
+}
+
+// --------------------------------------------------------
+// Stage an id into every cell overlapped by the given box.
+// Colliders outside the world bounds are clamped to the border cells.
+//
+// center		- world position of the collider
+// halfExtents	- half widths of the collider
+// id			- value handed back by GetCell
+// --------------------------------------------------------
+void SpatialHash::Insert(const XMFLOAT3& center, const XMFLOAT3& halfExtents, unsigned int id)
+{
+	int iMin = ClampCell((center.x - halfExtents.x + halfWidth.x) * cellsPerUnit.x, 0);
+	int iMax = ClampCell((center.x + halfExtents.x + halfWidth.x) * cellsPerUnit.x, 0);
+	int jMin = ClampCell((center.y - halfExtents.y + halfWidth.y) * cellsPerUnit.y, 1);
+	int jMax = ClampCell((center.y + halfExtents.y + halfWidth.y) * cellsPerUnit.y, 1);
+	int kMin = ClampCell((center.z - halfExtents.z + halfWidth.z) * cellsPerUnit.z, 2);
+	int kMax = ClampCell((center.z + halfExtents.z + halfWidth.z) * cellsPerUnit.z, 2);
+
+	for (int k = kMin; k <= kMax; k++) {
+		for (int j = jMin; j <= jMax; j++) {
+			for (int i = iMin; i <= iMax; i++) {
+				entryCells.push_back(CellKey(i, j, k));
+				entryIds.push_back(id);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Group staged entries by bucket with a counting sort and
+// record the buckets that can produce pairs.
+// --------------------------------------------------------
+void SpatialHash::Build()
+{
+	size_t entryCount = entryIds.size();
+
+	// At least two buckets per entry keeps unrelated cells from sharing
+	unsigned int bucketBits = SPATIAL_HASH_MIN_BUCKET_BITS;
+	while ((1u << bucketBits) < entryCount * 2 && bucketBits < 31)
+		bucketBits++;
+	unsigned int bucketCount = 1u << bucketBits;
+
+	// Small grids index buckets by cell directly, larger ones are folded
+	// with a Fibonacci hash. Folded cells share a bucket, which only adds candidates.
+	unsigned long long cellCount = static_cast<unsigned long long>(cols[0]) * cols[1] * cols[2];
+	bool directIndex = cellCount <= bucketCount;
+	this->bucketBits = bucketBits;
+	isDirectIndex = directIndex;
+
+	// Histogram
+	bucketOffsets.assign(bucketCount + 1, 0);
+	for (size_t e = 0; e < entryCount; e++) {
+		if (!directIndex)
+			entryCells[e] = (entryCells[e] * 2654435769u) >> (32 - bucketBits);
+		bucketOffsets[entryCells[e] + 1]++;
+	}
+
+	// Prefix sum turns counts into start offsets
+	for (unsigned int b = 0; b < bucketCount; b++)
+		bucketOffsets[b + 1] += bucketOffsets[b];
+
+	// Record every bucket that has at least two entries
+	cellRanges.clear();
+	for (unsigned int b = 0; b < bucketCount; b++) {
+		if (bucketOffsets[b + 1] - bucketOffsets[b] > 1) {
+			cellRanges.push_back(bucketOffsets[b]);
+			cellRanges.push_back(bucketOffsets[b + 1]);
+		}
+	}
+
+	// Scatter, bucketOffsets[b] walks forward to the end of bucket b
+	sortedIds.resize(entryCount);
+	for (size_t e = 0; e < entryCount; e++)
+		sortedIds[bucketOffsets[entryCells[e]]++] = entryIds[e];
+}
+
+// --------------------------------------------------------
+// Number of cells that hold two or more entries
+// --------------------------------------------------------
+unsigned int SpatialHash::GetCellCount() const
+{
+	return static_cast<unsigned int>(cellRanges.size() / 2);
+}
+
+// --------------------------------------------------------
+// Get the ids stored in a cell
+//
+// cell		- index in [0, GetCellCount())
+// count	- set to the number of ids in the cell
+// --------------------------------------------------------
+const unsigned int * SpatialHash::GetCell(unsigned int cell, unsigned int& count) const
+{
+	unsigned int start = cellRanges[cell * 2];
+	count = cellRanges[cell * 2 + 1] - start;
+	return &sortedIds[start];
+}
+
+// --------------------------------------------------------
+// Convert a grid coordinate to a cell index in
+// [0, cols[axis])
+// --------------------------------------------------------
+int SpatialHash::ClampCell(float coord, int axis) const
+{
+	int c = static_cast<int>(coord);
+	if (coord < 0) c = 0;
+	if (c >= cols[axis]) c = cols[axis] - 1;
+	return c;
+}
+
+// --------------------------------------------------------
+// Key of the cell at column i, row j and slice k
+// --------------------------------------------------------
+unsigned int SpatialHash::CellKey(int i, int j, int k) const
+{
+	return static_cast<unsigned int>(i + cols[0] * (j + cols[1] * k));
+}
+
+// --------------------------------------------------------
+// Get the ids of the bucket a cell was sorted into by the
+// last Build(). Folded buckets also hold other cells' ids.
+// --------------------------------------------------------
+const unsigned int * SpatialHash::GetBucket(unsigned int cell, unsigned int& count) const
+{
+	unsigned int bucket = isDirectIndex ? cell : (cell * 2654435769u) >> (32 - bucketBits);
+	unsigned int start = bucket == 0 ? 0 : bucketOffsets[bucket - 1];
+	count = bucketOffsets[bucket] - start;
+	return sortedIds.data() + start;
+}
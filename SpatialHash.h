@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "Broadphase.h"
+
+using namespace DirectX;
+
+// Flat spatial hash used as the collision broadphase.
+// Colliders are staged as (cell key, id) entries and grouped by cell with a
+// counting sort on Build(), so each cell is a contiguous run of ids that can
+// be walked linearly. All arrays keep their capacity between frames.
+class SpatialHash :
+	public Broadphase
+{
+public:
+	SpatialHash();
+	SpatialHash(float maxScale, XMFLOAT3 halfWidth);
+	~SpatialHash();
+
+	// Inherited via Broadphase, the whole hash is rebuilt in FindPairs
+	void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void RemoveProxy(unsigned int id) override;
+	void RemoveAllProxies() override;
+	void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void FindPairs(CollisionPairCache& pairCache) override;
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) override;
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) override;
+
+	void Rebin();	// Rebuild the cells from every proxy's bounds, without looking for pairs
+	void Clear();	// Remove all staged entries, keeps allocations
+	void Insert(const XMFLOAT3& center, const XMFLOAT3& halfExtents, unsigned int id);	// Stage an id into every cell it overlaps
+	void Build();	// Sort staged entries into cells
+
+	// Cells holding two or more entries after the last Build()
+	unsigned int GetCellCount() const;
+	const unsigned int* GetCell(unsigned int cell, unsigned int& count) const;
+
+private:
+	int cols[3] = { 1, 1, 1 };	// Cells along each axis
+	XMFLOAT3 halfWidth = XMFLOAT3(10, 10, 10);
+	XMFLOAT3 cellsPerUnit = XMFLOAT3(0.05f, 0.05f, 0.05f);
+
+	// Bounds of every proxy, indexed by proxy id
+	struct ProxyBounds {
+		XMFLOAT3 center;
+		XMFLOAT3 halfExtents;
+		bool isActive;
+	};
+	std::vector<ProxyBounds> proxies;
+
+	// Staged entries
+	std::vector<unsigned int> entryCells;
+	std::vector<unsigned int> entryIds;
+
+	// Counting sort output
+	std::vector<unsigned int> bucketOffsets;	// Histogram, then start of each bucket in sortedIds
+	std::vector<unsigned int> sortedIds;		// Ids grouped by bucket
+	std::vector<unsigned int> cellRanges;		// (start, end) into sortedIds for buckets with 2+ entries
+
+	// Bucket layout of the last Build(), bucketOffsets[b] is then the end of bucket b
+	unsigned int bucketBits = 0;
+	bool isDirectIndex = true;
+
+	int ClampCell(float coord, int axis) const;
+	unsigned int CellKey(int i, int j, int k) const;
+	const unsigned int* GetBucket(unsigned int cell, unsigned int& count) const;
+};
+
@@ -1,6 +1,9 @@
 #include "StateManager.h"
+#include <chrono>
 #include "MemoryDebug.h"
 
+typedef std::chrono::high_resolution_clock SceneClock;
+
 StateManager::StateManager()
 {
 }
@@ -18,6 +21,16 @@ GameState& StateManager::GetCurrentState()
 	return currentState;
 }
 
+double StateManager::GetLastUnloadMilliseconds() const
+{
+	return lastUnloadMilliseconds;
+}
+
+double StateManager::GetLastLoadMilliseconds() const
+{
+	return lastLoadMilliseconds;
+}
+
 void StateManager::AddScene(GameState state, Scene * scene)
 {
 	if (scenesMap[state] == nullptr)
@@ -49,9 +62,17 @@ void StateManager::SetMaterials(std::unordered_map<const char*, Material*>* mate
 
 void StateManager::SetState(GameState newState)
 {
+	// Time both halves of the switch, unloading is where the old scene's
+	// entities, colliders and emitters are freed
+	SceneClock::time_point start = SceneClock::now();
 	UnloadScene(currentScene);
+	SceneClock::time_point unloaded = SceneClock::now();
 	currentScene = scenesMap[newState];
 	LoadScene(currentScene);
+	SceneClock::time_point loaded = SceneClock::now();
+
+	lastUnloadMilliseconds = std::chrono::duration<double, std::milli>(unloaded - start).count();
+	lastLoadMilliseconds = std::chrono::duration<double, std::milli>(loaded - unloaded).count();
 }
 
 void StateManager::LoadScene(Scene* scene)
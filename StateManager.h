@@ -13,6 +13,10 @@ public:
 	~StateManager();
 
 	GameState& GetCurrentState();
+
+	// Milliseconds the last SetState spent unloading the old scene and loading the new one
+	double GetLastUnloadMilliseconds() const;
+	double GetLastLoadMilliseconds() const;
 	
 	void AddScene(GameState state, Scene* scene);	// Add scene to associate with state
 	Scene* GetCurrentScene();	// Get pointer to current scene
@@ -33,6 +37,9 @@ private:
 
 	std::unordered_map<GameState, Scene*> scenesMap;
 
+	double lastUnloadMilliseconds = 0;
+	double lastLoadMilliseconds = 0;
+
 	void LoadScene(Scene* scene);	// Load a new scene
 	void UnloadScene(Scene* scene);	// Unload the current scene
 };
@@ -0,0 +1,374 @@
+#include <algorithm>
+#include "SweepAndPrune.h"
+#include "MemoryDebug.h"
+
+#define ENDPOINT_IS_MAX(data) ((data) & 1)
+#define ENDPOINT_ID(data) ((data) >> 1)
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+SweepAndPrune::SweepAndPrune()
+{
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+SweepAndPrune::~SweepAndPrune()
+{
+}
+
+// --------------------------------------------------------
+// Start tracking a proxy. Its endpoints are appended to the
+// end of each axis and sorted into place on the next
+// FindPairs, which also finds its overlaps.
+// --------------------------------------------------------
+void SweepAndPrune::AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	if (id >= boxes.size())
+		boxes.resize(id + 1);
+
+	Box& box = boxes[id];
+	box.isActive = true;
+	const float* c = &center.x;
+	const float* h = &halfExtents.x;
+	for (int axis = 0; axis < 3; axis++) {
+		box.min[axis] = c[axis] - h[axis];
+		box.max[axis] = c[axis] + h[axis];
+
+		box.minIndex[axis] = static_cast<unsigned int>(axes[axis].size());
+		axes[axis].push_back({ box.min[axis], id << 1 });
+		box.maxIndex[axis] = static_cast<unsigned int>(axes[axis].size());
+		axes[axis].push_back({ box.max[axis], (id << 1) | 1 });
+	}
+	if (box.max[0] - box.min[0] > widestX) widestX = box.max[0] - box.min[0];
+	addedSinceSort++;
+}
+
+// --------------------------------------------------------
+// Stop tracking a proxy, its endpoints and pairs are
+// removed right away so the id can be reused
+// --------------------------------------------------------
+void SweepAndPrune::RemoveProxy(unsigned int id)
+{
+	Box& box = boxes[id];
+	box.isActive = false;
+
+	for (int axis = 0; axis < 3; axis++) {
+		std::vector<Endpoint>& endpoints = axes[axis];
+
+		// Close the gaps left by both endpoints, max is always after min
+		unsigned int minIndex = box.minIndex[axis];
+		unsigned int maxIndex = box.maxIndex[axis];
+		endpoints.erase(endpoints.begin() + maxIndex);
+		endpoints.erase(endpoints.begin() + minIndex);
+
+		for (unsigned int i = minIndex; i < endpoints.size(); i++)
+			SetEndpointIndex(axis, i);
+	}
+
+	// Drop every pair using this proxy
+	for (size_t i = pairs.size() - 1; i < pairs.size(); i--) {
+		if (CollisionPairCache::GetFirst(pairs[i]) == id || CollisionPairCache::GetSecond(pairs[i]) == id)
+			RemovePair(CollisionPairCache::GetFirst(pairs[i]), CollisionPairCache::GetSecond(pairs[i]));
+	}
+}
+
+// --------------------------------------------------------
+// Stop tracking every proxy, dropping the endpoint lists
+// and pairs whole instead of closing gaps one by one
+// --------------------------------------------------------
+void SweepAndPrune::RemoveAllProxies()
+{
+	for (int axis = 0; axis < 3; axis++)
+		axes[axis].clear();
+	boxes.clear();
+	pairs.clear();
+	pairIndices.clear();
+	addedSinceSort = 0;
+	widestX = 0;
+}
+
+// --------------------------------------------------------
+// Store new bounds for a proxy, sorting waits for FindPairs
+// --------------------------------------------------------
+void SweepAndPrune::UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents)
+{
+	Box& box = boxes[id];
+	const float* c = &center.x;
+	const float* h = &halfExtents.x;
+	for (int axis = 0; axis < 3; axis++) {
+		box.min[axis] = c[axis] - h[axis];
+		box.max[axis] = c[axis] + h[axis];
+		axes[axis][box.minIndex[axis]].value = box.min[axis];
+		axes[axis][box.maxIndex[axis]].value = box.max[axis];
+	}
+	if (box.max[0] - box.min[0] > widestX) widestX = box.max[0] - box.min[0];
+}
+
+// --------------------------------------------------------
+// Re-sort each axis, updating the pair set as endpoints
+// pass each other, then add every overlapping pair
+// --------------------------------------------------------
+void SweepAndPrune::FindPairs(CollisionPairCache& pairCache)
+{
+	// Appended endpoints start out of order, a large batch of them is
+	// cheaper to handle with a full sort than with insertion sort
+	if (addedSinceSort > 16 && addedSinceSort * 8 > axes[0].size() / 2) {
+		RebuildAxes();
+	}
+	else {
+		for (int axis = 0; axis < 3; axis++)
+			SortAxis(axis);
+	}
+	addedSinceSort = 0;
+
+	// Boxes only grow the widest width between frames, shrink it back here
+	widestX = 0;
+	for (size_t id = 0; id < boxes.size(); id++) {
+		if (boxes[id].isActive && boxes[id].max[0] - boxes[id].min[0] > widestX)
+			widestX = boxes[id].max[0] - boxes[id].min[0];
+	}
+
+	// Overlaps are tracked for every layer, so a layer change needs no rescan
+	for (size_t i = 0; i < pairs.size(); i++) {
+		unsigned int a = CollisionPairCache::GetFirst(pairs[i]);
+		unsigned int b = CollisionPairCache::GetSecond(pairs[i]);
+		if (CanPair(a, b))
+			pairCache.AddCandidate(a, b);
+	}
+}
+
+// --------------------------------------------------------
+// Append every proxy whose box overlaps the query box.
+// A box overlapping the query on x has its min endpoint no
+// further left than the query's min less the widest box, so
+// only that stretch of the sorted x axis is walked. Proxies
+// appended since the last sort are checked one by one.
+// --------------------------------------------------------
+void SweepAndPrune::QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results)
+{
+	const float* c = &center.x;
+	const float* h = &halfExtents.x;
+	float queryMin[3], queryMax[3];
+	for (int axis = 0; axis < 3; axis++) {
+		queryMin[axis] = c[axis] - h[axis];
+		queryMax[axis] = c[axis] + h[axis];
+	}
+
+	const std::vector<Endpoint>& endpoints = axes[0];
+	size_t unsorted = static_cast<size_t>(addedSinceSort) * 2;
+	size_t sortedCount = endpoints.size() > unsorted ? endpoints.size() - unsorted : 0;
+
+	auto appendIfOverlapping = [&](const Endpoint& endpoint) {
+		if (ENDPOINT_IS_MAX(endpoint.data)) return;
+		unsigned int id = ENDPOINT_ID(endpoint.data);
+		const Box& box = boxes[id];
+		for (int axis = 0; axis < 3; axis++) {
+			if (box.max[axis] < queryMin[axis] || box.min[axis] > queryMax[axis]) return;
+		}
+		results.push_back(id);
+	};
+
+	float first = queryMin[0] - widestX;
+	size_t i = std::lower_bound(endpoints.begin(), endpoints.begin() + sortedCount, first,
+		[](const Endpoint& endpoint, float value) { return endpoint.value < value; }) - endpoints.begin();
+	for (; i < sortedCount && endpoints[i].value <= queryMax[0]; i++)
+		appendIfOverlapping(endpoints[i]);
+	for (i = sortedCount; i < endpoints.size(); i++)
+		appendIfOverlapping(endpoints[i]);
+}
+
+// --------------------------------------------------------
+// Box query over the segment's bounds, then a slab test of
+// each proxy found. There is no order along the segment to
+// use here, so long diagonal rays cost the most.
+// --------------------------------------------------------
+void SweepAndPrune::QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results)
+{
+	XMVECTOR start = XMLoadFloat3(&origin);
+	XMVECTOR end = start + XMLoadFloat3(&direction) * maxDistance;
+	XMFLOAT3 center, halfExtents;
+	XMStoreFloat3(&center, (start + end) * 0.5f);
+	XMStoreFloat3(&halfExtents, XMVectorAbs(end - start) * 0.5f);
+
+	size_t first = results.size();
+	QueryBox(center, halfExtents, results);
+
+	size_t kept = first;
+	for (size_t i = first; i < results.size(); i++) {
+		const Box& box = boxes[results[i]];
+		XMFLOAT3 min(box.min[0], box.min[1], box.min[2]);
+		XMFLOAT3 max(box.max[0], box.max[1], box.max[2]);
+		if (SegmentOverlapsBounds(origin, direction, maxDistance, min, max))
+			results[kept++] = results[i];
+	}
+	results.resize(kept);
+}
+
+// --------------------------------------------------------
+// Number of overlapping pairs after the last FindPairs
+// --------------------------------------------------------
+size_t SweepAndPrune::GetPairCount() const
+{
+	return pairs.size();
+}
+
+// --------------------------------------------------------
+// Insertion sort one axis. Lists are nearly sorted from the
+// last frame so this is close to linear.
+//
+// A min moving left past a max means the boxes may have
+// started overlapping, a max moving left past a min means
+// they have stopped. Either only changes the pair if the
+// boxes overlap on the other two axes.
+// --------------------------------------------------------
+void SweepAndPrune::SortAxis(int axis)
+{
+	std::vector<Endpoint>& endpoints = axes[axis];
+
+	for (unsigned int i = 1; i < endpoints.size(); i++) {
+		Endpoint key = endpoints[i];
+		unsigned int j = i;
+
+		while (j > 0 && endpoints[j - 1].value > key.value) {
+			Endpoint& other = endpoints[j - 1];
+			unsigned int keyId = ENDPOINT_ID(key.data);
+			unsigned int otherId = ENDPOINT_ID(other.data);
+
+			if (!ENDPOINT_IS_MAX(key.data) && ENDPOINT_IS_MAX(other.data)) {
+				if (OverlapsSorted(keyId, otherId, axis))
+					AddPair(keyId, otherId);
+			}
+			else if (ENDPOINT_IS_MAX(key.data) && !ENDPOINT_IS_MAX(other.data)) {
+				if (OverlapsSorted(keyId, otherId, axis))
+					RemovePair(keyId, otherId);
+			}
+
+			// Shift the other endpoint right
+			endpoints[j] = other;
+			SetEndpointIndex(axis, j);
+			j--;
+		}
+
+		if (j != i) {
+			endpoints[j] = key;
+			SetEndpointIndex(axis, j);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Fully sort every axis and find all pairs from scratch by
+// sweeping the x axis with a list of open boxes
+// --------------------------------------------------------
+void SweepAndPrune::RebuildAxes()
+{
+	for (int axis = 0; axis < 3; axis++) {
+		std::vector<Endpoint>& endpoints = axes[axis];
+		std::sort(endpoints.begin(), endpoints.end(),
+			[](const Endpoint& a, const Endpoint& b) { return a.value < b.value || (a.value == b.value && a.data < b.data); });
+		for (unsigned int i = 0; i < endpoints.size(); i++)
+			SetEndpointIndex(axis, i);
+	}
+
+	pairs.clear();
+	pairIndices.clear();
+
+	std::vector<unsigned int> open;
+	for (unsigned int i = 0; i < axes[0].size(); i++) {
+		unsigned int data = axes[0][i].data;
+		unsigned int id = ENDPOINT_ID(data);
+
+		if (ENDPOINT_IS_MAX(data)) {
+			open.erase(std::find(open.begin(), open.end(), id));
+		}
+		else {
+			for (size_t j = 0; j < open.size(); j++) {
+				if (Overlaps(id, open[j]))
+					AddPair(id, open[j]);
+			}
+			open.push_back(id);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Box test on all three axes
+// --------------------------------------------------------
+bool SweepAndPrune::Overlaps(unsigned int a, unsigned int b) const
+{
+	const Box& boxA = boxes[a];
+	const Box& boxB = boxes[b];
+	for (int axis = 0; axis < 3; axis++) {
+		if (boxA.max[axis] < boxB.min[axis] || boxB.max[axis] < boxA.min[axis])
+			return false;
+	}
+	return a != b;
+}
+
+// --------------------------------------------------------
+// Box test on the two axes other than skipAxis, using the
+// endpoint positions instead of the values. Axes that have
+// not been sorted yet this frame still describe last frame,
+// which keeps the pair set consistent with one endpoint
+// swap at a time.
+// --------------------------------------------------------
+bool SweepAndPrune::OverlapsSorted(unsigned int a, unsigned int b, int skipAxis) const
+{
+	const Box& boxA = boxes[a];
+	const Box& boxB = boxes[b];
+	for (int axis = 0; axis < 3; axis++) {
+		if (axis == skipAxis) continue;
+		if (boxA.maxIndex[axis] < boxB.minIndex[axis] || boxB.maxIndex[axis] < boxA.minIndex[axis])
+			return false;
+	}
+	return a != b;
+}
+
+// --------------------------------------------------------
+// Add a pair unless it is already known
+// --------------------------------------------------------
+void SweepAndPrune::AddPair(unsigned int a, unsigned int b)
+{
+	CollisionPairKey key = CollisionPairCache::MakeKey(a, b);
+	if (pairIndices.find(key) != pairIndices.end())
+		return;
+
+	pairIndices[key] = static_cast<unsigned int>(pairs.size());
+	pairs.push_back(key);
+}
+
+// --------------------------------------------------------
+// Remove a pair if it is known, swapping the last pair into
+// its place
+// --------------------------------------------------------
+void SweepAndPrune::RemovePair(unsigned int a, unsigned int b)
+{
+	auto iter = pairIndices.find(CollisionPairCache::MakeKey(a, b));
+	if (iter == pairIndices.end())
+		return;
+
+	unsigned int index = iter->second;
+	pairIndices.erase(iter);
+
+	if (index != pairs.size() - 1) {
+		pairs[index] = pairs.back();
+		pairIndices[pairs[index]] = index;
+	}
+	pairs.pop_back();
+}
+
+// --------------------------------------------------------
+// Point the owning box at the endpoint's new position
+// --------------------------------------------------------
+void SweepAndPrune::SetEndpointIndex(int axis, unsigned int index)
+{
+	unsigned int data = axes[axis][index].data;
+	Box& box = boxes[ENDPOINT_ID(data)];
+	if (ENDPOINT_IS_MAX(data))
+		box.maxIndex[axis] = index;
+	else
+		box.minIndex[axis] = index;
+}
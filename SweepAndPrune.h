@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <DirectXMath.h>
+#include "Broadphase.h"
+
+using namespace DirectX;
+
+// Incremental sweep and prune broadphase.
+// Keeps the min/max endpoints of every proxy sorted along each axis. Since
+// colliders only move a little per frame, the lists are re-sorted with an
+// insertion sort and every swap of a min past a max adds or removes an
+// overlapping pair, so the pair set is carried between frames.
+class SweepAndPrune :
+	public Broadphase
+{
+public:
+	SweepAndPrune();
+	~SweepAndPrune();
+
+	// Inherited via Broadphase
+	void AddProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void RemoveProxy(unsigned int id) override;
+	void RemoveAllProxies() override;
+	void UpdateProxy(unsigned int id, const XMFLOAT3& center, const XMFLOAT3& halfExtents) override;
+	void FindPairs(CollisionPairCache& pairCache) override;
+	void QueryBox(const XMFLOAT3& center, const XMFLOAT3& halfExtents, std::vector<unsigned int>& results) override;
+	void QueryRay(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, std::vector<unsigned int>& results) override;
+
+	size_t GetPairCount() const;
+
+private:
+	// One end of a proxy on an axis, data is (proxy id << 1) | isMax
+	struct Endpoint {
+		float value;
+		unsigned int data;
+	};
+
+	struct Box {
+		float min[3];
+		float max[3];
+		unsigned int minIndex[3];	// Position of the endpoints in each axis list
+		unsigned int maxIndex[3];
+		bool isActive;
+	};
+
+	std::vector<Endpoint> axes[3];
+	std::vector<Box> boxes;	// Indexed by proxy id
+
+	// Overlapping pairs, dense for iteration with a key -> index map for removal
+	std::vector<CollisionPairKey> pairs;
+	std::unordered_map<CollisionPairKey, unsigned int> pairIndices;
+
+	unsigned int addedSinceSort = 0;	// Proxies appended since the last FindPairs
+	float widestX = 0;					// Widest box on the x axis, bounds how far back a query looks
+
+	void SortAxis(int axis);
+	void RebuildAxes();
+	bool Overlaps(unsigned int a, unsigned int b) const;
+	bool OverlapsSorted(unsigned int a, unsigned int b, int skipAxis) const;
+	void AddPair(unsigned int a, unsigned int b);
+	void RemovePair(unsigned int a, unsigned int b);
+	void SetEndpointIndex(int axis, unsigned int index);
+};
+
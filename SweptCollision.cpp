@@ -0,0 +1,243 @@
+#include "SweptCollision.h"
+#include <cmath>
+#include "MemoryDebug.h"
+
+// Motions shorter than this, squared, are treated as standing still
+#define SWEEP_EPSILON 1e-12f
+
+static const SweepResult noSweepHit = { false, 1.0f, XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 0) };
+
+// --------------------------------------------------------
+// Earliest t in [0, 1] at which origin + t * motion comes
+// within radius of center
+// --------------------------------------------------------
+static bool RayVsSphere(FXMVECTOR origin, FXMVECTOR motion, FXMVECTOR center, float radius, float& t)
+{
+	XMVECTOR m = origin - center;
+	float c = XMVectorGetX(XMVector3LengthSq(m)) - radius * radius;
+	if (c <= 0) {
+		t = 0;
+		return true;
+	}
+
+	// Standing still or moving away
+	float a = XMVectorGetX(XMVector3LengthSq(motion));
+	float b = XMVectorGetX(XMVector3Dot(m, motion));
+	if (a < SWEEP_EPSILON || b >= 0) return false;
+
+	float discriminant = b * b - a * c;
+	if (discriminant < 0) return false;
+
+	t = (-b - sqrtf(discriminant)) / a;
+	return t <= 1.0f;
+}
+
+// --------------------------------------------------------
+// Earliest t in [0, 1] at which origin + t * motion enters
+// the side of the cylinder around segment p to q. The ends
+// are left to the spheres of the capsule.
+// --------------------------------------------------------
+static bool RayVsCylinderSide(FXMVECTOR origin, FXMVECTOR motion, FXMVECTOR p, GXMVECTOR q, float radius, float& t)
+{
+	XMVECTOR axis = q - p;
+	XMVECTOR m = origin - p;
+	float dd = XMVectorGetX(XMVector3LengthSq(axis));
+	float md = XMVectorGetX(XMVector3Dot(m, axis));
+	float nd = XMVectorGetX(XMVector3Dot(motion, axis));
+	float nn = XMVectorGetX(XMVector3LengthSq(motion));
+	float mn = XMVectorGetX(XMVector3Dot(m, motion));
+
+	// Moving along the axis never crosses the side
+	float a = dd * nn - nd * nd;
+	if (a < SWEEP_EPSILON * dd) return false;
+
+	float b = dd * mn - nd * md;
+	float c = dd * (XMVectorGetX(XMVector3LengthSq(m)) - radius * radius) - md * md;
+	float discriminant = b * b - a * c;
+	if (discriminant < 0) return false;
+
+	t = (-b - sqrtf(discriminant)) / a;
+	if (t < 0 || t > 1.0f) return false;
+
+	// Only the part of the side between p and q
+	float s = md + t * nd;
+	return s >= 0 && s <= dd;
+}
+
+// --------------------------------------------------------
+// Earliest t in [0, 1] at which origin + t * motion comes
+// within radius of segment p to q
+// --------------------------------------------------------
+static bool RayVsCapsule(FXMVECTOR origin, FXMVECTOR motion, FXMVECTOR p, GXMVECTOR q, float radius, float& t)
+{
+	bool isHit = false;
+	float hitT;
+	t = 1.0f;
+	if (RayVsCylinderSide(origin, motion, p, q, radius, hitT)) { t = hitT; isHit = true; }
+	if (RayVsSphere(origin, motion, p, radius, hitT) && hitT <= t) { t = hitT; isHit = true; }
+	if (RayVsSphere(origin, motion, q, radius, hitT) && hitT <= t) { t = hitT; isHit = true; }
+	return isHit;
+}
+
+// --------------------------------------------------------
+// Corner of a box centered on the origin, a set bit picks
+// the positive side of that axis (x = 1, y = 2, z = 4)
+// --------------------------------------------------------
+static XMVECTOR BoxCorner(const XMFLOAT3& halfExtents, unsigned int bits)
+{
+	return XMVectorSet(
+		bits & 1 ? halfExtents.x : -halfExtents.x,
+		bits & 2 ? halfExtents.y : -halfExtents.y,
+		bits & 4 ? halfExtents.z : -halfExtents.z,
+		0);
+}
+
+// --------------------------------------------------------
+// Sphere against a box centered on the origin.
+//
+// The motion is first clipped against the box grown by the
+// radius. Where the grown box is hit beyond two or three of
+// the original faces the hit is on a sharp edge or corner,
+// while the real swept shape is rounded there, so the edges
+// meeting at that spot are tested as capsules instead.
+// --------------------------------------------------------
+static SweepResult SweepSphereVsBox(FXMVECTOR origin, FXMVECTOR motion, float radius, const XMFLOAT3& halfExtents)
+{
+	XMVECTOR extent = XMLoadFloat3(&halfExtents);
+
+	// Already touching at the start
+	XMVECTOR nearest = XMVectorClamp(origin, -extent, extent);
+	XMVECTOR offset = origin - nearest;
+	float distanceSq = XMVectorGetX(XMVector3LengthSq(offset));
+	if (distanceSq <= radius * radius) {
+		SweepResult result = { true, 0.0f };
+		XMStoreFloat3(&result.point, nearest);
+		XMStoreFloat3(&result.normal, distanceSq > 0 ? XMVector3Normalize(offset) : XMVectorZero());
+		return result;
+	}
+
+	// Slab test against the grown box
+	XMFLOAT3 o, d;
+	XMStoreFloat3(&o, origin);
+	XMStoreFloat3(&d, motion);
+	const float* originAxes = &o.x;
+	const float* motionAxes = &d.x;
+	const float* halfAxes = &halfExtents.x;
+
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		float grown = halfAxes[axis] + radius;
+		if (fabsf(motionAxes[axis]) * fabsf(motionAxes[axis]) < SWEEP_EPSILON) {
+			if (fabsf(originAxes[axis]) > grown) return noSweepHit;
+			continue;
+		}
+
+		float t1 = (-grown - originAxes[axis]) / motionAxes[axis];
+		float t2 = (grown - originAxes[axis]) / motionAxes[axis];
+		if (t1 > t2) { float swap = t1; t1 = t2; t2 = swap; }
+		if (t1 > tMin) tMin = t1;
+		if (t2 < tMax) tMax = t2;
+		if (tMin > tMax) return noSweepHit;
+	}
+
+	// Which original faces the hit lies beyond
+	XMFLOAT3 hit;
+	XMStoreFloat3(&hit, origin + motion * tMin);
+	const float* hitAxes = &hit.x;
+	unsigned int below = 0, above = 0, outside = 0;
+	for (int axis = 0; axis < 3; axis++) {
+		if (hitAxes[axis] < -halfAxes[axis]) { below |= 1 << axis; outside++; }
+		if (hitAxes[axis] > halfAxes[axis]) { above |= 1 << axis; outside++; }
+	}
+
+	float t = tMin;
+	if (outside == 3) {
+		// Corner region, the three edges leaving that corner
+		XMVECTOR corner = BoxCorner(halfExtents, above);
+		bool isHit = false;
+		float edgeT;
+		t = 1.0f;
+		for (unsigned int axisBit = 1; axisBit <= 4; axisBit <<= 1) {
+			if (RayVsCapsule(origin, motion, corner, BoxCorner(halfExtents, above ^ axisBit), radius, edgeT) && edgeT <= t) {
+				t = edgeT;
+				isHit = true;
+			}
+		}
+		if (!isHit) return noSweepHit;
+	}
+	else if (outside == 2) {
+		// Edge region, the edge runs along the one axis the hit is inside of
+		unsigned int edgeAxis = 7 ^ (below | above);
+		if (!RayVsCapsule(origin, motion, BoxCorner(halfExtents, above), BoxCorner(halfExtents, above | edgeAxis), radius, t))
+			return noSweepHit;
+	}
+
+	// Contact is the point on the box nearest the sphere's center at t
+	XMVECTOR center = origin + motion * t;
+	nearest = XMVectorClamp(center, -extent, extent);
+
+	SweepResult result = { true, t };
+	XMStoreFloat3(&result.point, nearest);
+	XMStoreFloat3(&result.normal, XMVector3Normalize(center - nearest));
+	return result;
+}
+
+// --------------------------------------------------------
+// Sphere against sphere, the moving sphere's center against
+// a sphere of both radii
+// --------------------------------------------------------
+SweepResult SweepSphereVsSphere(const XMFLOAT3 & start, const XMFLOAT3 & end, float radius, const XMFLOAT3 & center, float otherRadius)
+{
+	XMVECTOR origin = XMLoadFloat3(&start);
+	XMVECTOR motion = XMLoadFloat3(&end) - origin;
+	XMVECTOR centerVec = XMLoadFloat3(&center);
+
+	float t;
+	if (!RayVsSphere(origin, motion, centerVec, radius + otherRadius, t)) return noSweepHit;
+
+	// Concentric spheres have no direction
+	XMVECTOR offset = origin + motion * t - centerVec;
+	XMVECTOR normal = XMVector3Equal(offset, XMVectorZero()) ? XMVectorZero() : XMVector3Normalize(offset);
+
+	SweepResult result = { true, t };
+	XMStoreFloat3(&result.point, centerVec + normal * otherRadius);
+	XMStoreFloat3(&result.normal, normal);
+	return result;
+}
+
+// --------------------------------------------------------
+// Sphere against an axis aligned box
+// --------------------------------------------------------
+SweepResult SweepSphereVsAABB(const XMFLOAT3 & start, const XMFLOAT3 & end, float radius, const XMFLOAT3 & center, const XMFLOAT3 & halfExtents)
+{
+	XMVECTOR centerVec = XMLoadFloat3(&center);
+	XMVECTOR origin = XMLoadFloat3(&start) - centerVec;
+	XMVECTOR motion = XMLoadFloat3(&end) - XMLoadFloat3(&start);
+
+	SweepResult result = SweepSphereVsBox(origin, motion, radius, halfExtents);
+	if (result.isHit)
+		XMStoreFloat3(&result.point, XMLoadFloat3(&result.point) + centerVec);
+	return result;
+}
+
+// --------------------------------------------------------
+// Sphere against an oriented box, run in box space and the
+// contact moved back to world space
+// --------------------------------------------------------
+SweepResult SweepSphereVsOBB(const XMFLOAT3 & start, const XMFLOAT3 & end, float radius, const XMFLOAT3 & center, const XMFLOAT3 & halfExtents, const XMFLOAT4X4 & rotation)
+{
+	XMMATRIX toWorld = XMLoadFloat4x4(&rotation);
+	XMMATRIX toBox = XMMatrixTranspose(toWorld);
+
+	XMVECTOR centerVec = XMLoadFloat3(&center);
+	XMVECTOR origin = XMVector3TransformNormal(XMLoadFloat3(&start) - centerVec, toBox);
+	XMVECTOR motion = XMVector3TransformNormal(XMLoadFloat3(&end) - XMLoadFloat3(&start), toBox);
+
+	SweepResult result = SweepSphereVsBox(origin, motion, radius, halfExtents);
+	if (result.isHit) {
+		XMStoreFloat3(&result.point, XMVector3TransformNormal(XMLoadFloat3(&result.point), toWorld) + centerVec);
+		XMStoreFloat3(&result.normal, XMVector3TransformNormal(XMLoadFloat3(&result.normal), toWorld));
+	}
+	return result;
+}
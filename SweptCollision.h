@@ -0,0 +1,21 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// First contact of a sphere moving in a straight line through one update
+struct SweepResult {
+	bool isHit;
+	float toi;			// Fraction of the motion travelled before touching, 0 to 1
+	XMFLOAT3 point;		// Contact point on the target's surface
+	XMFLOAT3 normal;	// Target surface normal at the point, facing the sphere
+};
+
+// Continuous tests for a sphere of the given radius moving from start to end
+// against a stationary target. A sphere already touching the target at start
+// hits at toi 0, with a zero normal if its center starts inside the target.
+SweepResult SweepSphereVsSphere(const XMFLOAT3& start, const XMFLOAT3& end, float radius, const XMFLOAT3& center, float otherRadius);
+SweepResult SweepSphereVsAABB(const XMFLOAT3& start, const XMFLOAT3& end, float radius, const XMFLOAT3& center, const XMFLOAT3& halfExtents);
+
+// rotation takes box space to world space, as a collider's rotation matrix does
+SweepResult SweepSphereVsOBB(const XMFLOAT3& start, const XMFLOAT3& end, float radius, const XMFLOAT3& center, const XMFLOAT3& halfExtents, const XMFLOAT4X4& rotation);
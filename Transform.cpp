@@ -97,7 +97,7 @@ void Transform::Move(float dx, float dy, float dz)
 	position.x += dx;
 	position.y += dy;
 	position.z += dz;
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 // --------------------------------------------------------
@@ -126,7 +126,7 @@ void Transform::MoveForward(float dright, float dup, float dfwd)
 
 	// Store back in pos and set dirty
 	XMStoreFloat3(&position, xmPos);
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 
@@ -143,7 +143,7 @@ void Transform::SetPosition(XMFLOAT3 position)
 	//memcpy(&this->position, position, sizeof(XMFLOAT3));
 
 	// setting dirty since next time we ask for world, we need to recalc
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 // --------------------------------------------------------
@@ -161,7 +161,7 @@ void Transform::SetPosition(float x, float y, float z)
 	position.z = z;
 
 	// setting dirty since next time we ask for world, we need to recalc
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 // --------------------------------------------------------
@@ -176,7 +176,7 @@ void Transform::SetScale(XMFLOAT3 scale)
 	//memcpy(&this->scale, scale, sizeof(float) * 3);
 
 	// setting dirty since next time we ask for world, we need to recalc
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 // --------------------------------------------------------
@@ -194,7 +194,7 @@ void Transform::SetScale(float x, float y, float z)
 	scale.z = z;
 
 	// setting dirty since next time we ask for world, we need to recalc
-	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT);
+	isDirty |= (IS_DIRTY_WVM | IS_DIRTY_IVT | IS_DIRTY_COL);
 }
 
 // --------------------------------------------------------
@@ -302,6 +302,15 @@ const unsigned short Transform::IsDirty() const
 	return isDirty;
 }
 
+// --------------------------------------------------------
+// Clear dirty flags once whoever keeps that state has
+// caught up with this transform
+// --------------------------------------------------------
+void Transform::ClearDirty(unsigned short flags)
+{
+	isDirty &= (~flags);
+}
+
 // --------------------------------------------------------
 // Get the world matrix
 // --------------------------------------------------------
@@ -329,6 +338,58 @@ const XMFLOAT4X4 & Transform::GetInverseTransposeWorldMatrix()
 	return worldInverseTranspose;
 }
 
+// --------------------------------------------------------
+// Save the current state as the last tick's
+// --------------------------------------------------------
+void Transform::SavePrevious()
+{
+	previousPosition = position;
+	previousScale = scale;
+	previousRotation = rotation;
+	hasPrevious = true;
+}
+
+// --------------------------------------------------------
+// Drop the last tick's state
+// --------------------------------------------------------
+void Transform::ResetPrevious()
+{
+	hasPrevious = false;
+}
+
+// --------------------------------------------------------
+// Blend the last tick's state and the current one and
+// build the matrices from that
+//
+// alpha								- 0 for the last tick's state,
+//										  1 for the current one
+// interpolatedWorld					- Gets the transposed world matrix
+// interpolatedWorldInverseTranspose	- Gets its inverse transpose
+// --------------------------------------------------------
+void Transform::GetInterpolatedWorldMatrices(float alpha, XMFLOAT4X4& interpolatedWorld, XMFLOAT4X4& interpolatedWorldInverseTranspose)
+{
+	// Most transforms did not move since the last tick, those keep their cached matrices
+	bool isMoving = hasPrevious && alpha < 1.0f
+		&& (position.x != previousPosition.x || position.y != previousPosition.y || position.z != previousPosition.z
+		|| scale.x != previousScale.x || scale.y != previousScale.y || scale.z != previousScale.z
+		|| rotation.x != previousRotation.x || rotation.y != previousRotation.y
+		|| rotation.z != previousRotation.z || rotation.w != previousRotation.w);
+	if (!isMoving) {
+		interpolatedWorld = GetWorldMatrix();
+		interpolatedWorldInverseTranspose = GetInverseTransposeWorldMatrix();
+		return;
+	}
+
+	XMMATRIX scaleMat = XMMatrixScalingFromVector(XMVectorLerp(XMLoadFloat3(&previousScale), XMLoadFloat3(&scale), alpha));
+	XMMATRIX rotMat = XMMatrixRotationQuaternion(XMQuaternionSlerp(XMLoadFloat4(&previousRotation), XMLoadFloat4(&rotation), alpha));
+	XMMATRIX transMat = XMMatrixTranslationFromVector(XMVectorLerp(XMLoadFloat3(&previousPosition), XMLoadFloat3(&position), alpha));
+	XMMATRIX worldMat = scaleMat * rotMat * transMat;
+
+	// Transposed for the shader as the cached ones are
+	XMStoreFloat4x4(&interpolatedWorld, XMMatrixTranspose(worldMat));
+	XMStoreFloat4x4(&interpolatedWorldInverseTranspose, XMMatrixInverse(nullptr, worldMat));
+}
+
 // --------------------------------------------------------
 // Recalculates the current world matrix according to the supplied
 // scale, rotation and translation vectors
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <d3d11.h>
+#include <cstddef>
 #include <DirectXMath.h>
 
 using namespace DirectX;
@@ -9,7 +9,8 @@ using namespace DirectX;
 #define IS_DIRTY_WVM	0x000F // is world view matrix dirty
 #define IS_DIRTY_RUF	0x00F0 // is RUF dirty
 #define IS_DIRTY_IVT	0x0F00 // inverse transpose dirty
-#define IS_DIRTY_ALL	0x0FFF // all dirty
+#define IS_DIRTY_COL	0xF000 // collider world state dirty
+#define IS_DIRTY_ALL	0xFFFF // all dirty
 
 // Asserts
 // Including some static asserts to be super duper sure XMFLOAT3 can cast to
@@ -60,11 +61,27 @@ public:
 
 	// Return whether or not transform is currently dirty
 	const unsigned short IsDirty() const;
+
+	// Clear flags for state kept outside the transform, like IS_DIRTY_COL
+	void ClearDirty(unsigned short flags);
 	
 	// return reference or copy???
 	const XMFLOAT4X4& GetWorldMatrix();
 	const XMFLOAT4X4& GetInverseTransposeWorldMatrix();
 
+	// Keep the current state as that of the last simulation tick, which the
+	// interpolated matrices blend from
+	void SavePrevious();
+
+	// Forget the last tick's state, so a transform placed somewhere new is
+	// not drawn sliding there before the next tick saves one again
+	void ResetPrevious();
+
+	// World matrix and its inverse transpose alpha of the way from the last
+	// tick's state to the current one. The current matrices while there is
+	// no last state or it is the same.
+	void GetInterpolatedWorldMatrices(float alpha, XMFLOAT4X4& interpolatedWorld, XMFLOAT4X4& interpolatedWorldInverseTranspose);
+
 private:
 	// Perform this call internally so unnecessary calculations are not made
 	void CalculateWorldMatrix();
@@ -85,6 +102,12 @@ private:
 	XMFLOAT4X4 world; // world matrix
 	XMFLOAT4X4 worldInverseTranspose;
 
+	// State as of the last simulation tick
+	XMFLOAT3 previousPosition;
+	XMFLOAT3 previousScale;
+	XMFLOAT4 previousRotation;
+	bool hasPrevious = false;
+
 	// whenever an update to isSTDirty or isRDirty occurs, world mat will be recalc'd
 	unsigned short isDirty;
 };